@@ -0,0 +1,116 @@
+#-------------------------------------------------
+#
+# Settings shared by all the Chronomodel targets :
+# - ChronomodelCore.pro : the engine (model, MCMC, plugins likelihoods), a static library without QtWidgets
+# - Chronomodel.pro : the application
+# - ChronomodelCmd.pro : the command line
+# Set TARGET before including this file.
+#
+#-------------------------------------------------
+VERSION = 1.3.5 # check in file main.cpp
+
+CONFIG(debug, debug|release) {
+        BUILD_DIR=build/debug
+	macx{
+		REAL_DESTDIR=Debug
+	}
+} else {
+        BUILD_DIR=build/release
+	macx{
+		REAL_DESTDIR=Release
+	}
+}
+
+# The targets are built from the same directory : each one has its own intermediate files
+DESTDIR = $$BUILD_DIR
+OBJECTS_DIR = $$BUILD_DIR/$$TARGET/obj
+MOC_DIR = $$BUILD_DIR/$$TARGET/moc
+RCC_DIR = $$BUILD_DIR/$$TARGET/rcc
+
+# Compilation warning flags
+QMAKE_CXXFLAGS_WARN_ON += -Wno-unknown-pragmas -Wno-unused-parameter
+
+#########################################
+# C++ 11
+# Config must use C++ 11 for random number generator
+# This works for Windows, Linux & Mac 10.7 and +
+#########################################
+CONFIG += C++11
+
+macx{
+	# This is the SDK used to compile : change it to whatever latest version of mac you are using.
+	QMAKE_MAC_SDK = macosx10.11
+	
+	# This is the minimal Mac OS X version supported by the application. You must have the corresponding SDK installed whithin XCode.
+	QMAKE_MACOSX_DEPLOYMENT_TARGET = 10.7
+}
+
+#########################################
+# DEFINES
+#########################################
+
+DEFINES += _USE_MATH_DEFINES
+
+# Activate this to use FFT kernel method on histograms
+
+USE_FFT = 1
+DEFINES += "USE_FFT=$${USE_FFT}"
+
+# Choose the plugins to compile directly with the application
+
+USE_PLUGIN_UNIFORM = 1
+USE_PLUGIN_GAUSS = 1
+USE_PLUGIN_14C = 1
+USE_PLUGIN_TL = 1
+USE_PLUGIN_AM = 1
+
+DEFINES += "USE_PLUGIN_UNIFORM=$${USE_PLUGIN_UNIFORM}"
+DEFINES += "USE_PLUGIN_GAUSS=$${USE_PLUGIN_GAUSS}"
+DEFINES += "USE_PLUGIN_14C=$${USE_PLUGIN_14C}"
+DEFINES += "USE_PLUGIN_TL=$${USE_PLUGIN_TL}"
+DEFINES += "USE_PLUGIN_AM=$${USE_PLUGIN_AM}"
+
+#########################################
+# FFTW
+# FFTW_LIBS is added by ChronomodelCore.pri, after the core library
+#########################################
+
+macx{
+	# IMPORTANT NOTE :
+	# We use FFTW 3.2.2 on Mac to support Mac OS X versions from 10.7.
+	# (Using FFTW 3.3.4 is available for mac 10.9+)
+	# We provide FFTW.3.2.2.dmg if you want to install it on your system, but this is not necessary!
+	# The generated XCode project will locate FFTW files in the project directory and statically link against it.
+	
+	# this is to include fftw.h in the code :
+	INCLUDEPATH += $$PWD/lib/FFTW/mac
+	
+	# Link the application with FFTW library
+	# If no dylib are present, static libs (.a) are used => that's why we moved .dylib files in a "dylib" folder.
+	FFTW_LIBS = -L"$$PWD/lib/FFTW/mac" -lfftw3f
+}
+win32{
+	INCLUDEPATH += $$PWD/lib/FFTW
+	FFTW_LIBS = -L"$$PWD/lib/FFTW/win32" -lfftw3f-3
+}
+#linux :
+unix:!macx{ 
+	INCLUDEPATH += $$PWD/lib/FFTW
+	FFTW_LIBS = -lfftw3f
+}
+
+#########################################
+# INCLUDES (core)
+#########################################
+
+INCLUDEPATH += $$PWD/src/
+INCLUDEPATH += $$PWD/src/mcmc/
+INCLUDEPATH += $$PWD/src/model/
+INCLUDEPATH += $$PWD/src/plugins/
+INCLUDEPATH += $$PWD/src/plugins/plugin_14C/
+INCLUDEPATH += $$PWD/src/plugins/plugin_am/
+INCLUDEPATH += $$PWD/src/plugins/plugin_gauss/
+INCLUDEPATH += $$PWD/src/plugins/plugin_tl/
+INCLUDEPATH += $$PWD/src/plugins/plugin_uniform/
+INCLUDEPATH += $$PWD/src/project/
+INCLUDEPATH += $$PWD/src/utilities/
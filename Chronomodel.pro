@@ -6,60 +6,36 @@
 # Chronomodel
 #
 #-------------------------------------------------
-VERSION = 1.3.5 # check in file main.pro
-#PRO_PATH=$$PWD
-PRO_PATH=$$_PRO_FILE_PWD_
+TARGET = Chronomodel
+TEMPLATE = app
+
+include(Chronomodel.pri)
+include(ChronomodelCore.pri)
 
 message("-------------------------------------------")
 CONFIG(debug, debug|release) {
-        BUILD_DIR=build/debug
 	message("Running qmake : Debug")
-	macx{
-		REAL_DESTDIR=Debug
-	}
 } else {
-        BUILD_DIR=build/release
 	message("Running qmake : Release")
-	macx{
-		REAL_DESTDIR=Release
-	}
 }
-message("-------------------------------------------")
-
-
-TARGET = Chronomodel
-TEMPLATE = app
-
-DESTDIR = $$BUILD_DIR
-OBJECTS_DIR = $$BUILD_DIR/obj
-MOC_DIR = $$BUILD_DIR/moc
-RCC_DIR = $$BUILD_DIR/rcc
-
 message("PRO_PATH : $$_PRO_FILE_PWD_")
 message("BUILD_DIR : $$BUILD_DIR")
 message("DESTDIR : $$DESTDIR")
 message("OBJECTS_DIR : $$OBJECTS_DIR")
 message("MOC_DIR : $$MOC_DIR")
 message("RCC_DIR : $$RCC_DIR")
+message("-------------------------------------------")
 
+#PRO_PATH=$$PWD
+PRO_PATH=$$_PRO_FILE_PWD_
 
 # Qt modules (must be deployed along with the application
-QT += core gui widgets svg
+QT += core gui widgets svg concurrent network
 
 # Resource file (for images)
 #RESOURCES = $$PRO_PATH/Chronomodel.qrc
 RESOURCES = Chronomodel.qrc
 
-# Compilation warning flags
-QMAKE_CXXFLAGS_WARN_ON += -Wno-unknown-pragmas -Wno-unused-parameter
-
-#########################################
-# C++ 11
-# Config must use C++ 11 for random number generator
-# This works for Windows, Linux & Mac 10.7 and +
-#########################################
-CONFIG += C++11
-
 #########################################
 # MAC specific settings
 #########################################
@@ -67,68 +43,11 @@ macx{
 	# Icon file
     ICON = $$PRO_PATH/icon/Chronomodel.icns
 
-	# This is the SDK used to compile : change it to whatever latest version of mac you are using.
-	QMAKE_MAC_SDK = macosx10.11
-	
-	# This is the minimal Mac OS X version supported by the application. You must have the corresponding SDK installed whithin XCode.
-	QMAKE_MACOSX_DEPLOYMENT_TARGET = 10.7
-
 	# Define a set of resources to deploy inside the bundle :
 	RESOURCES_FILES.path = Contents/Resources
 	RESOURCES_FILES.files += $$PRO_PATH/deploy/Calib
 	#RESOURCES_FILES.files += $$PRO_PATH/icon/Chronomodel.icns
 	QMAKE_BUNDLE_DATA += RESOURCES_FILES
-}
-win32{
-	# Resource file (Windows only)
-	#RC_FILE += Chronomodel.rc
-	RC_ICONS += $$PRO_PATH/icon/Chronomodel.ico
-}
-
-#########################################
-# DEFINES
-#########################################
-
-DEFINES += _USE_MATH_DEFINES
-
-# Activate this to use FFT kernel method on histograms
-
-USE_FFT = 1
-DEFINES += "USE_FFT=$${USE_FFT}"
-
-# Choose the plugins to compile directly with the application
-
-USE_PLUGIN_UNIFORM = 1
-USE_PLUGIN_GAUSS = 1
-USE_PLUGIN_14C = 1
-USE_PLUGIN_TL = 1
-USE_PLUGIN_AM = 1
-
-DEFINES += "USE_PLUGIN_UNIFORM=$${USE_PLUGIN_UNIFORM}"
-DEFINES += "USE_PLUGIN_GAUSS=$${USE_PLUGIN_GAUSS}"
-DEFINES += "USE_PLUGIN_14C=$${USE_PLUGIN_14C}"
-DEFINES += "USE_PLUGIN_TL=$${USE_PLUGIN_TL}"
-DEFINES += "USE_PLUGIN_AM=$${USE_PLUGIN_AM}"
-
-#########################################
-# FFTW
-#########################################
-
-macx{
-	# IMPORTANT NOTE :
-	# We use FFTW 3.2.2 on Mac to support Mac OS X versions from 10.7.
-	# (Using FFTW 3.3.4 is available for mac 10.9+)
-	# We provide FFTW.3.2.2.dmg if you want to install it on your system, but this is not necessary!
-	# The generated XCode project will locate FFTW files in the project directory and statically link against it.
-	
-	# this is to include fftw.h in the code :
-	INCLUDEPATH += $$_PRO_FILE_PWD_/lib/FFTW/mac
-	
-	
-	# Link the application with FFTW library
-	# If no dylib are present, static libs (.a) are used => that's why we moved .dylib files in a "dylib" folder.
-	LIBS += -L"$$_PRO_FILE_PWD_/lib/FFTW/mac" -lfftw3f
-        LIBS += -L"$$_PRO_FILE_PWD_/lib/FFTW/mac" -lfftw3f
 	
 	# If we were deploying FFTW as a dynamic library, we should :
 	# - Move all files from "lib/FFTW/mac/dylib" to "lib/FFTW/mac"
@@ -143,29 +62,15 @@ macx{
 	#QMAKE_POST_LINK += install_name_tool -change old/path @executable_path/../Frameworks/libfftw3f.3.dylib $$PRO_PATH/Release/Chronomodel.app/Contents/MacOS/Chronomodel;
 }
 win32{
-	INCLUDEPATH += lib/FFTW
-	LIBS += -L"$$_PRO_FILE_PWD_/lib/FFTW/win32" -lfftw3f-3
-}
-#linux :
-unix:!macx{ 
-	INCLUDEPATH += lib/FFTW
-	LIBS += -lfftw3f
+	# Resource file (Windows only)
+	#RC_FILE += Chronomodel.rc
+	RC_ICONS += $$PRO_PATH/icon/Chronomodel.ico
 }
 
 #########################################
-# INCLUDES
+# INCLUDES (user interface, the core ones are in Chronomodel.pri)
 #########################################
 
-INCLUDEPATH += src/
-INCLUDEPATH += src/mcmc/
-INCLUDEPATH += src/model/
-INCLUDEPATH += src/plugins/
-INCLUDEPATH += src/plugins/plugin_14C/
-INCLUDEPATH += src/plugins/plugin_am/
-INCLUDEPATH += src/plugins/plugin_gauss/
-INCLUDEPATH += src/plugins/plugin_tl/
-INCLUDEPATH += src/plugins/plugin_uniform/
-INCLUDEPATH += src/project/
 INCLUDEPATH += src/ui/
 INCLUDEPATH += src/ui/dialogs/
 INCLUDEPATH += src/ui/graphs/
@@ -177,73 +82,52 @@ INCLUDEPATH += src/ui/panel_results/
 INCLUDEPATH += src/ui/panel_mcmc/
 INCLUDEPATH += src/ui/widgets/
 INCLUDEPATH += src/ui/window/
-INCLUDEPATH += src/utilities/
 
 #########################################
 # HEADERS
 #########################################
 
 HEADERS += src/MainController.h
-HEADERS += src/AppSettings.h
-HEADERS += src/StateKeys.h
 HEADERS += src/ChronoApp.h
 
-HEADERS += src/mcmc/Functions.h
-HEADERS += src/mcmc/Generator.h
-HEADERS += src/mcmc/MCMCLoop.h
-HEADERS += src/mcmc/MCMCLoopMain.h
-HEADERS += src/mcmc/MetropolisVariable.h
-HEADERS += src/mcmc/MHVariable.h
-HEADERS += src/mcmc/MCMCSettings.h
-
-HEADERS += src/model/Model.h
-HEADERS += src/model/Date.h
-HEADERS += src/model/Event.h
-HEADERS += src/model/EventKnown.h
-HEADERS += src/model/Phase.h
-HEADERS += src/model/Constraint.h
-HEADERS += src/model/EventConstraint.h
-HEADERS += src/model/PhaseConstraint.h
-HEADERS += src/model/ModelUtilities.h
-
-HEADERS += src/plugins/PluginAbstract.h
 HEADERS += src/plugins/PluginFormAbstract.h
 HEADERS += src/plugins/GraphViewRefAbstract.h
 HEADERS += src/plugins/PluginSettingsViewAbstract.h
+HEADERS += src/plugins/PluginUiAbstract.h
 
 equals(USE_PLUGIN_TL, 1){
-	HEADERS += src/plugins/plugin_tl/PluginTL.h
 	HEADERS += src/plugins/plugin_tl/PluginTLForm.h
 	HEADERS += src/plugins/plugin_tl/PluginTLRefView.h
 	HEADERS += src/plugins/plugin_tl/PluginTLSettingsView.h
+	HEADERS += src/plugins/plugin_tl/PluginTLUi.h
 }
 equals(USE_PLUGIN_14C, 1){
-	HEADERS += src/plugins/plugin_14C/Plugin14C.h
 	HEADERS += src/plugins/plugin_14C/Plugin14CForm.h
 	HEADERS += src/plugins/plugin_14C/Plugin14CRefView.h
         HEADERS += src/plugins/plugin_14C/Plugin14CSettingsView.h
+	HEADERS += src/plugins/plugin_14C/Plugin14CUi.h
 }
 equals(USE_PLUGIN_GAUSS, 1){
-	HEADERS += src/plugins/plugin_gauss/PluginGauss.h
 	HEADERS += src/plugins/plugin_gauss/PluginGaussForm.h
 	HEADERS += src/plugins/plugin_gauss/PluginGaussRefView.h
         HEADERS += src/plugins/plugin_gauss/PluginGaussSettingsView.h
+	HEADERS += src/plugins/plugin_gauss/PluginGaussUi.h
 }
 equals(USE_PLUGIN_AM, 1){
-	HEADERS += src/plugins/plugin_am/PluginMag.h
 	HEADERS += src/plugins/plugin_am/PluginMagForm.h
 	HEADERS += src/plugins/plugin_am/PluginMagRefView.h
         HEADERS += src/plugins/plugin_am/PluginMagSettingsView.h
+	HEADERS += src/plugins/plugin_am/PluginMagUi.h
 }
 equals(USE_PLUGIN_UNIFORM, 1){
-	HEADERS += src/plugins/plugin_uniform/PluginUniform.h
 	HEADERS += src/plugins/plugin_uniform/PluginUniformForm.h
+	HEADERS += src/plugins/plugin_uniform/PluginUniformUi.h
 }
 
 HEADERS += src/project/Project.h
-HEADERS += src/project/PluginManager.h
-HEADERS += src/project/ProjectSettings.h
+HEADERS += src/project/PluginUiManager.h
 HEADERS += src/project/ProjectSettingsDialog.h
+HEADERS += src/project/ProjectSaver.h
 HEADERS += src/project/SetProjectState.h
 HEADERS += src/project/StateEvent.h
     
@@ -317,11 +201,8 @@ HEADERS += src/ui/widgets/Marker.h
 HEADERS += src/ui/window/MainWindow.h
 HEADERS += src/ui/window/ProjectView.h
 
-HEADERS += src/utilities/Singleton.h
-HEADERS += src/utilities/StdUtilities.h
-HEADERS += src/utilities/QtUtilities.h
 HEADERS += src/utilities/DoubleValidator.h
-HEADERS += src/utilities/DateUtils.h
+HEADERS += src/utilities/WidgetUtilities.h
 
 
 #########################################
@@ -330,60 +211,41 @@ HEADERS += src/utilities/DateUtils.h
 
 SOURCES += src/main.cpp
 SOURCES += src/MainController.cpp
-SOURCES += src/AppSettings.cpp
 SOURCES += src/ChronoApp.cpp
 
-SOURCES += src/mcmc/Functions.cpp
-SOURCES += src/mcmc/Generator.cpp
-SOURCES += src/mcmc/MCMCLoop.cpp
-SOURCES += src/mcmc/MCMCLoopMain.cpp
-SOURCES += src/mcmc/MetropolisVariable.cpp
-SOURCES += src/mcmc/MHVariable.cpp
-SOURCES += src/mcmc/MCMCSettings.cpp
-
-SOURCES += src/model/Model.cpp
-SOURCES += src/model/Date.cpp
-SOURCES += src/model/Event.cpp
-SOURCES += src/model/EventKnown.cpp
-SOURCES += src/model/Phase.cpp
-SOURCES += src/model/Constraint.cpp
-SOURCES += src/model/EventConstraint.cpp
-SOURCES += src/model/PhaseConstraint.cpp
-SOURCES += src/model/ModelUtilities.cpp
-
 equals(USE_PLUGIN_TL, 1){
-	SOURCES += src/plugins/plugin_tl/PluginTL.cpp
 	SOURCES += src/plugins/plugin_tl/PluginTLForm.cpp
 	SOURCES += src/plugins/plugin_tl/PluginTLRefView.cpp
     SOURCES += src/plugins/plugin_tl/PluginTLSettingsView.cpp
+	SOURCES += src/plugins/plugin_tl/PluginTLUi.cpp
 }
 equals(USE_PLUGIN_14C, 1){
-	SOURCES += src/plugins/plugin_14C/Plugin14C.cpp
 	SOURCES += src/plugins/plugin_14C/Plugin14CForm.cpp
 	SOURCES += src/plugins/plugin_14C/Plugin14CRefView.cpp
         SOURCES += src/plugins/plugin_14C/Plugin14CSettingsView.cpp
+	SOURCES += src/plugins/plugin_14C/Plugin14CUi.cpp
 }
 equals(USE_PLUGIN_GAUSS, 1){
-	SOURCES += src/plugins/plugin_gauss/PluginGauss.cpp
 	SOURCES += src/plugins/plugin_gauss/PluginGaussForm.cpp
 	SOURCES += src/plugins/plugin_gauss/PluginGaussRefView.cpp
         SOURCES += src/plugins/plugin_gauss/PluginGaussSettingsView.cpp
+	SOURCES += src/plugins/plugin_gauss/PluginGaussUi.cpp
 }
 equals(USE_PLUGIN_AM, 1){
-	SOURCES += src/plugins/plugin_am/PluginMag.cpp
 	SOURCES += src/plugins/plugin_am/PluginMagForm.cpp
 	SOURCES += src/plugins/plugin_am/PluginMagRefView.cpp
         SOURCES += src/plugins/plugin_am/PluginMagSettingsView.cpp
+	SOURCES += src/plugins/plugin_am/PluginMagUi.cpp
 }
 equals(USE_PLUGIN_UNIFORM, 1){
-	SOURCES += src/plugins/plugin_uniform/PluginUniform.cpp
 	SOURCES += src/plugins/plugin_uniform/PluginUniformForm.cpp
+	SOURCES += src/plugins/plugin_uniform/PluginUniformUi.cpp
 }
 
 SOURCES += src/project/Project.cpp
-SOURCES += src/project/PluginManager.cpp
-SOURCES += src/project/ProjectSettings.cpp
+SOURCES += src/project/PluginUiManager.cpp
 SOURCES += src/project/ProjectSettingsDialog.cpp
+SOURCES += src/project/ProjectSaver.cpp
 SOURCES += src/project/SetProjectState.cpp
 SOURCES += src/project/StateEvent.cpp
     
@@ -454,11 +316,8 @@ SOURCES += src/ui/widgets/Marker.cpp
 SOURCES += src/ui/window/MainWindow.cpp
 SOURCES += src/ui/window/ProjectView.cpp
 
-SOURCES += src/utilities/StdUtilities.cpp
-SOURCES += src/utilities/QtUtilities.cpp
 SOURCES += src/utilities/DoubleValidator.cpp
-SOURCES += src/utilities/DateUtils.cpp
-
+SOURCES += src/utilities/WidgetUtilities.cpp
 
 message("--------------------TRANSLATIONS-----------------------")
 TRANSLATIONS +=\
@@ -0,0 +1,20 @@
+#-------------------------------------------------
+#
+# Builds the core library, then the application, the command line and the benchmarks
+#
+#-------------------------------------------------
+
+TEMPLATE = subdirs
+
+SUBDIRS = core app cmd bench
+
+core.file = ChronomodelCore.pro
+
+app.file = Chronomodel.pro
+app.depends = core
+
+cmd.file = ChronomodelCmd.pro
+cmd.depends = core
+
+bench.file = ChronomodelBench.pro
+bench.depends = core
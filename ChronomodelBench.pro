@@ -0,0 +1,32 @@
+#-------------------------------------------------
+#
+# Chronomodel benchmarks
+# Times the random variates, the plugins likelihoods, and the calibration, the MCMC and the results on synthetic projects (see src/bench/Benchmark.h)
+#
+#-------------------------------------------------
+
+TARGET = ChronomodelBench
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+include(Chronomodel.pri)
+include(ChronomodelCore.pri)
+
+# No QtWidgets : only the core library is used
+QT = core gui concurrent network
+
+INCLUDEPATH += src/bench/
+
+HEADERS += src/bench/Benchmark.h
+HEADERS += src/bench/SyntheticProject.h
+HEADERS += src/bench/ModelBenchmarks.h
+HEADERS += src/bench/PluginBenchmarks.h
+HEADERS += src/bench/RandomBenchmarks.h
+
+SOURCES += src/bench/main.cpp
+SOURCES += src/bench/Benchmark.cpp
+SOURCES += src/bench/SyntheticProject.cpp
+SOURCES += src/bench/ModelBenchmarks.cpp
+SOURCES += src/bench/PluginBenchmarks.cpp
+SOURCES += src/bench/RandomBenchmarks.cpp
@@ -0,0 +1,30 @@
+#-------------------------------------------------
+#
+# Chronomodel command line
+# Runs .chr projects without user interface (see src/cmd/CmdRunner.h)
+#
+#-------------------------------------------------
+
+TARGET = ChronomodelCmd
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+include(Chronomodel.pri)
+include(ChronomodelCore.pri)
+
+# No QtWidgets : only the core library is used
+QT = core gui concurrent network
+
+INCLUDEPATH += src/cmd/
+
+HEADERS += src/cmd/CmdRunner.h
+HEADERS += src/cmd/Sweep.h
+HEADERS += src/cmd/WorkStealingScheduler.h
+HEADERS += src/cmd/BatchRunner.h
+
+SOURCES += src/cmd/main.cpp
+SOURCES += src/cmd/CmdRunner.cpp
+SOURCES += src/cmd/Sweep.cpp
+SOURCES += src/cmd/WorkStealingScheduler.cpp
+SOURCES += src/cmd/BatchRunner.cpp
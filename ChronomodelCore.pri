@@ -0,0 +1,18 @@
+#-------------------------------------------------
+#
+# Links a target with the core library (include after Chronomodel.pri)
+# The core library must be built first : see ChronomodelAll.pro
+#
+#-------------------------------------------------
+
+LIBS += -L$$OUT_PWD/$$BUILD_DIR -lChronomodelCore
+LIBS += $$FFTW_LIBS
+
+# Peak memory of the process (see Instrumentation)
+win32: LIBS += -lpsapi
+
+win32-msvc*{
+	PRE_TARGETDEPS += $$OUT_PWD/$$BUILD_DIR/ChronomodelCore.lib
+} else {
+	PRE_TARGETDEPS += $$OUT_PWD/$$BUILD_DIR/libChronomodelCore.a
+}
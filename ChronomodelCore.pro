@@ -0,0 +1,132 @@
+#-------------------------------------------------
+#
+# Chronomodel core library
+# Model, MCMC and plugins likelihoods / reference curves, without QtWidgets :
+# linked by the application, the command line, and usable from other programs.
+#
+#-------------------------------------------------
+
+TARGET = ChronomodelCore
+TEMPLATE = lib
+CONFIG += staticlib
+
+include(Chronomodel.pri)
+
+# QtGui only for QColor and QIcon, QtNetwork for the distributed chains
+QT = core gui concurrent network
+
+#########################################
+# HEADERS
+#########################################
+
+HEADERS += src/AppSettings.h
+HEADERS += src/StateKeys.h
+
+HEADERS += src/mcmc/Functions.h
+HEADERS += src/mcmc/Generator.h
+HEADERS += src/mcmc/MCMCLoop.h
+HEADERS += src/mcmc/MCMCLoopMain.h
+HEADERS += src/mcmc/MCMCPreview.h
+HEADERS += src/mcmc/ChainProtocol.h
+HEADERS += src/mcmc/ChainDispatcher.h
+HEADERS += src/mcmc/ChainWorker.h
+HEADERS += src/mcmc/MetropolisVariable.h
+HEADERS += src/mcmc/MHVariable.h
+HEADERS += src/mcmc/MCMCSettings.h
+HEADERS += src/mcmc/TruncatedNormal.h
+
+HEADERS += src/model/Model.h
+HEADERS += src/model/Date.h
+HEADERS += src/model/CalibrationStore.h
+HEADERS += src/model/ChunkedFile.h
+HEADERS += src/model/Event.h
+HEADERS += src/model/EventKnown.h
+HEADERS += src/model/Phase.h
+HEADERS += src/model/Constraint.h
+HEADERS += src/model/EventConstraint.h
+HEADERS += src/model/PhaseConstraint.h
+HEADERS += src/model/ModelUtilities.h
+
+HEADERS += src/plugins/PluginAbstract.h
+
+equals(USE_PLUGIN_TL, 1){
+	HEADERS += src/plugins/plugin_tl/PluginTL.h
+}
+equals(USE_PLUGIN_14C, 1){
+	HEADERS += src/plugins/plugin_14C/Plugin14C.h
+}
+equals(USE_PLUGIN_GAUSS, 1){
+	HEADERS += src/plugins/plugin_gauss/PluginGauss.h
+}
+equals(USE_PLUGIN_AM, 1){
+	HEADERS += src/plugins/plugin_am/PluginMag.h
+}
+equals(USE_PLUGIN_UNIFORM, 1){
+	HEADERS += src/plugins/plugin_uniform/PluginUniform.h
+}
+
+HEADERS += src/project/PluginManager.h
+HEADERS += src/project/ProjectSettings.h
+
+HEADERS += src/utilities/Singleton.h
+HEADERS += src/utilities/StdUtilities.h
+HEADERS += src/utilities/QtUtilities.h
+HEADERS += src/utilities/DateUtils.h
+HEADERS += src/utilities/Instrumentation.h
+HEADERS += src/utilities/Trace.h
+
+#########################################
+# SOURCES
+#########################################
+
+SOURCES += src/AppSettings.cpp
+
+SOURCES += src/mcmc/Functions.cpp
+SOURCES += src/mcmc/Generator.cpp
+SOURCES += src/mcmc/MCMCLoop.cpp
+SOURCES += src/mcmc/MCMCLoopMain.cpp
+SOURCES += src/mcmc/MCMCPreview.cpp
+SOURCES += src/mcmc/ChainProtocol.cpp
+SOURCES += src/mcmc/ChainDispatcher.cpp
+SOURCES += src/mcmc/ChainWorker.cpp
+SOURCES += src/mcmc/MetropolisVariable.cpp
+SOURCES += src/mcmc/MHVariable.cpp
+SOURCES += src/mcmc/MCMCSettings.cpp
+SOURCES += src/mcmc/TruncatedNormal.cpp
+
+SOURCES += src/model/Model.cpp
+SOURCES += src/model/Date.cpp
+SOURCES += src/model/CalibrationStore.cpp
+SOURCES += src/model/ChunkedFile.cpp
+SOURCES += src/model/Event.cpp
+SOURCES += src/model/EventKnown.cpp
+SOURCES += src/model/Phase.cpp
+SOURCES += src/model/Constraint.cpp
+SOURCES += src/model/EventConstraint.cpp
+SOURCES += src/model/PhaseConstraint.cpp
+SOURCES += src/model/ModelUtilities.cpp
+
+equals(USE_PLUGIN_TL, 1){
+	SOURCES += src/plugins/plugin_tl/PluginTL.cpp
+}
+equals(USE_PLUGIN_14C, 1){
+	SOURCES += src/plugins/plugin_14C/Plugin14C.cpp
+}
+equals(USE_PLUGIN_GAUSS, 1){
+	SOURCES += src/plugins/plugin_gauss/PluginGauss.cpp
+}
+equals(USE_PLUGIN_AM, 1){
+	SOURCES += src/plugins/plugin_am/PluginMag.cpp
+}
+equals(USE_PLUGIN_UNIFORM, 1){
+	SOURCES += src/plugins/plugin_uniform/PluginUniform.cpp
+}
+
+SOURCES += src/project/PluginManager.cpp
+SOURCES += src/project/ProjectSettings.cpp
+
+SOURCES += src/utilities/StdUtilities.cpp
+SOURCES += src/utilities/QtUtilities.cpp
+SOURCES += src/utilities/DateUtils.cpp
+SOURCES += src/utilities/Instrumentation.cpp
+SOURCES += src/utilities/Trace.cpp
@@ -31,6 +31,12 @@ rm -rf ${BUNDLE_PATH}
 cd $ROOT_PATH
 
 
+# -------------------------------------------------------
+#	Build the core library linked by the application (ChronomodelCore.pro, in Release mode)
+# -------------------------------------------------------
+${QT_BIN_PATH}/qmake "CONFIG+=release" -o Makefile.core $ROOT_PATH/ChronomodelCore.pro
+make -f Makefile.core || exit 1
+
 # -------------------------------------------------------
 #	Create XCode project in Release mode (.pro file is in debug mode by default)
 # -------------------------------------------------------
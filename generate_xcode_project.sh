@@ -5,6 +5,11 @@ BUNDLE_PATH=Release/Chronomodel.app
 QT_BIN_PATH=$1
 
 cd $ROOT_PATH
+
+# The application links the core library : it is built first, outside of the XCode project
+${QT_BIN_PATH}/qmake "CONFIG+=debug" -o Makefile.core $ROOT_PATH/ChronomodelCore.pro
+make -f Makefile.core || exit 1
+
 ${QT_BIN_PATH}/qmake -spec macx-xcode "CONFIG+=debug" $ROOT_PATH/Chronomodel.pro
 
 exit 0
@@ -2,6 +2,8 @@
 #include <QString>
 #include <QLocale>
 
+AppSettings AppSettings::mCurrent = AppSettings();
+
 AppSettings::AppSettings():
 mAutoSave(APP_SETTINGS_DEFAULT_AUTO_SAVE),
 mAutoSaveDelay(APP_SETTINGS_DEFAULT_AUTO_SAVE_DELAY_SEC),
@@ -61,3 +63,13 @@ AppSettings::~AppSettings()
 {
     
 }
+
+const AppSettings& AppSettings::current()
+{
+    return mCurrent;
+}
+
+void AppSettings::setCurrent(const AppSettings& s)
+{
+    mCurrent = s;
+}
@@ -42,6 +42,10 @@ public:
     AppSettings& operator=(const AppSettings& s);
     void copyFrom(const AppSettings& s);
     virtual ~AppSettings();
+    
+    // Settings in use in the application, e.g. to format dates outside of the main window (command line, logs)
+    static const AppSettings& current();
+    static void setCurrent(const AppSettings& s);
 
 public:
     QLocale::Language mLanguage;
@@ -57,6 +61,9 @@ public:
     short mImageQuality;
     DateUtils::FormatDate mFormatDate;
     int mPrecision;
+    
+private:
+    static AppSettings mCurrent;
 };
 
 #endif
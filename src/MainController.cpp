@@ -1,5 +1,6 @@
 #include "MainController.h"
 #include "PluginManager.h"
+#include "PluginUiManager.h"
 #include "MainWindow.h"
 #include "Painting.h"
 
@@ -8,6 +9,7 @@ MainController::MainController(const QString& filePath)
 {
     Painting::init();
     PluginManager::loadPlugins();
+    PluginUiManager::loadPluginUis();
     
     mMainWindow = MainWindow::getInstance();
     mMainWindow->readSettings(filePath);
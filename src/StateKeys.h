@@ -76,5 +76,7 @@
 #define STATE_MCMC_SEEDS "seeds"
 
 #define STATE_MCMC_MIXING "mixing_level"
+#define STATE_MCMC_GENERATOR "generator"
+#define STATE_MCMC_REPLICAS "tempering_replicas"
 
 #endif
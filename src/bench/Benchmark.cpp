@@ -0,0 +1,168 @@
+#include "Benchmark.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QSysInfo>
+#include <QThread>
+#include <algorithm>
+#include <iostream>
+
+
+#pragma mark Case
+BenchmarkCase::BenchmarkCase(const QString& name):
+mName(name)
+{
+
+}
+
+BenchmarkCase::~BenchmarkCase()
+{
+
+}
+
+const QString& BenchmarkCase::name() const
+{
+    return mName;
+}
+
+#pragma mark Result
+QJsonObject BenchmarkResult::toJson() const
+{
+    QJsonObject json;
+    json["benchmark"] = mName;
+    json["params"] = mParams;
+    if(!mError.isEmpty())
+    {
+        json["error"] = mError;
+        return json;
+    }
+    json["repetitions"] = mRepetitions;
+    json["items"] = (double)mItems;
+    json["min_ms"] = mMinNs * 1e-6;
+    json["median_ms"] = mMedianNs * 1e-6;
+    json["mean_ms"] = mMeanNs * 1e-6;
+    // The best repetition is the least disturbed by the machine
+    if(mMinNs > 0)
+        json["items_per_s"] = mItems / (mMinNs * 1e-9);
+    return json;
+}
+
+#pragma mark Runner
+BenchmarkRunner::BenchmarkRunner():
+mMinTime(BENCHMARK_DEFAULT_MIN_TIME),
+mMinRepetitions(BENCHMARK_DEFAULT_MIN_REPETITIONS),
+mMaxRepetitions(BENCHMARK_DEFAULT_MAX_REPETITIONS)
+{
+
+}
+
+void BenchmarkRunner::setFilter(const QString& pattern)
+{
+    mFilter = QRegularExpression(pattern);
+}
+
+void BenchmarkRunner::setMinTime(int ms)
+{
+    mMinTime = ms;
+}
+
+void BenchmarkRunner::setRepetitions(int minRepetitions, int maxRepetitions)
+{
+    mMinRepetitions = minRepetitions;
+    mMaxRepetitions = qMax(minRepetitions, maxRepetitions);
+}
+
+bool BenchmarkRunner::matches(const QString& name) const
+{
+    return mFilter.pattern().isEmpty() || mFilter.match(name).hasMatch();
+}
+
+void BenchmarkRunner::run(BenchmarkCase* benchmark)
+{
+    if(matches(benchmark->name()))
+    {
+        BenchmarkResult result = measure(benchmark);
+        mResults.append(result);
+        printLine(result.toJson());
+    }
+    delete benchmark;
+}
+
+BenchmarkResult BenchmarkRunner::measure(BenchmarkCase* benchmark)
+{
+    BenchmarkResult result;
+    result.mName = benchmark->name();
+
+    QVector<qint64> times;
+    try{
+        benchmark->setUp();
+
+        QElapsedTimer total;
+        total.start();
+        while(times.size() < mMaxRepetitions && (times.size() < mMinRepetitions || total.elapsed() < mMinTime))
+        {
+            benchmark->prepare();
+
+            QElapsedTimer timer;
+            timer.start();
+            result.mItems = benchmark->run();
+            times.append(timer.nsecsElapsed());
+        }
+    }
+    catch(QString error){
+        result.mParams = benchmark->mParams;
+        result.mError = error;
+        return result;
+    }
+    // Cases may add what they measured (e.g. the statistics of a check)
+    result.mParams = benchmark->mParams;
+
+    std::sort(times.begin(), times.end());
+    qint64 sum = 0;
+    for(int i=0; i<times.size(); ++i)
+        sum += times.at(i);
+
+    result.mRepetitions = times.size();
+    result.mMinNs = times.first();
+    result.mMedianNs = times.at(times.size() / 2);
+    result.mMeanNs = sum / times.size();
+    return result;
+}
+
+const QVector<BenchmarkResult>& BenchmarkRunner::results() const
+{
+    return mResults;
+}
+
+bool BenchmarkRunner::hasErrors() const
+{
+    for(int i=0; i<mResults.size(); ++i)
+    {
+        if(!mResults.at(i).mError.isEmpty())
+            return true;
+    }
+    return false;
+}
+
+QJsonObject BenchmarkRunner::header()
+{
+    QJsonObject json;
+    json["format_version"] = BENCHMARK_FORMAT_VERSION;
+    json["application"] = qApp->applicationName() + " " + qApp->applicationVersion();
+    json["qt"] = QString(qVersion());
+    json["cpu"] = QSysInfo::currentCpuArchitecture();
+    json["os"] = QSysInfo::prettyProductName();
+    json["threads"] = QThread::idealThreadCount();
+#ifdef QT_DEBUG
+    json["build"] = QString("debug");
+#else
+    json["build"] = QString("release");
+#endif
+    return json;
+}
+
+void BenchmarkRunner::printLine(const QJsonObject& line)
+{
+    std::cout << QJsonDocument(line).toJson(QJsonDocument::Compact).toStdString() << std::endl;
+}
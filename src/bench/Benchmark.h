@@ -0,0 +1,94 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <QString>
+#include <QStringList>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QVector>
+
+// Version of the output : to be increased when the meaning of a field or of a benchmark changes
+#define BENCHMARK_FORMAT_VERSION 1
+
+#define BENCHMARK_DEFAULT_MIN_TIME 500
+#define BENCHMARK_DEFAULT_MIN_REPETITIONS 3
+#define BENCHMARK_DEFAULT_MAX_REPETITIONS 1000
+
+
+/**
+ * @brief One measured operation. setUp() and prepare() are not timed :
+ * prepare() restores what run() consumed (e.g. clears the caches), before each repetition.
+ * Errors are thrown as QString, like the rest of the model. What the case holds is released by its destructor.
+ */
+class BenchmarkCase
+{
+public:
+    BenchmarkCase(const QString& name);
+    virtual ~BenchmarkCase();
+
+    const QString& name() const;
+
+    virtual void setUp() {}
+    virtual void prepare() {}
+    // Processed items (dates, iterations, bytes...) : the throughput is given in items per second
+    virtual quint64 run() = 0;
+
+    // Parameters of the case, reported with its results (size of the synthetic project...) : read after the last repetition
+    QJsonObject mParams;
+
+private:
+    QString mName;
+};
+
+struct BenchmarkResult
+{
+    BenchmarkResult(): mRepetitions(0), mItems(0), mMinNs(0), mMedianNs(0), mMeanNs(0) {}
+
+    QString mName;
+    QJsonObject mParams;
+    int mRepetitions;
+    quint64 mItems; // per repetition
+    qint64 mMinNs;
+    qint64 mMedianNs;
+    qint64 mMeanNs;
+    QString mError;
+
+    QJsonObject toJson() const;
+};
+
+/**
+ * @brief Repeats each case until it ran at least mMinTime ms and mMinRepetitions times.
+ * The results are printed as JSON lines on stdout, with sorted keys : the output of two commits can be compared line by line.
+ */
+class BenchmarkRunner
+{
+public:
+    BenchmarkRunner();
+
+    void setFilter(const QString& pattern);
+    void setMinTime(int ms);
+    void setRepetitions(int minRepetitions, int maxRepetitions);
+
+    bool matches(const QString& name) const;
+
+    // Runs the case if it matches the filter, then deletes it
+    void run(BenchmarkCase* benchmark);
+
+    const QVector<BenchmarkResult>& results() const;
+    bool hasErrors() const;
+
+    // Machine and build, printed first
+    static QJsonObject header();
+    static void printLine(const QJsonObject& line);
+
+private:
+    BenchmarkResult measure(BenchmarkCase* benchmark);
+
+    QRegularExpression mFilter;
+    int mMinTime;
+    int mMinRepetitions;
+    int mMaxRepetitions;
+    QVector<BenchmarkResult> mResults;
+};
+
+#endif
@@ -0,0 +1,435 @@
+#include "ModelBenchmarks.h"
+#include "Model.h"
+#include "Date.h"
+#include "CalibrationStore.h"
+#include "MetropolisVariable.h"
+
+#include <QFileInfo>
+
+
+#pragma mark Loop
+BenchLoop::BenchLoop(Model* model):MCMCLoopMain(model)
+{
+
+}
+
+void BenchLoop::calibrateDates()
+{
+    const QString error = calibrate();
+    if(!error.isEmpty())
+        throw error;
+}
+
+void BenchLoop::initChain(State state)
+{
+    QList<MetropolisVariable*> variables = ModelFixture::variables(mModel);
+    for(int i=0; i<variables.size(); ++i)
+        variables[i]->reset();
+
+    mChainIndex = 0;
+    Chain& chain = mChains[mChainIndex];
+    chain.mBurnIterIndex = 0;
+    chain.mBatchIndex = 0;
+    chain.mBatchIterIndex = 0;
+    chain.mRunIterIndex = 0;
+    chain.mTotalIter = 0;
+
+    Generator::initGenerator(chain.mSeed, mGeneratorEngine);
+    initVariablesForChain();
+    initMCMC();
+    mState = state;
+}
+
+void BenchLoop::sweep()
+{
+    update();
+    ++mChains[mChainIndex].mTotalIter;
+}
+
+quint64 BenchLoop::adaptBatch()
+{
+    Chain& chain = mChains[mChainIndex];
+    for(chain.mBatchIterIndex = 0; chain.mBatchIterIndex < chain.mNumBatchIter; ++chain.mBatchIterIndex)
+        sweep();
+    ++chain.mBatchIndex;
+    adapt();
+    return chain.mNumBatchIter;
+}
+
+#pragma mark Fixture
+ModelFixture::ModelFixture(const SyntheticSpec& spec):
+mSpec(spec),
+mSampledModel(0)
+{
+    mState = SyntheticProject::generate(spec);
+}
+
+ModelFixture::~ModelFixture()
+{
+    delete mSampledModel;
+}
+
+const QJsonObject& ModelFixture::state() const
+{
+    return mState;
+}
+
+const SyntheticSpec& ModelFixture::spec() const
+{
+    return mSpec;
+}
+
+/**
+ * @brief Same pipeline as the command line : check, then calibration and MCMC on the loop thread
+ */
+Model* ModelFixture::sampledModel()
+{
+    if(!mSampledModel)
+    {
+        Model* model = createModel();
+        MCMCLoopMain* loop = new MCMCLoopMain(model);
+        loop->start();
+        loop->wait();
+
+        const QString abortedReason = loop->mAbortedReason;
+        delete loop;
+        if(!abortedReason.isEmpty())
+        {
+            delete model;
+            throw abortedReason;
+        }
+        mSampledModel = model;
+    }
+    return mSampledModel;
+}
+
+/**
+ * @brief The model keeps a pointer to the state (see Model::setJson) : the state of the fixture outlives it.
+ */
+Model* ModelFixture::createModel() const
+{
+    Model* model = new Model();
+    model->setJson(mState);
+    try{
+        model->fromJson(mState);
+        model->isValid();
+    }
+    catch(QString error){
+        delete model;
+        throw error;
+    }
+    return model;
+}
+
+QList<MetropolisVariable*> ModelFixture::variables(Model* model)
+{
+    QList<MetropolisVariable*> variables;
+    for(int i=0; i<model->mEvents.size(); ++i)
+    {
+        Event* event = model->mEvents[i];
+        variables.append(&event->mTheta);
+        for(int j=0; j<event->mDates.size(); ++j)
+        {
+            Date& date = event->mDates[j];
+            variables.append(&date.mTheta);
+            variables.append(&date.mSigma);
+            variables.append(&date.mWiggle);
+        }
+    }
+    for(int i=0; i<model->mPhases.size(); ++i)
+    {
+        Phase* phase = model->mPhases[i];
+        variables.append(&phase->mAlpha);
+        variables.append(&phase->mBeta);
+        variables.append(&phase->mDuration);
+    }
+    return variables;
+}
+
+int ModelFixture::numDates(Model* model)
+{
+    int numDates = 0;
+    for(int i=0; i<model->mEvents.size(); ++i)
+        numDates += model->mEvents[i]->mDates.size();
+    return numDates;
+}
+
+#pragma mark Calibration
+/**
+ * @brief All the dates, without the calibrations already stored (see CalibrationStore)
+ */
+CalibrationBenchmark::CalibrationBenchmark(const QString& prefix, ModelFixturePtr fixture):BenchmarkCase(prefix + "/calibration"),
+mFixture(fixture),
+mModel(0),
+mLoop(0)
+{
+    mParams = fixture->spec().toJson();
+}
+
+CalibrationBenchmark::~CalibrationBenchmark()
+{
+    delete mLoop;
+    delete mModel;
+}
+
+void CalibrationBenchmark::setUp()
+{
+    mModel = mFixture->createModel();
+    mLoop = new BenchLoop(mModel);
+}
+
+void CalibrationBenchmark::prepare()
+{
+    CalibrationStore::clear();
+    for(int i=0; i<mModel->mEvents.size(); ++i)
+    {
+        for(int j=0; j<mModel->mEvents[i]->mDates.size(); ++j)
+            mModel->mEvents[i]->mDates[j].mCalibration.clear();
+    }
+}
+
+quint64 CalibrationBenchmark::run()
+{
+    mLoop->calibrateDates();
+    return ModelFixture::numDates(mModel);
+}
+
+#pragma mark Sweep
+/**
+ * @brief Update of all the variables, as during the burn-in (items : sweeps)
+ */
+SweepBenchmark::SweepBenchmark(const QString& prefix, ModelFixturePtr fixture):BenchmarkCase(prefix + "/mcmc sweep"),
+mFixture(fixture),
+mModel(0),
+mLoop(0)
+{
+    mParams = fixture->spec().toJson();
+}
+
+SweepBenchmark::~SweepBenchmark()
+{
+    delete mLoop;
+    delete mModel;
+}
+
+void SweepBenchmark::setUp()
+{
+    mModel = mFixture->createModel();
+    mLoop = new BenchLoop(mModel);
+    mLoop->calibrateDates();
+}
+
+void SweepBenchmark::prepare()
+{
+    mLoop->initChain(MCMCLoop::eBurning);
+}
+
+quint64 SweepBenchmark::run()
+{
+    for(int i=0; i<BENCH_SWEEPS_PER_RUN; ++i)
+        mLoop->sweep();
+    return BENCH_SWEEPS_PER_RUN;
+}
+
+#pragma mark Adaptation
+/**
+ * @brief One batch of the adaptation, with its iterations (items : iterations)
+ */
+AdaptBenchmark::AdaptBenchmark(const QString& prefix, ModelFixturePtr fixture):BenchmarkCase(prefix + "/adapt batch"),
+mFixture(fixture),
+mModel(0),
+mLoop(0)
+{
+    mParams = fixture->spec().toJson();
+    mParams["iter_per_batch"] = fixture->spec().mNumBatchIter;
+}
+
+AdaptBenchmark::~AdaptBenchmark()
+{
+    delete mLoop;
+    delete mModel;
+}
+
+void AdaptBenchmark::setUp()
+{
+    mModel = mFixture->createModel();
+    mLoop = new BenchLoop(mModel);
+    mLoop->calibrateDates();
+}
+
+void AdaptBenchmark::prepare()
+{
+    mLoop->initChain(MCMCLoop::eAdapting);
+}
+
+quint64 AdaptBenchmark::run()
+{
+    return mLoop->adaptBatch();
+}
+
+#pragma mark Posterior densities
+/**
+ * @brief Densities of all the variables (items : variables)
+ */
+DensitiesBenchmark::DensitiesBenchmark(const QString& prefix, ModelFixturePtr fixture):BenchmarkCase(prefix + "/densities"),
+mFixture(fixture)
+{
+    mParams = fixture->spec().toJson();
+    mParams["fft_len"] = BENCH_FFT_LEN;
+    mParams["run_iter"] = fixture->spec().mNumRunIter;
+}
+
+void DensitiesBenchmark::prepare()
+{
+    // The densities are only computed again when their key changes
+    QList<MetropolisVariable*> variables = ModelFixture::variables(mFixture->sampledModel());
+    for(int i=0; i<variables.size(); ++i)
+        variables[i]->mHistosKey = 0;
+}
+
+quint64 DensitiesBenchmark::run()
+{
+    Model* model = mFixture->sampledModel();
+    model->generatePosteriorDensities(model->mChains, BENCH_FFT_LEN, BENCH_HFACTOR);
+    return ModelFixture::variables(model).size();
+}
+
+#pragma mark HPD
+/**
+ * @brief HPD and credibility intervals of all the variables (items : variables)
+ */
+HPDBenchmark::HPDBenchmark(const QString& prefix, ModelFixturePtr fixture):BenchmarkCase(prefix + "/hpd"),
+mFixture(fixture)
+{
+    mParams = fixture->spec().toJson();
+    mParams["threshold"] = BENCH_HPD_THRESHOLD;
+}
+
+void HPDBenchmark::setUp()
+{
+    Model* model = mFixture->sampledModel();
+    model->generatePosteriorDensities(model->mChains, BENCH_FFT_LEN, BENCH_HFACTOR);
+}
+
+void HPDBenchmark::prepare()
+{
+    QList<MetropolisVariable*> variables = ModelFixture::variables(mFixture->sampledModel());
+    for(int i=0; i<variables.size(); ++i)
+    {
+        variables[i]->mHPDKey = 0;
+        variables[i]->mCredibilityKey = 0;
+    }
+}
+
+quint64 HPDBenchmark::run()
+{
+    Model* model = mFixture->sampledModel();
+    model->generateCredibilityAndHPD(model->mChains, BENCH_HPD_THRESHOLD);
+    return ModelFixture::variables(model).size();
+}
+
+#pragma mark Results file
+/**
+ * @brief Complete results written to a .dat file (items : bytes)
+ */
+SaveBenchmark::SaveBenchmark(const QString& prefix, ModelFixturePtr fixture):BenchmarkCase(prefix + "/save dat"),
+mFixture(fixture)
+{
+    mParams = fixture->spec().toJson();
+}
+
+void SaveBenchmark::setUp()
+{
+    if(!mDir.isValid())
+        throw QString("Cannot create a temporary directory");
+
+    Model* model = mFixture->sampledModel();
+    model->generatePosteriorDensities(model->mChains, BENCH_FFT_LEN, BENCH_HFACTOR);
+    model->generateNumericalResults(model->mChains);
+}
+
+quint64 SaveBenchmark::run()
+{
+    const QString path = mDir.filePath("bench.dat");
+    mFixture->sampledModel()->saveToFile(path);
+    return QFileInfo(path).size();
+}
+
+/**
+ * @brief Results read from a .dat file into a new model : the saved results are valid, nothing is computed again (items : bytes)
+ */
+LoadBenchmark::LoadBenchmark(const QString& prefix, ModelFixturePtr fixture):BenchmarkCase(prefix + "/load dat"),
+mFixture(fixture),
+mModel(0)
+{
+    mParams = fixture->spec().toJson();
+}
+
+LoadBenchmark::~LoadBenchmark()
+{
+    delete mModel;
+}
+
+void LoadBenchmark::setUp()
+{
+    if(!mDir.isValid())
+        throw QString("Cannot create a temporary directory");
+
+    Model* model = mFixture->sampledModel();
+    model->generatePosteriorDensities(model->mChains, BENCH_FFT_LEN, BENCH_HFACTOR);
+    model->generateNumericalResults(model->mChains);
+    model->saveToFile(mDir.filePath("bench.dat"));
+}
+
+void LoadBenchmark::prepare()
+{
+    delete mModel;
+    mModel = 0;
+    mModel = mFixture->createModel();
+}
+
+quint64 LoadBenchmark::run()
+{
+    const QString path = mDir.filePath("bench.dat");
+    mModel->restoreFromFile(path);
+    return QFileInfo(path).size();
+}
+
+#pragma mark Validation
+/**
+ * @brief Model built from the project state and checked, as before each run (items : events)
+ */
+ValidationBenchmark::ValidationBenchmark(const QString& prefix, ModelFixturePtr fixture):BenchmarkCase(prefix + "/validation"),
+mFixture(fixture)
+{
+    mParams = fixture->spec().toJson();
+}
+
+quint64 ValidationBenchmark::run()
+{
+    Model* model = mFixture->createModel();
+    const int numEvents = model->mEvents.size();
+    delete model;
+    return numEvents;
+}
+
+#pragma mark Suite
+void runModelBenchmarks(BenchmarkRunner& runner, const QString& prefix, const SyntheticSpec& spec)
+{
+    ModelFixturePtr fixture(new ModelFixture(spec));
+
+    runner.run(new ValidationBenchmark(prefix, fixture));
+    runner.run(new CalibrationBenchmark(prefix, fixture));
+    runner.run(new SweepBenchmark(prefix, fixture));
+    runner.run(new AdaptBenchmark(prefix, fixture));
+    runner.run(new DensitiesBenchmark(prefix, fixture));
+    runner.run(new HPDBenchmark(prefix, fixture));
+    runner.run(new SaveBenchmark(prefix, fixture));
+    runner.run(new LoadBenchmark(prefix, fixture));
+}
+
+void runValidationBenchmark(BenchmarkRunner& runner, const QString& prefix, const SyntheticSpec& spec)
+{
+    ModelFixturePtr fixture(new ModelFixture(spec));
+    runner.run(new ValidationBenchmark(prefix, fixture));
+}
@@ -0,0 +1,176 @@
+#ifndef MODELBENCHMARKS_H
+#define MODELBENCHMARKS_H
+
+#include "Benchmark.h"
+#include "SyntheticProject.h"
+#include "MCMCLoopMain.h"
+
+#include <QSharedPointer>
+#include <QTemporaryDir>
+
+class Model;
+class MetropolisVariable;
+
+// Parameters of the post-processing, as in the results view by default
+#define BENCH_FFT_LEN 1024
+#define BENCH_HFACTOR 1.
+#define BENCH_HPD_THRESHOLD 95.
+// Sweeps timed together : one sweep of a small project is too short for the timer
+#define BENCH_SWEEPS_PER_RUN 10
+
+
+/**
+ * @brief Gives the benchmarks access to the stages of the loop, which are otherwise only run by run()
+ */
+class BenchLoop: public MCMCLoopMain
+{
+public:
+    BenchLoop(Model* model);
+
+    void calibrateDates();
+    // Clears the traces and starts the first chain again, in the given state
+    void initChain(State state);
+    void sweep();
+    // One batch of iterations, then the adaptation : returns the number of iterations
+    quint64 adaptBatch();
+};
+
+/**
+ * @brief Synthetic project and its model, shared by the benchmarks of a same spec.
+ * The model is built, then calibrated and sampled on demand (not timed).
+ */
+class ModelFixture
+{
+public:
+    ModelFixture(const SyntheticSpec& spec);
+    ~ModelFixture();
+
+    const QJsonObject& state() const;
+    const SyntheticSpec& spec() const;
+
+    // Model of the project, calibrated and with the traces of a complete MCMC
+    Model* sampledModel();
+
+    // New model of the project (to be deleted by the caller)
+    Model* createModel() const;
+
+    static QList<MetropolisVariable*> variables(Model* model);
+    static int numDates(Model* model);
+
+private:
+    SyntheticSpec mSpec;
+    QJsonObject mState;
+    Model* mSampledModel;
+};
+
+typedef QSharedPointer<ModelFixture> ModelFixturePtr;
+
+#pragma mark Cases
+class CalibrationBenchmark: public BenchmarkCase
+{
+public:
+    CalibrationBenchmark(const QString& prefix, ModelFixturePtr fixture);
+    ~CalibrationBenchmark();
+    virtual void setUp();
+    virtual void prepare();
+    virtual quint64 run();
+private:
+    ModelFixturePtr mFixture;
+    Model* mModel;
+    BenchLoop* mLoop;
+};
+
+class SweepBenchmark: public BenchmarkCase
+{
+public:
+    SweepBenchmark(const QString& prefix, ModelFixturePtr fixture);
+    ~SweepBenchmark();
+    virtual void setUp();
+    virtual void prepare();
+    virtual quint64 run();
+private:
+    ModelFixturePtr mFixture;
+    Model* mModel;
+    BenchLoop* mLoop;
+};
+
+class AdaptBenchmark: public BenchmarkCase
+{
+public:
+    AdaptBenchmark(const QString& prefix, ModelFixturePtr fixture);
+    ~AdaptBenchmark();
+    virtual void setUp();
+    virtual void prepare();
+    virtual quint64 run();
+private:
+    ModelFixturePtr mFixture;
+    Model* mModel;
+    BenchLoop* mLoop;
+};
+
+class DensitiesBenchmark: public BenchmarkCase
+{
+public:
+    DensitiesBenchmark(const QString& prefix, ModelFixturePtr fixture);
+    virtual void prepare();
+    virtual quint64 run();
+private:
+    ModelFixturePtr mFixture;
+};
+
+class HPDBenchmark: public BenchmarkCase
+{
+public:
+    HPDBenchmark(const QString& prefix, ModelFixturePtr fixture);
+    virtual void setUp();
+    virtual void prepare();
+    virtual quint64 run();
+private:
+    ModelFixturePtr mFixture;
+};
+
+class SaveBenchmark: public BenchmarkCase
+{
+public:
+    SaveBenchmark(const QString& prefix, ModelFixturePtr fixture);
+    virtual void setUp();
+    virtual quint64 run();
+private:
+    ModelFixturePtr mFixture;
+    QTemporaryDir mDir;
+};
+
+class LoadBenchmark: public BenchmarkCase
+{
+public:
+    LoadBenchmark(const QString& prefix, ModelFixturePtr fixture);
+    ~LoadBenchmark();
+    virtual void setUp();
+    virtual void prepare();
+    virtual quint64 run();
+private:
+    ModelFixturePtr mFixture;
+    QTemporaryDir mDir;
+    Model* mModel;
+};
+
+class ValidationBenchmark: public BenchmarkCase
+{
+public:
+    ValidationBenchmark(const QString& prefix, ModelFixturePtr fixture);
+    virtual quint64 run();
+private:
+    ModelFixturePtr mFixture;
+};
+
+/**
+ * @brief Runs all the model benchmarks of a spec : names are "<prefix>/<benchmark>"
+ */
+void runModelBenchmarks(BenchmarkRunner& runner, const QString& prefix, const SyntheticSpec& spec);
+
+/**
+ * @brief Only builds and checks the model of a spec : for projects too large to be sampled by the suite
+ */
+void runValidationBenchmark(BenchmarkRunner& runner, const QString& prefix, const SyntheticSpec& spec);
+
+#endif
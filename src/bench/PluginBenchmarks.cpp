@@ -0,0 +1,187 @@
+#include "PluginBenchmarks.h"
+#include "SyntheticProject.h"
+#include "PluginManager.h"
+#include "../PluginAbstract.h"
+
+#include "Plugin14C.h"
+#include "PluginMag.h"
+#include "PluginGauss.h"
+
+#include <random>
+
+
+#pragma mark Likelihood
+LikelihoodBenchmark::LikelihoodBenchmark(const QString& name, const QString& pluginId, const QJsonObject& data, Method method, bool randomT):BenchmarkCase(name),
+mPluginId(pluginId),
+mData(data),
+mMethod(method),
+mRandomT(randomT),
+mPlugin(0),
+mSink(0.)
+{
+    mParams["plugin"] = pluginId;
+    mParams["data"] = data;
+    mParams["points"] = BENCH_LIKELIHOOD_POINTS;
+    mParams["tmin"] = BENCH_LIKELIHOOD_TMIN;
+    mParams["tmax"] = BENCH_LIKELIHOOD_TMAX;
+    mParams["t"] = randomT ? QString("random") : QString("sequential");
+    mParams["seed"] = BENCH_PLUGIN_SEED;
+}
+
+void LikelihoodBenchmark::setUp()
+{
+    mPlugin = PluginManager::getPluginFromId(mPluginId);
+    if(!mPlugin)
+        throw QString("Unknown plugin : ") + mPluginId;
+
+    // Raw output of the engine, as in SyntheticProject : the same t on every platform
+    std::mt19937 engine(BENCH_PLUGIN_SEED);
+    const double span = BENCH_LIKELIHOOD_TMAX - BENCH_LIKELIHOOD_TMIN;
+    mT.resize(BENCH_LIKELIHOOD_POINTS);
+    for(int i=0; i<mT.size(); ++i)
+    {
+        if(mRandomT)
+            mT[i] = BENCH_LIKELIHOOD_TMIN + span * (engine() / 4294967296.);
+        else
+            mT[i] = BENCH_LIKELIHOOD_TMIN + span * i / mT.size();
+    }
+    mExponents.resize(mT.size());
+}
+
+quint64 LikelihoodBenchmark::run()
+{
+    double sum = 0.;
+    const int n = mT.size();
+
+    if(mMethod == eScalar)
+    {
+        for(int i=0; i<n; ++i)
+            sum += mPlugin->getLikelyhood(mT[i], mData);
+    }
+    else if(mMethod == eArg)
+    {
+        for(int i=0; i<n; ++i)
+            sum += mPlugin->getLikelyhoodArg(mT[i], mData).second;
+    }
+    else
+    {
+        // Data read once for all the t, as when the dates are appended to the batch
+        const GaussianLikelyhood likelyhood = mPlugin->getGaussianLikelyhood(mData);
+        const double invError = 1. / likelyhood.mError;
+        const double* t = mT.constData();
+        double* exponents = mExponents.data();
+        for(int i=0; i<n; ++i)
+        {
+            const double g = (likelyhood.mA * t[i] + likelyhood.mB) * t[i] + likelyhood.mC;
+            const double d = (likelyhood.mMeasure - g) * invError;
+            exponents[i] = -0.5 * d * d;
+        }
+        for(int i=0; i<n; ++i)
+            sum += exponents[i];
+    }
+    mSink += sum;
+    return n;
+}
+
+#pragma mark Curves loading
+CurvesLoadingBenchmark::CurvesLoadingBenchmark(const QString& name, const QString& pluginId):BenchmarkCase(name),
+mPluginId(pluginId),
+mPlugin(0)
+{
+    mParams["plugin"] = pluginId;
+}
+
+void CurvesLoadingBenchmark::setUp()
+{
+    mPlugin = PluginManager::getPluginFromId(mPluginId);
+    if(!mPlugin)
+        throw QString("Unknown plugin : ") + mPluginId;
+}
+
+/**
+ * @brief The curves are loaded again by the plugin itself : they are the same files, the plugin ends in the same state
+ */
+quint64 CurvesLoadingBenchmark::run()
+{
+    int numCurves = 0;
+    QString path;
+    if(mPluginId == "14c")
+    {
+        Plugin14C* plugin = (Plugin14C*)mPlugin;
+        plugin->loadRefDatas();
+        numCurves = plugin->mRefDatas.size();
+        path = plugin->getRefsPath();
+    }
+    else if(mPluginId == "am")
+    {
+        PluginMag* plugin = (PluginMag*)mPlugin;
+        plugin->loadRefDatas();
+        numCurves = plugin->mRefDatas.size();
+        path = plugin->getRefsPath();
+    }
+    else if(mPluginId == "gauss")
+    {
+        PluginGauss* plugin = (PluginGauss*)mPlugin;
+        plugin->loadRefDatas();
+        numCurves = plugin->mRefDatas.size();
+        path = plugin->getRefsPath();
+    }
+    else
+        throw QString("No reference curve for the plugin : ") + mPluginId;
+
+    if(numCurves == 0)
+        throw QString("No reference curve found in ") + path;
+    return numCurves;
+}
+
+#pragma mark Suite
+/**
+ * @brief One date per plugin, whose true date is in the middle of the study period.
+ * The gaussian plugin is measured with its equation and with its reference curve.
+ */
+void runPluginBenchmarks(BenchmarkRunner& runner)
+{
+    const double t = (BENCH_LIKELIHOOD_TMIN + BENCH_LIKELIHOOD_TMAX) / 2;
+    std::mt19937 engine(BENCH_PLUGIN_SEED);
+
+    QStringList variants;
+    QStringList pluginIds;
+    QList<QJsonObject> datas;
+
+    const QStringList ids = QStringList() << "14c" << "am" << "tl/osl" << "gauss" << "typo_ref.";
+    for(int i=0; i<ids.size(); ++i)
+    {
+        variants.append(ids[i]);
+        pluginIds.append(ids[i]);
+        datas.append(SyntheticProject::data(ids[i], t, engine));
+    }
+
+    QJsonObject gaussCurve = SyntheticProject::data("gauss", t, engine);
+    gaussCurve[DATE_GAUSS_MODE_STR] = QString(DATE_GAUSS_MODE_CURVE);
+    gaussCurve[DATE_GAUSS_CURVE_STR] = QString("example_csv_ref.csv");
+    variants.append("gauss curve");
+    pluginIds.append("gauss");
+    datas.append(gaussCurve);
+
+    for(int i=0; i<variants.size(); ++i)
+    {
+        const QString prefix = "plugin/" + variants[i] + "/";
+        PluginAbstract* plugin = PluginManager::getPluginFromId(pluginIds[i]);
+        if(!plugin)
+            throw QString("Unknown plugin : ") + pluginIds[i];
+
+        runner.run(new LikelihoodBenchmark(prefix + "likelihood random", pluginIds[i], datas[i], LikelihoodBenchmark::eScalar, true));
+        runner.run(new LikelihoodBenchmark(prefix + "likelihood sequential", pluginIds[i], datas[i], LikelihoodBenchmark::eScalar, false));
+        if(plugin->withLikelyhoodArg())
+        {
+            runner.run(new LikelihoodBenchmark(prefix + "likelihood arg random", pluginIds[i], datas[i], LikelihoodBenchmark::eArg, true));
+            runner.run(new LikelihoodBenchmark(prefix + "likelihood arg sequential", pluginIds[i], datas[i], LikelihoodBenchmark::eArg, false));
+        }
+        if(plugin->withGaussianLikelyhood(datas[i]))
+            runner.run(new LikelihoodBenchmark(prefix + "likelihood batch", pluginIds[i], datas[i], LikelihoodBenchmark::eGaussian, true));
+    }
+
+    runner.run(new CurvesLoadingBenchmark("plugin/14c/load curves", "14c"));
+    runner.run(new CurvesLoadingBenchmark("plugin/am/load curves", "am"));
+    runner.run(new CurvesLoadingBenchmark("plugin/gauss/load curves", "gauss"));
+}
@@ -0,0 +1,69 @@
+#ifndef PLUGINBENCHMARKS_H
+#define PLUGINBENCHMARKS_H
+
+#include "Benchmark.h"
+
+#include <QJsonObject>
+#include <QVector>
+
+class PluginAbstract;
+
+// Dates t of each repetition, on the default study period (see SyntheticSpec)
+#define BENCH_LIKELIHOOD_POINTS 4096
+#define BENCH_LIKELIHOOD_TMIN 0.
+#define BENCH_LIKELIHOOD_TMAX 1800.
+#define BENCH_PLUGIN_SEED 1
+
+
+/**
+ * @brief Likelihood of one date of a plugin at BENCH_LIKELIHOOD_POINTS dates t (items : points).
+ * Random t : the lookups in the reference curve jump from one point to another, as in the MCMC.
+ * Sequential t : regular grid, as in the calibration.
+ */
+class LikelihoodBenchmark: public BenchmarkCase
+{
+public:
+    enum Method{
+        eScalar = 0,   // getLikelyhood
+        eArg = 1,      // getLikelyhoodArg
+        eGaussian = 2  // getGaussianLikelyhood, then the closed form on contiguous arrays (see DatesGaussBatch)
+    };
+
+    LikelihoodBenchmark(const QString& name, const QString& pluginId, const QJsonObject& data, Method method, bool randomT);
+    virtual void setUp();
+    virtual quint64 run();
+
+private:
+    QString mPluginId;
+    QJsonObject mData;
+    Method mMethod;
+    bool mRandomT;
+
+    PluginAbstract* mPlugin;
+    QVector<double> mT;
+    QVector<double> mExponents;
+    // Results are accumulated here, so that the loops are not optimized away
+    double mSink;
+};
+
+/**
+ * @brief Reference curves of a plugin read from its Calib folder, with the interpolation of the missing years (items : curves)
+ */
+class CurvesLoadingBenchmark: public BenchmarkCase
+{
+public:
+    CurvesLoadingBenchmark(const QString& name, const QString& pluginId);
+    virtual void setUp();
+    virtual quint64 run();
+
+private:
+    QString mPluginId;
+    PluginAbstract* mPlugin;
+};
+
+/**
+ * @brief Runs the likelihoods of every plugin and the loading of their curves : names are "plugin/<variant>/<benchmark>"
+ */
+void runPluginBenchmarks(BenchmarkRunner& runner);
+
+#endif
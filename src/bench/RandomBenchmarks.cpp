@@ -0,0 +1,331 @@
+#include "RandomBenchmarks.h"
+#include "Generator.h"
+#include "TruncatedNormal.h"
+
+#include <cmath>
+#include <algorithm>
+
+// Beyond this number of trials, the previous samplers gave up
+#define BENCH_PREVIOUS_TRIALS 100000
+
+
+#pragma mark Previous samplers
+/**
+ * @brief Generator::gaussByDoubleExp as it was before TruncatedNormal, without its debug output
+ */
+static double previousDoubleExp(const double mean, const double sigma, const double min, const double max)
+{
+    const long double x_min = (min - mean) / sigma;
+    const long double x_max = (max - mean) / sigma;
+    const long double sqrt_e = sqrtl(expl(1.0));
+
+    long double exp_x_min = 0.0;
+    long double exp_x_max = 0.0;
+    long double exp_minus_x_min = 0.0;
+    long double exp_minus_x_max = 0.0;
+    long double c = 0.0;
+    long double f0 = 0.0;
+
+    if(x_min < 0. && x_max > 0.)
+    {
+        exp_x_min = expl(x_min);
+        exp_minus_x_max = expl(-x_max);
+        c = 1. - 0.5 * (exp_x_min + exp_minus_x_max);
+        f0 = 0.5 * (1. - exp_x_min) / c;
+    }
+    else if(x_min >= 0.)
+    {
+        exp_minus_x_min = expl(-x_min);
+        exp_minus_x_max = expl(-x_max);
+    }
+    else
+    {
+        exp_x_min = expl(x_min);
+        exp_x_max = expl(x_max);
+    }
+
+    long double x = 0.;
+    double ur = 1.0;
+    long double rap = 0.0;
+    int trials = 0;
+
+    while(rap < ur)
+    {
+        if(++trials > BENCH_PREVIOUS_TRIALS)
+            throw QString("Previous double exponential sampler : no solution after ") + QString::number(BENCH_PREVIOUS_TRIALS) + " trials";
+
+        const long double u = (long double)Generator::randomUniform();
+        if(x_min < 0. && x_max > 0.)
+        {
+            if(u <= f0)
+                x = logl(exp_x_min + 2.0 * c * u);
+            else
+                x = -logl(1. - 2.0 * c * (u - f0));
+        }
+        else if(x_min >= 0.)
+            x = -logl(exp_minus_x_min - u * (exp_minus_x_min - exp_minus_x_max));
+        else
+            x = logl(exp_x_min - u * (exp_x_min - exp_x_max));
+
+        ur = Generator::randomUniform();
+
+        if(x_min >= 1.)
+            rap = expl(0.5 * (x_min * x_min - x * x) + x - x_min);
+        else if(x_max <= -1.)
+            rap = expl(0.5 * (x_max * x_max - x * x) + x_max - x);
+        else
+            rap = expl(-0.5 * x * x + std::fabs(x)) / sqrt_e;
+    }
+    return (double)(mean + (x * sigma));
+}
+
+/**
+ * @brief Event::updateTheta with the eBoxMuller method as it was before TruncatedNormal (with a lower limit of trials)
+ */
+static double previousRejection(const double mean, const double sigma, const double min, const double max)
+{
+    double x;
+    int trials = 0;
+    do{
+        if(++trials > BENCH_PREVIOUS_TRIALS)
+            throw QString("Previous rejection sampler : no solution after ") + QString::number(BENCH_PREVIOUS_TRIALS) + " trials";
+        x = Generator::gauss(mean, sigma);
+    }while(x < min || x > max);
+    return x;
+}
+
+static double gaussDensity(const double x)
+{
+    return exp(-0.5 * x * x) / sqrt(2. * M_PI);
+}
+
+#pragma mark Generator
+GeneratorBenchmark::GeneratorBenchmark(const QString& name, Generator::Engine engine, Variate variate, bool batch):BenchmarkCase(name),
+mEngine(engine),
+mVariate(variate),
+mBatch(batch),
+mSink(0.)
+{
+    mParams["engine"] = (int)engine;
+    mParams["draws"] = BENCH_RANDOM_DRAWS;
+    mParams["seed"] = BENCH_RANDOM_SEED;
+}
+
+void GeneratorBenchmark::setUp()
+{
+    Generator::initGenerator(BENCH_RANDOM_SEED, mEngine);
+    mBuffer.resize(BENCH_RANDOM_DRAWS);
+}
+
+quint64 GeneratorBenchmark::run()
+{
+    double sum = 0.;
+    if(mBatch)
+    {
+        if(mVariate == eUniform)
+            Generator::randomUniforms(mBuffer.data(), mBuffer.size());
+        else
+            Generator::gausses(mBuffer.data(), mBuffer.size());
+        for(int i=0; i<mBuffer.size(); ++i)
+            sum += mBuffer.at(i);
+    }
+    else if(mVariate == eUniform)
+    {
+        for(int i=0; i<BENCH_RANDOM_DRAWS; ++i)
+            sum += Generator::randomUniform();
+    }
+    else
+    {
+        for(int i=0; i<BENCH_RANDOM_DRAWS; ++i)
+            sum += Generator::gauss(0., 1.);
+    }
+    mSink += sum;
+    return BENCH_RANDOM_DRAWS;
+}
+
+#pragma mark Truncated normal
+TruncatedNormalBenchmark::TruncatedNormalBenchmark(const QString& name, Sampler sampler, double a, double b):BenchmarkCase(name),
+mSampler(sampler),
+mA(a),
+mB(b),
+mSink(0.)
+{
+    mParams["a"] = a;
+    mParams["b"] = b;
+    mParams["draws"] = BENCH_RANDOM_DRAWS;
+    mParams["seed"] = BENCH_RANDOM_SEED;
+}
+
+double TruncatedNormalBenchmark::sample(Sampler sampler, double a, double b)
+{
+    switch(sampler)
+    {
+        case ePreviousDoubleExp:
+            return previousDoubleExp(0., 1., a, b);
+        case ePreviousRejection:
+            return previousRejection(0., 1., a, b);
+        default:
+            return TruncatedNormal::sample(0., 1., a, b);
+    }
+}
+
+void TruncatedNormalBenchmark::setUp()
+{
+    // The engine of the previous versions
+    Generator::initGenerator(BENCH_RANDOM_SEED, Generator::eMersenneBoxMuller);
+}
+
+quint64 TruncatedNormalBenchmark::run()
+{
+    double sum = 0.;
+    for(int i=0; i<BENCH_RANDOM_DRAWS; ++i)
+        sum += sample(mSampler, mA, mB);
+    mSink += sum;
+    return BENCH_RANDOM_DRAWS;
+}
+
+#pragma mark Truncated normal check
+TruncatedNormalCheck::TruncatedNormalCheck(const QString& name, double a, double b):BenchmarkCase(name),
+mA(a),
+mB(b)
+{
+    // Exact moments : the mass is computed on the side of the interval where it keeps its precision
+    const double mass = (a >= 0) ? TruncatedNormal::upperTail(a) - TruncatedNormal::upperTail(b)
+                                 : TruncatedNormal::cdf(b) - TruncatedNormal::cdf(a);
+    mMean = (gaussDensity(a) - gaussDensity(b)) / mass;
+    mVariance = 1. + (a * gaussDensity(a) - b * gaussDensity(b)) / mass - mMean * mMean;
+
+    mParams["a"] = a;
+    mParams["b"] = b;
+    mParams["draws"] = BENCH_RANDOM_DRAWS;
+    mParams["seed"] = BENCH_RANDOM_SEED;
+    mDraws.resize(BENCH_RANDOM_DRAWS);
+}
+
+void TruncatedNormalCheck::prepare()
+{
+    Generator::initGenerator(BENCH_RANDOM_SEED, Generator::eMersenneBoxMuller);
+}
+
+double TruncatedNormalCheck::repartition(const double x) const
+{
+    if(mA >= 0)
+        return (TruncatedNormal::upperTail(mA) - TruncatedNormal::upperTail(x)) / (TruncatedNormal::upperTail(mA) - TruncatedNormal::upperTail(mB));
+    else
+        return (TruncatedNormal::cdf(x) - TruncatedNormal::cdf(mA)) / (TruncatedNormal::cdf(mB) - TruncatedNormal::cdf(mA));
+}
+
+/**
+ * @brief z of the mean and of the variance, and KS distance. Sorts the draws.
+ */
+TruncatedNormalCheck::Statistics TruncatedNormalCheck::statistics(QVector<double>& draws) const
+{
+    const int n = draws.size();
+    double sum = 0.;
+    for(int i=0; i<n; ++i)
+        sum += draws.at(i);
+    const double mean = sum / n;
+
+    double sum2 = 0.;
+    double sum4 = 0.;
+    for(int i=0; i<n; ++i)
+    {
+        const double d2 = (draws.at(i) - mean) * (draws.at(i) - mean);
+        sum2 += d2;
+        sum4 += d2 * d2;
+    }
+    const double variance = sum2 / (n - 1);
+    // The tails are far from gaussian : the standard error of the variance uses the fourth moment of the draws
+    const double varianceError = sqrt(std::max(0., sum4 / n - variance * variance) / n);
+
+    std::sort(draws.begin(), draws.end());
+    double ks = 0.;
+    for(int i=0; i<n; ++i)
+    {
+        const double f = repartition(draws.at(i));
+        ks = std::max(ks, std::max((i + 1.) / n - f, f - (double)i / n));
+    }
+
+    Statistics stats;
+    stats.mMeanZ = (mean - mMean) / sqrt(mVariance / n);
+    stats.mVarianceZ = (varianceError > 0) ? (variance - mVariance) / varianceError : 0.;
+    stats.mKS = ks * sqrt((double)n);
+    return stats;
+}
+
+quint64 TruncatedNormalCheck::run()
+{
+    for(int i=0; i<mDraws.size(); ++i)
+        mDraws[i] = TruncatedNormal::sample(0., 1., mA, mB);
+    const Statistics stats = statistics(mDraws);
+
+    mParams["mean_z"] = stats.mMeanZ;
+    mParams["variance_z"] = stats.mVarianceZ;
+    mParams["ks"] = stats.mKS;
+
+    // Same statistics for the previous sampler, for the comparison only
+    for(int i=0; i<mDraws.size(); ++i)
+        mDraws[i] = previousDoubleExp(0., 1., mA, mB);
+    const Statistics previous = statistics(mDraws);
+
+    mParams["previous_mean_z"] = previous.mMeanZ;
+    mParams["previous_variance_z"] = previous.mVarianceZ;
+    mParams["previous_ks"] = previous.mKS;
+
+    if(fabs(stats.mMeanZ) > BENCH_CHECK_MAX_Z)
+        throw QString("Truncated normal : wrong mean, z = ") + QString::number(stats.mMeanZ);
+    if(fabs(stats.mVarianceZ) > BENCH_CHECK_MAX_Z)
+        throw QString("Truncated normal : wrong variance, z = ") + QString::number(stats.mVarianceZ);
+    if(stats.mKS > BENCH_CHECK_KS)
+        throw QString("Truncated normal : wrong distribution, KS = ") + QString::number(stats.mKS);
+
+    return 2 * mDraws.size();
+}
+
+#pragma mark Suite
+/**
+ * @brief Both engines of Generator, then one interval per regime of TruncatedNormal::sampleStandard.
+ * The previous rejection sampler is only measured where it accepts more than 1e-3 of its draws.
+ */
+void runRandomBenchmarks(BenchmarkRunner& runner)
+{
+    const Generator::Engine engines[] = {Generator::eMersenneBoxMuller, Generator::eXoshiroZiggurat};
+    const char* engineNames[] = {"mersenne box-muller", "xoshiro ziggurat"};
+    for(int i=0; i<2; ++i)
+    {
+        const QString prefix = QString("random/generator/") + engineNames[i] + "/";
+        runner.run(new GeneratorBenchmark(prefix + "uniform", engines[i], GeneratorBenchmark::eUniform, false));
+        runner.run(new GeneratorBenchmark(prefix + "uniform batch", engines[i], GeneratorBenchmark::eUniform, true));
+        runner.run(new GeneratorBenchmark(prefix + "gauss", engines[i], GeneratorBenchmark::eGauss, false));
+        runner.run(new GeneratorBenchmark(prefix + "gauss batch", engines[i], GeneratorBenchmark::eGauss, true));
+    }
+
+    struct Regime
+    {
+        const char* mName;
+        double mA;
+        double mB;
+        bool mWithRejection;
+    };
+    const Regime regimes[] = {
+        {"inversion", -1., 1.5, true},
+        {"inversion wide", -4., 4., true},
+        {"uniform rejection", 0.3, 0.6, true},
+        {"exponential rejection", 2.5, 6., true},
+        {"uniform rejection tail", 3., 3.1, false},
+        {"exponential rejection far tail", 8., 12., false},
+        {"negative tail", -6., -2.5, true}
+    };
+
+    for(unsigned i=0; i<sizeof(regimes) / sizeof(Regime); ++i)
+    {
+        const Regime& regime = regimes[i];
+        const QString prefix = QString("random/truncated normal/") + regime.mName + "/";
+
+        runner.run(new TruncatedNormalCheck(prefix + "check", regime.mA, regime.mB));
+        runner.run(new TruncatedNormalBenchmark(prefix + "current", TruncatedNormalBenchmark::eCurrent, regime.mA, regime.mB));
+        runner.run(new TruncatedNormalBenchmark(prefix + "previous double exp", TruncatedNormalBenchmark::ePreviousDoubleExp, regime.mA, regime.mB));
+        if(regime.mWithRejection)
+            runner.run(new TruncatedNormalBenchmark(prefix + "previous rejection", TruncatedNormalBenchmark::ePreviousRejection, regime.mA, regime.mB));
+    }
+}
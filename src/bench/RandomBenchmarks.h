@@ -0,0 +1,104 @@
+#ifndef RANDOMBENCHMARKS_H
+#define RANDOMBENCHMARKS_H
+
+#include "Benchmark.h"
+#include "Generator.h"
+
+#include <QVector>
+
+// Draws of each repetition
+#define BENCH_RANDOM_DRAWS 100000
+#define BENCH_RANDOM_SEED 1
+
+// Distribution checks : |z| of the moments, and Kolmogorov-Smirnov statistic * sqrt(n) at the 0.001 level
+#define BENCH_CHECK_MAX_Z 5.
+#define BENCH_CHECK_KS 1.95
+
+
+/**
+ * @brief Variates of an engine of Generator per second (items : draws), one at a time or into a buffer
+ */
+class GeneratorBenchmark: public BenchmarkCase
+{
+public:
+    enum Variate{
+        eUniform = 0,
+        eGauss = 1
+    };
+
+    GeneratorBenchmark(const QString& name, Generator::Engine engine, Variate variate, bool batch);
+    virtual void setUp();
+    virtual quint64 run();
+
+private:
+    Generator::Engine mEngine;
+    Variate mVariate;
+    bool mBatch;
+    QVector<double> mBuffer;
+    double mSink;
+};
+
+/**
+ * @brief Draws of a gaussian truncated to [a, b] (standardized : mean 0, sigma 1) per second (items : draws).
+ * The previous samplers (before TruncatedNormal) are kept here as references.
+ */
+class TruncatedNormalBenchmark: public BenchmarkCase
+{
+public:
+    enum Sampler{
+        eCurrent = 0,          // TruncatedNormal::sample
+        ePreviousDoubleExp = 1, // Generator::gaussByDoubleExp : double exponential proposal
+        ePreviousRejection = 2  // Event::updateTheta eBoxMuller : gaussian draws until one is in [a, b]
+    };
+
+    TruncatedNormalBenchmark(const QString& name, Sampler sampler, double a, double b);
+    virtual void setUp();
+    virtual quint64 run();
+
+    static double sample(Sampler sampler, double a, double b);
+
+private:
+    Sampler mSampler;
+    double mA;
+    double mB;
+    // Results are accumulated here, so that the loop is not optimized away
+    double mSink;
+};
+
+/**
+ * @brief Compares BENCH_RANDOM_DRAWS draws of TruncatedNormal::sample on [a, b] to the exact truncated gaussian :
+ * mean, variance and Kolmogorov-Smirnov distance. Throws when they are out of tolerance, so the case is reported as an error.
+ * The same statistics of the previous double exponential sampler are reported alongside.
+ * The generator is seeded before each repetition : the check always gives the same result.
+ */
+class TruncatedNormalCheck: public BenchmarkCase
+{
+public:
+    TruncatedNormalCheck(const QString& name, double a, double b);
+    virtual void prepare();
+    virtual quint64 run();
+
+private:
+    struct Statistics
+    {
+        double mMeanZ;
+        double mVarianceZ;
+        double mKS; // * sqrt(n)
+    };
+    Statistics statistics(QVector<double>& draws) const;
+    // Repartition of the truncated gaussian
+    double repartition(const double x) const;
+
+    double mA;
+    double mB;
+    double mMean;
+    double mVariance;
+    QVector<double> mDraws;
+};
+
+/**
+ * @brief Runs the variates of both engines, and the truncated gaussian benchmarks and checks in each regime of TruncatedNormal : names are "random/..."
+ */
+void runRandomBenchmarks(BenchmarkRunner& runner);
+
+#endif
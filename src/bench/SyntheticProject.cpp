@@ -0,0 +1,316 @@
+#include "SyntheticProject.h"
+#include "Event.h"
+#include "Date.h"
+#include "ProjectSettings.h"
+#include "MCMCSettings.h"
+#include "PluginManager.h"
+#include "StateKeys.h"
+#include "../PluginAbstract.h"
+
+#include "Plugin14C.h"
+#include "PluginMag.h"
+#include "PluginTL.h"
+#include "PluginGauss.h"
+#include "PluginUniform.h"
+
+#include <QJsonArray>
+#include <QVector>
+#include <algorithm>
+
+
+SyntheticSpec::SyntheticSpec():
+mNumEvents(50),
+mDatesPerEvent(1),
+mPluginIds(QStringList() << "gauss"),
+mNumPhases(0),
+mTauType(Phase::eTauUnknown),
+mGammaType(PhaseConstraint::eGammaUnknown),
+mChainDepth(1),
+mTmin(0),
+mTmax(1800),
+mSeed(1),
+mNumBurnIter(100),
+mMaxBatches(5),
+mNumBatchIter(100),
+mNumRunIter(1000)
+{
+
+}
+
+QJsonObject SyntheticSpec::toJson() const
+{
+    QJsonObject json;
+    json["events"] = mNumEvents;
+    json["dates_per_event"] = mDatesPerEvent;
+    json["plugins"] = mPluginIds.join(",");
+    json["phases"] = mNumPhases;
+    json["tau_type"] = (int)mTauType;
+    json["gamma_type"] = (int)mGammaType;
+    json["chain_depth"] = mChainDepth;
+    json["tmin"] = mTmin;
+    json["tmax"] = mTmax;
+    json["seed"] = (double)mSeed;
+    return json;
+}
+
+#pragma mark Generator
+// Orders the indexes of the events by position in time
+struct PositionLess
+{
+    PositionLess(const QVector<double>& positions): mPositions(positions) {}
+    
+    bool operator()(int a, int b) const
+    {
+        return mPositions[a] < mPositions[b];
+    }
+    
+    const QVector<double>& mPositions;
+};
+
+QJsonObject SyntheticProject::generate(const SyntheticSpec& spec)
+{
+    if(spec.mNumEvents < 1 || spec.mDatesPerEvent < 1 || spec.mPluginIds.isEmpty())
+        throw QString("A synthetic project needs at least one event and one date");
+    if(spec.mNumPhases > spec.mNumEvents)
+        throw QString("A synthetic project cannot have more phases than events");
+    if(spec.mChainDepth < 1 || spec.mTmax <= spec.mTmin)
+        throw QString("Invalid synthetic project");
+
+    // Explicit engine : the same sequence on every platform
+    std::mt19937 engine(spec.mSeed);
+
+    const int depth = qMin(spec.mChainDepth, spec.mNumEvents);
+    const int numChains = (spec.mNumEvents + depth - 1) / depth;
+    const double span = spec.mTmax - spec.mTmin;
+    const double margin = 0.1 * span;
+
+    // Position in time of each event, in [0, 1[ : by level in its chain, then by chain
+    QVector<double> positions(spec.mNumEvents);
+    for(int i=0; i<spec.mNumEvents; ++i)
+    {
+        const int chain = i / depth;
+        const int level = i % depth;
+        positions[i] = (level + (chain + 0.5) / numChains) / depth;
+    }
+
+    // The phases split the events by position : none is empty, and no stratigraphic constraint goes back in time
+    QVector<int> order(spec.mNumEvents);
+    for(int i=0; i<order.size(); ++i)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), PositionLess(positions));
+    QVector<int> eventPhase(spec.mNumEvents, -1);
+    if(spec.mNumPhases > 0)
+    {
+        for(int rank=0; rank<order.size(); ++rank)
+            eventPhase[order[rank]] = rank * spec.mNumPhases / spec.mNumEvents;
+    }
+
+    // ----------------------------------------------------
+    //  Phases and their succession
+    // ----------------------------------------------------
+    const double phaseSpan = (span - 2 * margin) / qMax(1, spec.mNumPhases);
+    QJsonArray phases;
+    for(int p=0; p<spec.mNumPhases; ++p)
+    {
+        QJsonObject phase;
+        phase[STATE_ID] = p + 1;
+        phase[STATE_NAME] = "Phase " + QString::number(p + 1);
+        phase[STATE_COLOR_RED] = 120;
+        phase[STATE_COLOR_GREEN] = 120;
+        phase[STATE_COLOR_BLUE] = 120;
+        phase[STATE_ITEM_X] = 0.;
+        phase[STATE_ITEM_Y] = p * 100.;
+        phase[STATE_IS_SELECTED] = false;
+        phase[STATE_PHASE_TAU_TYPE] = (int)spec.mTauType;
+        phase[STATE_PHASE_TAU_FIXED] = 2 * phaseSpan;
+        phase[STATE_PHASE_TAU_MIN] = phaseSpan;
+        phase[STATE_PHASE_TAU_MAX] = 3 * phaseSpan;
+        phases.append(phase);
+    }
+
+    QJsonArray phasesConstraints;
+    for(int p=0; p+1<spec.mNumPhases; ++p)
+    {
+        QJsonObject constraint;
+        constraint[STATE_ID] = p + 1;
+        constraint[STATE_CONSTRAINT_BWD_ID] = p + 1;
+        constraint[STATE_CONSTRAINT_FWD_ID] = p + 2;
+        constraint[STATE_CONSTRAINT_GAMMA_TYPE] = (int)spec.mGammaType;
+        constraint[STATE_CONSTRAINT_GAMMA_FIXED] = 0.;
+        constraint[STATE_CONSTRAINT_GAMMA_MIN] = 0.;
+        constraint[STATE_CONSTRAINT_GAMMA_MAX] = phaseSpan;
+        phasesConstraints.append(constraint);
+    }
+
+    // ----------------------------------------------------
+    //  Events, their dates, and the stratigraphic chains
+    // ----------------------------------------------------
+    QJsonArray events;
+    int dateId = 1;
+    for(int i=0; i<spec.mNumEvents; ++i)
+    {
+        const double t = spec.mTmin + margin + positions[i] * (span - 2 * margin);
+
+        QJsonObject event;
+        event[STATE_EVENT_TYPE] = (int)Event::eDefault;
+        event[STATE_ID] = i + 1;
+        event[STATE_NAME] = "Event " + QString::number(i + 1);
+        event[STATE_COLOR_RED] = 200;
+        event[STATE_COLOR_GREEN] = 200;
+        event[STATE_COLOR_BLUE] = 200;
+        event[STATE_EVENT_METHOD] = (int)Event::eDoubleExp;
+        event[STATE_ITEM_X] = (i / depth) * 150.;
+        event[STATE_ITEM_Y] = (i % depth) * -100.;
+        event[STATE_IS_SELECTED] = false;
+        event[STATE_IS_CURRENT] = false;
+        event[STATE_EVENT_PHASE_IDS] = (eventPhase[i] >= 0) ? QString::number(eventPhase[i] + 1) : QString();
+
+        QJsonArray dates;
+        for(int k=0; k<spec.mPluginIds.size(); ++k)
+        {
+            for(int j=0; j<spec.mDatesPerEvent; ++j)
+            {
+                const QString name = "Date " + QString::number(i + 1) + "." + QString::number(dates.size() + 1);
+                dates.append(date(spec.mPluginIds[k], dateId++, name, t, engine));
+            }
+        }
+        event[STATE_EVENT_DATES] = dates;
+        events.append(event);
+    }
+
+    QJsonArray eventsConstraints;
+    for(int i=0; i<spec.mNumEvents; ++i)
+    {
+        if((i % depth) + 1 < depth && i + 1 < spec.mNumEvents)
+        {
+            QJsonObject constraint;
+            constraint[STATE_ID] = eventsConstraints.size() + 1;
+            constraint[STATE_CONSTRAINT_BWD_ID] = i + 1;
+            constraint[STATE_CONSTRAINT_FWD_ID] = i + 2;
+            eventsConstraints.append(constraint);
+        }
+    }
+
+    // ----------------------------------------------------
+    //  Settings : one chain, seeded
+    // ----------------------------------------------------
+    ProjectSettings settings;
+    settings.mTmin = spec.mTmin;
+    settings.mTmax = spec.mTmax;
+    settings.mStep = 1.;
+    settings.mStepForced = false;
+
+    MCMCSettings mcmc;
+    mcmc.mNumChains = 1;
+    mcmc.mNumBurnIter = spec.mNumBurnIter;
+    mcmc.mMaxBatches = spec.mMaxBatches;
+    mcmc.mNumBatchIter = spec.mNumBatchIter;
+    mcmc.mNumRunIter = spec.mNumRunIter;
+    mcmc.mThinningInterval = 1;
+    mcmc.mSeeds = QList<int>() << (int)spec.mSeed;
+
+    QJsonObject state;
+    state[STATE_SETTINGS] = settings.toJson();
+    state[STATE_MCMC] = mcmc.toJson();
+    state[STATE_EVENTS] = events;
+    state[STATE_PHASES] = phases;
+    state[STATE_EVENTS_CONSTRAINTS] = eventsConstraints;
+    state[STATE_PHASES_CONSTRAINTS] = phasesConstraints;
+    return state;
+}
+
+/**
+ * @brief Data of a measurement of the plugin made at the date t, with its error
+ */
+QJsonObject SyntheticProject::data(const QString& pluginId, double t, std::mt19937& engine)
+{
+    QJsonObject data;
+    if(pluginId == "14c")
+    {
+        const double error = 30.;
+        data[DATE_14C_AGE_STR] = 1950. - t + noise(error, engine);
+        data[DATE_14C_ERROR_STR] = error;
+        data[DATE_14C_REF_CURVE_STR] = QString("intcal13.14c");
+        data[DATE_14C_DELTA_R_STR] = 0.;
+        data[DATE_14C_DELTA_R_ERROR_STR] = 0.;
+    }
+    else if(pluginId == "am")
+    {
+        // Inclinations of the reference curve stay around 60-70° on the default study period
+        const double error = 2.;
+        data[DATE_AM_IS_INC_STR] = true;
+        data[DATE_AM_IS_DEC_STR] = false;
+        data[DATE_AM_IS_INT_STR] = false;
+        data[DATE_AM_INC_STR] = 65. + noise(2 * error, engine);
+        data[DATE_AM_DEC_STR] = 0.;
+        data[DATE_AM_INTENSITY_STR] = 0.;
+        data[DATE_AM_ERROR_STR] = error;
+        data[DATE_AM_REF_CURVE_STR] = QString("gal2002sph2014_i.ref");
+    }
+    else if(pluginId == "tl/osl")
+    {
+        const double error = 50.;
+        const double refYear = 2000.;
+        data[DATE_TL_AGE_STR] = refYear - t + noise(error, engine);
+        data[DATE_TL_ERROR_STR] = error;
+        data[DATE_TL_REF_YEAR_STR] = refYear;
+    }
+    else if(pluginId == "gauss")
+    {
+        const double error = 50.;
+        data[DATE_GAUSS_AGE_STR] = t + noise(error, engine);
+        data[DATE_GAUSS_ERROR_STR] = error;
+        data[DATE_GAUSS_A_STR] = 0.;
+        data[DATE_GAUSS_B_STR] = 1.;
+        data[DATE_GAUSS_C_STR] = 0.;
+        data[DATE_GAUSS_MODE_STR] = QString(DATE_GAUSS_MODE_EQ);
+        data[DATE_GAUSS_CURVE_STR] = QString("");
+    }
+    else if(pluginId == "typo_ref.")
+    {
+        const double width = 100.;
+        const double center = t + noise(width / 2, engine);
+        data[DATE_UNIFORM_MIN_STR] = center - width / 2;
+        data[DATE_UNIFORM_MAX_STR] = center + width / 2;
+    }
+    else
+        throw QString("No synthetic data for the plugin : ") + pluginId;
+
+    return data;
+}
+
+QJsonObject SyntheticProject::date(const QString& pluginId, int id, const QString& name, double t, std::mt19937& engine)
+{
+    PluginAbstract* plugin = PluginManager::getPluginFromId(pluginId);
+    if(!plugin)
+        throw QString("Unknown plugin : ") + pluginId;
+
+    QJsonObject date;
+    date[STATE_ID] = id;
+    date[STATE_NAME] = name;
+    date[STATE_DATE_DATA] = data(pluginId, t, engine);
+    date[STATE_DATE_PLUGIN_ID] = pluginId;
+    date[STATE_DATE_METHOD] = (int)plugin->getDataMethod();
+    date[STATE_DATE_VALID] = true;
+    date[STATE_DATE_DELTA_TYPE] = (int)Date::eDeltaFixed;
+    date[STATE_DATE_DELTA_FIXED] = 0.;
+    date[STATE_DATE_DELTA_MIN] = 0.;
+    date[STATE_DATE_DELTA_MAX] = 0.;
+    date[STATE_DATE_DELTA_AVERAGE] = 0.;
+    date[STATE_DATE_DELTA_ERROR] = 0.;
+    date[STATE_COLOR_RED] = 200;
+    date[STATE_COLOR_GREEN] = 200;
+    date[STATE_COLOR_BLUE] = 200;
+    date[STATE_DATE_SUB_DATES] = QJsonArray();
+    return date;
+}
+
+/**
+ * @brief Uniform noise in [-error, error[, from the raw output of the engine :
+ * the distributions of the standard library are not the same on every platform.
+ */
+double SyntheticProject::noise(double error, std::mt19937& engine)
+{
+    const double u = engine() / 4294967296.;
+    return (2 * u - 1) * error;
+}
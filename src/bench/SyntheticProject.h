@@ -0,0 +1,61 @@
+#ifndef SYNTHETICPROJECT_H
+#define SYNTHETICPROJECT_H
+
+#include "Phase.h"
+#include "PhaseConstraint.h"
+
+#include <QString>
+#include <QStringList>
+#include <QJsonObject>
+#include <random>
+
+
+/**
+ * @brief Size and structure of a synthetic project.
+ * The events are laid out on stratigraphic chains of mChainDepth events (constrained from the oldest to the youngest),
+ * the phases split them by date, and the phases follow each other (phase constraints).
+ */
+struct SyntheticSpec
+{
+    SyntheticSpec();
+
+    int mNumEvents;
+    int mDatesPerEvent; // of each plugin of mPluginIds
+    QStringList mPluginIds;
+    int mNumPhases;
+    Phase::TauType mTauType;
+    PhaseConstraint::GammaType mGammaType;
+    int mChainDepth; // 1 : no stratigraphic constraint
+
+    int mTmin;
+    int mTmax;
+    quint32 mSeed;
+
+    // MCMC of one chain
+    int mNumBurnIter;
+    int mMaxBatches;
+    int mNumBatchIter;
+    int mNumRunIter;
+
+    QJsonObject toJson() const;
+};
+
+/**
+ * @brief Builds the state of a synthetic project, like the state of a .chr file.
+ * The "true" date of each event is drawn from its position in its chain, the measurements of its dates
+ * are drawn around it : the same spec always gives the same project, on every machine.
+ * The plugins must be loaded (see PluginManager) : throws a QString if one of them is missing.
+ */
+class SyntheticProject
+{
+public:
+    static QJsonObject generate(const SyntheticSpec& spec);
+    // Data of a date of the plugin, whose true date is t (see PluginAbstract::getLikelyhood)
+    static QJsonObject data(const QString& pluginId, double t, std::mt19937& engine);
+
+private:
+    static QJsonObject date(const QString& pluginId, int id, const QString& name, double t, std::mt19937& engine);
+    static double noise(double error, std::mt19937& engine);
+};
+
+#endif
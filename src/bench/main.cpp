@@ -0,0 +1,137 @@
+#include "Benchmark.h"
+#include "ModelBenchmarks.h"
+#include "PluginBenchmarks.h"
+#include "RandomBenchmarks.h"
+#include "SyntheticProject.h"
+#include "PluginManager.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QLocale>
+#include <iostream>
+
+
+/**
+ * @brief Benchmarks entry point : ChronomodelBench [options]
+ * Prints a header line (machine, build), then one JSON line per benchmark.
+ * The random variates and plugins benchmarks always run. Without any project option, the model benchmarks run the presets below (the largest one is only built and checked). The Calib folder must be next to the executable, as for ChronomodelCmd.
+ */
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    a.setApplicationName("ChronoModel");
+    a.setApplicationVersion("1.3.5"); // check in file Chronomodel.pri
+    a.setOrganizationDomain("http://www.chronomodel.com");
+    a.setOrganizationName("CNRS");
+
+    QLocale locale(QLocale::English);
+    locale.setNumberOptions(QLocale::OmitGroupSeparator);
+    QLocale::setDefault(locale);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QCoreApplication::translate("main", "Benchmarks of ChronoModel on synthetic projects"));
+    parser.addHelpOption();
+
+    QCommandLineOption filterOption("filter", QCoreApplication::translate("main", "Only runs the benchmarks whose name matches this regular expression"), "regexp");
+    QCommandLineOption minTimeOption("min-time", QCoreApplication::translate("main", "Minimum time spent on each benchmark (ms)"), "ms", QString::number(BENCHMARK_DEFAULT_MIN_TIME));
+    QCommandLineOption eventsOption("events", QCoreApplication::translate("main", "Number of events of the synthetic project"), "count");
+    QCommandLineOption datesOption("dates", QCoreApplication::translate("main", "Number of dates of each plugin per event"), "count");
+    QCommandLineOption pluginsOption("plugins", QCoreApplication::translate("main", "Plugins of the dates, separated by commas (14c, am, tl/osl, gauss, typo_ref.)"), "ids");
+    QCommandLineOption phasesOption("phases", QCoreApplication::translate("main", "Number of successive phases"), "count");
+    QCommandLineOption depthOption("depth", QCoreApplication::translate("main", "Number of events of each stratigraphic chain"), "count");
+    QCommandLineOption tauOption("tau", QCoreApplication::translate("main", "Duration of the phases : 0 unknown, 1 fixed, 2 range"), "type");
+    QCommandLineOption gammaOption("gamma", QCoreApplication::translate("main", "Hiatus between the phases : 0 unknown, 1 fixed, 2 range"), "type");
+    QCommandLineOption seedOption("seed", QCoreApplication::translate("main", "Seed of the synthetic project and of its chain"), "seed");
+
+    parser.addOption(filterOption);
+    parser.addOption(minTimeOption);
+    parser.addOption(eventsOption);
+    parser.addOption(datesOption);
+    parser.addOption(pluginsOption);
+    parser.addOption(phasesOption);
+    parser.addOption(depthOption);
+    parser.addOption(tauOption);
+    parser.addOption(gammaOption);
+    parser.addOption(seedOption);
+
+    parser.process(a);
+
+    PluginManager::loadPlugins();
+
+    BenchmarkRunner runner;
+    runner.setFilter(parser.value(filterOption));
+    runner.setMinTime(parser.value(minTimeOption).toInt());
+
+    BenchmarkRunner::printLine(BenchmarkRunner::header());
+
+    const bool custom = parser.isSet(eventsOption) || parser.isSet(datesOption) || parser.isSet(pluginsOption)
+        || parser.isSet(phasesOption) || parser.isSet(depthOption) || parser.isSet(tauOption)
+        || parser.isSet(gammaOption) || parser.isSet(seedOption);
+
+    try{
+        // Innermost costs of the sampling, independent of the project
+        runRandomBenchmarks(runner);
+        runPluginBenchmarks(runner);
+
+        if(custom)
+        {
+            SyntheticSpec spec;
+            if(parser.isSet(eventsOption))
+                spec.mNumEvents = parser.value(eventsOption).toInt();
+            if(parser.isSet(datesOption))
+                spec.mDatesPerEvent = parser.value(datesOption).toInt();
+            if(parser.isSet(pluginsOption))
+                spec.mPluginIds = parser.value(pluginsOption).split(",", QString::SkipEmptyParts);
+            if(parser.isSet(phasesOption))
+                spec.mNumPhases = parser.value(phasesOption).toInt();
+            if(parser.isSet(depthOption))
+                spec.mChainDepth = parser.value(depthOption).toInt();
+            if(parser.isSet(tauOption))
+                spec.mTauType = (Phase::TauType)parser.value(tauOption).toInt();
+            if(parser.isSet(gammaOption))
+                spec.mGammaType = (PhaseConstraint::GammaType)parser.value(gammaOption).toInt();
+            if(parser.isSet(seedOption))
+                spec.mSeed = parser.value(seedOption).toUInt();
+
+            runModelBenchmarks(runner, "custom", spec);
+        }
+        else
+        {
+            // Gaussian dates only : the cost of the model itself
+            SyntheticSpec small;
+            runModelBenchmarks(runner, "small", small);
+
+            // Every plugin, with their reference curves
+            SyntheticSpec mixed;
+            mixed.mPluginIds = QStringList() << "14c" << "am" << "tl/osl" << "gauss";
+            runModelBenchmarks(runner, "mixed", mixed);
+
+            // Phases with durations and hiatus, and stratigraphic chains
+            SyntheticSpec stratified;
+            stratified.mNumEvents = 200;
+            stratified.mPluginIds = QStringList() << "14c";
+            stratified.mNumPhases = 5;
+            stratified.mTauType = Phase::eTauRange;
+            stratified.mGammaType = PhaseConstraint::eGammaRange;
+            stratified.mChainDepth = 4;
+            runModelBenchmarks(runner, "stratified", stratified);
+
+            // Size of the largest projects : only the construction and the checks of the model (see Model::fromJson)
+            SyntheticSpec large;
+            large.mNumEvents = 5000;
+            large.mNumPhases = 200;
+            large.mTauType = Phase::eTauRange;
+            large.mGammaType = PhaseConstraint::eGammaRange;
+            large.mChainDepth = 10;
+            runValidationBenchmark(runner, "large", large);
+        }
+    }
+    catch(QString error){
+        // The project or the data of a plugin could not be generated (missing plugin...)
+        std::cerr << error.toStdString() << std::endl;
+        return 2;
+    }
+
+    return runner.hasErrors() ? 1 : 0;
+}
@@ -0,0 +1,214 @@
+#include "BatchRunner.h"
+#include "ModelUtilities.h"
+#include "QtUtilities.h"
+
+#include <QDir>
+#include <QFile>
+#include <QTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QObject>
+
+
+BatchRunner::BatchRunner(CmdRunner* runner, const QJsonObject& state, const QList<SweepVariant>& variants, const QString& projectName, const QString& outputPath):
+mRunner(runner),
+mState(state),
+mVariants(variants),
+mProjectName(projectName),
+mOutputPath(outputPath)
+{
+    mSweptPaths = Sweep::sweptPaths(mVariants);
+    mLocale = mRunner->csvLocale();
+    
+    const int n = mVariants.size();
+    mStatus.fill(CmdRunner::eOk, n);
+    mMessages.resize(n);
+    mElapsed.fill(0., n);
+    mResults.resize(n);
+}
+
+BatchRunner::~BatchRunner()
+{
+    
+}
+
+void BatchRunner::runTask(int index)
+{
+    const SweepVariant& variant = mVariants.at(index);
+    const QString variantPath = QDir(mOutputPath).absoluteFilePath(variant.mName);
+    QTime time;
+    time.start();
+    
+    CmdRunner::Status status = CmdRunner::eOk;
+    QString message;
+    QJsonObject results;
+    try{
+        // Same checks as when loading : the validity of the dates depends on the study period
+        QJsonObject state = Sweep::applyVariant(mState, variant);
+        state = ModelUtilities::checkValidDates(state);
+        status = mRunner->runModel(state, mProjectName, variantPath, false, message, &results);
+    }
+    catch(QString error){
+        status = CmdRunner::eInvalidModel;
+        message = error;
+    }
+    if(status == CmdRunner::eOk)
+        message = QObject::tr("Results written in ") + variantPath;
+    
+    mStatus[index] = status;
+    mMessages[index] = message;
+    mElapsed[index] = time.elapsed() / 1000.;
+    mResults[index] = results;
+    
+    mRunner->printVariantStatus(index, mVariants.size(), variant.mName, status, message);
+}
+
+CmdRunner::Status BatchRunner::status() const
+{
+    int status = CmdRunner::eOk;
+    for(int i=0; i<mStatus.size(); ++i)
+        status = qMax(status, (int)mStatus.at(i));
+    return (CmdRunner::Status)status;
+}
+
+int BatchRunner::numFailed() const
+{
+    return mStatus.size() - mStatus.count(CmdRunner::eOk);
+}
+
+#pragma mark Summary
+/**
+ * @brief Quoted as in RFC 4180 : the swept values may be JSON arrays or objects, and the names may hold the cell separator
+ */
+static QString quoteCsvCell(const QString& cell)
+{
+    QString quoted = cell;
+    quoted.replace("\"", "\"\"");
+    return "\"" + quoted + "\"";
+}
+
+void BatchRunner::writeSummary() const
+{
+    QDir dir(mOutputPath);
+    if(!dir.mkpath("."))
+        throw QObject::tr("Cannot create the directory : ") + mOutputPath;
+    
+    QList<QStringList> rows = summaryRows();
+    for(int r=0; r<rows.size(); ++r)
+    {
+        for(int c=0; c<rows[r].size(); ++c)
+            rows[r][c] = quoteCsvCell(rows[r][c]);
+    }
+    if(!saveCsvTo(rows, dir.absoluteFilePath(CMD_SWEEP_SUMMARY), mRunner->csvCellSeparator()))
+        throw QObject::tr("Cannot write the file : ") + dir.absoluteFilePath(CMD_SWEEP_SUMMARY);
+    
+    QJsonArray variants;
+    for(int i=0; i<mVariants.size(); ++i)
+    {
+        QJsonObject variant;
+        variant["name"] = mVariants.at(i).mName;
+        variant["values"] = mVariants.at(i).mValues;
+        variant["code"] = (int)mStatus.at(i);
+        variant["message"] = mMessages.at(i);
+        variant["elapsed"] = mElapsed.at(i);
+        variants.append(variant);
+    }
+    QJsonObject json;
+    json["project"] = mProjectName;
+    json["variants"] = variants;
+    
+    QFile file(dir.absoluteFilePath(CMD_SWEEP_VARIANTS));
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        throw QObject::tr("Cannot write the file : ") + file.fileName();
+    file.write(QJsonDocument(json).toJson(QJsonDocument::Indented));
+    file.close();
+}
+
+/**
+ * @brief Long format (one line per variable of each variant) : easy to filter and pivot in a spreadsheet or R.
+ * The swept values are repeated on each line. A failed variant has a single line, without statistics.
+ */
+QList<QStringList> BatchRunner::summaryRows() const
+{
+    QList<QStringList> rows;
+    
+    QStringList header;
+    header << "variant" << "status" << "elapsed (s)";
+    header << mSweptPaths;
+    header << "kind" << "name" << "variable" << "mode" << "mean" << "std" << "Q1" << "Q2" << "Q3" << "credibility inf" << "credibility sup" << "hpd";
+    rows.append(header);
+    
+    for(int i=0; i<mVariants.size(); ++i)
+    {
+        QStringList variantCells;
+        variantCells << mVariants.at(i).mName << QString::number((int)mStatus.at(i)) << mLocale.toString(mElapsed.at(i));
+        for(int p=0; p<mSweptPaths.size(); ++p)
+            variantCells << valueToString(mVariants.at(i).mValues.value(mSweptPaths.at(p)));
+        
+        if(mStatus.at(i) != CmdRunner::eOk)
+        {
+            rows.append(variantCells);
+            continue;
+        }
+        
+        const QJsonArray events = mResults.at(i).value("events").toArray();
+        for(int e=0; e<events.size(); ++e)
+        {
+            const QJsonObject event = events.at(e).toObject();
+            appendVariableRows(rows, variantCells, "event", event, QStringList() << "theta");
+            
+            const QJsonArray dates = event.value("dates").toArray();
+            for(int d=0; d<dates.size(); ++d)
+                appendVariableRows(rows, variantCells, "date", dates.at(d).toObject(), QStringList() << "theta" << "sigma");
+        }
+        const QJsonArray phases = mResults.at(i).value("phases").toArray();
+        for(int p=0; p<phases.size(); ++p)
+            appendVariableRows(rows, variantCells, "phase", phases.at(p).toObject(), QStringList() << "alpha" << "beta" << "duration");
+    }
+    return rows;
+}
+
+void BatchRunner::appendVariableRows(QList<QStringList>& rows, const QStringList& variantCells, const QString& kind, const QJsonObject& item, const QStringList& variables) const
+{
+    for(int v=0; v<variables.size(); ++v)
+    {
+        const QJsonObject variable = item.value(variables.at(v)).toObject();
+        const QJsonArray credibility = variable.value("credibility").toArray();
+        
+        QStringList hpd;
+        const QJsonArray intervals = variable.value("hpd").toArray();
+        for(int h=0; h<intervals.size(); ++h)
+        {
+            const QJsonArray interval = intervals.at(h).toArray();
+            hpd << "[" + mLocale.toString(interval.at(1).toDouble()) + " : " + mLocale.toString(interval.at(2).toDouble()) + "] (" + mLocale.toString(interval.at(0).toDouble(), 'f', 1) + "%)";
+        }
+        
+        QStringList row = variantCells;
+        row << kind << item.value("name").toString() << variables.at(v);
+        row << mLocale.toString(variable.value("mode").toDouble());
+        row << mLocale.toString(variable.value("mean").toDouble());
+        row << mLocale.toString(variable.value("stddev").toDouble());
+        row << mLocale.toString(variable.value("q1").toDouble());
+        row << mLocale.toString(variable.value("q2").toDouble());
+        row << mLocale.toString(variable.value("q3").toDouble());
+        row << mLocale.toString(credibility.at(0).toDouble());
+        row << mLocale.toString(credibility.at(1).toDouble());
+        row << hpd.join(" ");
+        rows.append(row);
+    }
+}
+
+QString BatchRunner::valueToString(const QJsonValue& value) const
+{
+    if(value.isDouble())
+        return mLocale.toString(value.toDouble());
+    if(value.isBool())
+        return value.toBool() ? "true" : "false";
+    if(value.isString())
+        return value.toString();
+    if(value.isArray())
+        return QJsonDocument(value.toArray()).toJson(QJsonDocument::Compact);
+    if(value.isObject())
+        return QJsonDocument(value.toObject()).toJson(QJsonDocument::Compact);
+    return QString();
+}
@@ -0,0 +1,54 @@
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include "WorkStealingScheduler.h"
+#include "CmdRunner.h"
+#include "Sweep.h"
+
+#include <QJsonObject>
+#include <QVector>
+#include <QLocale>
+
+
+/**
+ * @brief Runs the variants of a project, one task per variant (see WorkStealingScheduler).
+ * Each variant writes its results in <output>/<variant>/, then the consolidated summary is written in <output>/ :
+ * summary.csv (key posterior statistics of each variable, one line per variable and variant)
+ * and variants.json (values, status and duration of each variant).
+ * The variants whose dates and study period are unchanged share their calibrations (see CalibrationStore).
+ */
+class BatchRunner: public SchedulerTask
+{
+public:
+    BatchRunner(CmdRunner* runner, const QJsonObject& state, const QList<SweepVariant>& variants, const QString& projectName, const QString& outputPath);
+    virtual ~BatchRunner();
+    
+    void runTask(int index);
+    
+    // Worst status of the variants
+    CmdRunner::Status status() const;
+    int numFailed() const;
+    
+    void writeSummary() const;
+    
+private:
+    QList<QStringList> summaryRows() const;
+    void appendVariableRows(QList<QStringList>& rows, const QStringList& variantCells, const QString& kind, const QJsonObject& item, const QStringList& variables) const;
+    QString valueToString(const QJsonValue& value) const;
+    
+    CmdRunner* mRunner;
+    QJsonObject mState;
+    QList<SweepVariant> mVariants;
+    QStringList mSweptPaths;
+    QString mProjectName;
+    QString mOutputPath;
+    QLocale mLocale;
+    
+    // One element per variant, allocated before the run : each task only writes its own
+    QVector<CmdRunner::Status> mStatus;
+    QVector<QString> mMessages;
+    QVector<double> mElapsed;
+    QVector<QJsonObject> mResults;
+};
+
+#endif
@@ -0,0 +1,656 @@
+#include "CmdRunner.h"
+#include "Model.h"
+#include "MCMCLoopMain.h"
+#include "ModelUtilities.h"
+#include "Functions.h"
+#include "QtUtilities.h"
+#include "StateKeys.h"
+#include "Sweep.h"
+#include "BatchRunner.h"
+#include "ChainDispatcher.h"
+#include "ChainWorker.h"
+#include "Trace.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QMutex>
+#include <QThread>
+#include <QDebug>
+#include <iostream>
+
+// The variants of a sweep print their status from the worker threads
+static QMutex sOutputMutex;
+
+/**
+ * @brief Records the trace of the command (--trace) and writes it when the command returns
+ */
+class TraceWriter
+{
+public:
+    TraceWriter(const QString& path): mPath(path)
+    {
+        if(!mPath.isEmpty())
+            Trace::start();
+    }
+    ~TraceWriter()
+    {
+        if(mPath.isEmpty())
+            return;
+        Trace::stop();
+        try{
+            Trace::write(mPath);
+        }
+        catch(QString error){
+            std::cerr << error.toStdString() << std::endl;
+        }
+    }
+private:
+    QString mPath;
+};
+
+CmdRunner::CmdRunner():
+mFFTLen(CMD_DEFAULT_FFT_LEN),
+mHFactor(CMD_DEFAULT_HFACTOR),
+mHPDThreshold(CMD_DEFAULT_HPD),
+mSaveDat(true),
+mQuiet(false),
+mNumLocalWorkers(0),
+mCSVCellSeparator(","),
+mCSVDecSeparator("."),
+mStepMax(0),
+mLastPercent(-1)
+{
+
+}
+
+CmdRunner::~CmdRunner()
+{
+
+}
+
+/**
+ * @brief Parses the arguments and runs the projects one after the other.
+ * @return the exit code of the command line (see Status)
+ */
+int CmdRunner::exec(const QStringList& arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription(tr("Runs ChronoModel projects without user interface"));
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("projects", tr("Project files (.chr) to run"), "project.chr...");
+
+    QCommandLineOption outputOption(QStringList() << "o" << "output", tr("Output directory (default : next to each project, named <project>_results)"), "directory");
+    QCommandLineOption fftLenOption("fft-len", tr("Number of points of the posterior densities"), "length", QString::number(CMD_DEFAULT_FFT_LEN));
+    QCommandLineOption hFactorOption("h-factor", tr("Bandwidth factor of the posterior densities"), "factor", QString::number(CMD_DEFAULT_HFACTOR));
+    QCommandLineOption hpdOption("hpd", tr("HPD and credibility threshold (%)"), "threshold", QString::number(CMD_DEFAULT_HPD));
+    QCommandLineOption cellSepOption("csv-sep", tr("CSV cell separator"), "separator", ",");
+    QCommandLineOption decSepOption("csv-dec", tr("CSV decimal separator (. or ,)"), "separator", ".");
+    QCommandLineOption noDatOption("no-dat", tr("Do not write the .dat results file"));
+    QCommandLineOption quietOption(QStringList() << "q" << "quiet", tr("Only print the status of the projects"));
+    QCommandLineOption sweepOption("sweep", tr("Runs the variants of the project described in this JSON file (see Sweep.h) and writes a summary"), "spec.json");
+    QCommandLineOption jobsOption(QStringList() << "j" << "jobs", tr("Number of variants run at the same time (default : number of cores)"), "jobs", QString::number(QThread::idealThreadCount()));
+
+    parser.addOption(outputOption);
+    parser.addOption(fftLenOption);
+    parser.addOption(hFactorOption);
+    parser.addOption(hpdOption);
+    parser.addOption(cellSepOption);
+    parser.addOption(decSepOption);
+    parser.addOption(noDatOption);
+    parser.addOption(quietOption);
+    QCommandLineOption workerOption("worker", tr("Runs as a worker : connects to the master at this address (local:<name> or host:port) and runs its chains"), "address");
+    QCommandLineOption workerOnceOption("worker-once", tr("With --worker : stops when the master is gone, instead of waiting for the next one"));
+    QCommandLineOption listenOption("listen", tr("Runs the chains on the workers connecting to this address (local:<name> or [tcp:]host:port)"), "address");
+    QCommandLineOption localWorkersOption("local-workers", tr("Runs the chains on this number of worker processes started on this machine"), "count");
+    QCommandLineOption traceOption("trace", tr("Writes the timeline of the run (calibration, chains, results...) to this Chrome trace file"), "trace.json");
+
+    parser.addOption(sweepOption);
+    parser.addOption(jobsOption);
+    parser.addOption(workerOption);
+    parser.addOption(workerOnceOption);
+    parser.addOption(listenOption);
+    parser.addOption(localWorkersOption);
+    parser.addOption(traceOption);
+
+    if(!parser.parse(arguments))
+    {
+        std::cerr << parser.errorText().toStdString() << std::endl;
+        return eUsageError;
+    }
+    if(parser.isSet("help"))
+    {
+        std::cout << parser.helpText().toStdString();
+        return eOk;
+    }
+    if(parser.isSet("version"))
+    {
+        parser.showVersion();
+    }
+
+    TraceWriter traceWriter(parser.value(traceOption));
+
+    if(parser.isSet(workerOption))
+    {
+        ChainWorker worker;
+        try{
+            worker.serve(parser.value(workerOption), parser.isSet(workerOnceOption));
+        }
+        catch(QString error){
+            std::cerr << error.toStdString() << std::endl;
+            return eMCMCError;
+        }
+        return eOk;
+    }
+
+    const QStringList projects = parser.positionalArguments();
+    if(projects.isEmpty())
+    {
+        std::cerr << parser.helpText().toStdString();
+        return eUsageError;
+    }
+
+    bool ok = true;
+    mFFTLen = parser.value(fftLenOption).toInt(&ok);
+    if(!ok || mFFTLen < 32 || (mFFTLen & (mFFTLen - 1)) != 0)
+    {
+        std::cerr << tr("The FFT length must be a power of 2, at least 32").toStdString() << std::endl;
+        return eUsageError;
+    }
+    mHFactor = parser.value(hFactorOption).toDouble(&ok);
+    if(!ok || !(mHFactor > 0 && mHFactor <= 100))
+    {
+        std::cerr << tr("The bandwidth factor must be in ]0, 100]").toStdString() << std::endl;
+        return eUsageError;
+    }
+    mHPDThreshold = parser.value(hpdOption).toDouble(&ok);
+    if(!ok || mHPDThreshold < 0 || mHPDThreshold > 100)
+    {
+        std::cerr << tr("The HPD threshold must be in [0, 100]").toStdString() << std::endl;
+        return eUsageError;
+    }
+    mCSVCellSeparator = parser.value(cellSepOption);
+    mCSVDecSeparator = parser.value(decSepOption);
+    mSaveDat = !parser.isSet(noDatOption);
+    mQuiet = parser.isSet(quietOption);
+
+    mListenAddress = parser.value(listenOption);
+    mNumLocalWorkers = 0;
+    if(parser.isSet(localWorkersOption))
+    {
+        mNumLocalWorkers = parser.value(localWorkersOption).toInt(&ok);
+        if(!ok || mNumLocalWorkers < 1)
+        {
+            std::cerr << tr("The number of local workers must be at least 1").toStdString() << std::endl;
+            return eUsageError;
+        }
+    }
+
+    if(parser.isSet(sweepOption))
+    {
+        const int jobs = parser.value(jobsOption).toInt(&ok);
+        if(!ok || jobs < 1)
+        {
+            std::cerr << tr("The number of jobs must be at least 1").toStdString() << std::endl;
+            return eUsageError;
+        }
+        if(projects.size() != 1)
+        {
+            std::cerr << tr("A sweep runs the variants of a single project").toStdString() << std::endl;
+            return eUsageError;
+        }
+        if(!mListenAddress.isEmpty() || mNumLocalWorkers > 0)
+        {
+            std::cerr << tr("The variants of a sweep cannot share the workers : use --jobs").toStdString() << std::endl;
+            return eUsageError;
+        }
+        QFileInfo info(projects.first());
+        const QString outputPath = parser.isSet(outputOption) ? parser.value(outputOption) : info.absolutePath() + "/" + info.completeBaseName() + "_sweep";
+        return runSweep(projects.first(), parser.value(sweepOption), outputPath, jobs);
+    }
+
+    int result = eOk;
+    for(int i=0; i<projects.size(); ++i)
+    {
+        QFileInfo info(projects[i]);
+        QString outputPath;
+        if(parser.isSet(outputOption))
+        {
+            outputPath = parser.value(outputOption);
+            if(projects.size() > 1)
+                outputPath += "/" + info.completeBaseName();
+        }
+        else
+            outputPath = info.absolutePath() + "/" + info.completeBaseName() + "_results";
+
+        // The next projects are run anyway : the worst status is returned
+        result = qMax(result, (int)runProject(projects[i], outputPath));
+    }
+    return result;
+}
+
+CmdRunner::Status CmdRunner::runProject(const QString& projectPath, const QString& outputPath)
+{
+    mProject = projectPath;
+    QTime startTime = QTime::currentTime();
+
+    QJsonObject state;
+    try{
+        state = loadState(projectPath);
+    }
+    catch(QString error){
+        printStatus(eLoadError, error);
+        return eLoadError;
+    }
+
+    QString error;
+    const Status status = runModel(state, projectPath, outputPath, true, error);
+    if(status != eOk)
+    {
+        printStatus(status, error);
+        return status;
+    }
+    printStatus(eOk, tr("Results written in ") + QDir(outputPath).absolutePath() + " (" + QString::number(startTime.elapsed() / 1000.) + " s)");
+    return eOk;
+}
+
+/**
+ * @brief Runs all the variants of the project, several at a time, then writes the summary.
+ */
+CmdRunner::Status CmdRunner::runSweep(const QString& projectPath, const QString& specPath, const QString& outputPath, int jobs)
+{
+    mProject = projectPath;
+    QTime startTime = QTime::currentTime();
+
+    QJsonObject state;
+    try{
+        state = loadState(projectPath);
+    }
+    catch(QString error){
+        printStatus(eLoadError, error);
+        return eLoadError;
+    }
+
+    QList<SweepVariant> variants;
+    try{
+        QFile file(specPath);
+        if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+            throw tr("Cannot read the file : ") + specPath;
+
+        QJsonParseError parseError;
+        QJsonDocument jsonDoc(QJsonDocument::fromJson(file.readAll(), &parseError));
+        file.close();
+        if(parseError.error != QJsonParseError::NoError || !jsonDoc.isObject())
+            throw tr("The sweep specification could not be loaded : ") + parseError.errorString();
+
+        variants = Sweep::variantsFromSpec(jsonDoc.object());
+    }
+    catch(QString error){
+        printStatus(eUsageError, error);
+        return eUsageError;
+    }
+
+    BatchRunner batch(this, state, variants, projectPath, outputPath);
+    WorkStealingScheduler scheduler(jobs);
+    scheduler.run(&batch, variants.size());
+
+    try{
+        batch.writeSummary();
+    }
+    catch(QString error){
+        printStatus(eWriteError, error);
+        return eWriteError;
+    }
+
+    const Status status = batch.status();
+    QString message = tr("Summary written in ") + QDir(outputPath).absolutePath() + " (" + QString::number(startTime.elapsed() / 1000.) + " s)";
+    if(status != eOk)
+        message += " : " + tr("%1 variant(s) failed on %2").arg(batch.numFailed()).arg(variants.size());
+    printStatus(status, message);
+    return status;
+}
+
+/**
+ * @brief Check, calibration, MCMC, posterior densities and results files of one model.
+ * @param error message of the failure when the status is not eOk
+ * @param results if not null, receives the numerical results (same as results.json)
+ */
+CmdRunner::Status CmdRunner::runModel(const QJsonObject& state, const QString& projectName, const QString& outputPath, bool progress, QString& error, QJsonObject* results)
+{
+    // ----------------------------------------------------
+    //  Check
+    // ----------------------------------------------------
+    Model* model = new Model();
+    model->setJson(state);
+    try{
+        model->fromJson(state);
+        model->isValid();
+    }
+    catch(QString e){
+        delete model;
+        error = e;
+        return eInvalidModel;
+    }
+
+    // ----------------------------------------------------
+    //  Calibration and MCMC (on the loop thread, this one just waits)
+    // ----------------------------------------------------
+    MCMCLoopMain* loop = new MCMCLoopMain(model);
+
+    ChainDispatcher* dispatcher = 0;
+    if(!mListenAddress.isEmpty() || mNumLocalWorkers > 0)
+    {
+        dispatcher = new ChainDispatcher();
+        if(!mListenAddress.isEmpty())
+            dispatcher->setListenAddress(mListenAddress);
+        dispatcher->setLocalWorkers(mNumLocalWorkers, QCoreApplication::applicationFilePath());
+        loop->setDispatcher(dispatcher);
+    }
+
+    // The progress is polled from this thread : the loop only publishes its counters (see MCMCLoop::progress)
+    loop->start();
+    int stepIndex = 0;
+    while(!loop->wait(MCMC_PROGRESS_INTERVAL))
+    {
+        if(progress)
+        {
+            const MCMCProgress progressState = loop->progress();
+            if(progressState.mStepIndex != stepIndex)
+            {
+                stepIndex = progressState.mStepIndex;
+                setStep(progressState.mStepTitle, 0, progressState.mStepMax);
+            }
+            setProgress(progressState.mStepValue);
+        }
+    }
+
+    const QString abortedReason = loop->mAbortedReason;
+    model->mLogMCMC = loop->getChainsLog() + loop->getInitLog();
+    delete loop;
+    delete dispatcher;
+
+    if(!abortedReason.isEmpty())
+    {
+        delete model;
+        error = abortedReason;
+        return eMCMCError;
+    }
+
+    // ----------------------------------------------------
+    //  Post-processing : same as the results view
+    // ----------------------------------------------------
+    if(progress)
+        setStep(tr("Posterior densities"), 0, 0);
+    model->generatePosteriorDensities(model->mChains, mFFTLen, mHFactor);
+    model->generateNumericalResults(model->mChains);
+    model->generateCredibilityAndHPD(model->mChains, mHPDThreshold);
+    model->generateModelLog();
+    model->generateResultsLog();
+
+    // ----------------------------------------------------
+    //  Results
+    // ----------------------------------------------------
+    if(progress)
+        setStep(tr("Writing results"), 0, 0);
+    const QJsonObject resultsJson = resultsToJson(model, projectName);
+    try{
+        writeResults(model, outputPath, QFileInfo(projectName).completeBaseName(), resultsJson);
+    }
+    catch(QString e){
+        delete model;
+        error = e;
+        return eWriteError;
+    }
+    delete model;
+
+    if(results)
+        *results = resultsJson;
+    return eOk;
+}
+
+/**
+ * @brief Reads the project file and applies the same checks as when it is opened in the application.
+ */
+QJsonObject CmdRunner::loadState(const QString& projectPath)
+{
+    QFile file(projectPath);
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        throw tr("Cannot read the file : ") + projectPath;
+
+    QJsonParseError error;
+    QJsonDocument jsonDoc(QJsonDocument::fromJson(file.readAll(), &error));
+    file.close();
+
+    if(error.error != QJsonParseError::NoError)
+        throw tr("The project file could not be loaded : ") + error.errorString();
+    if(!jsonDoc.isObject() || !jsonDoc.object().contains(STATE_EVENTS))
+        throw tr("This is not a ChronoModel project : ") + projectPath;
+
+    QJsonObject state = ModelUtilities::checkDatesCompatibility(jsonDoc.object());
+    return ModelUtilities::checkValidDates(state);
+}
+
+QString CmdRunner::csvCellSeparator() const
+{
+    return mCSVCellSeparator;
+}
+
+QLocale CmdRunner::csvLocale() const
+{
+    QLocale locale = (mCSVDecSeparator == ".") ? QLocale::English : QLocale::French;
+    locale.setNumberOptions(QLocale::OmitGroupSeparator);
+    return locale;
+}
+
+void CmdRunner::writeResults(Model* model, const QString& outputPath, const QString& baseName, const QJsonObject& results) const
+{
+    QDir dir(outputPath);
+    if(!dir.mkpath("."))
+        throw tr("Cannot create the directory : ") + outputPath;
+
+    if(mSaveDat)
+        model->saveToFile(dir.absoluteFilePath(baseName + ".chr.dat"));
+
+    // CSV : same files as the export of the results view
+    const QLocale locale = csvLocale();
+
+    bool ok = saveCsvTo(model->getStats(locale), dir.absoluteFilePath("stats.csv"), mCSVCellSeparator);
+    if(model->mPhases.size() > 0)
+    {
+        ok = ok && saveCsvTo(model->getPhasesTraces(locale), dir.absoluteFilePath("phases.csv"), mCSVCellSeparator);
+        for(int i=0; i<model->mPhases.size(); ++i)
+        {
+            QString name = model->mPhases[i]->getName().toLower().simplified().replace(" ", "_");
+            ok = ok && saveCsvTo(model->getPhaseTrace(i, locale), dir.absoluteFilePath("phase_" + name + ".csv"), mCSVCellSeparator);
+        }
+    }
+    ok = ok && saveCsvTo(model->getEventsTraces(locale), dir.absoluteFilePath("events.csv"), mCSVCellSeparator);
+    if(!ok)
+        throw tr("Cannot write the CSV files in : ") + outputPath;
+
+    // JSON : numerical results and logs
+    QFile file(dir.absoluteFilePath("results.json"));
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        throw tr("Cannot write the file : ") + file.fileName();
+    file.write(QJsonDocument(results).toJson(QJsonDocument::Indented));
+    file.close();
+}
+
+/**
+ * @brief Numerical results of the model, in the native BC/AD scale (the display format of the application is not applied).
+ */
+QJsonObject CmdRunner::resultsToJson(Model* model, const QString& projectName) const
+{
+    QJsonObject results;
+    results["project"] = projectName;
+    results["tmin"] = model->mSettings.mTmin;
+    results["tmax"] = model->mSettings.mTmax;
+    results["step"] = model->mSettings.mStep;
+    results["fft_len"] = mFFTLen;
+    results["h_factor"] = mHFactor;
+    results["hpd_threshold"] = mHPDThreshold;
+
+    QJsonArray seeds;
+    for(int i=0; i<model->mChains.size(); ++i)
+        seeds.append(model->mChains[i].mSeed);
+    results["seeds"] = seeds;
+
+    QJsonArray events;
+    for(int i=0; i<model->mEvents.size(); ++i)
+    {
+        Event* event = model->mEvents[i];
+        QJsonObject eventJson;
+        eventJson["name"] = event->getName();
+        eventJson["theta"] = variableToJson(event->mTheta);
+
+        QJsonArray dates;
+        for(int j=0; j<event->mDates.size(); ++j)
+        {
+            Date& date = event->mDates[j];
+            QJsonObject dateJson;
+            dateJson["name"] = date.getName();
+            dateJson["theta"] = variableToJson(date.mTheta);
+            dateJson["sigma"] = variableToJson(date.mSigma);
+            dates.append(dateJson);
+        }
+        eventJson["dates"] = dates;
+        events.append(eventJson);
+    }
+    results["events"] = events;
+
+    QJsonArray phases;
+    for(int i=0; i<model->mPhases.size(); ++i)
+    {
+        Phase* phase = model->mPhases[i];
+        QJsonObject phaseJson;
+        phaseJson["name"] = phase->getName();
+        phaseJson["alpha"] = variableToJson(phase->mAlpha);
+        phaseJson["beta"] = variableToJson(phase->mBeta);
+        phaseJson["duration"] = variableToJson(phase->mDuration);
+        phases.append(phaseJson);
+    }
+    results["phases"] = phases;
+
+    QJsonObject logs;
+    logs["model"] = model->getModelLog();
+    logs["mcmc"] = model->getMCMCLog();
+    logs["results"] = model->getResultsLog();
+    results["logs"] = logs;
+    results["instrumentation"] = model->mInstrumentation.toJson();
+
+    return results;
+}
+
+QJsonObject CmdRunner::variableToJson(MetropolisVariable& variable) const
+{
+    QJsonObject json;
+    json["mode"] = variable.mResults.analysis.mode;
+    json["mean"] = variable.mResults.analysis.mean;
+    json["stddev"] = variable.mResults.analysis.stddev;
+    json["q1"] = variable.mResults.quartiles.Q1;
+    json["q2"] = variable.mResults.quartiles.Q2;
+    json["q3"] = variable.mResults.quartiles.Q3;
+
+    QJsonArray credibility;
+    credibility.append(variable.mCredibility.first);
+    credibility.append(variable.mCredibility.second);
+    json["credibility"] = credibility;
+    json["credibility_threshold"] = variable.mExactCredibilityThreshold * 100.;
+
+    QJsonArray hpd;
+    QList<QPair<double, QPair<double, double> > > intervals = intervalsForHpd(variable.mHPD, variable.mThreshold);
+    for(int i=0; i<intervals.size(); ++i)
+    {
+        QJsonArray interval;
+        interval.append(intervals[i].first);
+        interval.append(intervals[i].second.first);
+        interval.append(intervals[i].second.second);
+        hpd.append(interval);
+    }
+    json["hpd"] = hpd;
+    return json;
+}
+
+#pragma mark Progress
+void CmdRunner::setStep(const QString& title, int min, int max)
+{
+    mStep = title;
+    mStepMax = max - min;
+    mLastPercent = -1;
+    mStepTime.start();
+
+    QJsonObject message;
+    message["type"] = QString("step");
+    message["step"] = mStep;
+    message["max"] = mStepMax;
+    printMessage(message);
+}
+
+/**
+ * @brief Polled every MCMC_PROGRESS_INTERVAL ms : only the changes of percentage are printed.
+ */
+void CmdRunner::setProgress(int value)
+{
+    if(mStepMax <= 0)
+        return;
+
+    const int percent = (int)(100. * value / mStepMax);
+    if(percent == mLastPercent)
+        return;
+    mLastPercent = percent;
+
+    QJsonObject message;
+    message["type"] = QString("progress");
+    message["step"] = mStep;
+    message["value"] = value;
+    message["max"] = mStepMax;
+    message["elapsed"] = mStepTime.elapsed() / 1000.;
+    printMessage(message);
+}
+
+void CmdRunner::printMessage(const QJsonObject& message)
+{
+    if(mQuiet)
+        return;
+
+    QJsonObject line = message;
+    line["project"] = mProject;
+    printLine(line);
+}
+
+void CmdRunner::printStatus(Status status, const QString& message)
+{
+    QJsonObject line;
+    line["type"] = QString("status");
+    line["project"] = mProject;
+    line["code"] = (int)status;
+    line["message"] = message;
+    printLine(line);
+}
+
+/**
+ * @brief Status of one variant of a sweep, printed even in quiet mode (the project status comes at the end).
+ */
+void CmdRunner::printVariantStatus(int index, int count, const QString& variant, Status status, const QString& message)
+{
+    QJsonObject line;
+    line["type"] = QString("variant");
+    line["project"] = mProject;
+    line["variant"] = variant;
+    line["index"] = index + 1;
+    line["count"] = count;
+    line["code"] = (int)status;
+    line["message"] = message;
+    printLine(line);
+}
+
+void CmdRunner::printLine(const QJsonObject& line) const
+{
+    QMutexLocker locker(&sOutputMutex);
+    std::cout << QJsonDocument(line).toJson(QJsonDocument::Compact).constData() << std::endl;
+}
@@ -0,0 +1,97 @@
+#ifndef CMDRUNNER_H
+#define CMDRUNNER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QJsonObject>
+#include <QTime>
+#include <QLocale>
+
+class Model;
+class MetropolisVariable;
+
+#define CMD_DEFAULT_FFT_LEN 1024
+#define CMD_DEFAULT_HFACTOR 1.
+#define CMD_DEFAULT_HPD 95.
+#define CMD_SWEEP_SUMMARY "summary.csv"
+#define CMD_SWEEP_VARIANTS "variants.json"
+
+
+/**
+ * @brief Runs .chr projects without any UI : load, check, calibrate, MCMC, posterior densities,
+ * then writes the results (.dat, CSV and JSON) in an output directory.
+ * Progress and status are printed on stdout as JSON lines, one object per line, e.g. :
+ * {"type":"progress","project":"a.chr","step":"Chain 1/3 : Burning","value":250,"max":1000}
+ * The messages for humans (qDebug...) stay on stderr.
+ * With --sweep, the variants of one project are run concurrently (see Sweep and BatchRunner).
+ * With --listen or --local-workers, the chains are run by worker processes (see ChainDispatcher),
+ * which are this same program started with --worker <address>.
+ * With --trace, the timeline of the run is written as a Chrome trace file (see Trace).
+ */
+class CmdRunner: public QObject
+{
+    Q_OBJECT
+public:
+    // Exit codes of the command line : the worst status of the projects is returned
+    enum Status
+    {
+        eOk = 0,
+        eUsageError = 1,
+        eLoadError = 2,
+        eInvalidModel = 3,
+        eMCMCError = 4,
+        eWriteError = 5
+    };
+
+    CmdRunner();
+    virtual ~CmdRunner();
+
+    int exec(const QStringList& arguments);
+    Status runProject(const QString& projectPath, const QString& outputPath);
+    Status runSweep(const QString& projectPath, const QString& specPath, const QString& outputPath, int jobs);
+
+    // Pipeline of one model, from its state to its results files.
+    // Without progress, it only reads the settings of the runner : several models can run at the same time.
+    Status runModel(const QJsonObject& state, const QString& projectName, const QString& outputPath, bool progress, QString& error, QJsonObject* results = 0);
+
+    QString csvCellSeparator() const;
+    QLocale csvLocale() const;
+
+    void printVariantStatus(int index, int count, const QString& variant, Status status, const QString& message);
+
+private:
+    // Called by the polling loop of runModel, with the progress of the MCMC thread
+    void setStep(const QString& title, int min, int max);
+    void setProgress(int value);
+
+    QJsonObject loadState(const QString& projectPath);
+    void writeResults(Model* model, const QString& outputPath, const QString& baseName, const QJsonObject& results) const;
+    QJsonObject resultsToJson(Model* model, const QString& projectName) const;
+    QJsonObject variableToJson(MetropolisVariable& variable) const;
+
+    void printMessage(const QJsonObject& message);
+    void printStatus(Status status, const QString& message);
+    void printLine(const QJsonObject& line) const;
+
+    int mFFTLen;
+    double mHFactor;
+    double mHPDThreshold;
+    bool mSaveDat;
+    bool mQuiet;
+
+    // Distributed chains (see ChainDispatcher)
+    QString mListenAddress;
+    int mNumLocalWorkers;
+    QString mCSVCellSeparator;
+    QString mCSVDecSeparator;
+
+    // Progress of the current project
+    QString mProject;
+    QString mStep;
+    int mStepMax;
+    int mLastPercent;
+    QTime mStepTime;
+};
+
+#endif
@@ -0,0 +1,200 @@
+#include "Sweep.h"
+#include "StateKeys.h"
+
+#include <QObject>
+#include <QJsonArray>
+#include <QRegularExpression>
+#include <QSet>
+
+
+QList<SweepVariant> Sweep::variantsFromSpec(const QJsonObject& spec)
+{
+    QList<SweepVariant> variants;
+    
+    // ----------------------------------------------------
+    //  Cartesian product of the swept values
+    // ----------------------------------------------------
+    const QJsonObject sweep = spec.value(SWEEP_SWEEP).toObject();
+    if(!sweep.isEmpty())
+    {
+        QList<QJsonObject> combinations;
+        combinations.append(QJsonObject());
+        
+        for(QJsonObject::const_iterator it = sweep.constBegin(); it != sweep.constEnd(); ++it)
+        {
+            const QJsonArray values = it.value().toArray();
+            if(values.isEmpty())
+                throw QObject::tr("The sweep of \"%1\" has no value").arg(it.key());
+            
+            QList<QJsonObject> expanded;
+            for(int i=0; i<combinations.size(); ++i)
+            {
+                for(int j=0; j<values.size(); ++j)
+                {
+                    QJsonObject combination = combinations[i];
+                    combination[it.key()] = values[j];
+                    expanded.append(combination);
+                }
+            }
+            combinations = expanded;
+        }
+        for(int i=0; i<combinations.size(); ++i)
+        {
+            SweepVariant variant;
+            variant.mName = QString("variant_%1").arg(i + 1, 3, 10, QChar('0'));
+            variant.mValues = combinations[i];
+            variants.append(variant);
+        }
+    }
+    
+    // ----------------------------------------------------
+    //  Explicit variants
+    // ----------------------------------------------------
+    const QJsonArray explicitVariants = spec.value(SWEEP_VARIANTS).toArray();
+    for(int i=0; i<explicitVariants.size(); ++i)
+    {
+        const QJsonObject variantJson = explicitVariants[i].toObject();
+        SweepVariant variant;
+        variant.mName = variantJson.value(SWEEP_NAME).toString();
+        if(variant.mName.isEmpty())
+            variant.mName = QString("variant_%1").arg(variants.size() + 1, 3, 10, QChar('0'));
+        variant.mValues = variantJson.value(SWEEP_VALUES).toObject();
+        variants.append(variant);
+    }
+    
+    if(variants.isEmpty())
+        throw QObject::tr("The sweep specification has no variant : use \"%1\" and/or \"%2\"").arg(SWEEP_SWEEP, SWEEP_VARIANTS);
+    
+    // The names are used as directory names
+    QSet<QString> names;
+    for(int i=0; i<variants.size(); ++i)
+    {
+        variants[i].mName = variants[i].mName.simplified().replace(QRegularExpression("[^\\w\\-\\.]"), "_");
+        if(names.contains(variants[i].mName))
+            throw QObject::tr("Two variants have the same name : ") + variants[i].mName;
+        names.insert(variants[i].mName);
+    }
+    return variants;
+}
+
+QStringList Sweep::sweptPaths(const QList<SweepVariant>& variants)
+{
+    QStringList paths;
+    for(int i=0; i<variants.size(); ++i)
+    {
+        const QStringList keys = variants[i].mValues.keys();
+        for(int j=0; j<keys.size(); ++j)
+        {
+            if(!paths.contains(keys[j]))
+                paths.append(keys[j]);
+        }
+    }
+    return paths;
+}
+
+QJsonObject Sweep::applyVariant(const QJsonObject& state, const SweepVariant& variant)
+{
+    QJsonObject variantState = state;
+    for(QJsonObject::const_iterator it = variant.mValues.constBegin(); it != variant.mValues.constEnd(); ++it)
+        applyValue(variantState, it.key(), it.value());
+    return variantState;
+}
+
+/**
+ * @brief Replaces the value at the given path (see Sweep). Throws if the path does not match anything.
+ */
+void Sweep::applyValue(QJsonObject& state, const QString& path, const QJsonValue& value)
+{
+    QStringList keys = path.split("/", QString::SkipEmptyParts);
+    static const QRegularExpression rootExp("^(\\w+)(?:\\[(.*)\\])?$");
+    const QRegularExpressionMatch match = rootExp.match(keys.isEmpty() ? QString() : keys.first());
+    if(keys.size() < 2 || !match.hasMatch())
+        throw QObject::tr("Invalid sweep path : ") + path;
+    
+    const QString root = match.captured(1);
+    const QString selector = match.captured(2);
+    keys.removeFirst();
+    
+    int found = 0;
+    if(root == STATE_SETTINGS || root == STATE_MCMC)
+    {
+        QJsonObject object = state.value(root).toObject();
+        if(selector.isEmpty() && setNestedValue(object, keys, value))
+            ++found;
+        state[root] = object;
+    }
+    else if(root == STATE_EVENTS || root == STATE_PHASES)
+    {
+        QJsonArray items = state.value(root).toArray();
+        for(int i=0; i<items.size(); ++i)
+        {
+            QJsonObject item = items[i].toObject();
+            if(!selector.isEmpty() && item.value(STATE_NAME).toString() != selector)
+                continue;
+            if(setNestedValue(item, keys, value))
+                ++found;
+            items[i] = item;
+        }
+        state[root] = items;
+    }
+    else if(root == STATE_EVENT_DATES)
+    {
+        const bool exclude = (keys.size() == 1 && keys.first() == SWEEP_EXCLUDED);
+        QJsonArray events = state.value(STATE_EVENTS).toArray();
+        for(int i=0; i<events.size(); ++i)
+        {
+            QJsonObject event = events[i].toObject();
+            QJsonArray dates = event.value(STATE_EVENT_DATES).toArray();
+            for(int j=dates.size()-1; j>=0; --j)
+            {
+                QJsonObject date = dates[j].toObject();
+                if(!selector.isEmpty() && date.value(STATE_NAME).toString() != selector)
+                    continue;
+                if(exclude)
+                {
+                    ++found;
+                    if(value.toBool())
+                        dates.removeAt(j);
+                }
+                else
+                {
+                    if(setNestedValue(date, keys, value))
+                        ++found;
+                    dates[j] = date;
+                }
+            }
+            event[STATE_EVENT_DATES] = dates;
+            events[i] = event;
+        }
+        state[STATE_EVENTS] = events;
+    }
+    else
+        throw QObject::tr("Unknown sweep path : ") + path;
+    
+    if(found == 0)
+        throw QObject::tr("The sweep path does not match anything in the project : ") + path;
+}
+
+/**
+ * @brief Only replaces existing keys : returns false if one of the keys is missing.
+ */
+bool Sweep::setNestedValue(QJsonObject& object, const QStringList& keys, const QJsonValue& value)
+{
+    const QString key = keys.first();
+    if(!object.contains(key))
+        return false;
+    
+    if(keys.size() == 1)
+    {
+        object[key] = value;
+        return true;
+    }
+    if(!object.value(key).isObject())
+        return false;
+    
+    QJsonObject child = object.value(key).toObject();
+    if(!setNestedValue(child, keys.mid(1), value))
+        return false;
+    object[key] = child;
+    return true;
+}
@@ -0,0 +1,54 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <QString>
+#include <QStringList>
+#include <QJsonObject>
+#include <QList>
+
+#define SWEEP_SWEEP "sweep"
+#define SWEEP_VARIANTS "variants"
+#define SWEEP_NAME "name"
+#define SWEEP_VALUES "values"
+#define SWEEP_EXCLUDED "excluded"
+
+
+/**
+ * @brief One variant of a project : the values to replace in its state, by path (see Sweep).
+ */
+struct SweepVariant
+{
+    QString mName;
+    QJsonObject mValues;
+};
+
+/**
+ * @brief Sweep specification (JSON file) :
+ * {
+ *   "sweep": { "settings/tmin": [-2000, -1000], "mcmc/num_iter": [1000, 10000] },
+ *   "variants": [ { "name": "no_outlier", "values": { "dates[Ly-1234]/excluded": true } } ]
+ * }
+ * All the combinations of the "sweep" values are run (cartesian product), then the explicit "variants".
+ *
+ * Paths :
+ * - settings/<key>, mcmc/<key> : study period and MCMC settings,
+ * - events[name]/<key>, phases[name]/<key>, dates[name]/<key> : applied to the items with this name,
+ *   or to all of them without [name]. The key may be nested, e.g. dates[Ly-1234]/data/ref_curve,
+ * - dates[name]/excluded : true removes the date from its event (outlier configurations).
+ * The keys must already exist in the project : a misspelled path is an error, not a silent no-op.
+ */
+class Sweep
+{
+public:
+    static QList<SweepVariant> variantsFromSpec(const QJsonObject& spec);
+    static QJsonObject applyVariant(const QJsonObject& state, const SweepVariant& variant);
+    
+    // Paths set by at least one variant, in order of appearance (columns of the summary)
+    static QStringList sweptPaths(const QList<SweepVariant>& variants);
+    
+private:
+    static void applyValue(QJsonObject& state, const QString& path, const QJsonValue& value);
+    static bool setNestedValue(QJsonObject& object, const QStringList& keys, const QJsonValue& value);
+};
+
+#endif
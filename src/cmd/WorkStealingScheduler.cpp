@@ -0,0 +1,108 @@
+#include "WorkStealingScheduler.h"
+#include <QMutexLocker>
+
+
+#pragma mark Worker
+SchedulerWorker::SchedulerWorker(WorkStealingScheduler* scheduler, int worker):
+mScheduler(scheduler),
+mWorker(worker)
+{
+    
+}
+
+SchedulerWorker::~SchedulerWorker()
+{
+    
+}
+
+void SchedulerWorker::run()
+{
+    int index = 0;
+    while(mScheduler->takeTask(mWorker, index))
+        mScheduler->mTask->runTask(index);
+}
+
+#pragma mark Scheduler
+WorkStealingScheduler::WorkStealingScheduler(int numWorkers):
+mNumWorkers(qMax(1, numWorkers)),
+mTask(0)
+{
+    for(int i=0; i<mNumWorkers; ++i)
+        mQueues.append(new Queue());
+}
+
+WorkStealingScheduler::~WorkStealingScheduler()
+{
+    qDeleteAll(mQueues);
+    mQueues.clear();
+}
+
+int WorkStealingScheduler::numWorkers() const
+{
+    return mNumWorkers;
+}
+
+void WorkStealingScheduler::run(SchedulerTask* task, int numTasks)
+{
+    if(!task || numTasks <= 0)
+        return;
+    
+    mTask = task;
+    
+    // No need for more threads than tasks
+    const int numThreads = qMin(mNumWorkers, numTasks);
+    
+    // Contiguous blocks : the first tasks of each queue are started at once
+    for(int w=0; w<mNumWorkers; ++w)
+    {
+        QMutexLocker locker(&mQueues[w]->mMutex);
+        mQueues[w]->mIndexes.clear();
+        if(w >= numThreads)
+            continue;
+        const int begin = (w * numTasks) / numThreads;
+        const int end = ((w + 1) * numTasks) / numThreads;
+        for(int i=begin; i<end; ++i)
+            mQueues[w]->mIndexes.append(i);
+    }
+    
+    QList<SchedulerWorker*> workers;
+    for(int w=0; w<numThreads; ++w)
+    {
+        SchedulerWorker* worker = new SchedulerWorker(this, w);
+        workers.append(worker);
+        worker->start();
+    }
+    for(int w=0; w<workers.size(); ++w)
+        workers[w]->wait();
+    
+    qDeleteAll(workers);
+    mTask = 0;
+}
+
+/**
+ * @brief Front of the worker's own queue, or else back of the first non empty queue of the others.
+ * The tasks are never added once started : when all the queues are empty, the worker can stop.
+ */
+bool WorkStealingScheduler::takeTask(int worker, int& index)
+{
+    {
+        Queue* own = mQueues[worker];
+        QMutexLocker locker(&own->mMutex);
+        if(!own->mIndexes.isEmpty())
+        {
+            index = own->mIndexes.takeFirst();
+            return true;
+        }
+    }
+    for(int i=1; i<mNumWorkers; ++i)
+    {
+        Queue* victim = mQueues[(worker + i) % mNumWorkers];
+        QMutexLocker locker(&victim->mMutex);
+        if(!victim->mIndexes.isEmpty())
+        {
+            index = victim->mIndexes.takeLast();
+            return true;
+        }
+    }
+    return false;
+}
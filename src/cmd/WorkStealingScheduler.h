@@ -0,0 +1,69 @@
+#ifndef WORKSTEALINGSCHEDULER_H
+#define WORKSTEALINGSCHEDULER_H
+
+#include <QThread>
+#include <QMutex>
+#include <QList>
+#include <QVector>
+
+
+/**
+ * @brief Work run by the scheduler : runTask is called once per index, from any worker thread.
+ */
+class SchedulerTask
+{
+public:
+    virtual ~SchedulerTask() {}
+    virtual void runTask(int index) = 0;
+};
+
+class WorkStealingScheduler;
+
+class SchedulerWorker: public QThread
+{
+public:
+    SchedulerWorker(WorkStealingScheduler* scheduler, int worker);
+    virtual ~SchedulerWorker();
+    
+protected:
+    void run();
+    
+private:
+    WorkStealingScheduler* mScheduler;
+    int mWorker;
+};
+
+/**
+ * @brief Runs the indexes [0, numTasks[ on several threads.
+ * Each worker starts with a contiguous block of indexes in its own queue, takes its tasks from the front
+ * and, once its queue is empty, steals from the back of the other queues.
+ * The tasks may have very different durations (e.g. MCMC settings sweeps) : no worker stays idle while others have work left.
+ */
+class WorkStealingScheduler
+{
+public:
+    WorkStealingScheduler(int numWorkers);
+    virtual ~WorkStealingScheduler();
+    
+    // Blocks until all the tasks are done
+    void run(SchedulerTask* task, int numTasks);
+    
+    int numWorkers() const;
+    
+private:
+    bool takeTask(int worker, int& index);
+    
+    struct Queue
+    {
+        QMutex mMutex;
+        QList<int> mIndexes;
+    };
+    
+    int mNumWorkers;
+    QVector<Queue*> mQueues;
+    SchedulerTask* mTask;
+    
+    friend class SchedulerWorker;
+};
+
+#endif
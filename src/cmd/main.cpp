@@ -0,0 +1,30 @@
+#include "CmdRunner.h"
+#include "PluginManager.h"
+
+#include <QCoreApplication>
+#include <QLocale>
+
+
+/**
+ * @brief Command line entry point : ChronomodelCmd [options] project.chr...
+ * Only a QCoreApplication is created : no window is ever shown and no display is needed.
+ */
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    a.setApplicationName("ChronoModel");
+    a.setApplicationVersion("1.3.5"); // check in file Chronomodel.pri
+    a.setOrganizationDomain("http://www.chronomodel.com");
+    a.setOrganizationName("CNRS");
+
+    // The numbers written in the logs and results must not depend on the machine running the batch
+    QLocale locale(QLocale::English);
+    locale.setNumberOptions(QLocale::OmitGroupSeparator);
+    QLocale::setDefault(locale);
+
+    PluginManager::loadPlugins();
+
+    CmdRunner runner;
+    return runner.exec(a.arguments());
+}
@@ -11,6 +11,7 @@
 #include <fenv.h>
 
 #include "StdUtilities.h"
+#include "Trace.h"
 
 #pragma STDC FENV_ACCESS on
 
@@ -66,7 +67,7 @@ int main(int argc, char *argv[])
     
     a.setApplicationName("ChronoModel");
     a.setApplicationDisplayName("ChronoModel");
-    a.setApplicationVersion("1.3.5"); // check in file Chronomodel.pro
+    a.setApplicationVersion("1.3.5"); // check in file Chronomodel.pri
     a.setOrganizationDomain("http://www.chronomodel.com");
     a.setOrganizationName("CNRS");
     a.setWindowIcon(QIcon(":chronomodel.png"));
@@ -97,9 +98,26 @@ int main(int argc, char *argv[])
     
     //QApplication::setStyle(new DarkBlueStyle());
     
+    // Opt-in timeline of the session, written when the application quits (see Trace)
+    const QString tracePath = QString::fromLocal8Bit(qgetenv(TRACE_ENV_VARIABLE));
+    if(!tracePath.isEmpty())
+        Trace::start();
+    
     MainController* c = new MainController(filePath);
     (void) c;
     
-    return a.exec();
+    const int result = a.exec();
+    
+    if(!tracePath.isEmpty())
+    {
+        Trace::stop();
+        try{
+            Trace::write(tracePath);
+        }
+        catch(QString error){
+            qDebug() << error;
+        }
+    }
+    return result;
 }
 
@@ -0,0 +1,384 @@
+#include "ChainDispatcher.h"
+#include "MCMCLoop.h"
+#include "QtUtilities.h"
+
+#include <QCoreApplication>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QProcess>
+#include <QDebug>
+#include <climits>
+
+
+ChainDispatcher::ChainDispatcher():
+mNumLocalWorkers(0),
+mWaitTimeout(CHAIN_WORKER_TIMEOUT),
+mTcpServer(0),
+mLocalServer(0),
+mNumSpawns(0),
+mNumDone(0)
+{
+    mListenAddress = "local:chronomodel-" + QString::number(QCoreApplication::applicationPid());
+}
+
+ChainDispatcher::~ChainDispatcher()
+{
+    close();
+}
+
+void ChainDispatcher::setListenAddress(const QString& address)
+{
+    mListenAddress = address;
+}
+
+void ChainDispatcher::setLocalWorkers(int count, const QString& program)
+{
+    mNumLocalWorkers = count;
+    mWorkerProgram = program;
+}
+
+void ChainDispatcher::setWaitTimeout(int timeout)
+{
+    mWaitTimeout = timeout;
+}
+
+const QString& ChainDispatcher::listenAddress() const
+{
+    return mListenAddress;
+}
+
+#pragma mark Run
+void ChainDispatcher::run(MCMCLoop* loop, QList<ChainResult>& results)
+{
+    const int numChains = loop->mChains.size();
+    const QJsonObject state = loop->dispatchedState();
+    
+    results.clear();
+    for(int i=0; i<numChains; ++i)
+        results.append(ChainResult());
+    
+    mPending.clear();
+    for(int i=0; i<numChains; ++i)
+        mPending.append(i);
+    mNumDone = 0;
+    mEvents.clear();
+    mChainError = QString();
+    
+    // Progress : sum of the iterations of all the chains
+    quint64 totalIter = 0;
+    for(int i=0; i<numChains; ++i)
+    {
+        const Chain& chain = loop->mChains.at(i);
+        totalIter += chain.mNumBurnIter + chain.mMaxBatchs * chain.mNumBatchIter + chain.mNumRunIter;
+    }
+    
+    try{
+        listen();
+        for(int i=0; i<mNumLocalWorkers; ++i)
+            spawnWorker();
+        
+        loop->setStep(tr("Running %1 chains on workers (%2)").arg(numChains).arg(mListenAddress), (int)qMin(totalIter, (quint64)INT_MAX));
+        
+        QTime noWorkerTime;
+        noWorkerTime.start();
+        
+        while(mNumDone < numChains)
+        {
+            if(loop->isInterruptionRequested())
+                throw QString(ABORTED_BY_USER);
+            
+            acceptWorkers();
+            
+            // ----- Messages of the workers -----
+            const int timeout = mWorkers.isEmpty() ? 50 : qMax(1, 50 / mWorkers.size());
+            for(int w=mWorkers.size()-1; w>=0; --w)
+            {
+                Worker& worker = mWorkers[w];
+                bool connected = false;
+                QString reason = tr("connection lost");
+                try{
+                    connected = readWorker(worker, results, timeout);
+                }
+                catch(QString error){
+                    // Another protocol version, a stray connection or a corrupted message : only this worker is concerned
+                    reason = error;
+                }
+                if(!mChainError.isEmpty())
+                    throw mChainError;
+                
+                if(!connected)
+                    dropWorker(w, reason);
+                else if(worker.mChainIndex >= 0 && worker.mLastMessage.elapsed() > CHAIN_WORKER_TIMEOUT)
+                    dropWorker(w, tr("no news for %1 s").arg(CHAIN_WORKER_TIMEOUT / 1000));
+            }
+            respawnWorkers();
+            
+            // ----- Requests to the idle workers -----
+            for(int w=0; w<mWorkers.size() && !mPending.isEmpty(); ++w)
+            {
+                Worker& worker = mWorkers[w];
+                if(!worker.mReady || worker.mChainIndex >= 0)
+                    continue;
+                
+                worker.mChainIndex = mPending.takeFirst();
+                worker.mIterations = 0;
+                worker.mLastMessage.start();
+                try{
+                    ChainProtocol::writeMessage(worker.mSocket, ChainProtocol::request(worker.mChainIndex, state));
+                    worker.mSocket->waitForBytesWritten(0);
+                }
+                catch(QString error){
+                    // The worker died since it was read : its chain goes back to the queue
+                    dropWorker(w--, error);
+                }
+            }
+            
+            // ----- Progress : of each chain, polled by the user interface (see MCMCLoop::progress) -----
+            quint64 doneIter = 0;
+            QVector<int> chainsValue(numChains, 0);
+            for(int i=0; i<numChains; ++i)
+            {
+                if(results.at(i).mChainIndex >= 0)
+                {
+                    doneIter += results.at(i).mChain.mTotalIter;
+                    chainsValue[i] = loop->mChainsMax.at(i);
+                }
+            }
+            for(int w=0; w<mWorkers.size(); ++w)
+            {
+                const Worker& worker = mWorkers.at(w);
+                doneIter += worker.mIterations;
+                if(worker.mChainIndex >= 0)
+                    chainsValue[worker.mChainIndex] = (int)qMin(worker.mIterations, (quint64)INT_MAX);
+            }
+            for(int i=0; i<numChains; ++i)
+                loop->setChainValue(i, chainsValue.at(i));
+            loop->mDoneIterations.store((int)qMin(doneIter, (quint64)INT_MAX));
+            loop->setStepValue((int)qMin(doneIter, (quint64)INT_MAX));
+            
+            if(mWorkers.isEmpty())
+            {
+                if(noWorkerTime.elapsed() > mWaitTimeout)
+                    throw tr("No worker available on %1 after %2 s").arg(mListenAddress).arg(mWaitTimeout / 1000);
+            }
+            else
+                noWorkerTime.start();
+        }
+    }
+    catch(QString error){
+        close();
+        throw error;
+    }
+    close();
+    
+    // The reassignments are written in the log of the chains
+    for(int i=0; i<mEvents.size(); ++i)
+        results[mEvents.at(i).first].mLog += line(mEvents.at(i).second);
+}
+
+/**
+ * @brief Reads the available messages of a worker. Throws if the worker sends an invalid message.
+ * The error of a chain is kept in mChainError : it aborts the run.
+ * @return false if the worker is gone
+ */
+bool ChainDispatcher::readWorker(Worker& worker, QList<ChainResult>& results, int timeout)
+{
+    ChainMessage message;
+    qint64 bytesRead = 0;
+    bool received = ChainProtocol::readMessage(worker.mSocket, worker.mBuffer, message, timeout, &bytesRead);
+    // A large result may take longer than CHAIN_WORKER_TIMEOUT to arrive : the worker is alive as long as data comes
+    if(bytesRead > 0)
+        worker.mLastMessage.start();
+    while(received)
+    {
+        worker.mLastMessage.start();
+        switch(message.mType)
+        {
+            case ChainMessage::eHello:
+            {
+                worker.mName = ChainProtocol::readHello(message);
+                worker.mReady = true;
+                break;
+            }
+            case ChainMessage::eProgress:
+            {
+                int chainIndex = -1;
+                quint64 iterations = 0;
+                ChainProtocol::readProgress(message, chainIndex, iterations);
+                if(chainIndex == worker.mChainIndex)
+                    worker.mIterations = iterations;
+                break;
+            }
+            case ChainMessage::eResult:
+            {
+                ChainResult result = ChainProtocol::readResult(message);
+                if(result.mChainIndex != worker.mChainIndex)
+                    throw tr("Unexpected chain result from the worker ") + worker.mName;
+                
+                result.mLog += line("Worker : " + worker.mName);
+                results[result.mChainIndex] = result;
+                ++mNumDone;
+                worker.mChainIndex = -1;
+                worker.mIterations = 0;
+                break;
+            }
+            case ChainMessage::eError:
+            {
+                // The same model and seed would fail on any worker : the run is aborted
+                int chainIndex = -1;
+                ChainProtocol::readError(message, chainIndex, mChainError);
+                if(mChainError.isEmpty())
+                    mChainError = tr("Chain %1 failed on the worker %2").arg(chainIndex + 1).arg(worker.mName);
+                return true;
+            }
+            default:
+                break;
+        }
+        received = ChainProtocol::takeMessage(worker.mBuffer, message);
+    }
+    return ChainProtocol::isConnected(worker.mSocket);
+}
+
+/**
+ * @brief The chain of the worker goes back to the front of the queue : it is the next one to be sent.
+ */
+void ChainDispatcher::dropWorker(int index, const QString& reason)
+{
+    Worker worker = mWorkers.takeAt(index);
+    if(worker.mChainIndex >= 0)
+    {
+        mPending.prepend(worker.mChainIndex);
+        const QString event = tr("Chain %1 reassigned : worker %2 lost (%3)").arg(worker.mChainIndex + 1).arg(worker.mName).arg(reason);
+        mEvents.append(qMakePair(worker.mChainIndex, event));
+        qDebug() << "ChainDispatcher :" << event;
+    }
+    delete worker.mSocket;
+}
+
+#pragma mark Connections
+void ChainDispatcher::listen()
+{
+    close();
+    if(ChainProtocol::isLocalAddress(mListenAddress))
+    {
+        const QString name = ChainProtocol::localName(mListenAddress);
+        QLocalServer::removeServer(name);
+        mLocalServer = new QLocalServer();
+        if(!mLocalServer->listen(name))
+            throw tr("Cannot listen on %1 : %2").arg(mListenAddress, mLocalServer->errorString());
+        return;
+    }
+    
+    QString host;
+    quint16 port = 0;
+    if(!ChainProtocol::parseTcpAddress(mListenAddress, host, port))
+        throw tr("Invalid address : ") + mListenAddress;
+    
+    mTcpServer = new QTcpServer();
+    if(!mTcpServer->listen(QHostAddress(host), port))
+        throw tr("Cannot listen on %1 : %2").arg(mListenAddress, mTcpServer->errorString());
+}
+
+void ChainDispatcher::acceptWorkers()
+{
+    QList<QIODevice*> sockets;
+    if(mTcpServer)
+    {
+        mTcpServer->waitForNewConnection(0);
+        while(mTcpServer->hasPendingConnections())
+        {
+            QTcpSocket* socket = mTcpServer->nextPendingConnection();
+            socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+            sockets.append(socket);
+        }
+    }
+    if(mLocalServer)
+    {
+        mLocalServer->waitForNewConnection(0);
+        while(mLocalServer->hasPendingConnections())
+            sockets.append(mLocalServer->nextPendingConnection());
+    }
+    
+    for(int i=0; i<sockets.size(); ++i)
+    {
+        // Not owned by the server : the sockets are deleted with their worker
+        sockets[i]->setParent(0);
+        Worker worker;
+        worker.mSocket = sockets[i];
+        worker.mLastMessage.start();
+        mWorkers.append(worker);
+    }
+}
+
+void ChainDispatcher::spawnWorker()
+{
+    QProcess* process = new QProcess();
+    process->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    process->setStandardOutputFile(QProcess::nullDevice());
+    process->start(mWorkerProgram, QStringList() << "--worker" << mListenAddress << "--worker-once");
+    if(!process->waitForStarted())
+    {
+        const QString error = process->errorString();
+        delete process;
+        throw tr("Cannot start the worker %1 : %2").arg(mWorkerProgram, error);
+    }
+    mProcesses.append(process);
+    ++mNumSpawns;
+}
+
+/**
+ * @brief The spawned workers that died are replaced, up to twice their number in total
+ * (a worker that always dies is not restarted forever).
+ */
+void ChainDispatcher::respawnWorkers()
+{
+    for(int i=mProcesses.size()-1; i>=0; --i)
+    {
+        QProcess* process = mProcesses[i];
+        process->waitForFinished(0);
+        if(process->state() == QProcess::NotRunning)
+        {
+            mProcesses.removeAt(i);
+            delete process;
+        }
+    }
+    while(mProcesses.size() < mNumLocalWorkers && !mPending.isEmpty() && mNumSpawns < 2 * mNumLocalWorkers)
+        spawnWorker();
+}
+
+void ChainDispatcher::close()
+{
+    for(int w=0; w<mWorkers.size(); ++w)
+    {
+        if(ChainProtocol::isConnected(mWorkers[w].mSocket))
+        {
+            try{
+                ChainProtocol::writeMessage(mWorkers[w].mSocket, ChainMessage(ChainMessage::eQuit));
+                mWorkers[w].mSocket->waitForBytesWritten(1000);
+            }
+            catch(QString error){
+                // The worker is gone anyway
+            }
+        }
+        delete mWorkers[w].mSocket;
+    }
+    mWorkers.clear();
+    
+    // The spawned workers stop when their master is gone
+    for(int i=0; i<mProcesses.size(); ++i)
+    {
+        if(!mProcesses[i]->waitForFinished(2000))
+            mProcesses[i]->kill();
+        mProcesses[i]->waitForFinished(1000);
+    }
+    qDeleteAll(mProcesses);
+    mProcesses.clear();
+    mNumSpawns = 0;
+    
+    delete mTcpServer;
+    mTcpServer = 0;
+    delete mLocalServer;
+    mLocalServer = 0;
+}
@@ -0,0 +1,88 @@
+#ifndef CHAINDISPATCHER_H
+#define CHAINDISPATCHER_H
+
+#include "ChainProtocol.h"
+#include <QObject>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QPair>
+#include <QTime>
+
+class MCMCLoop;
+class QIODevice;
+class QTcpServer;
+class QLocalServer;
+class QProcess;
+
+
+/**
+ * @brief Runs the chains of an MCMCLoop on worker processes (see ChainWorker), one chain per worker at a time.
+ * The workers connect to the listen address : remote nodes started with "ChronomodelCmd --worker <address>",
+ * and/or local processes spawned by the dispatcher (localhost mode, on a local socket by default).
+ * A worker that disconnects, sends an invalid message or nothing for CHAIN_WORKER_TIMEOUT is dropped and its chain is given to another one ;
+ * the spawned workers that die are replaced.
+ * Everything runs on the calling thread (the MCMC thread), with blocking sockets.
+ */
+class ChainDispatcher: public QObject
+{
+    Q_OBJECT
+public:
+    ChainDispatcher();
+    virtual ~ChainDispatcher();
+    
+    // "local:<name>" or "[tcp:]<host>:<port>" (e.g. tcp:0.0.0.0:4567 for remote workers)
+    void setListenAddress(const QString& address);
+    // Number of worker processes to spawn on this machine, running program (ChronomodelCmd)
+    void setLocalWorkers(int count, const QString& program);
+    // Maximum delay without any worker (ms)
+    void setWaitTimeout(int timeout);
+    
+    const QString& listenAddress() const;
+    
+    // Throws the error of a chain, or if no worker is available
+    void run(MCMCLoop* loop, QList<ChainResult>& results);
+    
+private:
+    struct Worker
+    {
+        Worker(): mSocket(0), mReady(false), mChainIndex(-1), mIterations(0) {}
+        
+        QIODevice* mSocket;
+        QByteArray mBuffer;
+        QString mName;
+        bool mReady;
+        int mChainIndex;
+        quint64 mIterations;
+        QTime mLastMessage;
+    };
+    
+    void listen();
+    void close();
+    void acceptWorkers();
+    void spawnWorker();
+    void respawnWorkers();
+    bool readWorker(Worker& worker, QList<ChainResult>& results, int timeout);
+    void dropWorker(int index, const QString& reason);
+    
+    QString mListenAddress;
+    int mNumLocalWorkers;
+    QString mWorkerProgram;
+    int mWaitTimeout;
+    
+    QTcpServer* mTcpServer;
+    QLocalServer* mLocalServer;
+    QList<Worker> mWorkers;
+    QList<QProcess*> mProcesses;
+    int mNumSpawns;
+    
+    // Chains waiting for a worker, by chain index
+    QList<int> mPending;
+    int mNumDone;
+    // Reassignments, by chain index
+    QList<QPair<int, QString> > mEvents;
+    // Error sent by a worker for its chain
+    QString mChainError;
+};
+
+#endif
@@ -0,0 +1,298 @@
+#include "ChainProtocol.h"
+
+#include <QIODevice>
+#include <QTcpSocket>
+#include <QLocalSocket>
+#include <QJsonDocument>
+#include <QObject>
+
+
+bool ChainProtocol::isLocalAddress(const QString& address)
+{
+    return address.startsWith("local:");
+}
+
+QString ChainProtocol::localName(const QString& address)
+{
+    return address.mid(QString("local:").size());
+}
+
+bool ChainProtocol::parseTcpAddress(const QString& address, QString& host, quint16& port)
+{
+    QString hostPort = address;
+    if(hostPort.startsWith("tcp:"))
+        hostPort = hostPort.mid(4);
+    
+    const int sep = hostPort.lastIndexOf(':');
+    if(sep <= 0)
+        return false;
+    
+    bool ok = false;
+    host = hostPort.left(sep);
+    port = hostPort.mid(sep + 1).toUShort(&ok);
+    return ok;
+}
+
+QIODevice* ChainProtocol::connectTo(const QString& address, int timeout)
+{
+    if(isLocalAddress(address))
+    {
+        QLocalSocket* socket = new QLocalSocket();
+        socket->setObjectName(address);
+        socket->connectToServer(localName(address));
+        if(socket->waitForConnected(timeout))
+            return socket;
+        delete socket;
+        return 0;
+    }
+    
+    QString host;
+    quint16 port = 0;
+    if(!parseTcpAddress(address, host, port))
+        throw QObject::tr("Invalid address : ") + address;
+    
+    QTcpSocket* socket = new QTcpSocket();
+    socket->setObjectName(address);
+    socket->connectToHost(host, port);
+    if(socket->waitForConnected(timeout))
+    {
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        return socket;
+    }
+    delete socket;
+    return 0;
+}
+
+bool ChainProtocol::isConnected(QIODevice* socket)
+{
+    QAbstractSocket* tcpSocket = qobject_cast<QAbstractSocket*>(socket);
+    if(tcpSocket)
+        return tcpSocket->state() == QAbstractSocket::ConnectedState;
+    
+    QLocalSocket* localSocket = qobject_cast<QLocalSocket*>(socket);
+    if(localSocket)
+        return localSocket->state() == QLocalSocket::ConnectedState;
+    return false;
+}
+
+/**
+ * @brief The sockets are used without event loop (the MCMC and worker threads block on them) :
+ * waitForReadyRead is what actually reads from the system.
+ */
+bool ChainProtocol::readMessage(QIODevice* socket, QByteArray& buffer, ChainMessage& message, int timeout, qint64* bytesRead)
+{
+    if(bytesRead)
+        *bytesRead = 0;
+    if(takeMessage(buffer, message))
+        return true;
+    
+    if(socket->bytesAvailable() > 0 || socket->waitForReadyRead(timeout))
+    {
+        const QByteArray data = socket->readAll();
+        if(bytesRead)
+            *bytesRead = data.size();
+        buffer.append(data);
+    }
+    return takeMessage(buffer, message);
+}
+
+#pragma mark Frames
+void ChainProtocol::writeMessage(QIODevice* device, const ChainMessage& message)
+{
+    QByteArray frame;
+    QDataStream out(&frame, QIODevice::WriteOnly);
+    out.setVersion(CHAIN_STREAM_VERSION);
+    out << (quint32)CHAIN_PROTOCOL_MAGIC;
+    out << (quint16)CHAIN_PROTOCOL_VERSION;
+    out << (quint16)message.mType;
+    out << (quint32)message.mPayload.size();
+    frame.append(message.mPayload);
+    
+    if(device->write(frame) != frame.size())
+        throw QObject::tr("Cannot send a message to : ") + device->objectName();
+}
+
+bool ChainProtocol::takeMessage(QByteArray& buffer, ChainMessage& message)
+{
+    if(buffer.size() < CHAIN_HEADER_SIZE)
+        return false;
+    
+    QDataStream in(buffer);
+    in.setVersion(CHAIN_STREAM_VERSION);
+    quint32 magic = 0;
+    quint16 version = 0;
+    quint16 type = 0;
+    quint32 size = 0;
+    in >> magic >> version >> type >> size;
+    
+    if(magic != CHAIN_PROTOCOL_MAGIC)
+        throw QObject::tr("Invalid message : this is not a ChronoModel worker");
+    if(version != CHAIN_PROTOCOL_VERSION)
+        throw QObject::tr("The worker does not use the same protocol version (%1 instead of %2)").arg(version).arg(CHAIN_PROTOCOL_VERSION);
+    if(size > CHAIN_MAX_PAYLOAD_SIZE)
+        throw QObject::tr("Invalid message : its size (%1 bytes) is over the limit of %2 bytes").arg(size).arg(CHAIN_MAX_PAYLOAD_SIZE);
+    
+    if((quint32)buffer.size() < CHAIN_HEADER_SIZE + size)
+        return false;
+    
+    message.mType = (ChainMessage::Type)type;
+    message.mPayload = buffer.mid(CHAIN_HEADER_SIZE, size);
+    buffer.remove(0, CHAIN_HEADER_SIZE + size);
+    return true;
+}
+
+#pragma mark Messages
+ChainMessage ChainProtocol::request(int chainIndex, const QJsonObject& state)
+{
+    ChainMessage message(ChainMessage::eRequest);
+    QDataStream out(&message.mPayload, QIODevice::WriteOnly);
+    out.setVersion(CHAIN_STREAM_VERSION);
+    out << (qint32)chainIndex;
+    out << qCompress(QJsonDocument(state).toJson(QJsonDocument::Compact));
+    return message;
+}
+
+void ChainProtocol::readRequest(const ChainMessage& message, int& chainIndex, QJsonObject& state)
+{
+    QDataStream in(message.mPayload);
+    in.setVersion(CHAIN_STREAM_VERSION);
+    qint32 index = -1;
+    QByteArray json;
+    in >> index >> json;
+    
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(qUncompress(json), &error);
+    if(in.status() != QDataStream::Ok || error.error != QJsonParseError::NoError || !doc.isObject())
+        throw QObject::tr("Invalid chain request");
+    
+    chainIndex = index;
+    state = doc.object();
+}
+
+ChainMessage ChainProtocol::progress(int chainIndex, quint64 iterations)
+{
+    ChainMessage message(ChainMessage::eProgress);
+    QDataStream out(&message.mPayload, QIODevice::WriteOnly);
+    out.setVersion(CHAIN_STREAM_VERSION);
+    out << (qint32)chainIndex << iterations;
+    return message;
+}
+
+void ChainProtocol::readProgress(const ChainMessage& message, int& chainIndex, quint64& iterations)
+{
+    QDataStream in(message.mPayload);
+    in.setVersion(CHAIN_STREAM_VERSION);
+    qint32 index = -1;
+    in >> index >> iterations;
+    chainIndex = index;
+}
+
+ChainMessage ChainProtocol::result(const ChainResult& result)
+{
+    ChainMessage message(ChainMessage::eResult);
+    QDataStream out(&message.mPayload, QIODevice::WriteOnly);
+    out.setVersion(CHAIN_STREAM_VERSION);
+    out << (qint32)result.mChainIndex;
+    out << result.mChain;
+    out << result.mLog;
+    out << result.mInitLog;
+    out << qCompress(result.mState);
+    return message;
+}
+
+ChainResult ChainProtocol::readResult(const ChainMessage& message)
+{
+    QDataStream in(message.mPayload);
+    in.setVersion(CHAIN_STREAM_VERSION);
+    
+    ChainResult result;
+    qint32 index = -1;
+    QByteArray state;
+    in >> index;
+    in >> result.mChain;
+    in >> result.mLog;
+    in >> result.mInitLog;
+    in >> state;
+    if(in.status() != QDataStream::Ok)
+        throw QObject::tr("Invalid chain result");
+    
+    result.mChainIndex = index;
+    result.mState = qUncompress(state);
+    return result;
+}
+
+ChainMessage ChainProtocol::error(int chainIndex, const QString& error)
+{
+    ChainMessage message(ChainMessage::eError);
+    QDataStream out(&message.mPayload, QIODevice::WriteOnly);
+    out.setVersion(CHAIN_STREAM_VERSION);
+    out << (qint32)chainIndex << error;
+    return message;
+}
+
+void ChainProtocol::readError(const ChainMessage& message, int& chainIndex, QString& error)
+{
+    QDataStream in(message.mPayload);
+    in.setVersion(CHAIN_STREAM_VERSION);
+    qint32 index = -1;
+    in >> index >> error;
+    chainIndex = index;
+}
+
+ChainMessage ChainProtocol::hello(const QString& name)
+{
+    ChainMessage message(ChainMessage::eHello);
+    QDataStream out(&message.mPayload, QIODevice::WriteOnly);
+    out.setVersion(CHAIN_STREAM_VERSION);
+    out << name;
+    return message;
+}
+
+QString ChainProtocol::readHello(const ChainMessage& message)
+{
+    QDataStream in(message.mPayload);
+    in.setVersion(CHAIN_STREAM_VERSION);
+    QString name;
+    in >> name;
+    return name;
+}
+
+#pragma mark Chain
+QDataStream& operator<<(QDataStream& stream, const Chain& chain)
+{
+    stream << (qint32)chain.mSeed;
+    stream << (quint64)chain.mNumBurnIter;
+    stream << (quint64)chain.mBurnIterIndex;
+    stream << (quint32)chain.mMaxBatchs;
+    stream << (quint32)chain.mNumBatchIter;
+    stream << (quint64)chain.mBatchIterIndex;
+    stream << (quint32)chain.mBatchIndex;
+    stream << (quint64)chain.mNumRunIter;
+    stream << (quint64)chain.mRunIterIndex;
+    stream << (quint64)chain.mTotalIter;
+    stream << (quint64)chain.mThinningInterval;
+    return stream;
+}
+
+QDataStream& operator>>(QDataStream& stream, Chain& chain)
+{
+    qint32 seed;
+    quint32 maxBatchs, numBatchIter, batchIndex;
+    quint64 numBurnIter, burnIterIndex, batchIterIndex, numRunIter, runIterIndex, totalIter, thinningInterval;
+    
+    stream >> seed >> numBurnIter >> burnIterIndex >> maxBatchs >> numBatchIter >> batchIterIndex;
+    stream >> batchIndex >> numRunIter >> runIterIndex >> totalIter >> thinningInterval;
+    
+    chain.mSeed = seed;
+    chain.mNumBurnIter = numBurnIter;
+    chain.mBurnIterIndex = burnIterIndex;
+    chain.mMaxBatchs = maxBatchs;
+    chain.mNumBatchIter = numBatchIter;
+    chain.mBatchIterIndex = batchIterIndex;
+    chain.mBatchIndex = batchIndex;
+    chain.mNumRunIter = numRunIter;
+    chain.mRunIterIndex = runIterIndex;
+    chain.mTotalIter = totalIter;
+    chain.mThinningInterval = thinningInterval;
+    return stream;
+}
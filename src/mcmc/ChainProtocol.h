@@ -0,0 +1,104 @@
+#ifndef CHAINPROTOCOL_H
+#define CHAINPROTOCOL_H
+
+#include <QByteArray>
+#include <QString>
+#include <QDataStream>
+#include <QJsonObject>
+#include "MCMCSettings.h"
+
+class QIODevice;
+
+#define CHAIN_PROTOCOL_MAGIC 0x43484d43 // "CHMC"
+#define CHAIN_PROTOCOL_VERSION 1
+#define CHAIN_STREAM_VERSION QDataStream::Qt_5_0
+#define CHAIN_HEADER_SIZE 12
+// Larger payloads are refused : a corrupted size would make the buffer grow without limit
+#define CHAIN_MAX_PAYLOAD_SIZE (1 << 30)
+
+// A worker sends its progress at least this often (ms) : it is considered dead after CHAIN_WORKER_TIMEOUT without receiving anything from it
+#define CHAIN_PROGRESS_INTERVAL 1000
+#define CHAIN_WORKER_TIMEOUT 60000
+
+
+/**
+ * @brief Messages exchanged by the master (MCMCLoop + ChainDispatcher) and its workers (ChainWorker),
+ * over TCP or local (Unix) sockets. Each message is a frame :
+ * magic (quint32), protocol version (quint16), type (quint16), payload size (quint32), payload (QDataStream, big endian).
+ *
+ * worker -> master : eHello(name), then for each chain eProgress(chain, iterations)... and eResult or eError
+ * master -> worker : eRequest(chain, compressed project JSON with the seeds of all the chains), eQuit at the end of the run
+ */
+struct ChainMessage
+{
+    enum Type
+    {
+        eHello = 1,
+        eRequest = 2,
+        eProgress = 3,
+        eResult = 4,
+        eError = 5,
+        eQuit = 6
+    };
+    
+    ChainMessage(): mType(eHello) {}
+    ChainMessage(Type type): mType(type) {}
+    
+    Type mType;
+    QByteArray mPayload;
+};
+
+/**
+ * @brief Result of a chain run by a worker : the chain counters, its logs and the traces and adaptation state
+ * of all the variables for this chain (see MCMCLoopMain::saveChainState).
+ */
+struct ChainResult
+{
+    ChainResult(): mChainIndex(-1) {}
+    
+    int mChainIndex;
+    Chain mChain;
+    QString mLog;
+    QString mInitLog;
+    QByteArray mState;
+};
+
+class ChainProtocol
+{
+public:
+    // Addresses : "local:<name>" for a local socket, "[tcp:]<host>:<port>" for TCP
+    static bool isLocalAddress(const QString& address);
+    static QString localName(const QString& address);
+    static bool parseTcpAddress(const QString& address, QString& host, quint16& port);
+    
+    // Blocking connection (QTcpSocket or QLocalSocket), or 0 if it fails within the timeout
+    static QIODevice* connectTo(const QString& address, int timeout);
+    static bool isConnected(QIODevice* socket);
+    // Reads what is available (waiting at most timeout ms) and extracts a message into the buffer.
+    // bytesRead, if given, receives the number of bytes read from the socket, even if no message is complete yet.
+    static bool readMessage(QIODevice* socket, QByteArray& buffer, ChainMessage& message, int timeout, qint64* bytesRead = 0);
+    
+    static void writeMessage(QIODevice* device, const ChainMessage& message);
+    // Extracts the first complete message of the buffer. Throws if the data is not a frame of the protocol.
+    static bool takeMessage(QByteArray& buffer, ChainMessage& message);
+    
+    static ChainMessage request(int chainIndex, const QJsonObject& state);
+    static void readRequest(const ChainMessage& message, int& chainIndex, QJsonObject& state);
+    
+    static ChainMessage progress(int chainIndex, quint64 iterations);
+    static void readProgress(const ChainMessage& message, int& chainIndex, quint64& iterations);
+    
+    static ChainMessage result(const ChainResult& result);
+    static ChainResult readResult(const ChainMessage& message);
+    
+    static ChainMessage error(int chainIndex, const QString& error);
+    static void readError(const ChainMessage& message, int& chainIndex, QString& error);
+    
+    static ChainMessage hello(const QString& name);
+    static QString readHello(const ChainMessage& message);
+};
+
+QDataStream& operator<<(QDataStream& stream, const Chain& chain);
+QDataStream& operator>>(QDataStream& stream, Chain& chain);
+
+#endif
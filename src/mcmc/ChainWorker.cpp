@@ -0,0 +1,148 @@
+#include "ChainWorker.h"
+#include "MCMCLoopMain.h"
+#include "Model.h"
+
+#include <QCoreApplication>
+#include <QHostInfo>
+#include <QIODevice>
+#include <QThread>
+#include <QDebug>
+
+
+ChainWorker::ChainWorker()
+{
+    
+}
+
+ChainWorker::~ChainWorker()
+{
+    
+}
+
+QString ChainWorker::workerName()
+{
+    return QHostInfo::localHostName() + ":" + QString::number(QCoreApplication::applicationPid());
+}
+
+void ChainWorker::serve(const QString& masterAddress, bool once)
+{
+    bool connectedOnce = false;
+    while(true)
+    {
+        QIODevice* socket = ChainProtocol::connectTo(masterAddress, CHAIN_WORKER_RETRY_DELAY);
+        if(!socket)
+        {
+            // A spawned worker whose master is not there has nothing to wait for
+            if(once)
+                throw tr("Cannot connect to the master : ") + masterAddress;
+            QThread::msleep(CHAIN_WORKER_RETRY_DELAY);
+            continue;
+        }
+        
+        qDebug() << "ChainWorker connected to" << masterAddress;
+        connectedOnce = true;
+        try{
+            serveConnection(socket);
+        }
+        catch(QString error){
+            qDebug() << "ChainWorker :" << error;
+        }
+        delete socket;
+        
+        if(once && connectedOnce)
+            return;
+    }
+}
+
+void ChainWorker::serveConnection(QIODevice* socket)
+{
+    ChainProtocol::writeMessage(socket, ChainProtocol::hello(workerName()));
+    socket->waitForBytesWritten(CHAIN_WORKER_TIMEOUT);
+    
+    QByteArray buffer;
+    while(ChainProtocol::isConnected(socket))
+    {
+        ChainMessage message;
+        if(!ChainProtocol::readMessage(socket, buffer, message, CHAIN_PROGRESS_INTERVAL))
+            continue;
+        
+        if(message.mType == ChainMessage::eQuit)
+            return;
+        
+        if(message.mType == ChainMessage::eRequest)
+        {
+            int chainIndex = -1;
+            QJsonObject state;
+            ChainProtocol::readRequest(message, chainIndex, state);
+            runChain(socket, chainIndex, state);
+        }
+    }
+}
+
+/**
+ * @brief Runs one chain of the project, with the seeds of the master, and sends its result.
+ * The MCMC runs on its own thread : this one sends the progress, which is also the proof that the worker is alive.
+ */
+void ChainWorker::runChain(QIODevice* socket, int chainIndex, const QJsonObject& state)
+{
+    Model* model = new Model();
+    model->setJson(state);
+    
+    QString error;
+    try{
+        model->fromJson(state);
+        if(chainIndex < 0 || chainIndex >= (int)model->mMCMCSettings.mNumChains)
+            throw tr("Invalid chain index : ") + QString::number(chainIndex);
+    }
+    catch(QString e){
+        error = e;
+    }
+    if(!error.isEmpty())
+    {
+        delete model;
+        ChainProtocol::writeMessage(socket, ChainProtocol::error(chainIndex, error));
+        socket->waitForBytesWritten(CHAIN_WORKER_TIMEOUT);
+        return;
+    }
+    
+    // Through the base class : the chain state is only exposed to the workers and the dispatcher
+    MCMCLoop* loop = new MCMCLoopMain(model);
+    loop->setSingleChain(chainIndex);
+    loop->start();
+    
+    while(!loop->wait(CHAIN_PROGRESS_INTERVAL))
+    {
+        if(!ChainProtocol::isConnected(socket))
+        {
+            // The master is gone : its chains are reassigned, this one is useless
+            loop->requestInterruption();
+            loop->wait();
+            delete loop;
+            delete model;
+            throw tr("The master closed the connection");
+        }
+        ChainProtocol::writeMessage(socket, ChainProtocol::progress(chainIndex, loop->doneIterations()));
+        socket->waitForBytesWritten(CHAIN_PROGRESS_INTERVAL);
+    }
+    
+    if(!loop->mAbortedReason.isEmpty())
+    {
+        ChainProtocol::writeMessage(socket, ChainProtocol::error(chainIndex, loop->mAbortedReason));
+    }
+    else
+    {
+        ChainResult result;
+        result.mChainIndex = chainIndex;
+        result.mChain = loop->mChains.at(chainIndex);
+        result.mLog = loop->getChainsLog();
+        result.mInitLog = loop->getInitLog();
+        result.mState = loop->saveChainState();
+        ChainProtocol::writeMessage(socket, ChainProtocol::result(result));
+    }
+    delete loop;
+    delete model;
+    
+    // The result may be large : it must be sent before the next request is read
+    while(socket->bytesToWrite() > 0 && ChainProtocol::isConnected(socket))
+        socket->waitForBytesWritten(CHAIN_WORKER_TIMEOUT);
+}
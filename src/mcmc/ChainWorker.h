@@ -0,0 +1,38 @@
+#ifndef CHAINWORKER_H
+#define CHAINWORKER_H
+
+#include "ChainProtocol.h"
+#include <QObject>
+#include <QString>
+
+class QIODevice;
+
+// Delay between two connection attempts of a worker waiting for its master (ms)
+#define CHAIN_WORKER_RETRY_DELAY 2000
+
+
+/**
+ * @brief Worker process of distributed chains (see ChainDispatcher) : it connects to the master,
+ * then runs the chains it receives one after the other, sending its progress and the traces of each chain.
+ * The project and the seeds come with each request : the worker keeps nothing between two chains
+ * but the calibrations (see CalibrationStore).
+ */
+class ChainWorker: public QObject
+{
+    Q_OBJECT
+public:
+    ChainWorker();
+    virtual ~ChainWorker();
+    
+    // Blocks. If once is false, the worker waits for the next master after each run (pool of worker nodes),
+    // else it stops when its master is gone (workers spawned by the master).
+    void serve(const QString& masterAddress, bool once);
+    
+    static QString workerName();
+    
+private:
+    void serveConnection(QIODevice* socket);
+    void runChain(QIODevice* socket, int chainIndex, const QJsonObject& state);
+};
+
+#endif
@@ -164,6 +164,20 @@ QString densityAnalysisToString(const DensityAnalysis& analysis, const QString&
     return result;
 }
 
+QDataStream& operator<<(QDataStream& stream, const DensityAnalysis& analysis)
+{
+    stream << analysis.quartiles.Q1 << analysis.quartiles.Q2 << analysis.quartiles.Q3;
+    stream << analysis.analysis.max << analysis.analysis.mode << analysis.analysis.mean << analysis.analysis.stddev;
+    return stream;
+}
+
+QDataStream& operator>>(QDataStream& stream, DensityAnalysis& analysis)
+{
+    stream >> analysis.quartiles.Q1 >> analysis.quartiles.Q2 >> analysis.quartiles.Q3;
+    stream >> analysis.analysis.max >> analysis.analysis.mode >> analysis.analysis.mean >> analysis.analysis.stddev;
+    return stream;
+}
+
 
 Quartiles quartilesForTrace(const QVector<double>& trace)
 {
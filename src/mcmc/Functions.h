@@ -2,6 +2,7 @@
 #define FUNCTIONS_H
 
 #include <QMap>
+#include <QDataStream>
 #include <QVector>
 #include <cmath>
 #include "StdUtilities.h"
@@ -30,6 +31,10 @@ FunctionAnalysis analyseFunction(const QMap<double, double>& aFunction);
 QString functionAnalysisToString(const FunctionAnalysis& analysis);
 QString densityAnalysisToString(const DensityAnalysis& analysis, const QString& nl = "<br>");
 
+// Used to save the numerical results in the .dat file
+QDataStream& operator<<(QDataStream& stream, const DensityAnalysis& analysis);
+QDataStream& operator>>(QDataStream& stream, DensityAnalysis& analysis);
+
 // Standard Deviation (= écart type) of a vector of data
 double dataStd(QVector<double>& data);
 
@@ -14,13 +14,110 @@
 
 //int matherr(struct exception *e);
 
-std::mt19937 Generator::sGenerator = std::mt19937(0);
-std::uniform_real_distribution<double> Generator::sDistribution = std::uniform_real_distribution<double>(0, 1);
+// Ziggurat of G. Marsaglia and W. W. Tsang (2000) with 128 layers, as improved by J. A. Doornik (2005)
+#define ZIGGURAT_LAYERS 128
+#define ZIGGURAT_R 3.442619855899
+#define ZIGGURAT_V 9.91256303526217e-3
 
-void Generator::initGenerator(const int seed)
+struct ZigguratTables
 {
-    sDistribution = std::uniform_real_distribution<double>(0, 1);
-    sGenerator = std::mt19937(seed);
+    ZigguratTables()
+    {
+        double f = exp(-0.5 * ZIGGURAT_R * ZIGGURAT_R);
+        mX[0] = ZIGGURAT_V / f;
+        mX[1] = ZIGGURAT_R;
+        mX[ZIGGURAT_LAYERS] = 0;
+        for(int i=2; i<ZIGGURAT_LAYERS; ++i)
+        {
+            mX[i] = sqrt(-2. * log(ZIGGURAT_V / mX[i-1] + f));
+            f = exp(-0.5 * mX[i] * mX[i]);
+        }
+        for(int i=0; i<ZIGGURAT_LAYERS; ++i)
+            mRatio[i] = mX[i+1] / mX[i];
+    }
+    double mX[ZIGGURAT_LAYERS + 1];
+    double mRatio[ZIGGURAT_LAYERS];
+};
+
+static const ZigguratTables sZiggurat;
+
+// 53 random bits in ]0, 1[
+static inline double uniformOpen(const uint64_t bits)
+{
+    return ((bits >> 11) + 0.5) * (1. / 9007199254740992.);
+}
+
+
+#pragma mark Xoshiro256
+Xoshiro256::Xoshiro256()
+{
+    seed(0);
+}
+
+void Xoshiro256::seed(const uint64_t seed)
+{
+    // splitmix64, as recommended by the authors
+    uint64_t x = seed;
+    for(int i=0; i<4; ++i)
+    {
+        uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        mState[i] = z ^ (z >> 31);
+    }
+}
+
+void Xoshiro256::seed(std::seed_seq& seq)
+{
+    uint32_t words[8];
+    seq.generate(words, words + 8);
+    for(int i=0; i<4; ++i)
+        mState[i] = ((uint64_t)words[2*i] << 32) | words[2*i + 1];
+    
+    // The state must not be all zero
+    if(mState[0] == 0 && mState[1] == 0 && mState[2] == 0 && mState[3] == 0)
+        seed(0);
+}
+
+void RandomStream::seed(std::seed_seq& seq)
+{
+    mEngine = Generator::engine();
+    mMersenne.seed(seq);
+    mXoshiro.seed(seq);
+}
+
+
+#pragma mark Generator
+thread_local RandomStream Generator::sStream = RandomStream();
+thread_local std::uniform_real_distribution<double> Generator::sDistribution = std::uniform_real_distribution<double>(0, 1);
+thread_local RandomStream* Generator::sThreadStream = 0;
+
+void Generator::initGenerator(const int seed, const Engine engine)
+{
+    // The engine is held by the stream of the thread : the loops running at the same time do not share it
+    sStream.mEngine = engine;
+    sStream.mMersenne = std::mt19937(seed);
+    sStream.mXoshiro.seed((uint64_t)seed);
+}
+
+Generator::Engine Generator::engine()
+{
+    return stream().mEngine;
+}
+
+void Generator::setThreadStream(RandomStream* stream)
+{
+    sThreadStream = stream;
+}
+
+RandomStream* Generator::threadStream()
+{
+    return sThreadStream;
+}
+
+RandomStream& Generator::stream()
+{
+    return sThreadStream ? *sThreadStream : sStream;
 }
 
 int Generator::createSeed()
@@ -39,146 +136,94 @@ int Generator::createSeed()
 
 double Generator::randomUniform(double min, double max)
 {
-    return min + sDistribution(sGenerator) * (max - min);
+    RandomStream& current = stream();
+    if(current.mEngine == eXoshiroZiggurat)
+        return min + ((current.mXoshiro()) >> 11) * (1. / 9007199254740992.) * (max - min);
+    else
+        return min + sDistribution(current.mMersenne) * (max - min);
 }
 
-double Generator::gaussByDoubleExp(const double mean, const double sigma, const double min, const double max)
+double Generator::gauss(const double mean, const double sigma)
 {
-    errno=0;
-    if(min >= max)
+    RandomStream& current = stream();
+    if(current.mEngine == eXoshiroZiggurat)
+        return mean + ziggurat(current.mXoshiro) * sigma;
+    else
+        return mean + boxMuller() * sigma;
+}
+
+void Generator::randomUniforms(double* buffer, const int n, const double min, const double max)
+{
+    RandomStream& current = stream();
+    if(current.mEngine == eXoshiroZiggurat)
     {
-        if(min == max)
-            qDebug() << "DOUBLE EXP WARNING : min == max";
-        else
-            throw QObject::tr("DOUBLE EXP ERROR : min = ") + QString::number(min) + ", max = " + QString::number(max);
-        return min;
+        Xoshiro256& engine = current.mXoshiro;
+        const double scale = (max - min) / 9007199254740992.;
+        for(int i=0; i<n; ++i)
+            buffer[i] = min + (engine() >> 11) * scale;
     }
-    
-    const long double x_min = (min - mean) / sigma;
-    const long double x_max = (max - mean) / sigma;
-    
-  //  QString info = "DoubleExp : x_min = " + QString::number(x_min) + ", x_max = " + QString::number(x_max);
-
-    /*if(abs(x_max - x_min) < 1E-20)
+    else
     {
-        return randomUniform(min, max);
-    }*/
-    
-    long double x = (x_max + x_min) / 2.0;// initialisation arbitraire, valeur ecrasée ensuite
-    const long double sqrt_e = sqrtl(expl(1.0));
-    
-    feclearexcept(FE_ALL_EXCEPT);
-    
-
-    //qDebug() << "DOUBLE EXP DoubleExp : errno avant = "<<strerror(errno);
-    long double exp_x_min = 0.0;
-    long double exp_x_max = 0.0;
-    long double exp_minus_x_min = 0.0;
-    long double exp_minus_x_max = 0.0;
-    long double c = 0.0;
-    long double f0 = 0.0;
+        std::mt19937& engine = current.mMersenne;
+        for(int i=0; i<n; ++i)
+            buffer[i] = min + sDistribution(engine) * (max - min);
+    }
+}
 
-    if(x_min < 0. && x_max > 0.)
+void Generator::gausses(double* buffer, const int n, const double mean, const double sigma)
+{
+    RandomStream& current = stream();
+    if(current.mEngine == eXoshiroZiggurat)
     {
-        exp_x_min = expl(x_min);
-        exp_minus_x_max = expl(-x_max);
-        c = 1. - 0.5 * (exp_x_min + exp_minus_x_max);
-        f0 = 0.5 * (1. - exp_x_min) / c;
+        Xoshiro256& engine = current.mXoshiro;
+        for(int i=0; i<n; ++i)
+            buffer[i] = mean + ziggurat(engine) * sigma;
     }
     else
     {
-        if(x_min >= 0.)
-        {
-            exp_minus_x_min = expl(-x_min);
-            exp_minus_x_max = expl(-x_max);
-        }
-        else
-        {
-            exp_x_min = expl(x_min);
-            exp_x_max = expl(x_max);
-        }
+        for(int i=0; i<n; ++i)
+            buffer[i] = mean + boxMuller() * sigma;
     }
-    //info = "DoubleExp : exp_x_min = " + QString::number(exp_x_min) + ", exp_x_max = " + QString::number(exp_x_max);
-    //qDebug() <<"DoubleExp : exp_x_min = "<<exp_x_min;
-    //qDebug() << "exp(10 000=="<<exp((long double)(1000));
-    //qDebug() << "DOUBLE EXP DoubleExp : errno apres = "<<strerror(errno);
-    if(errno != 0)
-    {
-        qDebug() << "DOUBLE EXP : errno apres exp_minus_x_max = "<<strerror(errno);
-        qDebug() <<"DoubleExp : mean = "<< mean<<" min="<<min<<" max="<<max<<" sigma"<<sigma;
-        qDebug() <<" x_min="<< (double)(x_min)<<" x_max="<<(double)(x_max);
+}
 
-        errno=0;
-    }
-    double ur = 1.0;
-    long double rap = 0.0;
-    
-    int trials = 0;
-    int limit = 100000;
-    
-    while(rap < ur && trials < limit)
+/**
+ *  @brief One 64 bits draw gives the layer (7 bits) and the abscissa (53 bits) :
+ *  about 98.8% of the variates need no other computation.
+ */
+double Generator::ziggurat(Xoshiro256& engine)
+{
+    for(;;)
     {
-        long double u = (long double)randomUniform();
+        const uint64_t bits = engine();
+        const double u = 2. * uniformOpen(bits) - 1.;
+        const int i = (int)(bits & (ZIGGURAT_LAYERS - 1));
         
-        if(x_min < 0. && x_max > 0.)
-        {
-
-            if(u <= f0)
-            {
-                x = logl(exp_x_min + 2.0 * c * u);
-            }
-            else
-            {
-                x = -logl(1. - 2.0*c*(u-f0));
-            }
-        }
-        else
-        {
-            if(x_min >= 0.)
-            {
-                x = -logl(exp_minus_x_min - u * (exp_minus_x_min - exp_minus_x_max));
-            }
-            else
-            {
-                x = logl(exp_x_min - u * (exp_x_min - exp_x_max));
-            }
-        }
-        if(errno != 0)
-        {
-            //qDebug() << "DOUBLE EXP dans boucle = "<<strerror(errno);
-            throw "DoubleExp could not find a solution after " + QString::number(limit) + " trials! This may be ue to Taylor unsufficients developpement orders. Please try to run the calculations again!";
-        }
-        ur = randomUniform();
+        // Inside the rectangle of the layer
+        if(fabs(u) < sZiggurat.mRatio[i])
+            return u * sZiggurat.mX[i];
         
-        if(x_min >= 1.)
-        {
-            rap = expl(0.5 * (x_min * x_min - x * x) + x - x_min);
-        }
-        else if(x_max <= -1.)
-        {
-            rap = expl(0.5 * (x_max * x_max - x * x) + x_max - x);
-        }
-        else
-        {
-            rap = expl(-0.5 * x * x + std::fabs(x)) / sqrt_e;
-        }
+        // Base layer : tail beyond R
+        if(i == 0)
+            return zigguratTail(engine, u < 0);
         
-        ++trials;
+        // Wedge : rejection under the density
+        const double x = u * sZiggurat.mX[i];
+        const double f0 = exp(-0.5 * (sZiggurat.mX[i] * sZiggurat.mX[i] - x * x));
+        const double f1 = exp(-0.5 * (sZiggurat.mX[i+1] * sZiggurat.mX[i+1] - x * x));
+        if(f1 + uniformOpen(engine()) * (f0 - f1) < 1.)
+            return x;
     }
+}
 
-    if(trials == limit)
-    {
-        throw "DoubleExp could not find a solution after " + QString::number(limit) + " trials! This may be ue to Taylor unsufficients developpement orders. Please try to run the calculations again!";
-    }
-    if ((x<x_min) or (x>x_max)) {
-        
+double Generator::zigguratTail(Xoshiro256& engine, const bool negative)
+{
+    double x, y;
+    do{
+        x = log(uniformOpen(engine())) / ZIGGURAT_R;
+        y = log(uniformOpen(engine()));
+    }while(-2. * y < x * x);
     
-    qDebug() << "DOUBLE EXP DoubleExp : x = "<<(double)(x);
-    qDebug() << "DOUBLE EXP DoubleExp : (mean + (x * sigma)) = "<<(double)(mean + (x * sigma));
-    qDebug() <<" min="<< min<<" max=" <<(double)(x_max);
-        
-    }
-    return (double)(mean + (x * sigma));
+    return negative ? x - ZIGGURAT_R : ZIGGURAT_R - x;
 }
 
 // Simulation d'une loi gaussienne centrée réduite
@@ -189,10 +234,3 @@ double Generator::boxMuller()
     return sqrt(-2. * log(rand1)) * cos(2. * M_PI * rand2);
     //checkFloatingPointException("boxMuller");
 }
-
-double Generator::gaussByBoxMuller(const double mean, const double sigma)
-{
-    return mean + boxMuller() * sigma;
-    
-}
-
@@ -2,27 +2,94 @@
 #define GENERATOR_H
 
 #include "random"
+#include <cstdint>
 
 #ifndef M_PI
 #define M_PI 3.1415927
 #endif
 
+
+// xoshiro256** by D. Blackman and S. Vigna : 64 bits per call, 256 bits of state
+class Xoshiro256
+{
+public:
+    typedef uint64_t result_type;
+    
+    Xoshiro256();
+    void seed(std::seed_seq& seq);
+    void seed(const uint64_t seed);
+    
+    static result_type min() {return 0;}
+    static result_type max() {return UINT64_MAX;}
+    
+    inline result_type operator()()
+    {
+        const uint64_t result = rotl(mState[1] * 5, 7) * 9;
+        const uint64_t t = mState[1] << 17;
+        mState[2] ^= mState[0];
+        mState[3] ^= mState[1];
+        mState[1] ^= mState[2];
+        mState[0] ^= mState[3];
+        mState[2] ^= t;
+        mState[3] = rotl(mState[3], 45);
+        return result;
+    }
+    
+private:
+    static inline uint64_t rotl(const uint64_t x, const int k) {return (x << k) | (x >> (64 - k));}
+    uint64_t mState[4];
+};
+
+struct RandomStream;
+
 class Generator
 {
 public:
+    enum Engine
+    {
+        eMersenneBoxMuller = 0, // Used by previous versions (their traces are not reproduced : the updates draw in another order)
+        eXoshiroZiggurat = 1
+    };
+    
     static int createSeed();
-    static void initGenerator(const int seed);
+    static void initGenerator(const int seed, const Engine engine = eMersenneBoxMuller);
+    static Engine engine();
     
     static double randomUniform(double min = 0., double max = 1.);
-    static double gaussByDoubleExp(const double mean, const double sigma, const double min, const double max);
-    static double gaussByBoxMuller(const double mean, const double sigma);
+    static double gauss(const double mean, const double sigma);
+    
+    // Batch generation into buffers
+    static void randomUniforms(double* buffer, const int n, const double min = 0., const double max = 1.);
+    static void gausses(double* buffer, const int n, const double mean = 0., const double sigma = 1.);
+    
+    // Parallel updates : draws made by the calling thread come from "stream"
+    // instead of the chain stream, until it is reset with 0.
+    static void setThreadStream(RandomStream* stream);
+    static RandomStream* threadStream();
     
 private:
     Generator(){}
+    static RandomStream& stream();
     static double boxMuller();
+    static double ziggurat(Xoshiro256& engine);
+    static double zigguratTail(Xoshiro256& engine, const bool negative);
+    
+    // Chain stream of the calling thread : several MCMC loops, with different engines, can run in the same process
+    static thread_local RandomStream sStream;
+    static thread_local RandomStream* sThreadStream;
+    static thread_local std::uniform_real_distribution<double> sDistribution;
+};
+
+// Random stream of a chain, or of a part of a parallel update : it holds the state of both engines, and the engine it draws from
+struct RandomStream
+{
+    RandomStream(): mEngine(Generator::eMersenneBoxMuller) {}
+    // Draws from the engine of the calling thread (set by Generator::initGenerator)
+    void seed(std::seed_seq& seq);
     
-    static std::mt19937 sGenerator;
-    static std::uniform_real_distribution<double> sDistribution;
+    Generator::Engine mEngine;
+    std::mt19937 mMersenne;
+    Xoshiro256 mXoshiro;
 };
 
 #endif
@@ -1,14 +1,22 @@
 #include "MCMCLoop.h"
 #include "Generator.h"
 #include "QtUtilities.h"
+#include "ChainDispatcher.h"
+#include "Trace.h"
 #include <QDebug>
 #include <QTime>
+#include <QElapsedTimer>
 
 
 
 MCMCLoop::MCMCLoop():
+mGeneratorEngine(Generator::eMersenneBoxMuller),
 mChainIndex(0),
-mState(eBurning)
+mState(eBurning),
+mSingleChain(-1),
+mDispatcher(0),
+mDoneIterations(0),
+mInstrumentation(0)
 {
     
 }
@@ -21,6 +29,7 @@ MCMCLoop::~MCMCLoop()
 void MCMCLoop::setMCMCSettings(const MCMCSettings& s)
 {
     mChains.clear();
+    mGeneratorEngine = s.mGeneratorEngine;
     for(int i=0; i<(int)s.mNumChains; ++i)
     {
         Chain chain;
@@ -42,6 +51,80 @@ void MCMCLoop::setMCMCSettings(const MCMCSettings& s)
         chain.mThinningInterval = s.mThinningInterval;
         mChains.append(chain);
     }
+    
+    mChainsMax.clear();
+    for(int i=0; i<mChains.size(); ++i)
+    {
+        const Chain& chain = mChains.at(i);
+        mChainsMax.append((int)(chain.mNumBurnIter + chain.mMaxBatchs * chain.mNumBatchIter + chain.mNumRunIter));
+    }
+    mChainsValue = QVector<QAtomicInt>(mChains.size());
+}
+
+void MCMCLoop::setSingleChain(int index)
+{
+    mSingleChain = index;
+}
+
+void MCMCLoop::setDispatcher(ChainDispatcher* dispatcher)
+{
+    mDispatcher = dispatcher;
+}
+
+/**
+ * @brief Iterations done by all the chains since the start : can be read from any thread.
+ */
+int MCMCLoop::doneIterations() const
+{
+    return mDoneIterations.load();
+}
+
+/**
+ * @brief Progress of the current step and of each chain : can be read from any thread.
+ * The counters are read one after the other, they may belong to two successive iterations.
+ */
+MCMCProgress MCMCLoop::progress() const
+{
+    MCMCProgress progress;
+    {
+        QMutexLocker locker(&mStepMutex);
+        progress.mStepIndex = mStepIndex.load();
+        progress.mStepTitle = mStepTitle;
+        progress.mStepMax = mStepMax.load();
+    }
+    progress.mStepValue = mStepValue.load();
+    
+    // Set before the loop starts
+    progress.mDispatched = (mDispatcher != 0);
+    progress.mChainsMax = mChainsMax;
+    progress.mChainsValue.resize(mChainsValue.size());
+    for(int i=0; i<mChainsValue.size(); ++i)
+        progress.mChainsValue[i] = mChainsValue.at(i).load();
+    return progress;
+}
+
+/**
+ * @brief Starts a new step : the title is the only value protected by a lock, it changes a few times per run.
+ * The listeners see the new step through the mStepIndex of progress().
+ */
+void MCMCLoop::setStep(const QString& title, int max)
+{
+    QMutexLocker locker(&mStepMutex);
+    mStepTitle = title;
+    mStepMax.store(max);
+    mStepValue.store(0);
+    mStepIndex.store(mStepIndex.load() + 1);
+}
+
+/**
+ * @brief Called after each iteration of the chain mChainIndex : only stores the counters,
+ * the readers poll them at their own rate (see MCMC_PROGRESS_INTERVAL).
+ */
+void MCMCLoop::iterationDone(int stepValue)
+{
+    mDoneIterations.store(mDoneIterations.load() + 1);
+    setStepValue(stepValue);
+    setChainValue(mChainIndex, (int)mChains.at(mChainIndex).mTotalIter);
 }
 
 const QList<Chain>& MCMCLoop::chains()
@@ -66,223 +149,292 @@ void MCMCLoop::run()
     QString mTime = startChainTime.toString("hh:mm:ss.zzz");
     QString log= "Start " +mDate+" ->>> " +mTime;
     
-    //int timeDiff = 0;
-    
-    //QTime startTotalTime = QTime::currentTime();
-    
     //----------------------- Calibrating --------------------------------------
     
-    emit stepChanged(tr("Calibrating data..."), 0, 0);
+    setStep(tr("Calibrating data..."), 0);
+    
+    if(mInstrumentation)
+        mInstrumentation->clear();
     
-    //QTime startCalibTime = QTime::currentTime();
-       mAbortedReason = this->calibrate();
+    {
+        ScopedTimer timer(stat("mcmc/calibrate"));
+        TraceScope trace("mcmc", "Calibrate");
+        mAbortedReason = this->calibrate();
+    }
     if(!mAbortedReason.isEmpty())
     {
         return;
     }
     
-    /*QTime endCalibTime = QTime::currentTime();
-    int timeDiff = startCalibTime.msecsTo(endCalibTime);
-    log += line("Calib done in " + QString::number(timeDiff) + " ms");*/
-    
     //----------------------- Chains --------------------------------------
     
     QStringList seeds;
     
     mInitLog = QString();
+    mDoneIterations.store(0);
+    for(int i=0; i<mChainsValue.size(); ++i)
+        setChainValue(i, 0);
     
-    for(mChainIndex = 0; mChainIndex < mChains.size(); ++mChainIndex)
-    {        
-        log += "<hr>";
-        log += line("Chain : " + QString::number(mChainIndex + 1) + "/" + QString::number(mChains.size()));
-        
+    if(mSingleChain >= 0)
+    {
+        // Worker process (see ChainWorker) : only this chain is run, its traces are sent to the master without finalizing
+        QString chainLog;
+        mChainIndex = mSingleChain;
+        if(runChain(chainLog))
+            mChainsLog = chainLog;
+        return;
+    }
+    
+    if(mDispatcher)
+    {
+        // The chains are run by worker processes (see ChainDispatcher)
+        ScopedTimer timer(stat("mcmc/dispatched chains"), mChains.size());
+        TraceScope trace("mcmc", "Dispatched chains");
+        if(!runDispatchedChains(log))
+            return;
+        for(int i=0; i<mChains.size(); ++i)
+            seeds << QString::number(mChains[i].mSeed);
+    }
+    else
+    {
+        for(mChainIndex = 0; mChainIndex < mChains.size(); ++mChainIndex)
+        {
+            seeds << QString::number(mChains[mChainIndex].mSeed);
+            if(!runChain(log))
+                return;
+        }
+    }
+    
+    log += line("List of used chains seeds (to be copied for re-use in MCMC Settings) :<br>" + seeds.join(";"));
+    
+    //-----------------------------------------------------------------------
 
-        
-        Chain& chain = mChains[mChainIndex];
-        Generator::initGenerator(chain.mSeed);
-        
-        log += line("Seed : " + QString::number(chain.mSeed));
-        seeds << QString::number(chain.mSeed);
-        
-        this->initVariablesForChain();
-        
-        //----------------------- Initializing --------------------------------------
-        
-        emit stepChanged("Chain " + QString::number(mChainIndex+1) + "/" + QString::number(mChains.size()) + " : " + tr("Initializing MCMC"), 0, 0);
-        
-        //QTime startInitTime = QTime::currentTime();
+    setStep(tr("Computing posterior distributions and numerical results (HPD, credibility, ...)"), 0);
+    
+    try{
+        ScopedTimer timer(stat("mcmc/finalize"));
+        TraceScope trace("mcmc", "Finalize");
+        this->finalize();
+    }
+    catch(QString error)
+    {
+        mAbortedReason = error;
+        return;
+    }
+
+    //-----------------------------------------------------------------------
+    
+    mChainsLog = log;
+}
+
+/**
+ * @brief Runs the chain mChainIndex : burn, adapt and run.
+ * @return false if it is aborted (see mAbortedReason)
+ */
+bool MCMCLoop::runChain(QString& log)
+{
+    log += "<hr>";
+    log += line("Chain : " + QString::number(mChainIndex + 1) + "/" + QString::number(mChains.size()));
+    
+
+    
+    Chain& chain = mChains[mChainIndex];
+    Generator::initGenerator(chain.mSeed, mGeneratorEngine);
+    
+    log += line("Seed : " + QString::number(chain.mSeed));
+    log += line("Generator : " + QString(mGeneratorEngine == Generator::eXoshiroZiggurat ? "xoshiro256** / Ziggurat" : "mt19937 / Box-Muller"));
+    
+    this->initVariablesForChain();
+    
+    //----------------------- Initializing --------------------------------------
+    
+    setStep("Chain " + QString::number(mChainIndex+1) + "/" + QString::number(mChains.size()) + " : " + tr("Initializing MCMC"), 0);
+    
+    QElapsedTimer chainTimer;
+    chainTimer.start();
+    
+    const QString chainName = "Chain " + QString::number(mChainIndex + 1);
+    TRACE_SCOPE(stageTrace, "mcmc", chainName + " : init");
+    
+    try{
+        ScopedTimer timer(stat("mcmc/init"));
+        this->initMCMC();
+    }
+    catch(QString error)
+    {
+        mAbortedReason = error;
+        return false;
+    }
+    
+    // Updates and adaptations are timed one by one, the stages as a whole (items : iterations)
+    InstrumentStat* updateStat = stat("mcmc/update");
+    QElapsedTimer stageTimer;
+    
+    //----------------------- Burning --------------------------------------
+    
+    setStep("Chain " + QString::number(mChainIndex+1) + "/" + QString::number(mChains.size()) + " : " + tr("Burning"), chain.mNumBurnIter);
+    mState = eBurning;
+    
+    stageTimer.start();
+    TRACE_RESTART(stageTrace, chainName + " : burn");
+    
+    while(chain.mBurnIterIndex < chain.mNumBurnIter)
+    {
+        if(isInterruptionRequested())
+        {
+            mAbortedReason = ABORTED_BY_USER;
+            return false;
+        }
         
         try{
-            this->initMCMC();
+            ScopedTimer timer(updateStat);
+            this->update();
         }
         catch(QString error)
         {
             mAbortedReason = error;
-            return;
+            return false;
         }
         
-        /*QTime endInitTime = QTime::currentTime();
-        timeDiff = startInitTime.msecsTo(endInitTime);
-        
-        log += "=> Init done in " + QString::number(timeDiff) + " ms\n";*/
-        
-        //----------------------- Burning --------------------------------------
-        
-        emit stepChanged("Chain " + QString::number(mChainIndex+1) + "/" + QString::number(mChains.size()) + " : " + tr("Burning"), 0, chain.mNumBurnIter);
-        mState = eBurning;
-        
-        //QTime startBurnTime = QTime::currentTime();
+        ++chain.mBurnIterIndex;
+        ++chain.mTotalIter;
+        iterationDone(chain.mBurnIterIndex);
+    }
+    
+    addTime("chain/burn", stageTimer, chain.mBurnIterIndex);
+    
+    //----------------------- Adapting --------------------------------------
+    
+    setStep("Chain " + QString::number(mChainIndex+1) + "/" + QString::number(mChains.size()) + " : " + tr("Adapting"), chain.mMaxBatchs * chain.mNumBatchIter);
+    mState = eAdapting;
+    
+    stageTimer.start();
+    TRACE_RESTART(stageTrace, chainName + " : adapt");
+    InstrumentStat* adaptStat = stat("mcmc/adapt");
+    
+    while(chain.mBatchIndex * chain.mNumBatchIter < chain.mMaxBatchs * chain.mNumBatchIter)
+    {
+        if(isInterruptionRequested())
+        {
+            mAbortedReason = ABORTED_BY_USER;
+            return false;
+        }
+        TRACE_SCOPE(batchTrace, "mcmc", chainName + " : batch " + QString::number(chain.mBatchIndex + 1));
         
-        while(chain.mBurnIterIndex < chain.mNumBurnIter)
+        chain.mBatchIterIndex = 0;
+        while(chain.mBatchIterIndex < chain.mNumBatchIter)
         {
             if(isInterruptionRequested())
             {
                 mAbortedReason = ABORTED_BY_USER;
-                return;
+                return false;
             }
             
             try{
+                ScopedTimer timer(updateStat);
                 this->update();
             }
             catch(QString error)
             {
                 mAbortedReason = error;
-                return;
+                return false;
             }
             
-            
-            ++chain.mBurnIterIndex;
+            ++chain.mBatchIterIndex;
             ++chain.mTotalIter;
-            
-            emit stepProgressed(chain.mBurnIterIndex);
+            iterationDone(chain.mBatchIndex * chain.mNumBatchIter + chain.mBatchIterIndex);
         }
+        ++chain.mBatchIndex;
         
-        /*QTime endBurnTime = QTime::currentTime();
-        timeDiff = startBurnTime.msecsTo(endBurnTime);
-        log += "=> Burn done in " + QString::number(timeDiff) + " ms\n";*/
-        
-        //----------------------- Adapting --------------------------------------
-        
-        emit stepChanged("Chain " + QString::number(mChainIndex+1) + "/" + QString::number(mChains.size()) + " : " + tr("Adapting"), 0, chain.mMaxBatchs * chain.mNumBatchIter);
-        mState = eAdapting;
-        
-        //QTime startAdaptTime = QTime::currentTime();
-        
-        while(chain.mBatchIndex * chain.mNumBatchIter < chain.mMaxBatchs * chain.mNumBatchIter)
+        ScopedTimer timer(adaptStat);
+        if(adapt())
         {
-            if(isInterruptionRequested())
-            {
-                mAbortedReason = ABORTED_BY_USER;
-                return;
-            }
-            
-            chain.mBatchIterIndex = 0;
-            while(chain.mBatchIterIndex < chain.mNumBatchIter)
-            {
-                if(isInterruptionRequested())
-                {
-                    mAbortedReason = ABORTED_BY_USER;
-                    return;
-                }
-                
-                try{
-                    this->update();
-                }
-                catch(QString error)
-                {
-                    mAbortedReason = error;
-                    return;
-                }
-                
-                ++chain.mBatchIterIndex;
-                ++chain.mTotalIter;
-                
-                emit stepProgressed(chain.mBatchIndex * chain.mNumBatchIter + chain.mBatchIterIndex);
-            }
-            ++chain.mBatchIndex;
-            
-            if(adapt())
-            {
-                break;
-            }
+            break;
         }
-        log += line("Adapt OK at batch : " + QString::number(chain.mBatchIndex) + "/" + QString::number(chain.mMaxBatchs));
-        
-       /* QTime endAdaptTime = QTime::currentTime();
-        timeDiff = startAdaptTime.msecsTo(endAdaptTime);
-        log += "=> Adapt done in " + QString::number(timeDiff) + " ms\n";*/
-        
-        //----------------------- Running --------------------------------------
-        
-        emit stepChanged("Chain " + QString::number(mChainIndex+1) + "/" + QString::number(mChains.size()) + " : " + tr("Running"), 0, chain.mNumRunIter);
-        mState = eRunning;
-        
-        //QTime startRunTime = QTime::currentTime();
-        
-        while(chain.mRunIterIndex < chain.mNumRunIter)
+    }
+    log += line("Adapt OK at batch : " + QString::number(chain.mBatchIndex) + "/" + QString::number(chain.mMaxBatchs));
+    
+    addTime("chain/adapt", stageTimer, chain.mBatchIndex * chain.mNumBatchIter);
+    
+    //----------------------- Running --------------------------------------
+    
+    setStep("Chain " + QString::number(mChainIndex+1) + "/" + QString::number(mChains.size()) + " : " + tr("Running"), chain.mNumRunIter);
+    mState = eRunning;
+    
+    stageTimer.start();
+    TRACE_RESTART(stageTrace, chainName + " : run");
+    
+    while(chain.mRunIterIndex < chain.mNumRunIter)
+    {
+        if(isInterruptionRequested())
         {
-            if(isInterruptionRequested())
-            {
-                mAbortedReason = ABORTED_BY_USER;
-                return;
-            }
-            
-            try{
-                this->update();
-            }
-            catch(QString error)
-            {
-                mAbortedReason = error;
-                return;
-            }
-            
-            ++chain.mRunIterIndex;
-            ++chain.mTotalIter;
-            
-            emit stepProgressed(chain.mRunIterIndex);
+            mAbortedReason = ABORTED_BY_USER;
+            return false;
         }
         
-        /*QTime endRunTime = QTime::currentTime();
-        timeDiff = startRunTime.msecsTo(endRunTime);
-        log += "=> Acquire done in " + QString::number(timeDiff) + " ms\n";*/
-        
-        //-----------------------------------------------------------------------
+        try{
+            ScopedTimer timer(updateStat);
+            this->update();
+        }
+        catch(QString error)
+        {
+            mAbortedReason = error;
+            return false;
+        }
         
-       /* QTime endChainTime = QTime::currentTime();
-        timeDiff = startChainTime.msecsTo(endChainTime);
-        log += "=> Chain done in " + QString::number(timeDiff) + " ms\n";*/
+        ++chain.mRunIterIndex;
+        ++chain.mTotalIter;
+        iterationDone(chain.mRunIterIndex);
     }
+    // The adaptation may have stopped before its last batch
+    setChainValue(mChainIndex, mChainsMax.at(mChainIndex));
+    log += this->chainLog();
+    addTime("chain/run", stageTimer, chain.mRunIterIndex);
     
-    log += line("List of used chains seeds (to be copied for re-use in MCMC Settings) :<br>" + seeds.join(";"));
-    
+    //-----------------------------------------------------------------------
     
-    /*QTime endTotalTime = QTime::currentTime();
-    timeDiff = startTotalTime.msecsTo(endTotalTime);
-    log += "=> MCMC done in " + QString::number(timeDiff) + " ms\n";
+    const double chainSeconds = chainTimer.nsecsElapsed() * 1e-9;
+    if(mInstrumentation && chainSeconds > 0)
+        mInstrumentation->setValue("Chain " + QString::number(mChainIndex + 1) + " : iterations / s", chain.mTotalIter / chainSeconds);
+    return true;
+}
 
+#pragma mark Instrumentation
+InstrumentStat* MCMCLoop::stat(const QString& name)
+{
+    return mInstrumentation ? mInstrumentation->stat(name) : 0;
+}
 
-    QTime startFinalizeTime = QTime::currentTime();*/
-    //-----------------------------------------------------------------------
+void MCMCLoop::addTime(const QString& name, const QElapsedTimer& timer, quint64 items)
+{
+    if(mInstrumentation)
+        mInstrumentation->stat(name)->add(timer.nsecsElapsed(), items);
+}
 
-    emit stepChanged(tr("Computing posterior distributions and numerical results (HPD, credibility, ...)"), 0, 0);
-    
+#pragma mark Distributed chains
+/**
+ * @brief Sends the chains to the workers of the dispatcher and appends their states, in the order of the chains.
+ * The chains of a seed give the same traces on any worker (see MCMCLoopMain::initVariablesForChain).
+ */
+bool MCMCLoop::runDispatchedChains(QString& log)
+{
+    QList<ChainResult> results;
     try{
-        this->finalize();
+        mDispatcher->run(this, results);
+        
+        for(mChainIndex = 0; mChainIndex < mChains.size(); ++mChainIndex)
+        {
+            const ChainResult& result = results.at(mChainIndex);
+            mChains[mChainIndex] = result.mChain;
+            this->appendChainState(result.mState);
+            log += result.mLog;
+            mInitLog += result.mInitLog;
+        }
     }
     catch(QString error)
     {
         mAbortedReason = error;
-        return;
+        return false;
     }
-
-   /* QTime endFinalizeTime = QTime::currentTime();
-    timeDiff = startFinalizeTime.msecsTo(endFinalizeTime);
-    log += "=> Histos and results computed in " + QString::number(timeDiff) + " ms\n";
-    
-    log += "End time : " + endFinalizeTime.toString() + "\n";
-    */
-    //-----------------------------------------------------------------------
-    
-    mChainsLog = log;
+    return true;
 }
-
@@ -2,10 +2,43 @@
 #define MCMCLOOP_H
 
 #include <QThread>
+#include <QJsonObject>
+#include <QByteArray>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QVector>
 #include "MCMCSettings.h"
+#include "Generator.h"
+#include "Instrumentation.h"
 
 #define ABORTED_BY_USER "Aborted by user"
 
+// Period of the polling of the progress by the user interface and the command line (ms)
+#define MCMC_PROGRESS_INTERVAL 50
+
+class ChainDispatcher;
+
+
+/**
+ * @brief Copy of the progress of a loop, taken by MCMCLoop::progress() from any thread.
+ * A new step (title and maximum) gives a new mStepIndex.
+ */
+struct MCMCProgress
+{
+    MCMCProgress(): mStepIndex(0), mStepMax(0), mStepValue(0), mDispatched(false) {}
+    
+    int mStepIndex;
+    QString mStepTitle;
+    int mStepMax; // 0 : unknown length
+    int mStepValue;
+    
+    // The chains run at the same time on workers (see ChainDispatcher), else one after the other
+    bool mDispatched;
+    // Iterations of each chain, out of its burn + adapt + run iterations (the maximum)
+    QVector<int> mChainsValue;
+    QVector<int> mChainsMax;
+};
+
 
 class MCMCLoop : public QThread
 {
@@ -22,16 +55,16 @@ public:
     virtual ~MCMCLoop();
     
     void setMCMCSettings(const MCMCSettings& settings);
+    void setSingleChain(int index);
+    void setDispatcher(ChainDispatcher* dispatcher);
     const QList<Chain>& chains();
+    int doneIterations() const;
+    MCMCProgress progress() const;
     const QString& getChainsLog() const;
     const QString& getInitLog() const;
     
     void run();
     
-signals:
-    void stepChanged(QString title, int min, int max);
-    void stepProgressed(int value);
-    
 protected:
     virtual QString calibrate() = 0;
     virtual void initVariablesForChain() = 0;
@@ -39,14 +72,52 @@ protected:
     virtual void update() = 0;
     virtual void finalize() = 0;
     virtual bool adapt() = 0;
+    virtual QString chainLog() {return QString();}
+    
+    // Distributed chains : model sent to the workers, and traces and adaptation state of one chain
+    virtual QJsonObject dispatchedState() const = 0;
+    virtual QByteArray saveChainState() = 0;
+    virtual void appendChainState(const QByteArray& state) = 0;
+    
+    // Progress : published by the loop thread, polled by the other threads (see progress())
+    void setStep(const QString& title, int max);
+    void setStepValue(int value) {mStepValue.store(value);}
+    void setChainValue(int chainIndex, int value) {mChainsValue[chainIndex].store(value);}
+    void iterationDone(int stepValue);
+    
+    bool runChain(QString& log);
+    bool runDispatchedChains(QString& log);
+    
+    // Stat of the instrumentation of the model, or 0 if there is none (see Instrumentation)
+    InstrumentStat* stat(const QString& name);
+    void addTime(const QString& name, const QElapsedTimer& timer, quint64 items);
     
 protected:
     QList<Chain> mChains;
+    Generator::Engine mGeneratorEngine;
     int mChainIndex;
     State mState;
     QString mChainsLog;
     QString mInitLog;
     
+    // Index of the only chain to run (worker process), or -1
+    int mSingleChain;
+    ChainDispatcher* mDispatcher;
+    QAtomicInt mDoneIterations;
+    Instrumentation* mInstrumentation;
+    
+    // Only the loop thread writes the counters : the iterations only store them, without any lock
+    QAtomicInt mStepIndex;
+    QAtomicInt mStepMax;
+    QAtomicInt mStepValue;
+    QVector<QAtomicInt> mChainsValue;
+    QVector<int> mChainsMax;
+    QString mStepTitle;
+    mutable QMutex mStepMutex; // mStepTitle
+    
+    friend class ChainDispatcher;
+    friend class ChainWorker;
+    
 public:
     QString mAbortedReason;
 };
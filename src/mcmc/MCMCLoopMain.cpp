@@ -8,6 +8,7 @@
 #include "Date.h"
 #include "ModelUtilities.h"
 #include "QtUtilities.h"
+#include "ChainProtocol.h"
 #include "../PluginAbstract.h"
 
 #include <vector>
@@ -15,23 +16,136 @@
 #include <iostream>
 #include <random>
 #include <QDebug>
-#include <QMessageBox>
-#include <QApplication>
 #include <QTime>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QtConcurrent>
+
+
+// Updates the events of a chunk, drawing from the chunk random stream
+struct EventsChunkUpdate
+{
+    typedef void result_type;
+    
+    EventsChunkUpdate(QVector<RandomStream>& streams, double tmin, double tmax, bool doMemo):
+    mStreams(streams), mTmin(tmin), mTmax(tmax), mDoMemo(doMemo){}
+    
+    void operator()(EventsChunk& chunk)
+    {
+        RandomStream* previousStream = Generator::threadStream();
+        Generator::setThreadStream(&mStreams[chunk.mStreamIndex]);
+        try{
+            for(int i=0; i<chunk.mEvents.size(); ++i)
+            {
+                Event* event = chunk.mEvents[i];
+                event->updateTheta(mTmin, mTmax);
+                if(mDoMemo)
+                {
+                    event->mTheta.memo();
+                    event->mTheta.saveCurrentAcceptRate();
+                }
+            }
+        }
+        catch(QString error)
+        {
+            // Exceptions cannot cross the thread pool : the error is thrown again by the MCMC thread
+            chunk.mError = error;
+        }
+        Generator::setThreadStream(previousStream);
+    }
+    
+    QVector<RandomStream>& mStreams;
+    double mTmin;
+    double mTmax;
+    bool mDoMemo;
+};
+
+// Updates the dates of a chunk, each one drawing from its own random stream.
+// The draws of a date keep their order : delta, theta, sigma.
+struct DatesChunkUpdate
+{
+    typedef void result_type;
+    
+    DatesChunkUpdate(QVector<RandomStream>& streams, bool doMemo):
+    mStreams(streams), mDoMemo(doMemo){}
+    
+    void operator()(DatesChunk& chunk)
+    {
+        RandomStream* previousStream = Generator::threadStream();
+        try{
+            for(int i=0; i<chunk.mDates.size(); ++i)
+            {
+                Generator::setThreadStream(&mStreams[chunk.mFirstStream + i]);
+                chunk.mDates[i]->updateDelta(chunk.mEvents[i]);
+            }
+            
+            for(int k=0; k<chunk.mScalarDates.size(); ++k)
+            {
+                const int i = chunk.mScalarDates[k];
+                Generator::setThreadStream(&mStreams[chunk.mFirstStream + i]);
+                chunk.mDates[i]->updateTheta(chunk.mEvents[i]);
+            }
+            chunk.mGaussBatch.updateTheta(mStreams);
+            
+            for(int i=0; i<chunk.mDates.size(); ++i)
+            {
+                Date* date = chunk.mDates[i];
+                Generator::setThreadStream(&mStreams[chunk.mFirstStream + i]);
+                date->updateSigma(chunk.mEvents[i]);
+                date->updateWiggle();
+                
+                if(mDoMemo)
+                {
+                    date->mTheta.memo();
+                    date->mSigma.memo();
+                    date->mWiggle.memo();
+                    
+                    date->mTheta.saveCurrentAcceptRate();
+                    date->mSigma.saveCurrentAcceptRate();
+                }
+            }
+        }
+        catch(QString error)
+        {
+            chunk.mError = error;
+        }
+        Generator::setThreadStream(previousStream);
+    }
+    
+    QVector<RandomStream>& mStreams;
+    bool mDoMemo;
+};
+
+struct ReplicaUpdate
+{
+    typedef void result_type;
+    
+    void operator()(MCMCLoopMain*& replica)
+    {
+        replica->updateReplica();
+    }
+};
 
 
 MCMCLoopMain::MCMCLoopMain(Model* model):MCMCLoop(),
-mModel(model)
+mModel(model),
+mParallelUpdates(true),
+mDatesStat(0),
+mEventsStat(0),
+mPhasesStat(0),
+mConstraintsStat(0),
+mInverseTemperature(1.)
 {
     if(mModel)
     {
         setMCMCSettings(mModel->mMCMCSettings);
+        mInstrumentation = &mModel->mInstrumentation;
     }
 }
 
 MCMCLoopMain::~MCMCLoopMain()
 {
-
+    deleteReplicas();
 }
 
 QString MCMCLoopMain::calibrate()
@@ -55,7 +169,13 @@ QString MCMCLoopMain::calibrate()
             }
         }
         
-        emit stepChanged(tr("Calibrating..."), 0, dates.size());
+        setStep(tr("Calibrating..."), dates.size());
+        
+        // Only the cold chain is instrumented : the replicas are created below, and never calibrate
+        mDatesStat = stat("update/dates");
+        mEventsStat = stat("update/events");
+        mPhasesStat = stat("update/phases");
+        mConstraintsStat = stat("update/phases constraints");
         
 //        for(int i=0; i<dates.size(); ++i) // if dates[i] type is std::vector
         for(int i=0; i<dates.length(); ++i)
@@ -67,18 +187,30 @@ QString MCMCLoopMain::calibrate()
             if (dates[i]->mCalibration.isEmpty()) {
                  dates[i]->calibrate(mModel->mSettings);
             }
+            else if (dates[i]->mGuideTable.isEmpty()) {
+                // calibration restored or copied without its sampling tables
+                dates[i]->buildInversionTables();
+            }
             //dates[i]->calibrate(mModel->mSettings);
             if(dates[i]->mCalibSum == 0)
             {
                 return tr("The date density is nul for: ") + dates[i]->getName();
             }
             
-            emit stepProgressed(i);
+            setStepValue(i);
             
             //QTime endTime = QTime::currentTime();
             //int timeDiff = startTime.msecsTo(endTime);
             //mLog += "Data \"" + dates[i]->mName + "\" (" + dates[i]->mPlugin->getName() + ") calibrated in " + QString::number(timeDiff) + " ms\n";
         }
+        
+        try{
+            createReplicas();
+        }
+        catch(QString error)
+        {
+            return error;
+        }
         return QString();
     }
     return tr("Invalid model");
@@ -91,6 +223,26 @@ void MCMCLoopMain::initVariablesForChain()
     
     int acceptBufferLen = chain.mNumBatchIter; //chainLen / 100;
     
+    // Events random streams are derived from the chain seed
+    mEventsStreams.resize(MCMC_EVENTS_STREAMS);
+    for(int i=0; i<mEventsStreams.size(); ++i)
+    {
+        std::seed_seq seq{chain.mSeed, i};
+        mEventsStreams[i].seed(seq);
+    }
+    
+    // One stream per date, so that the results do not depend on the number of threads
+    int numDates = 0;
+    for(int i=0; i<events.size(); ++i)
+        numDates += events[i]->mDates.size();
+    
+    mDatesStreams.resize(numDates);
+    for(int i=0; i<mDatesStreams.size(); ++i)
+    {
+        std::seed_seq seq{chain.mSeed, 1, i};
+        mDatesStreams[i].seed(seq);
+    }
+    
     for(int i=0; i<events.size(); ++i)
     {
         Event* event = events[i];
@@ -111,6 +263,78 @@ void MCMCLoopMain::initVariablesForChain()
             date.mSigma.mLastAcceptsLength = acceptBufferLen;
         }
     }
+    
+    // Each replica runs the same chain, with a seed derived from the chain seed
+    mSwapTrials.fill(0, mReplicas.size());
+    mSwapAccepts.fill(0, mReplicas.size());
+    for(int r=0; r<mReplicas.size(); ++r)
+    {
+        MCMCLoopMain* replica = mReplicas[r];
+        std::seed_seq seq{chain.mSeed, 2, r};
+        quint32 seed;
+        seq.generate(&seed, &seed + 1);
+        
+        replica->mChains = mChains;
+        replica->mChains[mChainIndex].mSeed = (int)(seed >> 1);
+        replica->mChainIndex = mChainIndex;
+        replica->mReplicaStream.seed(seq);
+        replica->initVariablesForChain();
+    }
+}
+
+void MCMCLoopMain::initEventsChunks()
+{
+    mEventsChunks.clear();
+    
+    const QVector<QVector<Event*> > classes = ModelUtilities::getEventsIndependentClasses(mModel->mEvents, mModel->mPhases);
+    for(int i=0; i<classes.size(); ++i)
+    {
+        const QVector<Event*>& events = classes[i];
+        const int numChunks = qBound(1, events.size() / MCMC_EVENTS_CHUNK_MIN, MCMC_EVENTS_STREAMS);
+        
+        QVector<EventsChunk> chunks(numChunks);
+        for(int j=0; j<numChunks; ++j)
+        {
+            // Contiguous and balanced parts of the class
+            const int begin = (j * events.size()) / numChunks;
+            const int end = ((j + 1) * events.size()) / numChunks;
+            chunks[j].mEvents = events.mid(begin, end - begin);
+            chunks[j].mStreamIndex = j;
+        }
+        mEventsChunks.append(chunks);
+    }
+}
+
+void MCMCLoopMain::initDatesChunks()
+{
+    mDatesChunks.clear();
+    
+    QList<Event*>& events = mModel->mEvents;
+    int dateIndex = 0;
+    for(int i=0; i<events.size(); ++i)
+    {
+        Event* event = events[i];
+        for(int j=0; j<event->mDates.size(); ++j)
+        {
+            if(dateIndex % MCMC_DATES_CHUNK == 0)
+            {
+                DatesChunk chunk;
+                chunk.mFirstStream = dateIndex;
+                mDatesChunks.append(chunk);
+            }
+            DatesChunk& chunk = mDatesChunks.last();
+            Date* date = &event->mDates[j];
+            
+            if(DatesGaussBatch::accepts(*date))
+                chunk.mGaussBatch.append(date, event, dateIndex);
+            else
+                chunk.mScalarDates.append(chunk.mDates.size());
+            
+            chunk.mDates.append(date);
+            chunk.mEvents.append(event);
+            ++dateIndex;
+        }
+    }
 }
 
 void MCMCLoopMain::initMCMC()
@@ -126,21 +350,21 @@ void MCMCLoopMain::initMCMC()
     // ----------------------------------------------------------------
     //  Init gamma
     // ----------------------------------------------------------------
-    emit stepChanged(tr("Initializing phases gaps..."), 0, events.size());
+    setStep(tr("Initializing phases gaps..."), events.size());
     for(int i=0; i<phasesConstraints.size(); ++i)
     {
         phasesConstraints[i]->initGamma();
-        emit stepProgressed(i);
+        setStepValue(i);
     }
     
     // ----------------------------------------------------------------
     //  Init tau
     // ----------------------------------------------------------------
-    emit stepChanged(tr("Initializing phases durations..."), 0, events.size());
+    setStep(tr("Initializing phases durations..."), events.size());
     for(int i=0; i<phases.size(); ++i)
     {
         phases[i]->initTau();
-        emit stepProgressed(i);
+        setStepValue(i);
     }
     
     for(int i=0; i<mModel->mEvents.size(); ++i)
@@ -156,7 +380,12 @@ void MCMCLoopMain::initMCMC()
     //  - si valeur fixe, facile!
     //  - si intervalle : random uniform sur l'intervalle (vérifier si min < max pour l'intervalle qui a été modifié par la validation du modèle)
     // ----------------------------------------------------------------
+    // Levels are the longest paths from the start events : they are set while sorting the events graph
+    ModelUtilities::getEventsTopologicalOrder(mModel->mEvents);
     QVector<Event*> eventsByLevel = ModelUtilities::sortEventsByLevel(mModel->mEvents);
+    
+    initEventsChunks();
+    initDatesChunks();
     int curLevel = 0;
     double curLevelMaxValue = mModel->mSettings.mTmin;
     double prevLevelMaxValue = mModel->mSettings.mTmin;
@@ -194,28 +423,15 @@ void MCMCLoopMain::initMCMC()
     // ----------------------------------------------------------------
     //  Init theta f, ti, ...
     // ----------------------------------------------------------------
-    emit stepChanged(tr("Initializing events..."), 0, events.size());
+    setStep(tr("Initializing events..."), events.size());
     QVector<Event*> unsortedEvents = ModelUtilities::unsortEvents(events);
     
-    QVector<QVector<Event*> > eventBranches = ModelUtilities::getAllEventsBranches(events);
-    QVector<QVector<Phase*> > phaseBranches = ModelUtilities::getAllPhasesBranches(phases, mModel->mSettings.mTmax - mModel->mSettings.mTmin);
-    
-    /*qDebug() << "==================";
-    for(int i=0; i<phaseBranches.size(); ++i)
-    {
-        qDebug() << "----------- branch " << i;
-        for(int j=0; j<phaseBranches[i].size(); ++j)
-        {
-            qDebug() << phaseBranches[i][j]->mName << " => ";
-        }
-    }*/
-    
     for(int i=0; i<unsortedEvents.size(); ++i)
     {
         if(unsortedEvents[i]->mType == Event::eDefault)
         {
-            double min = unsortedEvents[i]->getThetaMinRecursive(tmin, eventBranches, phaseBranches);
-            double max = unsortedEvents[i]->getThetaMaxRecursive(tmax, eventBranches, phaseBranches);
+            double min = unsortedEvents[i]->getThetaMinRecursive(tmin);
+            double max = unsortedEvents[i]->getThetaMaxRecursive(tmax);
             
             unsortedEvents[i]->mTheta.mX = Generator::randomUniform(min, max);
             unsortedEvents[i]->mInitialized = true;
@@ -229,10 +445,10 @@ void MCMCLoopMain::initMCMC()
                 qDebug()<<date.getName();
                 
                 // Init ti and its sigma
-                double idx = vector_interpolate_idx_for_value(Generator::randomUniform(), date.mRepartition);
-                date.mTheta.mX = tmin + idx * step;
+                double idx = date.getIdxFromRepartition(Generator::randomUniform());
+                date.mTheta.mX = date.getCalibTmin() + idx * step;
                 
-                FunctionAnalysis data = analyseFunction(vector_to_map(date.mCalibration, tmin, tmax, step));
+                FunctionAnalysis data = analyseFunction(date.getCalibMap());
                 date.mTheta.mSigmaMH = data.stddev; // computed in RenDateModel and ChronoModel V1.1
                 //date.mTheta.mSigmaMH = fabs(date.mTheta.mX-unsortedEvents[i]->mTheta.mX);
                 date.initDelta(unsortedEvents[i]);
@@ -243,14 +459,14 @@ void MCMCLoopMain::initMCMC()
             unsortedEvents[i]->mTheta.mSigmaMH = sqrt(unsortedEvents[i]->mS02);
             unsortedEvents[i]->mAShrinkage = 1.;
         }
-        emit stepProgressed(i);
+        setStepValue(i);
     }
     
     // ----------------------------------------------------------------
     //  Init sigma i
     // ----------------------------------------------------------------
     QString log;
-    emit stepChanged(tr("Initializing variances..."), 0, events.size());
+    setStep(tr("Initializing variances..."), events.size());
     
     for(int i=0; i<events.size(); ++i)
     {
@@ -268,17 +484,17 @@ void MCMCLoopMain::initMCMC()
             }
             date.mSigma.mSigmaMH = 1.;
         }
-        emit stepProgressed(i);
+        setStepValue(i);
     }
     // ----------------------------------------------------------------
     //  Init phases
     // ----------------------------------------------------------------
-    emit stepChanged(tr("Initializing phases..."), 0, events.size());
+    setStep(tr("Initializing phases..."), events.size());
     for(int i=0; i<phases.size(); ++i)
     {
         Phase* phase = phases[i];
         phase->updateAll(tmin, tmax);
-        emit stepProgressed(i);
+        setStepValue(i);
     }
     
     // ----------------------------------------------------------------
@@ -371,78 +587,169 @@ void MCMCLoopMain::initMCMC()
     mInitLog += "<hr>";
     mInitLog += log;
     
+    for(int r=0; r<mReplicas.size(); ++r)
+    {
+        Generator::setThreadStream(&mReplicas[r]->mReplicaStream);
+        try{
+            mReplicas[r]->initMCMC();
+        }
+        catch(QString error)
+        {
+            Generator::setThreadStream(0);
+            throw error;
+        }
+        Generator::setThreadStream(0);
+    }
 }
 
 void MCMCLoopMain::update()
 {
-    QList<Event*>& events = mModel->mEvents;
+    Chain& chain = mChains[mChainIndex];
+    
+    bool doMemo = (mState == eBurning) || (mState == eAdapting) || (chain.mTotalIter % chain.mThinningInterval == 0);
+    
+    if(mReplicas.isEmpty())
+    {
+        updateModel(doMemo);
+        mPreview.sample(mModel->mEvents, mChainIndex, mState, mModel->mSettings.mTmin, mModel->mSettings.mTmax);
+        return;
+    }
+    
+    //--------------------- Parallel tempering -----------------------------------------
+    // The hot replicas are updated concurrently with the cold chain, which is the only one recorded.
+    
+    QFuture<void> future = QtConcurrent::map(mReplicas, ReplicaUpdate());
+    try{
+        updateModel(doMemo);
+    }
+    catch(QString error)
+    {
+        future.waitForFinished();
+        throw error;
+    }
+    future.waitForFinished();
+    
+    for(int r=0; r<mReplicas.size(); ++r)
+    {
+        if(!mReplicas[r]->mReplicaError.isEmpty())
+        {
+            QString error = mReplicas[r]->mReplicaError;
+            mReplicas[r]->mReplicaError.clear();
+            throw error;
+        }
+    }
+    
+    if(chain.mTotalIter % MCMC_TEMPERING_SWAP_INTERVAL == 0)
+        swapReplicas();
+    
+    mPreview.sample(mModel->mEvents, mChainIndex, mState, mModel->mSettings.mTmin, mModel->mSettings.mTmax);
+}
+
+void MCMCLoopMain::updateReplica()
+{
+    Generator::setThreadStream(&mReplicaStream);
+    try{
+        updateModel(false);
+    }
+    catch(QString error)
+    {
+        mReplicaError = error;
+    }
+    Generator::setThreadStream(0);
+}
+
+void MCMCLoopMain::updateModel(const bool doMemo)
+{
     QList<Phase*>& phases = mModel->mPhases;
     QList<PhaseConstraint*>& phasesConstraints = mModel->mPhaseConstraints;
     
     double t_min = mModel->mSettings.mTmin;
     double t_max = mModel->mSettings.mTmax;
     
-    Chain& chain = mChains[mChainIndex];
+    //--------------------- Update Dates -----------------------------------------
+    // Given the events, each date only depends on its own event : the chunks are updated in parallel.
     
-    bool doMemo = (mState == eBurning) || (mState == eAdapting) || (chain.mTotalIter % chain.mThinningInterval == 0);
+    QElapsedTimer timer;
+    timer.start();
     
-    //--------------------- Update Dates -----------------------------------------
+    DatesChunkUpdate updateDatesChunk(mDatesStreams, doMemo);
+    if(!mParallelUpdates || mDatesChunks.size() == 1 || QThread::idealThreadCount() == 1)
+    {
+        for(int i=0; i<mDatesChunks.size(); ++i)
+            updateDatesChunk(mDatesChunks[i]);
+    }
+    else
+    {
+        QtConcurrent::blockingMap(mDatesChunks, updateDatesChunk);
+    }
     
-    int counter = 0;
-    for(int i=0; i<events.size(); ++i)
+    for(int i=0; i<mDatesChunks.size(); ++i)
     {
-        Event* event = events[i];
-        for(int j=0; j<event->mDates.size(); ++j)
+        if(!mDatesChunks[i].mError.isEmpty())
         {
-            Date& date = events[i]->mDates[j];
-            
-            date.updateDelta(event);
-            date.updateTheta(event);
-            date.updateSigma(event);
-            date.updateWiggle();
-            
-            if(doMemo)
-            {
-                date.mTheta.memo();
-                date.mSigma.memo();
-                date.mWiggle.memo();
-                
-                date.mTheta.saveCurrentAcceptRate();
-                date.mSigma.saveCurrentAcceptRate();
-            }
-            ++counter;
+            QString error = mDatesChunks[i].mError;
+            mDatesChunks[i].mError.clear();
+            throw error;
         }
     }
 
+    if(mDatesStat)
+        mDatesStat->add(timer.nsecsElapsed(), mDatesStreams.size());
+    
     //--------------------- Update Events -----------------------------------------
-
-    for(int i=0; i<events.size(); ++i)
+    // The events of an independence class do not depend on each other : the chunks of a class are updated in parallel.
+    // Each chunk draws from its own stream, so results do not depend on the number of threads.
+    
+    timer.start();
+    EventsChunkUpdate updateChunk(mEventsStreams, t_min, t_max, doMemo);
+    for(int i=0; i<mEventsChunks.size(); ++i)
     {
-        Event* event = events[i];
+        QVector<EventsChunk>& chunks = mEventsChunks[i];
+        if(!mParallelUpdates || chunks.size() == 1 || QThread::idealThreadCount() == 1)
+        {
+            for(int j=0; j<chunks.size(); ++j)
+                updateChunk(chunks[j]);
+        }
+        else
+        {
+            QtConcurrent::blockingMap(chunks, updateChunk);
+        }
         
-        event->updateTheta(t_min, t_max);
-        if(doMemo)
+        for(int j=0; j<chunks.size(); ++j)
         {
-            event->mTheta.memo();
-            event->mTheta.saveCurrentAcceptRate();
+            if(!chunks[j].mError.isEmpty())
+            {
+                QString error = chunks[j].mError;
+                chunks[j].mError.clear();
+                throw error;
+            }
         }
     }
 
+    if(mEventsStat)
+        mEventsStat->add(timer.nsecsElapsed(), mModel->mEvents.size());
+    
     //--------------------- Update Phases -----------------------------------------
 
+    timer.start();
     for(int i=0; i<phases.size(); ++i)
     {
         phases[i]->updateAll(t_min, t_max);
         if(doMemo)
             phases[i]->memoAll();
     }
+    if(mPhasesStat)
+        mPhasesStat->add(timer.nsecsElapsed(), phases.size());
     
     //--------------------- Update Phases constraints -----------------------------------------
     
+    timer.start();
     for(int i=0; i<phasesConstraints.size(); ++i)
     {
         phasesConstraints[i]->updateGamma();
     }
+    if(mConstraintsStat)
+        mConstraintsStat->add(timer.nsecsElapsed(), phasesConstraints.size());
 }
 
 bool MCMCLoopMain::adapt()
@@ -468,8 +775,9 @@ bool MCMCLoopMain::adapt()
             Date& date = event->mDates[j];
             
             //--------------------- Adapt Sigma MH de Theta i -----------------------------------------
+            // No walker to adapt when ti is drawn by Gibbs
             
-            if(date.mMethod == Date::eMHSymGaussAdapt)
+            if(date.mMethod == Date::eMHSymGaussAdapt && date.getTiSampler() != fGibbsGaussian)
             {
                 double taux = 100.f * date.mTheta.getCurrentAcceptRate();
                 if(taux <= taux_min || taux >= taux_max)
@@ -504,6 +812,13 @@ bool MCMCLoopMain::adapt()
             }
         }
     }
+    
+    // The replicas adapt their own proposals, at the same batches as the cold chain
+    for(int r=0; r<mReplicas.size(); ++r)
+    {
+        mReplicas[r]->mChains[mChainIndex].mBatchIndex = chain.mBatchIndex;
+        mReplicas[r]->adapt();
+    }
     return allOK;
 }
 
@@ -520,6 +835,8 @@ void MCMCLoopMain::finalize()
      */
     mModel->generateCorrelations(mChains);
     
+    deleteReplicas();
+    
     // This should not be done here because it uses resultsView parameters
     // ResultView will trigger it again when loading the model
     //mModel->generatePosteriorDensities(mChains, 1024, 1);
@@ -531,4 +848,325 @@ void MCMCLoopMain::finalize()
     //mModel->generateNumericalResults(mChains);
 }
 
+QString MCMCLoopMain::chainLog()
+{
+    QString log;
+    if(mReplicas.isEmpty())
+        return log;
+    
+    log += line("Tempering replicas : " + QString::number(mReplicas.size() + 1));
+    for(int k=0; k<mReplicas.size(); ++k)
+    {
+        const double betaCold = (k == 0) ? mInverseTemperature : mReplicas[k-1]->mInverseTemperature;
+        const double betaHot = mReplicas[k]->mInverseTemperature;
+        const double rate = (mSwapTrials[k] > 0) ? (100. * mSwapAccepts[k] / mSwapTrials[k]) : 0.;
+        log += line(" - swaps T=" + QString::number(1. / betaCold) + " <-> T=" + QString::number(1. / betaHot) + " : " + QString::number(rate, 'f', 1) + " %");
+    }
+    return log;
+}
+
+#pragma mark Distributed chains
+// Part of a variable produced by one chain : its trace and, for MH variables, the adaptation state
+static void saveVariableChain(QDataStream& out, const MetropolisVariable& variable)
+{
+    out << variable.mTrace;
+    out << variable.mX;
+}
+
+static void saveMHVariableChain(QDataStream& out, const MHVariable& variable)
+{
+    saveVariableChain(out, variable);
+    out << variable.mAllAccepts;
+    out << variable.mHistoryAcceptRateMH;
+    out << variable.mLastAccepts;
+    out << variable.mSigmaMH;
+}
+
+static void appendVariableChain(QDataStream& in, MetropolisVariable& variable)
+{
+    QVector<double> trace;
+    in >> trace;
+    in >> variable.mX;
+    variable.mTrace += trace;
+}
+
+static void appendMHVariableChain(QDataStream& in, MHVariable& variable)
+{
+    appendVariableChain(in, variable);
+    
+    QVector<bool> accepts;
+    QVector<double> history;
+    in >> accepts;
+    in >> history;
+    in >> variable.mLastAccepts;
+    in >> variable.mSigmaMH;
+    variable.mAllAccepts += accepts;
+    variable.mHistoryAcceptRateMH += history;
+}
+
+/**
+ * @brief Project sent to the workers : the seeds and the generator are those of this loop,
+ * so that a chain gives the same traces wherever it runs.
+ */
+QJsonObject MCMCLoopMain::dispatchedState() const
+{
+    QJsonObject state = mModel->getJson();
+    
+    MCMCSettings settings = mModel->mMCMCSettings;
+    settings.mGeneratorEngine = mGeneratorEngine;
+    settings.mSeeds.clear();
+    for(int i=0; i<mChains.size(); ++i)
+        settings.mSeeds.append(mChains.at(i).mSeed);
+    state[STATE_MCMC] = settings.toJson();
+    return state;
+}
+
+/**
+ * @brief Variables of the only chain run by a worker, in the same order as the .dat file (see Model::resultsSnapshot).
+ */
+QByteArray MCMCLoopMain::saveChainState()
+{
+    QByteArray state;
+    QDataStream out(&state, QIODevice::WriteOnly);
+    out.setVersion(CHAIN_STREAM_VERSION);
+    
+    const QList<Phase*>& phases = mModel->mPhases;
+    const QList<Event*>& events = mModel->mEvents;
+    
+    out << (qint32)phases.size();
+    out << (qint32)events.size();
+    
+    for(int i=0; i<phases.size(); ++i)
+    {
+        saveVariableChain(out, phases[i]->mAlpha);
+        saveVariableChain(out, phases[i]->mBeta);
+        saveVariableChain(out, phases[i]->mDuration);
+    }
+    for(int i=0; i<events.size(); ++i)
+    {
+        saveMHVariableChain(out, events[i]->mTheta);
+        
+        out << (qint32)events[i]->mDates.size();
+        for(int j=0; j<events[i]->mDates.size(); ++j)
+        {
+            const Date& date = events[i]->mDates[j];
+            saveMHVariableChain(out, date.mTheta);
+            saveMHVariableChain(out, date.mSigma);
+            saveMHVariableChain(out, date.mWiggle);
+        }
+    }
+    return state;
+}
+
+/**
+ * @brief Appends the chain mChainIndex, run by a worker, to the variables of the model.
+ */
+void MCMCLoopMain::appendChainState(const QByteArray& state)
+{
+    QDataStream in(state);
+    in.setVersion(CHAIN_STREAM_VERSION);
+    
+    QList<Phase*>& phases = mModel->mPhases;
+    QList<Event*>& events = mModel->mEvents;
+    
+    qint32 numPhases = 0;
+    qint32 numEvents = 0;
+    in >> numPhases >> numEvents;
+    if(numPhases != phases.size() || numEvents != events.size())
+        throw tr("The chain %1 does not match the model").arg(mChainIndex + 1);
+    
+    for(int i=0; i<phases.size(); ++i)
+    {
+        appendVariableChain(in, phases[i]->mAlpha);
+        appendVariableChain(in, phases[i]->mBeta);
+        appendVariableChain(in, phases[i]->mDuration);
+    }
+    for(int i=0; i<events.size(); ++i)
+    {
+        appendMHVariableChain(in, events[i]->mTheta);
+        
+        qint32 numDates = 0;
+        in >> numDates;
+        if(numDates != events[i]->mDates.size())
+            throw tr("The chain %1 does not match the model").arg(mChainIndex + 1);
+        
+        for(int j=0; j<events[i]->mDates.size(); ++j)
+        {
+            Date& date = events[i]->mDates[j];
+            appendMHVariableChain(in, date.mTheta);
+            appendMHVariableChain(in, date.mSigma);
+            appendMHVariableChain(in, date.mWiggle);
+        }
+    }
+    if(in.status() != QDataStream::Ok)
+        throw tr("Corrupted state of the chain %1").arg(mChainIndex + 1);
+}
+
+#pragma mark Parallel tempering
+/**
+ * @brief Creates the hot replicas of the model, once the dates are calibrated.
+ * Each replica is a full copy of the model whose date likelihoods are raised to beta = T^-1,
+ * the temperatures being geometrically spaced between 1 and MCMC_TEMPERING_MAX_TEMPERATURE.
+ */
+void MCMCLoopMain::createReplicas()
+{
+    deleteReplicas();
+    
+    const int numLoops = mModel->mMCMCSettings.mNumReplicas;
+    if(numLoops <= 1)
+        return;
+    
+    // A model without any date has no likelihood to temper
+    bool hasDates = false;
+    for(int i=0; i<mModel->mEvents.size(); ++i)
+        hasDates = hasDates || !mModel->mEvents[i]->mDates.isEmpty();
+    if(!hasDates)
+        return;
+    
+    const QJsonObject& json = mModel->getJson();
+    
+    for(int r=1; r<numLoops; ++r)
+    {
+        Model* model = new Model();
+        model->setJson(json);
+        try{
+            model->fromJson(json);
+            model->isValid();
+        }
+        catch(QString error)
+        {
+            delete model;
+            throw error;
+        }
+        
+        const double beta = pow(MCMC_TEMPERING_MAX_TEMPERATURE, -(double)r / (double)(numLoops - 1));
+        
+        QList<Event*>& events = mModel->mEvents;
+        QList<Event*>& replicaEvents = model->mEvents;
+        for(int i=0; i<events.size(); ++i)
+        {
+            for(int j=0; j<events[i]->mDates.size(); ++j)
+            {
+                Date& date = events[i]->mDates[j];
+                Date& replicaDate = replicaEvents[i]->mDates[j];
+                
+                replicaDate.mSettings = date.mSettings;
+                replicaDate.mCalibration = date.mCalibration;
+                replicaDate.mCalibOffset = date.mCalibOffset;
+                replicaDate.mCalibSum = date.mCalibSum;
+                replicaDate.mRepartition = date.mRepartition;
+                replicaDate.mGuideTable = date.mGuideTable;
+                replicaDate.mProposalQ1 = date.mProposalQ1;
+                replicaDate.mInverseTemperature = beta;
+            }
+        }
+        
+        MCMCLoopMain* replica = new MCMCLoopMain(model);
+        replica->mParallelUpdates = false;
+        replica->mInverseTemperature = beta;
+        mReplicas.append(replica);
+    }
+    mParallelUpdates = false;
+}
+
+void MCMCLoopMain::deleteReplicas()
+{
+    for(int r=0; r<mReplicas.size(); ++r)
+    {
+        Model* model = mReplicas[r]->mModel;
+        delete mReplicas[r];
+        delete model;
+    }
+    mReplicas.clear();
+    mParallelUpdates = true;
+}
+
+/**
+ * @brief Proposes to swap the states of the adjacent loops (k, k+1), the cold chain being the loop 0.
+ * The swap is accepted with probability min(1, (L(k+1) / L(k))^(beta(k) - beta(k+1))) where L is the untempered likelihood.
+ */
+void MCMCLoopMain::swapReplicas()
+{
+    QList<MCMCLoopMain*> loops;
+    loops.append(this);
+    loops.append(mReplicas);
+    
+    QVector<double> logL(loops.size());
+    QVector<double> beta(loops.size());
+    for(int k=0; k<loops.size(); ++k)
+    {
+        logL[k] = getLogLikelyhood(loops[k]->mModel);
+        beta[k] = loops[k]->mInverseTemperature;
+    }
+    
+    for(int k=0; k<loops.size()-1; ++k)
+    {
+        const double logRate = (beta[k] - beta[k+1]) * (logL[k+1] - logL[k]);
+        const double u = Generator::randomUniform();
+        
+        ++mSwapTrials[k];
+        
+        // A NaN rate (both likelihoods null) is rejected
+        if(log(u) < logRate)
+        {
+            swapStates(loops[k]->mModel, loops[k+1]->mModel);
+            qSwap(logL[k], logL[k+1]);
+            ++mSwapAccepts[k];
+        }
+    }
+}
+
+void MCMCLoopMain::swapStates(Model* model1, Model* model2)
+{
+    QList<Event*>& events1 = model1->mEvents;
+    QList<Event*>& events2 = model2->mEvents;
+    for(int i=0; i<events1.size(); ++i)
+    {
+        qSwap(events1[i]->mTheta.mX, events2[i]->mTheta.mX);
+        
+        for(int j=0; j<events1[i]->mDates.size(); ++j)
+        {
+            Date& date1 = events1[i]->mDates[j];
+            Date& date2 = events2[i]->mDates[j];
+            qSwap(date1.mTheta.mX, date2.mTheta.mX);
+            qSwap(date1.mSigma.mX, date2.mSigma.mX);
+            qSwap(date1.mWiggle.mX, date2.mWiggle.mX);
+            qSwap(date1.mDelta, date2.mDelta);
+        }
+    }
+    
+    QList<Phase*>& phases1 = model1->mPhases;
+    QList<Phase*>& phases2 = model2->mPhases;
+    for(int i=0; i<phases1.size(); ++i)
+    {
+        qSwap(phases1[i]->mAlpha.mX, phases2[i]->mAlpha.mX);
+        qSwap(phases1[i]->mBeta.mX, phases2[i]->mBeta.mX);
+        qSwap(phases1[i]->mTau, phases2[i]->mTau);
+        qSwap(phases1[i]->mDuration.mX, phases2[i]->mDuration.mX);
+    }
+    
+    QList<PhaseConstraint*>& constraints1 = model1->mPhaseConstraints;
+    QList<PhaseConstraint*>& constraints2 = model2->mPhaseConstraints;
+    for(int i=0; i<constraints1.size(); ++i)
+        qSwap(constraints1[i]->mGamma, constraints2[i]->mGamma);
+}
+
+/**
+ * @brief Untempered log-likelihood of the current dates, used by the swap moves : the target of each date, combinations included
+ */
+double MCMCLoopMain::getLogLikelyhood(Model* model)
+{
+    double logL = 0.;
+    QList<Event*>& events = model->mEvents;
+    for(int i=0; i<events.size(); ++i)
+    {
+        for(int j=0; j<events[i]->mDates.size(); ++j)
+        {
+            const Date& date = events[i]->mDates.at(j);
+            logL += date.getLogLikelyhood(date.mTheta.mX);
+        }
+    }
+    return logL;
+}
+
 
@@ -2,7 +2,45 @@
 #define MCMCLOOPMAIN_H
 
 #include "MCMCLoop.h"
+#include "MCMCPreview.h"
 #include "Model.h"
+#include "Generator.h"
+
+#include <QVector>
+
+// Maximum number of tasks a class of independent events is split into.
+// It does not depend on the number of cores, so that a seed gives the same results on every machine.
+#define MCMC_EVENTS_STREAMS 64
+// Minimum number of events updated by one task
+#define MCMC_EVENTS_CHUNK_MIN 16
+// Number of dates updated by one task. Each date has its own random stream.
+#define MCMC_DATES_CHUNK 32
+
+// Parallel tempering : the hottest replica samples the likelihood raised to 1 / MCMC_TEMPERING_MAX_TEMPERATURE
+#define MCMC_TEMPERING_MAX_TEMPERATURE 10.
+// Number of iterations between two rounds of swaps
+#define MCMC_TEMPERING_SWAP_INTERVAL 10
+
+
+// Events of a same independence class, updated sequentially by one task
+// drawing from its own random stream
+struct EventsChunk
+{
+    QVector<Event*> mEvents;
+    int mStreamIndex;
+    QString mError;
+};
+
+// Dates updated sequentially by one task : date i draws from the stream mFirstStream + i
+struct DatesChunk
+{
+    QVector<Date*> mDates;
+    QVector<Event*> mEvents;
+    int mFirstStream;
+    QVector<int> mScalarDates; // dates not sampled by the gaussian batch
+    DatesGaussBatch mGaussBatch;
+    QString mError;
+};
 
 
 class MCMCLoopMain: public MCMCLoop
@@ -19,9 +57,58 @@ protected:
     virtual void update();
     virtual bool adapt();
     virtual void finalize();
+    virtual QString chainLog();
+    
+    virtual QJsonObject dispatchedState() const;
+    virtual QByteArray saveChainState();
+    virtual void appendChainState(const QByteArray& state);
+    
+private:
+    void initEventsChunks();
+    void initDatesChunks();
+    void updateModel(const bool doMemo);
+    
+    // Parallel tempering
+    void createReplicas();
+    void deleteReplicas();
+    void swapReplicas();
+    static void swapStates(Model* model1, Model* model2);
+    static double getLogLikelyhood(Model* model);
 
 public:
+    // Called by the cold chain, concurrently with its own update
+    void updateReplica();
+    
     Model* mModel;
+    
+    // Events shown while the chains are running (see MCMCProgressDialog) : idle until events are chosen
+    MCMCPreview mPreview;
+    
+private:
+    // Chunks of each independence class of events (see ModelUtilities::getEventsIndependentClasses)
+    QVector<QVector<EventsChunk> > mEventsChunks;
+    QVector<RandomStream> mEventsStreams;
+    
+    QVector<DatesChunk> mDatesChunks;
+    QVector<RandomStream> mDatesStreams;
+    
+    // Chunks are updated in parallel, unless replicas already run concurrently
+    bool mParallelUpdates;
+    
+    // Cost of the update of each kind of variable (cold chain only, items : updated variables)
+    InstrumentStat* mDatesStat;
+    InstrumentStat* mEventsStat;
+    InstrumentStat* mPhasesStat;
+    InstrumentStat* mConstraintsStat;
+    
+    // Hot replicas of the cold chain, by increasing temperature
+    QList<MCMCLoopMain*> mReplicas;
+    double mInverseTemperature;
+    RandomStream mReplicaStream;
+    QString mReplicaError;
+    // Swaps between the replicas k and k+1 (the cold chain is 0)
+    QVector<unsigned long> mSwapTrials;
+    QVector<unsigned long> mSwapAccepts;
 };
 
 #endif
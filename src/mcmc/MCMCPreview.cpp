@@ -0,0 +1,152 @@
+#include "MCMCPreview.h"
+#include "Event.h"
+
+#include <QMutexLocker>
+
+
+MCMCPreview::MCMCPreview():
+mChainIndex(-1),
+mState(-1),
+mTmin(0.),
+mTmax(0.),
+mEventsChanged(0)
+{
+
+}
+
+#pragma mark User interface
+/**
+ * @brief Events to preview (indexes in Model::mEvents) : taken into account by the next iteration.
+ * An empty list stops the preview.
+ */
+void MCMCPreview::setEvents(const QList<int>& eventsIndexes)
+{
+    QMutexLocker locker(&mMutex);
+    mRequestedEvents = eventsIndexes.mid(0, MCMC_PREVIEW_MAX_EVENTS);
+    mEventsChanged.store(1);
+}
+
+MCMCPreviewSnapshot MCMCPreview::snapshot() const
+{
+    QMutexLocker locker(&mMutex);
+    return mSnapshot;
+}
+
+#pragma mark Loop
+void MCMCPreview::sample(const QList<Event*>& events, int chainIndex, int state, double tmin, double tmax)
+{
+    if(mEventsChanged.load())
+    {
+        QList<int> eventsIndexes;
+        {
+            QMutexLocker locker(&mMutex);
+            eventsIndexes = mRequestedEvents;
+            mEventsChanged.store(0);
+        }
+        mTmin = tmin;
+        mTmax = tmax;
+        restart(events, eventsIndexes);
+    }
+    if(mSeries.isEmpty())
+        return;
+
+    // The density is the one of the current stage : the burn-in does not hide the run
+    if(chainIndex != mChainIndex || state != mState)
+    {
+        if(chainIndex != mChainIndex)
+        {
+            for(int i=0; i<mSeries.size(); ++i)
+            {
+                mSeries[i].mTrace.clear();
+                mSeries[i].mTraceStart = 0;
+            }
+        }
+        mChainIndex = chainIndex;
+        mState = state;
+        clearStage();
+    }
+
+    const double binWidth = (mTmax - mTmin) / MCMC_PREVIEW_BINS;
+    for(int i=0; i<mSeries.size(); ++i)
+    {
+        MCMCPreviewSeries& series = mSeries[i];
+        const double x = events.at(series.mEventIndex)->mTheta.mX;
+
+        const int bin = qBound(0, (int)((x - mTmin) / binWidth), MCMC_PREVIEW_BINS - 1);
+        ++series.mHisto[bin];
+
+        if(series.mIterations > 0 && x != series.mLastX)
+            ++series.mAccepted;
+        ++series.mIterations;
+        series.mLastX = x;
+
+        if(series.mTrace.size() < MCMC_PREVIEW_TRACE_LENGTH)
+            series.mTrace.append(x);
+        else
+        {
+            series.mTrace[series.mTraceStart] = x;
+            series.mTraceStart = (series.mTraceStart + 1) % MCMC_PREVIEW_TRACE_LENGTH;
+        }
+    }
+
+    if(!mPublishTimer.isValid() || mPublishTimer.elapsed() >= MCMC_PREVIEW_INTERVAL)
+        publish();
+}
+
+void MCMCPreview::restart(const QList<Event*>& events, const QList<int>& eventsIndexes)
+{
+    mSeries.clear();
+    for(int i=0; i<eventsIndexes.size(); ++i)
+    {
+        const int index = eventsIndexes.at(i);
+        if(index < 0 || index >= events.size())
+            continue;
+
+        MCMCPreviewSeries series;
+        series.mEventIndex = index;
+        series.mIsMH = (events.at(index)->mMethod == Event::eMHAdaptGauss);
+        series.mTrace.reserve(MCMC_PREVIEW_TRACE_LENGTH);
+        mSeries.append(series);
+    }
+    clearStage();
+    publish();
+}
+
+void MCMCPreview::clearStage()
+{
+    for(int i=0; i<mSeries.size(); ++i)
+    {
+        mSeries[i].mHisto = QVector<int>(MCMC_PREVIEW_BINS, 0);
+        mSeries[i].mIterations = 0;
+        mSeries[i].mAccepted = 0;
+    }
+}
+
+/**
+ * @brief Copies the series for the user interface, unless it is reading them : then the next iteration tries again.
+ */
+void MCMCPreview::publish()
+{
+    if(!mMutex.tryLock())
+        return;
+
+    mSnapshot.mChainIndex = mChainIndex;
+    mSnapshot.mState = mState;
+    mSnapshot.mTmin = mTmin;
+    mSnapshot.mTmax = mTmax;
+    mSnapshot.mSeries = mSeries;
+    for(int i=0; i<mSeries.size(); ++i)
+    {
+        // Oldest value first
+        const MCMCPreviewSeries& series = mSeries.at(i);
+        const int n = series.mTrace.size();
+        QVector<double>& trace = mSnapshot.mSeries[i].mTrace;
+        for(int j=0; j<n; ++j)
+            trace[j] = series.mTrace.at((series.mTraceStart + j) % n);
+        mSnapshot.mSeries[i].mTraceStart = 0;
+    }
+    ++mSnapshot.mVersion;
+    mMutex.unlock();
+
+    mPublishTimer.start();
+}
@@ -0,0 +1,90 @@
+#ifndef MCMCPREVIEW_H
+#define MCMCPREVIEW_H
+
+#include <QList>
+#include <QVector>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+
+class Event;
+
+#define MCMC_PREVIEW_MAX_EVENTS 4
+// Bins of the histogram, over the study period
+#define MCMC_PREVIEW_BINS 100
+// Last iterations kept in the trace
+#define MCMC_PREVIEW_TRACE_LENGTH 1000
+// Minimum time between two copies for the user interface (ms)
+#define MCMC_PREVIEW_INTERVAL 250
+
+
+/**
+ * @brief Preview of the theta of one event, since the start of the current stage (burn, adapt or run) of the chain
+ */
+struct MCMCPreviewSeries
+{
+    MCMCPreviewSeries(): mEventIndex(-1), mIsMH(false), mIterations(0), mAccepted(0), mTraceStart(0), mLastX(0.) {}
+
+    int mEventIndex; // in Model::mEvents
+    bool mIsMH; // else the event is sampled by Gibbs : every value is accepted
+    QVector<int> mHisto;
+    QVector<double> mTrace; // oldest value first
+    int mIterations;
+    int mAccepted; // iterations whose value changed
+
+    // Loop thread only : mTrace is a ring buffer starting at mTraceStart
+    int mTraceStart;
+    double mLastX;
+};
+
+struct MCMCPreviewSnapshot
+{
+    MCMCPreviewSnapshot(): mVersion(0), mChainIndex(-1), mState(-1), mTmin(0.), mTmax(0.) {}
+
+    int mVersion; // increased by each copy
+    int mChainIndex;
+    int mState; // see MCMCLoop::State
+    double mTmin;
+    double mTmax;
+    QList<MCMCPreviewSeries> mSeries;
+};
+
+/**
+ * @brief Live preview of a few events while the MCMC is running (see MCMCProgressDialog).
+ * The loop thread updates the histograms and traces of the chosen events after each iteration,
+ * and copies them for the user interface every MCMC_PREVIEW_INTERVAL ms, only if the lock is free :
+ * the sampler never waits. Without any chosen event, an iteration only reads one atomic flag.
+ */
+class MCMCPreview
+{
+public:
+    MCMCPreview();
+
+    // User interface thread
+    void setEvents(const QList<int>& eventsIndexes);
+    MCMCPreviewSnapshot snapshot() const;
+
+    // Loop thread
+    void sample(const QList<Event*>& events, int chainIndex, int state, double tmin, double tmax);
+
+private:
+    void restart(const QList<Event*>& events, const QList<int>& eventsIndexes);
+    void clearStage();
+    void publish();
+
+    // Loop thread only
+    QList<MCMCPreviewSeries> mSeries;
+    int mChainIndex;
+    int mState;
+    double mTmin;
+    double mTmax;
+    QElapsedTimer mPublishTimer;
+
+    // Shared
+    mutable QMutex mMutex;
+    QAtomicInt mEventsChanged;
+    QList<int> mRequestedEvents;
+    MCMCPreviewSnapshot mSnapshot;
+};
+
+#endif
@@ -12,7 +12,9 @@ mMaxBatches(MCMC_MAX_ADAPT_BATCHES_DEFAULT),
 mNumBatchIter(MCMC_ITER_PER_BATCH_DEFAULT),
 mThinningInterval(MCMC_THINNING_INTERVAL_DEFAULT),
 mFinalBatchIndex(0),
-mMixingLevel(MCMC_MIXING_DEFAULT)
+mMixingLevel(MCMC_MIXING_DEFAULT),
+mGeneratorEngine(MCMC_GENERATOR_DEFAULT),
+mNumReplicas(MCMC_REPLICAS_DEFAULT)
 {
     
 }
@@ -40,6 +42,8 @@ void MCMCSettings::copyFrom(const MCMCSettings& s)
     mFinalBatchIndex = s.mFinalBatchIndex;
     
     mMixingLevel = s.mMixingLevel;
+    mGeneratorEngine = s.mGeneratorEngine;
+    mNumReplicas = s.mNumReplicas;
 }
 
 MCMCSettings::~MCMCSettings()
@@ -56,6 +60,8 @@ void MCMCSettings::restoreDefault()
     mNumBatchIter = MCMC_ITER_PER_BATCH_DEFAULT;
     mThinningInterval =  MCMC_THINNING_INTERVAL_DEFAULT;
     mMixingLevel =  MCMC_MIXING_DEFAULT;
+    mGeneratorEngine = MCMC_GENERATOR_DEFAULT;
+    mNumReplicas = MCMC_REPLICAS_DEFAULT;
     mFinalBatchIndex= 0;
 
 }
@@ -71,6 +77,9 @@ MCMCSettings MCMCSettings::fromJson(const QJsonObject& json)
     settings.mNumBatchIter = json.contains(STATE_MCMC_ITER_PER_BATCH) ? json[STATE_MCMC_ITER_PER_BATCH].toInt() : MCMC_ITER_PER_BATCH_DEFAULT;
     settings.mThinningInterval = json.contains(STATE_MCMC_THINNING_INTERVAL) ? json[STATE_MCMC_THINNING_INTERVAL].toInt() : MCMC_THINNING_INTERVAL_DEFAULT;
     settings.mMixingLevel = json.contains(STATE_MCMC_MIXING) ? json[STATE_MCMC_MIXING].toDouble() : MCMC_MIXING_DEFAULT;
+    // Projects saved before the choice of the generator keep the engine they were run with (not their traces : the updates have changed)
+    settings.mGeneratorEngine = json.contains(STATE_MCMC_GENERATOR) ? (Generator::Engine)json[STATE_MCMC_GENERATOR].toInt() : Generator::eMersenneBoxMuller;
+    settings.mNumReplicas = json.contains(STATE_MCMC_REPLICAS) ? json[STATE_MCMC_REPLICAS].toInt() : MCMC_REPLICAS_DEFAULT;
     QJsonArray seeds = json[STATE_MCMC_SEEDS].toArray();
     for(int i=0; i<seeds.size(); ++i)
         settings.mSeeds.append(seeds[i].toInt());
@@ -89,6 +98,8 @@ QJsonObject MCMCSettings::toJson() const
     mcmc[STATE_MCMC_THINNING_INTERVAL] = QJsonValue::fromVariant(mThinningInterval);
     
     mcmc[STATE_MCMC_MIXING] = QJsonValue::fromVariant(mMixingLevel);
+    mcmc[STATE_MCMC_GENERATOR] = QJsonValue::fromVariant((int)mGeneratorEngine);
+    mcmc[STATE_MCMC_REPLICAS] = QJsonValue::fromVariant(mNumReplicas);
     
     QJsonArray seeds;
     for(int i=0; i<mSeeds.size(); ++i)
@@ -4,6 +4,7 @@
 #include <QJsonObject>
 #include <QList>
 #include "StateKeys.h"
+#include "Generator.h"
 
 #define MCMC_NUM_CHAINS_DEFAULT 3
 #define MCMC_NUM_RUN_DEFAULT 100000
@@ -13,6 +14,8 @@
 #define MCMC_THINNING_INTERVAL_DEFAULT 10
 
 #define MCMC_MIXING_DEFAULT 0.99f
+#define MCMC_GENERATOR_DEFAULT Generator::eXoshiroZiggurat
+#define MCMC_REPLICAS_DEFAULT 1
 
 
 struct Chain
@@ -56,6 +59,8 @@ public:
     
     unsigned int mFinalBatchIndex;
     double mMixingLevel;
+    Generator::Engine mGeneratorEngine;
+    unsigned int mNumReplicas; // Parallel tempering when over 1 : the cold chain and its hot replicas
 };
 
 #endif
@@ -6,12 +6,31 @@
 #include "fftw3.h"
 #endif
 #include <QDebug>
+#include <QMutex>
 #include <algorithm>
+#include <cstring>
 
+#if USE_FFT
+// The FFTW planner is not thread-safe (only fftwf_execute is) : models computed at the same time share this lock
+static QMutex sFFTWPlannerMutex;
+#endif
 
 
 MetropolisVariable::MetropolisVariable():
-mX(0)
+mX(0),
+mCorrelationsKey(0),
+mHistosKey(0),
+mHistosFftLen(0),
+mHistosHFactor(0),
+mHistosTmin(0),
+mHistosTmax(0),
+mResultsKey(0),
+mHPDKey(0),
+mHPDThreshold(0),
+mCredibilityKey(0),
+mCredibilityThreshold(0),
+mTraceChecksum(0),
+mTraceChecksumSize(-1)
 {
 
 }
@@ -38,6 +57,36 @@ void MetropolisVariable::reset()
     mHPD.clear();
     
     mChainsResults.clear();
+    
+    mCorrelationsKey = 0;
+    mHistosKey = 0;
+    mResultsKey = 0;
+    mHPDKey = 0;
+    mCredibilityKey = 0;
+    mTraceChecksumSize = -1;
+}
+
+/**
+ * @brief FNV-1a over the 64 bits words of the trace. The trace only grows during the MCMC
+ * and is replaced as a whole when loaded : its size tells when the checksum must be computed again.
+ */
+quint64 MetropolisVariable::traceChecksum()
+{
+    if(mTraceChecksumSize != mTrace.size())
+    {
+        quint64 checksum = 14695981039346656037ULL;
+        for(int i=0; i<mTrace.size(); ++i)
+        {
+            quint64 word;
+            memcpy(&word, &mTrace.at(i), sizeof(word));
+            checksum ^= word;
+            checksum *= 1099511628211ULL;
+        }
+        // 0 is kept for "never computed"
+        mTraceChecksum = (checksum == 0) ? 1 : checksum;
+        mTraceChecksumSize = mTrace.size();
+    }
+    return mTraceChecksum;
 }
 
 /**
@@ -156,7 +205,11 @@ QMap<double, double> MetropolisVariable::generateHisto(QVector<double>& dataSrc,
     if(input != 0) {
         // ----- FFT -----
         
+        sFFTWPlannerMutex.lock();
         fftwf_plan plan_forward = fftwf_plan_dft_r2c_1d(inputSize, input, (fftwf_complex*)output, FFTW_ESTIMATE);
+        fftwf_plan plan_backward = fftwf_plan_dft_c2r_1d(inputSize, (fftwf_complex*)output, input, FFTW_ESTIMATE);
+        sFFTWPlannerMutex.unlock();
+        
         fftwf_execute(plan_forward);
         
         for(int i=0; i<outputSize/2; ++i) {
@@ -167,9 +220,13 @@ QMap<double, double> MetropolisVariable::generateHisto(QVector<double>& dataSrc,
             output[2*i + 1] *= factor;
         }
         
-        fftwf_plan plan_backward = fftwf_plan_dft_c2r_1d(inputSize, (fftwf_complex*)output, input, FFTW_ESTIMATE);
         fftwf_execute(plan_backward);
         
+        sFFTWPlannerMutex.lock();
+        fftwf_destroy_plan(plan_forward);
+        fftwf_destroy_plan(plan_backward);
+        sFFTWPlannerMutex.unlock();
+        
         // ----- FFT Buffer to result map -----
         /*
         areaTot =0.;
@@ -199,6 +256,11 @@ QMap<double, double> MetropolisVariable::generateHisto(QVector<double>& dataSrc,
 
 void MetropolisVariable::generateHistos(const QList<Chain>& chains, int fftLen, double hFactor, double tmin, double tmax)
 {
+    // Already computed on this trace with the same parameters (e.g. restored from a .dat file)
+    const quint64 key = traceChecksum();
+    if(mHistosKey == key && mHistosFftLen == fftLen && mHistosHFactor == hFactor && mHistosTmin == tmin && mHistosTmax == tmax)
+        return;
+    
     QVector<double> subFullTrace = fullRunTrace(chains);
     mHisto = generateHisto(subFullTrace, fftLen, hFactor, tmin, tmax);
  
@@ -209,12 +271,28 @@ void MetropolisVariable::generateHistos(const QList<Chain>& chains, int fftLen,
             mChainsHistos.append(generateHisto(subTrace, fftLen, hFactor, tmin, tmax));
         }
 //    }
+    
+    mHistosKey = key;
+    mHistosFftLen = fftLen;
+    mHistosHFactor = hFactor;
+    mHistosTmin = tmin;
+    mHistosTmax = tmax;
+    
+    // The numerical results and the HPD are computed on the histos
+    mResultsKey = 0;
+    mHPDKey = 0;
 }
 
 void MetropolisVariable::generateHPD(double threshold)
 {
+    if(mHistosKey != 0 && mHPDKey == mHistosKey && mHPDThreshold == threshold)
+        return;
+    
     if(!mHisto.isEmpty())
     {
+        mHPDKey = mHistosKey;
+        mHPDThreshold = threshold;
+        
         threshold = (threshold > 100 ? threshold = 100.0 : threshold);
         if (threshold==100.) {
              mHPD = mHisto;
@@ -247,13 +325,24 @@ void MetropolisVariable::generateCredibility(const QList<Chain>& chains, double
 {
     if(!mHisto.isEmpty())
     {
+        const quint64 key = traceChecksum();
+        if(mCredibilityKey == key && mCredibilityThreshold == threshold)
+            return;
+        
         mThreshold = threshold;
         mCredibility = credibilityForTrace(fullRunTrace(chains), threshold, mExactCredibilityThreshold);
+        mCredibilityKey = key;
+        mCredibilityThreshold = threshold;
     }
 }
 
 void MetropolisVariable::generateCorrelations(const QList<Chain>& chains)
 {
+    const quint64 key = traceChecksum();
+    if(mCorrelationsKey == key)
+        return;
+    mCorrelations.clear();
+    
     int hmax = 40;
     
     for(int c=0; c<chains.size(); ++c)
@@ -312,10 +401,14 @@ void MetropolisVariable::generateCorrelations(const QList<Chain>& chains)
         // Correlation ajoutée à la liste (une courbe de corrélation par chaine)
         mCorrelations.append(results);*/
     }
+    mCorrelationsKey = key;
 }
 
 void MetropolisVariable::generateNumericalResults(const QList<Chain>& chains)
 {
+    if(mHistosKey != 0 && mResultsKey == mHistosKey)
+        return;
+    
     // Results for chain concatenation
     mResults.analysis = analyseFunction(mHisto);
     mResults.quartiles = quartilesForTrace(fullRunTrace(chains));
@@ -329,6 +422,7 @@ void MetropolisVariable::generateNumericalResults(const QList<Chain>& chains)
         result.quartiles = quartilesForTrace(runTraceForChain(chains, i));
         mChainsResults.append(result);
     }
+    mResultsKey = mHistosKey;
 }
 
 #pragma mark getters (no calculs)
@@ -521,4 +615,65 @@ void MetropolisVariable::loadFromStream(QDataStream *in) // ajout PhD
     *in >> this->mThreshold;
     *in >> this->mTrace;
     *in >> this->mX;
+    
+    // New trace : the keys of its derived results are unknown until loadValidityFromStream()
+    mTraceChecksumSize = -1;
+    mCorrelationsKey = 0;
+    mHistosKey = 0;
+    mResultsKey = 0;
+    mHPDKey = 0;
+    mCredibilityKey = 0;
+}
+
+/**
+ * @brief The keys are saved with the checksum of the trace they were computed on :
+ * once loaded, they are only kept if the loaded trace has the same checksum.
+ */
+void MetropolisVariable::saveValidityToStream(QDataStream *out)
+{
+    *out << traceChecksum();
+    *out << mCorrelationsKey;
+    *out << mHistosKey;
+    *out << (qint32) mHistosFftLen;
+    *out << mHistosHFactor;
+    *out << mHistosTmin;
+    *out << mHistosTmax;
+    *out << mResultsKey;
+    *out << mResults;
+    *out << mChainsResults;
+    *out << mHPDKey;
+    *out << mHPDThreshold;
+    *out << mCredibilityKey;
+    *out << mCredibilityThreshold;
+}
+
+void MetropolisVariable::loadValidityFromStream(QDataStream *in)
+{
+    quint64 checksum = 0;
+    qint32 fftLen = 0;
+    *in >> checksum;
+    *in >> mCorrelationsKey;
+    *in >> mHistosKey;
+    *in >> fftLen;
+    mHistosFftLen = fftLen;
+    *in >> mHistosHFactor;
+    *in >> mHistosTmin;
+    *in >> mHistosTmax;
+    *in >> mResultsKey;
+    *in >> mResults;
+    *in >> mChainsResults;
+    *in >> mHPDKey;
+    *in >> mHPDThreshold;
+    *in >> mCredibilityKey;
+    *in >> mCredibilityThreshold;
+    
+    // Truncated chunk or trace modified outside : everything will be computed again
+    if(in->status() != QDataStream::Ok || checksum != traceChecksum())
+    {
+        mCorrelationsKey = 0;
+        mHistosKey = 0;
+        mResultsKey = 0;
+        mHPDKey = 0;
+        mCredibilityKey = 0;
+    }
 }
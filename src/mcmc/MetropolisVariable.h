@@ -29,6 +29,12 @@ public:
 
     void saveToStream(QDataStream *out); // ajout PhD
     void loadFromStream(QDataStream *in); // ajout PhD
+    // Validity keys of the derived results and the numerical results (see the .dat chunks in Model)
+    void saveValidityToStream(QDataStream *out);
+    void loadValidityFromStream(QDataStream *in);
+    
+    // Checksum of the trace, computed once per trace size
+    quint64 traceChecksum();
     // Virtual because MHVariable subclass adds some information
     virtual void generateNumericalResults(const QList<Chain>& chains);
 
@@ -89,6 +95,24 @@ public:
     DensityAnalysis mResults;
     QList<DensityAnalysis> mChainsResults;
     bool mIsDate;
+    
+    // Validity keys of the derived results : a result is only computed again when its key changes.
+    // Keys are built from the trace checksum (0 means "never computed") and the computation parameters.
+    quint64 mCorrelationsKey;
+    quint64 mHistosKey;
+    int mHistosFftLen;
+    double mHistosHFactor;
+    double mHistosTmin;
+    double mHistosTmax;
+    quint64 mResultsKey;
+    quint64 mHPDKey;
+    double mHPDThreshold;
+    quint64 mCredibilityKey;
+    double mCredibilityThreshold;
+    
+private:
+    quint64 mTraceChecksum;
+    int mTraceChecksumSize;
 };
 
 #endif
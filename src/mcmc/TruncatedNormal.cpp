@@ -0,0 +1,184 @@
+#include "TruncatedNormal.h"
+#include "Generator.h"
+#include <cmath>
+#include <algorithm>
+#include <QObject>
+#include <QString>
+
+// Beyond this bound, the tail is sampled by rejection instead of inversion
+#define TRUNC_NORMAL_TAIL 2.
+// Below this width, the interval is sampled by uniform rejection
+#define TRUNC_NORMAL_NARROW 0.5
+
+#ifndef M_SQRT2
+#define M_SQRT2 1.41421356237309504880
+#endif
+
+
+double TruncatedNormal::sample(const double mean, const double sigma, const double min, const double max)
+{
+    if(min >= max)
+    {
+        if(min == max)
+            return min;
+        throw QObject::tr("Truncated normal error : min = ") + QString::number(min) + ", max = " + QString::number(max);
+    }
+    if(sigma <= 0)
+        throw QObject::tr("Truncated normal error : sigma = ") + QString::number(sigma);
+    
+    const double a = (min - mean) / sigma;
+    const double b = (max - mean) / sigma;
+    
+    // Work on the positive side when the interval does not contain the mean
+    double x;
+    if(b <= 0)
+        x = -sampleStandard(-b, -a);
+    else
+        x = sampleStandard(a, b);
+    
+    return std::min(max, std::max(min, mean + x * sigma));
+}
+
+/**
+ *  @brief a < b, and a >= 0 or a < 0 < b
+ */
+double TruncatedNormal::sampleStandard(const double a, const double b)
+{
+    if(a >= TRUNC_NORMAL_TAIL)
+    {
+        const double lambda = (a + sqrt(a * a + 4.)) / 2.;
+        if((b - a) * lambda < 1.)
+            return sampleByUniformRejection(a, b);
+        else
+            return sampleByExpRejection(a, b);
+    }
+    else if(b - a < TRUNC_NORMAL_NARROW)
+    {
+        return sampleByUniformRejection(a, b);
+    }
+    return sampleByInversion(a, b);
+}
+
+/**
+ *  @brief Constant cost : no rejection.
+ *  The positive side uses the upper tail, which keeps its precision when Φ(a) is close to 1.
+ */
+double TruncatedNormal::sampleByInversion(const double a, const double b)
+{
+    const double u = Generator::randomUniform();
+    if(a >= 0)
+    {
+        const double qa = upperTail(a);
+        const double qb = upperTail(b);
+        return -quantile(qa - u * (qa - qb));
+    }
+    else
+    {
+        const double pa = cdf(a);
+        const double pb = cdf(b);
+        return quantile(pa + u * (pb - pa));
+    }
+}
+
+/**
+ *  @brief a >= TRUNC_NORMAL_TAIL : translated exponential proposal with the optimal rate,
+ *  the acceptance rate is over 0.9, and over 0.63 for the truncation at b.
+ */
+double TruncatedNormal::sampleByExpRejection(const double a, const double b)
+{
+    const double lambda = (a + sqrt(a * a + 4.)) / 2.;
+    double x;
+    bool accepted = false;
+    do{
+        x = a - log(1. - Generator::randomUniform()) / lambda;
+        if(x <= b)
+        {
+            const double u = Generator::randomUniform();
+            accepted = (u <= exp(-0.5 * (x - lambda) * (x - lambda)));
+        }
+    }while(!accepted);
+    
+    return x;
+}
+
+/**
+ *  @brief The density is bounded by its value at the point of [a, b] closest to 0.
+ *  The regimes only use it when the acceptance rate is over exp(-1.5).
+ */
+double TruncatedNormal::sampleByUniformRejection(const double a, const double b)
+{
+    const double m2 = (a > 0) ? a * a : 0.;
+    double x;
+    bool accepted = false;
+    do{
+        x = a + Generator::randomUniform() * (b - a);
+        const double u = Generator::randomUniform();
+        accepted = (u <= exp(0.5 * (m2 - x * x)));
+    }while(!accepted);
+    
+    return x;
+}
+
+#pragma mark Standard gaussian
+double TruncatedNormal::cdf(const double x)
+{
+    return 0.5 * erfc(-x / M_SQRT2);
+}
+
+double TruncatedNormal::upperTail(const double x)
+{
+    return 0.5 * erfc(x / M_SQRT2);
+}
+
+/**
+ *  @brief Rational approximation by P. J. Acklam (relative error 1.15e-9),
+ *  refined by one step of Halley's method to the precision of erfc.
+ */
+double TruncatedNormal::quantile(const double p)
+{
+    static const double a[6] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                                 1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+    static const double b[5] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                                 6.680131188771972e+01, -1.328068155288572e+01};
+    static const double c[6] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                                -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+    static const double d[4] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                                3.754408661907416e+00};
+    const double pLow = 0.02425;
+    
+    if(p <= 0)
+        return -HUGE_VAL;
+    if(p >= 1)
+        return HUGE_VAL;
+    
+    double x;
+    if(p < pLow)
+    {
+        const double q = sqrt(-2. * log(p));
+        x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+            ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.);
+    }
+    else if(p <= 1. - pLow)
+    {
+        const double q = p - 0.5;
+        const double r = q * q;
+        x = (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+            (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.);
+    }
+    else
+    {
+        const double q = sqrt(-2. * log(1. - p));
+        x = -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+             ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.);
+    }
+    
+    // Halley (exp(x^2/2) overflows in the extreme tails, where the approximation is kept)
+    if(fabs(x) < 37.)
+    {
+        const double e = cdf(x) - p;
+        const double u = e * sqrt(2. * M_PI) * exp(0.5 * x * x);
+        x = x - u / (1. + 0.5 * x * u);
+    }
+    
+    return x;
+}
@@ -0,0 +1,32 @@
+#ifndef TRUNCATEDNORMAL_H
+#define TRUNCATEDNORMAL_H
+
+
+/**
+ * @brief Sampling of a gaussian truncated to [min, max], with a bounded expected cost.
+ * The regime depends on the geometry of the standardized interval [a, b] :
+ * - far tail (a >= 2 after symmetry) : exponential rejection (Robert 1995), or uniform rejection if the interval is narrow ;
+ * - narrow interval : uniform rejection ;
+ * - otherwise : inversion of the cumulative distribution function.
+ * Draws come from Generator::randomUniform, so they follow the thread streams of parallel updates.
+ */
+class TruncatedNormal
+{
+public:
+    static double sample(const double mean, const double sigma, const double min, const double max);
+    
+    // Standard gaussian
+    static double cdf(const double x);
+    static double upperTail(const double x);
+    static double quantile(const double p);
+    
+private:
+    TruncatedNormal(){}
+    
+    static double sampleStandard(const double a, const double b);
+    static double sampleByInversion(const double a, const double b);
+    static double sampleByExpRejection(const double a, const double b);
+    static double sampleByUniformRejection(const double a, const double b);
+};
+
+#endif
@@ -0,0 +1,90 @@
+#include "CalibrationStore.h"
+#include "Date.h"
+#include "../PluginAbstract.h"
+
+#include <QJsonDocument>
+#include <QMutexLocker>
+
+
+QCache<QString, CalibrationCurve> CalibrationStore::mCurves(CALIBRATION_STORE_MAX_COST);
+QMutex CalibrationStore::mMutex;
+QSet<QString> CalibrationStore::mReserved;
+QWaitCondition CalibrationStore::mReservedChanged;
+
+/**
+ * @brief The likelihood only depends on the plugin and its data (or those of its sub-dates) :
+ * QJsonObject keys are sorted, so the compact JSON of the data identifies its content.
+ */
+QString CalibrationStore::getKey(const Date& date, const ProjectSettings& settings)
+{
+    QString key = date.mPlugin ? date.mPlugin->getId() : QString();
+    key += "|" + QString::number(settings.mTmin, 'g', 17);
+    key += "|" + QString::number(settings.mTmax, 'g', 17);
+    key += "|" + QString::number(settings.mStep, 'g', 17);
+    key += "|" + QString::fromUtf8(QJsonDocument(date.mData).toJson(QJsonDocument::Compact));
+    
+    // A combination is identified by its sub-dates
+    for(int i=0; i<date.mSubDates.size(); ++i)
+    {
+        const Date& subDate = date.mSubDates.at(i);
+        key += "|" + (subDate.mPlugin ? subDate.mPlugin->getId() : QString());
+        key += "|" + QString::fromUtf8(QJsonDocument(subDate.mData).toJson(QJsonDocument::Compact));
+    }
+    return key;
+}
+
+bool CalibrationStore::find(const QString& key, CalibrationCurve& curve)
+{
+    QMutexLocker locker(&mMutex);
+    CalibrationCurve* stored = mCurves.object(key);
+    if(!stored)
+        return false;
+    
+    curve = *stored;
+    return true;
+}
+
+/**
+ * @brief Same as find, but when the curve is missing the key is reserved for the caller,
+ * who must then calibrate and call insert (or release if it has no curve to store).
+ * If another thread already reserved the key, waits for its curve : models run at the same time
+ * (parameter sweeps) calibrate their common dates once.
+ */
+bool CalibrationStore::findOrReserve(const QString& key, CalibrationCurve& curve)
+{
+    QMutexLocker locker(&mMutex);
+    while(mReserved.contains(key))
+        mReservedChanged.wait(&mMutex);
+    
+    CalibrationCurve* stored = mCurves.object(key);
+    if(stored)
+    {
+        curve = *stored;
+        return true;
+    }
+    mReserved.insert(key);
+    return false;
+}
+
+void CalibrationStore::insert(const QString& key, const CalibrationCurve& curve)
+{
+    const int cost = qMax(1, curve.mCalibration.size() + curve.mRepartition.size() + curve.mProposalQ1.size() + curve.mGuideTable.size());
+    
+    QMutexLocker locker(&mMutex);
+    mCurves.insert(key, new CalibrationCurve(curve), cost);
+    if(mReserved.remove(key))
+        mReservedChanged.wakeAll();
+}
+
+void CalibrationStore::release(const QString& key)
+{
+    QMutexLocker locker(&mMutex);
+    if(mReserved.remove(key))
+        mReservedChanged.wakeAll();
+}
+
+void CalibrationStore::clear()
+{
+    QMutexLocker locker(&mMutex);
+    mCurves.clear();
+}
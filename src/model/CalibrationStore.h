@@ -0,0 +1,96 @@
+#ifndef CALIBRATIONSTORE_H
+#define CALIBRATIONSTORE_H
+
+#include "ProjectSettings.h"
+
+#include <QCache>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+class Date;
+
+// Maximum number of values held by the store (each curve costs the size of its vectors)
+#define CALIBRATION_STORE_MAX_COST (1 << 24)
+
+
+// Result of Date::calibrate, once built it is never modified
+struct CalibrationCurve
+{
+    QVector<double> mCalibration;
+    int mCalibOffset;
+    double mCalibSum;
+    QVector<double> mRepartition;
+    QVector<int> mGuideTable;
+    QVector<double> mProposalQ1;
+};
+
+/**
+ * @brief Calibrations shared by the dates having the same plugin, the same data (or sub-dates) and the same study period.
+ * The dates hold implicitly shared copies of the stored vectors : identical measurements are calibrated
+ * and stored once, whatever the number of Date instances refering to them.
+ * The cache may drop curves, the dates still referencing them keep them alive.
+ */
+class CalibrationStore
+{
+public:
+    static QString getKey(const Date& date, const ProjectSettings& settings);
+    static bool find(const QString& key, CalibrationCurve& curve);
+    static bool findOrReserve(const QString& key, CalibrationCurve& curve);
+    static void insert(const QString& key, const CalibrationCurve& curve);
+    static void release(const QString& key);
+    static void clear();
+    
+private:
+    static QCache<QString, CalibrationCurve> mCurves;
+    static QMutex mMutex;
+    
+    // Keys being calibrated : the other threads wait for the curve instead of computing it again
+    static QSet<QString> mReserved;
+    static QWaitCondition mReservedChanged;
+    
+private:
+    CalibrationStore(){}
+    ~CalibrationStore(){}
+    
+    Q_DISABLE_COPY(CalibrationStore)
+};
+
+/**
+ * @brief Reservation taken by CalibrationStore::findOrReserve : released when it goes out of scope
+ * without the curve having been inserted (e.g. on an exception), so that the waiting threads are never blocked.
+ */
+class CalibrationReservation
+{
+public:
+    CalibrationReservation():mReserved(false){}
+    ~CalibrationReservation()
+    {
+        if(mReserved)
+            CalibrationStore::release(mKey);
+    }
+    
+    // Same as CalibrationStore::findOrReserve, the reservation is held if the curve is not found
+    bool findOrReserve(const QString& key, CalibrationCurve& curve)
+    {
+        mKey = key;
+        mReserved = !CalibrationStore::findOrReserve(key, curve);
+        return !mReserved;
+    }
+    
+    void insert(const CalibrationCurve& curve)
+    {
+        CalibrationStore::insert(mKey, curve);
+        mReserved = false;
+    }
+    
+private:
+    QString mKey;
+    bool mReserved;
+    
+    Q_DISABLE_COPY(CalibrationReservation)
+};
+
+#endif
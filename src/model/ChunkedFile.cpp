@@ -0,0 +1,215 @@
+#include "ChunkedFile.h"
+
+#include <QDataStream>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QtConcurrent>
+
+// magic, version, stream version, number of chunks, table of contents offset
+#define CHUNKED_FILE_TOC_POS 16
+
+
+// Compresses a chunk : the chunks of a file are compressed in parallel
+struct ChunkCompress
+{
+    typedef void result_type;
+    
+    void operator()(FileChunk& chunk)
+    {
+        ChunkedFile::compress(chunk);
+    }
+};
+
+ChunkedFile::ChunkedFile():
+mMap(0),
+mVersion(0),
+mStreamVersion(0)
+{
+    
+}
+
+ChunkedFile::~ChunkedFile()
+{
+    close();
+}
+
+bool ChunkedFile::isChunkedFile(const QString& fileName)
+{
+    QFile file(fileName);
+    if(!file.open(QIODevice::ReadOnly))
+        return false;
+    
+    QDataStream in(&file);
+    quint32 magic = 0;
+    quint32 version = 0;
+    in >> magic;
+    in >> version;
+    return (in.status() == QDataStream::Ok) && (magic == CHUNKED_FILE_MAGIC) && (version >= 2);
+}
+
+/**
+ * @brief Writes the chunks in the order of the vector. The uncompressed data of the chunks is released once compressed.
+ */
+void ChunkedFile::write(const QString& fileName, QVector<FileChunk>& chunks, const int streamVersion)
+{
+    QtConcurrent::blockingMap(chunks, ChunkCompress());
+    writeCompressed(fileName, chunks, streamVersion);
+}
+
+void ChunkedFile::compress(FileChunk& chunk)
+{
+    chunk.mCompressed = qCompress(chunk.mData);
+    chunk.mData.clear();
+}
+
+void ChunkedFile::writeCompressed(const QString& fileName, QVector<FileChunk>& chunks, const int streamVersion)
+{
+    // Written to a temporary file in the same directory, renamed by commit()
+    QSaveFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly))
+        throw QObject::tr("Cannot write the file : ") + fileName;
+    
+    QDataStream out(&file);
+    out << (quint32)CHUNKED_FILE_MAGIC;
+    out << (quint32)CHUNKED_FILE_VERSION;
+    out << (qint32)streamVersion;
+    out << (qint32)chunks.size();
+    out << (quint64)0;
+    
+    QVector<quint64> offsets(chunks.size());
+    for(int i=0; i<chunks.size(); ++i)
+    {
+        offsets[i] = (quint64)file.pos();
+        if(file.write(chunks[i].mCompressed) != chunks[i].mCompressed.size())
+            throw QObject::tr("Cannot write the file : ") + fileName;
+    }
+    
+    const quint64 tocOffset = (quint64)file.pos();
+    for(int i=0; i<chunks.size(); ++i)
+    {
+        out << chunks[i].mName;
+        out << offsets[i];
+        out << (quint64)chunks[i].mCompressed.size();
+        chunks[i].mCompressed.clear();
+    }
+    
+    file.seek(CHUNKED_FILE_TOC_POS);
+    out << tocOffset;
+    
+    if(out.status() != QDataStream::Ok || !file.commit())
+        throw QObject::tr("Cannot write the file : ") + fileName;
+}
+
+void ChunkedFile::open(const QString& fileName)
+{
+    close();
+    
+    mFile.setFileName(fileName);
+    if(!mFile.open(QIODevice::ReadOnly))
+        throw QObject::tr("Cannot read the file : ") + fileName;
+    
+    QDataStream in(&mFile);
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint32 streamVersion = 0;
+    qint32 numChunks = 0;
+    quint64 tocOffset = 0;
+    in >> magic;
+    in >> version;
+    in >> streamVersion;
+    in >> numChunks;
+    in >> tocOffset;
+    
+    if(in.status() != QDataStream::Ok || magic != CHUNKED_FILE_MAGIC)
+        throw QObject::tr("Invalid results file : ") + fileName;
+    if(version > CHUNKED_FILE_VERSION)
+        throw QObject::tr("This results file has been written by a more recent version : ") + fileName;
+    if(tocOffset > (quint64)mFile.size())
+        throw QObject::tr("Invalid results file : ") + fileName;
+    
+    mVersion = version;
+    mStreamVersion = streamVersion;
+    
+    mFile.seek(tocOffset);
+    for(int i=0; i<numChunks; ++i)
+    {
+        QString name;
+        Entry entry;
+        in >> name;
+        in >> entry.mOffset;
+        in >> entry.mSize;
+        
+        if(in.status() != QDataStream::Ok || entry.mOffset + entry.mSize > tocOffset)
+            throw QObject::tr("Invalid results file : ") + fileName;
+        
+        mEntries.insert(name, entry);
+        mNames.append(name);
+    }
+    
+    // Without a mapping (unsupported by the file system), chunks are read with seek + read
+    mMap = mFile.map(0, mFile.size());
+}
+
+void ChunkedFile::close()
+{
+    if(mMap)
+    {
+        mFile.unmap(mMap);
+        mMap = 0;
+    }
+    if(mFile.isOpen())
+        mFile.close();
+    
+    mEntries.clear();
+    mNames.clear();
+    mVersion = 0;
+    mStreamVersion = 0;
+}
+
+bool ChunkedFile::contains(const QString& name) const
+{
+    return mEntries.contains(name);
+}
+
+QStringList ChunkedFile::chunkNames() const
+{
+    return mNames;
+}
+
+int ChunkedFile::version() const
+{
+    return mVersion;
+}
+
+int ChunkedFile::streamVersion() const
+{
+    return mStreamVersion;
+}
+
+QByteArray ChunkedFile::chunk(const QString& name) const
+{
+    QHash<QString, Entry>::const_iterator it = mEntries.constFind(name);
+    if(it == mEntries.constEnd())
+        throw QObject::tr("Missing data in the results file : ") + name;
+    
+    const Entry& entry = it.value();
+    QByteArray data;
+    if(mMap)
+    {
+        data = qUncompress(mMap + entry.mOffset, (int)entry.mSize);
+    }
+    else
+    {
+        QByteArray compressed;
+        {
+            QMutexLocker locker(&mMutex);
+            mFile.seek(entry.mOffset);
+            compressed = mFile.read(entry.mSize);
+        }
+        data = qUncompress(compressed);
+    }
+    
+    if(data.isEmpty() && entry.mSize > 0)
+        throw QObject::tr("Corrupted data in the results file : ") + name;
+    return data;
+}
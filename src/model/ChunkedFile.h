@@ -0,0 +1,79 @@
+#ifndef CHUNKEDFILE_H
+#define CHUNKEDFILE_H
+
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// "CHMD" : results files (.dat) written from version 2 start with this magic number,
+// older ones start with the size of their single compressed block
+#define CHUNKED_FILE_MAGIC 0x43484D44
+// 3 : chains chunk, validity keys after each variable
+#define CHUNKED_FILE_VERSION 3
+
+
+// One independently compressed part of the file (typically one variable)
+struct FileChunk
+{
+    QString mName;
+    QByteArray mData;
+    QByteArray mCompressed;
+};
+
+/**
+ * @brief Results file made of independently compressed chunks :
+ * - header : magic, version, QDataStream version of the chunks, number of chunks, offset of the table of contents ;
+ * - chunks : qCompress'ed data, compressed in parallel when writing ;
+ * - table of contents : name, offset and size of each chunk.
+ * The file is written to a temporary file, renamed over the previous one only once complete :
+ * an interrupted save never leaves a truncated file.
+ * When reading, the file is memory mapped : a chunk is uncompressed from the mapping when asked,
+ * so only the requested chunks are read, and they can be uncompressed concurrently.
+ */
+class ChunkedFile
+{
+public:
+    ChunkedFile();
+    ~ChunkedFile();
+    
+    static bool isChunkedFile(const QString& fileName);
+    static void write(const QString& fileName, QVector<FileChunk>& chunks, const int streamVersion);
+    
+    // Two steps writing, e.g. to compress the chunks while following their progress :
+    // writeCompressed() expects the chunks to be compressed already.
+    static void compress(FileChunk& chunk);
+    static void writeCompressed(const QString& fileName, QVector<FileChunk>& chunks, const int streamVersion);
+    
+    void open(const QString& fileName);
+    void close();
+    
+    bool contains(const QString& name) const;
+    QStringList chunkNames() const;
+    int version() const;
+    int streamVersion() const;
+    
+    // Thread safe
+    QByteArray chunk(const QString& name) const;
+    
+private:
+    struct Entry
+    {
+        quint64 mOffset;
+        quint64 mSize;
+    };
+    
+    mutable QFile mFile;
+    uchar* mMap;
+    QHash<QString, Entry> mEntries;
+    QStringList mNames;
+    int mVersion;
+    int mStreamVersion;
+    mutable QMutex mMutex;
+    
+    Q_DISABLE_COPY(ChunkedFile)
+};
+
+#endif
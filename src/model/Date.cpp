@@ -1,12 +1,14 @@
 #include "Date.h"
 #include "Event.h"
+#include "CalibrationStore.h"
 #include "Generator.h"
+#include "TruncatedNormal.h"
 #include "StdUtilities.h"
 #include "PluginManager.h"
 #include "../PluginAbstract.h"
-#include "Painting.h"
 #include "QtUtilities.h"
 #include "ModelUtilities.h"
+#include "Trace.h"
 #include <QDebug>
 
 
@@ -48,7 +50,10 @@ void Date::init()
     mIsCurrent = false;
     mIsSelected = false;
     mCalibSum = 0;
+    mCalibOffset = 0;
     mSubDates.clear();
+    mGaussianLikelyhood = GaussianLikelyhood();
+    mInverseTemperature = 1.;
 
 }
 
@@ -94,12 +99,17 @@ void Date::copyFrom(const Date& date)
     mIsSelected = date.mIsSelected;
     
     mCalibration = date.mCalibration;
+    mCalibOffset = date.mCalibOffset;
     mRepartition = date.mRepartition;
+    mGuideTable = date.mGuideTable;
+    mProposalQ1 = date.mProposalQ1;
     mCalibHPD = date.mCalibHPD;
     
     mSubDates = date.mSubDates;
     
     updateti = date.updateti;
+    mGaussianLikelyhood = date.mGaussianLikelyhood;
+    mInverseTemperature = date.mInverseTemperature;
     
     mMixingLevel = date.mMixingLevel;
 
@@ -251,18 +261,130 @@ QJsonObject Date::toJson() const
 double Date::getLikelyhood(const double& t)
 {
     double result = 0.f;
-    if(mPlugin)
+    if(!mSubDates.isEmpty())
+        result = getCombinedLikelyhood(t);
+    else if(mPlugin)
         result = mPlugin->getLikelyhood(t, mData);
+    
+    // Parallel tempering : a tempered replica samples G^beta
+    if(mInverseTemperature != 1.)
+        result = pow(result, mInverseTemperature);
     return result;
 }
 
+/**
+ *  @brief The likelihood is exp(second) / sqrt(first) : tempered, it is exp(beta.second) / sqrt(first^beta)
+ */
 QPair<double, double > Date::getLikelyhoodArg(const double& t)
 {
-    if(mPlugin)   return mPlugin->getLikelyhoodArg(t,mData);
+    if(mPlugin)
+    {
+        QPair<double, double> result;
+        if(mSubDates.isEmpty())
+            result = mPlugin->getLikelyhoodArg(t,mData);
+        else
+        {
+            // Product of the sub-dates likelihoods
+            result = qMakePair(1., 0.);
+            for(int i=0; i<mSubDates.size(); ++i)
+            {
+                const Date& subDate = mSubDates.at(i);
+                if(!subDate.mPlugin)
+                    return QPair<double, double>();
+                const QPair<double, double> arg = subDate.mPlugin->getLikelyhoodArg(t, subDate.mData);
+                result.first *= arg.first;
+                result.second += arg.second;
+            }
+        }
+        if(mInverseTemperature != 1.)
+        {
+            result.first = pow(result.first, mInverseTemperature);
+            result.second *= mInverseTemperature;
+        }
+        return result;
+    }
     else return QPair<double, double>();
 
 }
 
+/**
+ *  @brief Likelihood of a combination : the product of the sub-dates likelihoods, accumulated in log space.
+ *  The result itself may underflow for several narrow dates : ratios of likelihoods must use getLogLikelyhoodRatio.
+ */
+double Date::getCombinedLikelyhood(const double& t) const
+{
+    double logSum = 0.;
+    for(int i=0; i<mSubDates.size(); ++i)
+    {
+        const Date& subDate = mSubDates.at(i);
+        if(!subDate.mPlugin)
+            return 0.;
+        logSum += log(subDate.mPlugin->getLikelyhood(t, subDate.mData));
+    }
+    return exp(logSum);
+}
+
+/**
+ *  @brief Untempered log-likelihood : the product of the sub-dates likelihoods for a combination.
+ *  Computed from getLikelyhoodArg when the plugin offers it, so that it never takes the log of an underflowed likelihood.
+ */
+double Date::getLogLikelyhood(const double& t) const
+{
+    if(!mSubDates.isEmpty())
+    {
+        double logL = 0.;
+        for(int i=0; i<mSubDates.size(); ++i)
+            logL += mSubDates.at(i).getLogLikelyhood(t);
+        return logL;
+    }
+    if(!mPlugin)
+        return 0.;
+    
+    if(mPlugin->withLikelyhoodArg())
+    {
+        const QPair<double, double> arg = mPlugin->getLikelyhoodArg(t, mData);
+        return arg.second - 0.5 * log(arg.first);
+    }
+    return log(mPlugin->getLikelyhood(t, mData));
+}
+
+/**
+ *  @brief Tempered log of getLikelyhood(tNew) / getLikelyhood(tOld), which stays finite when both likelihoods underflow
+ */
+double Date::getLogLikelyhoodRatio(const double& tNew, const double& tOld) const
+{
+    return mInverseTemperature * (getLogLikelyhood(tNew) - getLogLikelyhood(tOld));
+}
+
+/**
+ *  @brief Combined likelihood on the grid tmin + i * step, up to a constant factor.
+ *  Each sub-date is evaluated into a buffer, then the logarithms are accumulated over the whole grid :
+ *  the product never underflows, whatever the number of sub-dates.
+ */
+void Date::computeCombinedLikelyhoods(const double tmin, const double step, QVector<double>& likelyhoods) const
+{
+    const int n = likelyhoods.size();
+    QVector<double> values(n);
+    QVector<double> logSum(n, 0.);
+    
+    for(int k=0; k<mSubDates.size(); ++k)
+    {
+        const Date& subDate = mSubDates.at(k);
+        if(!subDate.mPlugin)
+        {
+            likelyhoods.fill(0.);
+            return;
+        }
+        for(int i=0; i<n; ++i)
+            values[i] = subDate.mPlugin->getLikelyhood(tmin + (double)i * step, subDate.mData);
+        
+        log_accumulate(logSum.data(), values.constData(), n);
+    }
+    
+    exp_from_log(logSum.data(), n);
+    likelyhoods = logSum;
+}
+
 QString Date::getDesc() const
 {
     if(mPlugin)
@@ -293,14 +415,23 @@ void Date::reset()
     mTheta.reset();
     mSigma.reset();
     mCalibration.clear();
+    mCalibOffset = 0;
     mRepartition.clear();
+    mGuideTable.clear();
+    mProposalQ1.clear();
     mWiggle.reset();
 }
 
 void Date::calibrate(const ProjectSettings& settings)
 {
+    // Includes the wait for an identical date calibrated by another thread
+    TRACE_SCOPE(trace, "calibration", getName());
+    
     mCalibration.clear();
+    mCalibOffset = 0;
     mRepartition.clear();
+    mGuideTable.clear();
+    mProposalQ1.clear();
     mCalibHPD.clear();
     mSettings = settings;
     mCalibSum = 0;
@@ -308,28 +439,86 @@ void Date::calibrate(const ProjectSettings& settings)
     double tmin = mSettings.mTmin;
     double tmax = mSettings.mTmax;
     double step = mSettings.mStep;
-    double nbPts = 1 + round((tmax - tmin) / step);
+    int nbPts = 1 + (int)round((tmax - tmin) / step);
   //  qDebug()<<" Date::calibrate"<<tmin<<tmax<<step<<nbPts<<"size"<<mCalibration.size();
-    mCalibration.reserve(nbPts);
-    mRepartition.reserve(nbPts);
     
-    if(true) //mSubDates.size() == 0) // not a combination !
+    // Identical measurements share the same calibration (tempered replicas never calibrate)
+    const bool shared = (mPlugin != 0) && (mInverseTemperature == 1.);
+    // Released on any exit, unless the curve is inserted
+    CalibrationReservation reservation;
+    if(shared)
+    {
+        CalibrationCurve curve;
+        if(reservation.findOrReserve(CalibrationStore::getKey(*this, mSettings), curve))
+        {
+            mCalibration = curve.mCalibration;
+            mCalibOffset = curve.mCalibOffset;
+            mCalibSum = curve.mCalibSum;
+            mRepartition = curve.mRepartition;
+            mGuideTable = curve.mGuideTable;
+            mProposalQ1 = curve.mProposalQ1;
+            return;
+        }
+    }
+    
     {
-        double v = getLikelyhood(tmin);
-        double lastRepVal = v;
+        // The likelihood is first evaluated on the whole study period,
+        // then only its support is kept (with a null point on each side when available)
+        QVector<double> likelyhoods(nbPts);
+        if(mSubDates.isEmpty())
+        {
+            for(int i = 0; i < nbPts; ++i)
+                likelyhoods[i] = getLikelyhood(tmin + (double)i * step);
+        }
+        else
+        {
+            // Combination : the scale of the product does not matter, the calibration is normalized below
+            computeCombinedLikelyhoods(tmin, step, likelyhoods);
+            if(mInverseTemperature != 1.)
+            {
+                for(int i = 0; i < nbPts; ++i)
+                    likelyhoods[i] = pow(likelyhoods[i], mInverseTemperature);
+            }
+        }
         
-        mCalibration.append(v);
-        mRepartition.append(0);
-        mCalibSum += v;
+        double maxValue = 0.;
+        for(int i = 0; i < nbPts; ++i)
+        {
+            mCalibSum += likelyhoods[i];
+            maxValue = qMax(maxValue, likelyhoods[i]);
+        }
+        
+        if(maxValue <= 0.)
+            return;
         
-        for(int i = 1; i < nbPts; ++i)
+        const double threshold = maxValue * DATE_CALIB_TOLERANCE;
+        int first = 0;
+        while(likelyhoods[first] < threshold)
+            ++first;
+        int last = nbPts - 1;
+        while(likelyhoods[last] < threshold)
+            --last;
+        
+        first = qMax(0, first - 1);
+        last = qMin(nbPts - 1, last + 1);
+        for(int i=first; i<=last; ++i)
         {
-            double t = tmin + (double)i * step;
-            
-            float lastV = v;
-            v = getLikelyhood(t);
-            mCalibration.append(v);
-            mCalibSum += v;
+            if(likelyhoods[i] < threshold)
+                likelyhoods[i] = 0.;
+        }
+        
+        mCalibOffset = first;
+        mCalibration = likelyhoods.mid(first, last - first + 1);
+        likelyhoods.clear();
+        
+        const int n = mCalibration.size();
+        mRepartition.reserve(n);
+        mRepartition.append(0);
+        double lastRepVal = 0.;
+        for(int i = 1; i < n; ++i)
+        {
+            const double lastV = mCalibration.at(i-1);
+            const double v = mCalibration.at(i);
             
             double rep = lastRepVal;
             if(v != 0 && lastV != 0)
@@ -346,13 +535,36 @@ void Date::calibrate(const ProjectSettings& settings)
         // La courbe de calibration est transformée de sorte que l'aire sous la courbe soit 1
         mCalibration = equal_areas(mCalibration, step, 1.);
           //  qDebug()<<" Date::calibrate end"<<tmin<<tmax<<step<<nbPts<<"size"<<mCalibration.size();
+        
+        buildInversionTables();
     }
-    else
+    
+    if(shared)
     {
-        // TODO : combination
+        CalibrationCurve curve;
+        curve.mCalibration = mCalibration;
+        curve.mCalibOffset = mCalibOffset;
+        curve.mCalibSum = mCalibSum;
+        curve.mRepartition = mRepartition;
+        curve.mGuideTable = mGuideTable;
+        curve.mProposalQ1 = mProposalQ1;
+        reservation.insert(curve);
     }
 }
 
+/**
+ *  @brief Bounds of the stored support of the calibrated density
+ */
+double Date::getCalibTmin() const
+{
+    return mSettings.mTmin + mCalibOffset * mSettings.mStep;
+}
+
+double Date::getCalibTmax() const
+{
+    return mSettings.mTmin + (mCalibOffset + mCalibration.size() - 1) * mSettings.mStep;
+}
+
 QMap<double, double> Date::getCalibMap() const
 {
    /* QMap<double, double> map;
@@ -365,95 +577,88 @@ QMap<double, double> Date::getCalibMap() const
     return map;
 
     */
-    return vector_to_map(mCalibration, mSettings.mTmin, mSettings.mTmax, mSettings.mStep);
-}
-
-QPixmap Date::generateCalibThumb()
-{
-    if(mIsValid){
-        //  No need to draw the graph on a large size
-        //  These values are arbitary
-        QSize size(200, 30);
-        QPixmap thumb(size);
-        
-        QPainter p;
-        p.begin(&thumb);
-        p.setRenderHint(QPainter::Antialiasing);
-        
-        double tmin = mSettings.mTmin;
-        double tmax = mSettings.mTmax;
-        // qDebug()<<" Date::generateCalibThumb"<<tmin<<tmax<<mSettings.mStep;
-        GraphView graph;
-        graph.setFixedSize(size);
-        graph.setMargins(0, 0, 0, 0);
-        
-        graph.setRangeX(tmin, tmax);
-        graph.setCurrentX(tmin, tmax);
-        graph.setRangeY(0, 1.1f);
-        
-        graph.showXAxisArrow(false);
-        graph.showXAxisTicks(false);
-        graph.showXAxisSubTicks(false);
-        graph.showXAxisValues(false);
-        
-        graph.showYAxisArrow(false);
-        graph.showYAxisTicks(false);
-        graph.showYAxisSubTicks(false);
-        graph.showYAxisValues(false);
-        
-        graph.setXAxisMode(GraphView::eHidden);
-        graph.setYAxisMode(GraphView::eHidden);
-        
-        QColor color = mPlugin->getColor();//  Painting::mainColorLight;
-        
-        GraphCurve curve;
-        curve.mData = normalize_map(getCalibMap());
-        curve.mName = "Calibration";
-        curve.mPen = QPen(color, 2.f);
-        curve.mBrush = color;
-        curve.mIsHisto = false;
-        curve.mIsRectFromZero = true; // For Typo !!
-        
-        graph.addCurve(curve);
-        graph.repaint();
-        
-        graph.render(&p);
-        p.end();
-        
-        return thumb;
-    }
-    else{
-        // If date is invalid, return a null pixmap!
-        return QPixmap();
-    }
-    
-    //thumb.save("test.png");
-    //thumb = graph.grab();
-    
+    if(mCalibration.isEmpty())
+        return QMap<double, double>();
+    return vector_to_map(mCalibration, getCalibTmin(), getCalibTmax(), mSettings.mStep);
 }
 
 double Date::getLikelyhoodFromCalib(const double t)
 {
-    double tmin = mSettings.mTmin;
-    double tmax = mSettings.mTmax;
-    
     // We need at least two points to interpolate
-    if(mCalibration.size() < 2 || t < tmin || t > tmax)
+    if(mCalibration.size() < 2)
+        return 0;
+    
+    // Out of the stored support, the density is null
+    double idx = (t - getCalibTmin()) / mSettings.mStep;
+    if(idx < 0 || idx > mCalibration.size() - 1)
         return 0;
     
-    double prop = (t - tmin) / (tmax - tmin);
-    double idx = prop * (mCalibration.size() - 1); // tricky : if (tmax - tmin) = 2000, then calib size is 2001 !
-    int idxUnder = (int)floor(idx);
+    int idxUnder = qMin((int)floor(idx), mCalibration.size() - 2);
     int idxUpper = idxUnder + 1;
     
     // Important pour le créneau : pas d'interpolation autour des créneaux!
+    // (const access : the vector may be shared with other dates, see CalibrationStore)
     double v = 0.;
-    if(mCalibration[idxUnder] != 0 && mCalibration[idxUpper] != 0)
-        v = interpolate(idx, (double)idxUnder, (double)idxUpper, mCalibration[idxUnder], mCalibration[idxUpper]);
+    const double vUnder = mCalibration.at(idxUnder);
+    const double vUpper = mCalibration.at(idxUpper);
+    if(vUnder != 0 && vUpper != 0)
+        v = interpolate(idx, (double)idxUnder, (double)idxUpper, vUnder, vUpper);
     return v;
 }
 
 
+/**
+ *  @brief Tables used by fInversion : a guide table over mRepartition, with as many entries as grid steps,
+ *  and the calibrated part of the proposal density on each grid step.
+ *  Both only cover the stored support : their indexes are relative to mCalibOffset.
+ */
+void Date::buildInversionTables()
+{
+    mGuideTable.clear();
+    mProposalQ1.clear();
+    
+    const int n = mRepartition.size();
+    if(n < 2)
+        return;
+    
+    const double step = mSettings.mStep;
+    
+    mProposalQ1.resize(n - 1);
+    for(int i=0; i<n-1; ++i)
+        mProposalQ1[i] = (mRepartition.at(i+1) - mRepartition.at(i)) / step;
+    
+    // mGuideTable[k] is the first grid step whose repartition goes over k / m
+    const int m = n - 1;
+    mGuideTable.resize(m);
+    int i = 0;
+    for(int k=0; k<m; ++k)
+    {
+        const double u = (double)k / m;
+        while(i < n-2 && mRepartition.at(i+1) <= u)
+            ++i;
+        mGuideTable[k] = i;
+    }
+}
+
+/**
+ *  @brief Same result as vector_interpolate_idx_for_value(u, mRepartition),
+ *  but the guide table leaves about one step to walk instead of a dichotomy.
+ *  The index is relative to the stored support : the date is getCalibTmin() + idx * mSettings.mStep.
+ */
+double Date::getIdxFromRepartition(const double u) const
+{
+    const int m = mGuideTable.size();
+    if(m == 0)
+        return vector_interpolate_idx_for_value(u, mRepartition);
+    
+    int i = mGuideTable[qBound(0, (int)(u * m), m - 1)];
+    while(i < m-1 && mRepartition[i+1] <= u)
+        ++i;
+    
+    const double valueInf = mRepartition[i];
+    const double valueSup = mRepartition[i+1];
+    return (double)i + (u - valueInf) / (valueSup - valueInf);
+}
 
 
 void Date::updateTheta(Event* event)
@@ -504,7 +709,7 @@ void Date::initDelta(Event*)
             //mDelta = event->mTheta.mX - mTheta.mX;
             double tmin = mSettings.mTmin;
             double tmax = mSettings.mTmax;
-            mDelta = Generator::gaussByDoubleExp(mDeltaAverage,mDeltaError,tmin, tmax);
+            mDelta = TruncatedNormal::sample(mDeltaAverage,mDeltaError,tmin, tmax);
             break;
         }
         case eDeltaFixed:
@@ -524,7 +729,7 @@ void Date::updateDelta(Event* event)
         {
            double lambdai = event->mTheta.mX - mTheta.mX;
 
-            mDelta = Generator::gaussByDoubleExp(lambdai,mSigma.mX,mDeltaMin, mDeltaMax);
+            mDelta = TruncatedNormal::sample(lambdai,mSigma.mX,mDeltaMin, mDeltaMax);
             break;
         }
         case eDeltaGaussian:
@@ -532,7 +737,7 @@ void Date::updateDelta(Event* event)
             double lambdai = event->mTheta.mX - mTheta.mX;
             double w = (1/(mSigma.mX * mSigma.mX)) + (1/(mDeltaError * mDeltaError));
             double deltaAvg = (lambdai / (mSigma.mX * mSigma.mX) + mDeltaAverage / (mDeltaError * mDeltaError)) / w;
-            double x = Generator::gaussByBoxMuller(0, 1);
+            double x = Generator::gauss(0, 1);
             double delta = deltaAvg + x / sqrt(w);
             
             mDelta = delta;
@@ -558,7 +763,7 @@ void Date::updateSigma(Event* event)
     const int logVMax = 100;
     
     double V1 = mSigma.mX * mSigma.mX;
-    double logV2 = Generator::gaussByBoxMuller(log10(V1), mSigma.mSigmaMH);
+    double logV2 = Generator::gauss(log10(V1), mSigma.mSigmaMH);
     double V2 = pow(10, logV2);
     
     double rapport = 0;
@@ -656,11 +861,65 @@ QStringList Date::toCSV(QLocale csvLocale) const
 }
 
 #pragma mark sampling ti function
+/**
+ *  @brief When every sub-date has a linear gaussian likelihood (mA = 0), the combined likelihood is
+ *  a gaussian of the date itself : measure = t, with the summed precisions.
+ */
+bool Date::getCombinedGaussianLikelyhood(GaussianLikelyhood& likelyhood) const
+{
+    double precision = 0.;
+    double weightedSum = 0.;
+    for(int i=0; i<mSubDates.size(); ++i)
+    {
+        const Date& subDate = mSubDates.at(i);
+        if(!subDate.mPlugin || !subDate.mPlugin->withGaussianLikelyhood(subDate.mData))
+            return false;
+        
+        const GaussianLikelyhood sub = subDate.mPlugin->getGaussianLikelyhood(subDate.mData);
+        if(sub.mA != 0 || sub.mB == 0 || sub.mError <= 0)
+            return false;
+        
+        const double variance = sub.mError * sub.mError;
+        precision += sub.mB * sub.mB / variance;
+        weightedSum += sub.mB * (sub.mMeasure - sub.mC) / variance;
+    }
+    if(precision <= 0)
+        return false;
+    
+    likelyhood = GaussianLikelyhood();
+    likelyhood.mMeasure = weightedSum / precision;
+    likelyhood.mError = 1. / sqrt(precision);
+    likelyhood.mA = 0.;
+    likelyhood.mB = 1.;
+    likelyhood.mC = 0.;
+    return true;
+}
+
 void Date::autoSetTiSampler(const bool bSet)
 {
     // define sampling function
     // select if using getLikelyhooArg is possible, it's a faster way
     
+    // When g(t) is linear, the likelihood is gaussian in t : whatever the method, the full conditional of ti is
+    // the product of two gaussians and is sampled directly
+    if (bSet && !mSubDates.isEmpty()) {
+        // A product of gaussians in t is a gaussian in t
+        GaussianLikelyhood likelyhood;
+        if (getCombinedGaussianLikelyhood(likelyhood)) {
+            mGaussianLikelyhood = likelyhood;
+            updateti = fGibbsGaussian;
+            return;
+        }
+    }
+    else if (bSet && mPlugin!= 0 && mPlugin->withGaussianLikelyhood(mData)) {
+        const GaussianLikelyhood likelyhood = mPlugin->getGaussianLikelyhood(mData);
+        if (likelyhood.mA == 0 && likelyhood.mError > 0) {
+            mGaussianLikelyhood = likelyhood;
+            updateti = fGibbsGaussian;
+            return;
+        }
+    }
+    
     if (bSet && mPlugin!= 0 && mPlugin->withLikelyhoodArg()) {
          //   if (false) {
         switch(mMethod)
@@ -735,14 +994,14 @@ void fMHSymetric(Date* date,Event* event)
         // Ici, le marcheur est forcément gaussien avec H(theta i) : double_exp (gaussien tronqué)
       /*   double tmin = date->mSettings.mTmin;
         double tmax = date->mSettings.mTmax;
-         double theta = Generator::gaussByDoubleExp(event->mTheta.mX - date->mDelta, date->mSigma.mX, tmin, tmax);
+         double theta = TruncatedNormal::sample(event->mTheta.mX - date->mDelta, date->mSigma.mX, tmin, tmax);
          //rapport = G(theta_new) / G(theta_old)
          double rapport = date->getLikelyhoodFromCalib(theta) / date->getLikelyhoodFromCalib(date->mTheta.mX);
          date->mTheta.tryUpdate(theta, rapport);
     */
    
-        double tiNew = Generator::gaussByBoxMuller(event->mTheta.mX - date->mDelta, date->mSigma.mX);
-        double rapport = date->getLikelyhood(tiNew) / date->getLikelyhood(date->mTheta.mX);
+        double tiNew = Generator::gauss(event->mTheta.mX - date->mDelta, date->mSigma.mX);
+        double rapport = exp(date->getLogLikelyhoodRatio(tiNew, date->mTheta.mX));
         
         date->mTheta.tryUpdate(tiNew, rapport);
      
@@ -756,7 +1015,7 @@ void fMHSymetric(Date* date,Event* event)
 void fMHSymetricWithArg(Date* date,Event* event)
 {
     
-    double tiNew = Generator::gaussByBoxMuller(event->mTheta.mX - date->mDelta, date->mSigma.mX);
+    double tiNew = Generator::gauss(event->mTheta.mX - date->mDelta, date->mSigma.mX);
     
     QPair<double, double> argOld, argNew;
     
@@ -780,15 +1039,20 @@ double fProposalDensity(const double t, Date* date)
     double level = date->mMixingLevel;
     double q1= 0;
 
-    /// ----q1------Defined only on study period-----
+    /// ----q1------Defined only on the calibration support-----
     if (t>tmin && t<tmax) {
-      
-        double prop = (t - tmin) / (tmax - tmin);
-        double idx = prop * (date->mRepartition.size() - 1);
+        
+        double idx = (t - date->getCalibTmin()) / date->mSettings.mStep;
         int idxUnder = (int)floor(idx);
         
-        double step =(tmax-tmin+1)/date->mRepartition.size();
-        q1= (date->mRepartition[idxUnder+1]-date->mRepartition[idxUnder])/step;
+        if (date->mProposalQ1.isEmpty()) {
+            if (idxUnder >= 0 && idxUnder < date->mRepartition.size() - 1)
+                q1= (date->mRepartition.at(idxUnder+1)-date->mRepartition.at(idxUnder))/date->mSettings.mStep;
+        }
+        else if (idxUnder >= 0 && idxUnder < date->mProposalQ1.size()) {
+            // tabulated by Date::buildInversionTables
+            q1= date->mProposalQ1.at(idxUnder);
+        }
     }
     /// ----q2 shrinkage-----------
     /*double t0 =(tmax+tmin)/2;
@@ -819,16 +1083,15 @@ void fInversion(Date* date, Event* event)
     double tmax = date->mSettings.mTmax;
     
     if (u1<level) { // tiNew always in the study period
-        double idx = vector_interpolate_idx_for_value(u1, date->mRepartition);
-        double step =(tmax-tmin+1)/date->mRepartition.size();
-        tiNew = tmin + idx * step;
+        double idx = date->getIdxFromRepartition(u1);
+        tiNew = date->getCalibTmin() + idx * date->mSettings.mStep;
     }
     else {
         // -- gaussian
         double t0 =(tmax+tmin)/2;
         double s = (tmax-tmin)/2;
         
-        tiNew=Generator::gaussByBoxMuller(t0, s);
+        tiNew=Generator::gauss(t0, s);
         /*
         // -- double shrinkage
         double u2 = Generator::randomUniform();
@@ -847,15 +1110,16 @@ void fInversion(Date* date, Event* event)
         */
     }
              
-    double rapport1 = date->getLikelyhood(tiNew) / date->getLikelyhood(date->mTheta.mX);
+    // Likelihood and gaussian ratios are combined in log space
+    double logRapport1 = date->getLogLikelyhoodRatio(tiNew, date->mTheta.mX);
     
-    double rapport2= exp((-0.5/(date->mSigma.mX * date->mSigma.mX)) * (   pow(tiNew - (event->mTheta.mX - date->mDelta), 2)
+    double logRapport2= (-0.5/(date->mSigma.mX * date->mSigma.mX)) * (   pow(tiNew - (event->mTheta.mX - date->mDelta), 2)
                                                                   - pow(date->mTheta.mX - (event->mTheta.mX - date->mDelta), 2)
-                                                                ));
+                                                                );
     
     double rapport3= fProposalDensity(date->mTheta.mX,date) / fProposalDensity(tiNew,date);
     
-    date->mTheta.tryUpdate(tiNew, rapport1*rapport2*rapport3);
+    date->mTheta.tryUpdate(tiNew, exp(logRapport1 + logRapport2) * rapport3);
 }
 void fInversionWithArg(Date* date, Event* event)
 {
@@ -867,16 +1131,15 @@ void fInversionWithArg(Date* date, Event* event)
     
     if (u1<level) { // tiNew always in the study period
         double u2 = Generator::randomUniform();
-        double idx = vector_interpolate_idx_for_value(u2, date->mRepartition);
-        double step =(tmax-tmin+1)/date->mRepartition.size();
-        tiNew = tmin + idx * step;
+        double idx = date->getIdxFromRepartition(u2);
+        tiNew = date->getCalibTmin() + idx * date->mSettings.mStep;
     }
     else {
         // -- gaussian
         double t0 =(tmax+tmin)/2;
         double s = (tmax-tmin)/2;
         
-        tiNew=Generator::gaussByBoxMuller(t0, s);
+        tiNew=Generator::gauss(t0, s);
         /*
          // -- double shrinkage
          double u2 = Generator::randomUniform();
@@ -927,9 +1190,9 @@ void fMHSymGaussAdapt(Date* date, Event* event)
     //rapport = getLikelyhoodFromCalib(theta) / getLikelyhoodFromCalib(mTheta.mX); // rapport des G(theta i)
     */
     
-    double tiNew = Generator::gaussByBoxMuller(date->mTheta.mX, date->mTheta.mSigmaMH);
-    double rapport = date->getLikelyhood(tiNew) / date->getLikelyhood(date->mTheta.mX);
-    rapport *= exp((-0.5/(date->mSigma.mX * date->mSigma.mX)) * (   pow(tiNew - (event->mTheta.mX - date->mDelta), 2)
+    double tiNew = Generator::gauss(date->mTheta.mX, date->mTheta.mSigmaMH);
+    double rapport = exp(date->getLogLikelyhoodRatio(tiNew, date->mTheta.mX)
+                         + (-0.5/(date->mSigma.mX * date->mSigma.mX)) * (   pow(tiNew - (event->mTheta.mX - date->mDelta), 2)
                                                                   - pow(date->mTheta.mX - (event->mTheta.mX - date->mDelta), 2)
                                                                  ));
     
@@ -944,7 +1207,7 @@ void fMHSymGaussAdapt(Date* date, Event* event)
  */
 void fMHSymGaussAdaptWithArg(Date* date, Event* event)
 {
-    double tiNew = Generator::gaussByBoxMuller(date->mTheta.mX, date->mTheta.mSigmaMH);
+    double tiNew = Generator::gauss(date->mTheta.mX, date->mTheta.mSigmaMH);
     
     QPair<double, double> argOld, argNew;
     
@@ -960,3 +1223,130 @@ void fMHSymGaussAdaptWithArg(Date* date, Event* event)
     
     date->mTheta.tryUpdate(tiNew, rapport);
 }
+
+/**
+ *  @brief Gibbs : G(ti) is a gaussian of mean (measure - c) / b and variance (error / b)^2,
+ *  H(ti) a gaussian of mean theta - delta and variance sigma^2. Every draw is accepted.
+ */
+void fGibbsGaussian(Date* date, Event* event)
+{
+    const GaussianLikelyhood& likelyhood = date->mGaussianLikelyhood;
+    
+    const double precisionH = 1. / (date->mSigma.mX * date->mSigma.mX);
+    // G^beta of a tempered replica is a gaussian of variance (error / b)^2 / beta
+    const double beta = date->mInverseTemperature;
+    const double precisionG = beta * (likelyhood.mB * likelyhood.mB) / (likelyhood.mError * likelyhood.mError);
+    const double precision = precisionG + precisionH;
+    
+    const double center = event->mTheta.mX - date->mDelta;
+    const double mean = (beta * (likelyhood.mMeasure - likelyhood.mC) * likelyhood.mB / (likelyhood.mError * likelyhood.mError)
+                         + center * precisionH) / precision;
+    
+    const double tiNew = Generator::gauss(mean, 1. / sqrt(precision));
+    date->mTheta.tryUpdate(tiNew, 1.);
+}
+
+#pragma mark gaussian batch
+bool DatesGaussBatch::accepts(const Date& date)
+{
+    const samplingFunction sampler = date.getTiSampler();
+    return (date.mPlugin != 0) && date.mSubDates.isEmpty() &&
+           (sampler == fMHSymGaussAdaptWithArg || sampler == fMHSymetricWithArg) &&
+           date.mPlugin->withGaussianLikelyhood(date.mData);
+}
+
+void DatesGaussBatch::clear()
+{
+    mDates.clear();
+    mEvents.clear();
+    mStreamIndexes.clear();
+    mAdaptative.clear();
+    mMeasure.clear();
+    mInvError.clear();
+    mA.clear();
+    mB.clear();
+    mC.clear();
+}
+
+void DatesGaussBatch::append(Date* date, Event* event, const int streamIndex)
+{
+    const GaussianLikelyhood likelyhood = date->mPlugin->getGaussianLikelyhood(date->mData);
+    
+    mDates.append(date);
+    mEvents.append(event);
+    mStreamIndexes.append(streamIndex);
+    mAdaptative.append(date->getTiSampler() == fMHSymGaussAdaptWithArg);
+    mMeasure.append(likelyhood.mMeasure);
+    mInvError.append(1. / likelyhood.mError);
+    mA.append(likelyhood.mA);
+    mB.append(likelyhood.mB);
+    mC.append(likelyhood.mC);
+    
+    const int n = mDates.size();
+    mTOld.resize(n);
+    mTNew.resize(n);
+    mCenter.resize(n);
+    mHalfInvVariance.resize(n);
+    mLogRapport.resize(n);
+    mInverseTemperature.resize(n);
+}
+
+/**
+ *  @brief Same acceptance rates as fMHSymGaussAdaptWithArg and fMHSymetricWithArg :
+ *  the variance of the likelihood does not depend on t, so the ratio only depends on the exponents.
+ */
+void DatesGaussBatch::updateTheta(QVector<RandomStream>& streams)
+{
+    const int n = mDates.size();
+    
+    // Proposals : draws are sequential
+    for(int i=0; i<n; ++i)
+    {
+        Date* date = mDates[i];
+        Generator::setThreadStream(&streams[mStreamIndexes[i]]);
+        
+        mTOld[i] = date->mTheta.mX;
+        mCenter[i] = mEvents[i]->mTheta.mX - date->mDelta;
+        mInverseTemperature[i] = date->mInverseTemperature;
+        if(mAdaptative[i])
+        {
+            mTNew[i] = Generator::gauss(date->mTheta.mX, date->mTheta.mSigmaMH);
+            mHalfInvVariance[i] = 0.5 / (date->mSigma.mX * date->mSigma.mX);
+        }
+        else
+        {
+            // The proposal is the prior : H does not appear in the ratio
+            mTNew[i] = Generator::gauss(mCenter[i], date->mSigma.mX);
+            mHalfInvVariance[i] = 0.;
+        }
+    }
+    
+    // log(G(ti_new) / G(ti_old)) + log(H(ti_new) / H(ti_old)) : no branch, no call
+    const double* tOld = mTOld.constData();
+    const double* tNew = mTNew.constData();
+    const double* center = mCenter.constData();
+    const double* halfInvVariance = mHalfInvVariance.constData();
+    const double* measure = mMeasure.constData();
+    const double* invError = mInvError.constData();
+    const double* a = mA.constData();
+    const double* b = mB.constData();
+    const double* c = mC.constData();
+    const double* beta = mInverseTemperature.constData();
+    double* logRapport = mLogRapport.data();
+    
+    for(int i=0; i<n; ++i)
+    {
+        const double zOld = (measure[i] - (a[i] * tOld[i] * tOld[i] + b[i] * tOld[i] + c[i])) * invError[i];
+        const double zNew = (measure[i] - (a[i] * tNew[i] * tNew[i] + b[i] * tNew[i] + c[i])) * invError[i];
+        const double dOld = tOld[i] - center[i];
+        const double dNew = tNew[i] - center[i];
+        logRapport[i] = -0.5 * beta[i] * (zNew * zNew - zOld * zOld) - halfInvVariance[i] * (dNew * dNew - dOld * dOld);
+    }
+    
+    // Acceptations
+    for(int i=0; i<n; ++i)
+    {
+        Generator::setThreadStream(&streams[mStreamIndexes[i]]);
+        mDates[i]->mTheta.tryUpdate(mTNew[i], exp(mLogRapport[i]));
+    }
+}
@@ -4,11 +4,13 @@
 #include "MHVariable.h"
 #include "StateKeys.h"
 #include "ProjectSettings.h"
+#include "Generator.h"
 
 #include <QMap>
 #include <QJsonObject>
 #include <QString>
-#include <QPixmap>
+#include <QColor>
+#include <QVector>
 
 class Event;
 class PluginAbstract;
@@ -24,8 +26,22 @@ void fMHSymetricWithArg(Date* date, Event* event);
 void fMHSymGaussAdaptWithArg(Date* date, Event* event);
 void fInversionWithArg(Date* date, Event* event);
 
+void fGibbsGaussian(Date* date, Event* event);
+
 double fProposalDensity(const double t,Date* date);
 
+// Calibrated densities are only stored where they are above this fraction of their maximum
+#define DATE_CALIB_TOLERANCE 1e-8
+
+// Closed-form likelihood offered by some plugins : the measure is gaussian around g(t) = a.t^2 + b.t + c
+struct GaussianLikelyhood
+{
+    double mMeasure;
+    double mError;
+    double mA;
+    double mB;
+    double mC;
+};
 
 
 class Date
@@ -64,18 +80,27 @@ public:
     
     double getLikelyhood(const double& t);
     QPair<double, double > getLikelyhoodArg(const double& t);
+    double getCombinedLikelyhood(const double& t) const;
+    double getLogLikelyhood(const double& t) const;
+    double getLogLikelyhoodRatio(const double& tNew, const double& tOld) const;
+    void computeCombinedLikelyhoods(const double tmin, const double step, QVector<double>& likelyhoods) const;
+    bool getCombinedGaussianLikelyhood(GaussianLikelyhood& likelyhood) const;
     QString getDesc() const;
     
     void reset();
     void calibrate(const ProjectSettings& settings);
     double getLikelyhoodFromCalib(const double t);
+    void buildInversionTables();
+    double getIdxFromRepartition(const double u) const;
+    double getCalibTmin() const;
+    double getCalibTmax() const;
     QMap<double, double> getCalibMap() const;
-    QPixmap generateCalibThumb();
     
     void initDelta(Event* event);
     
     void updateTheta(Event* event);
     void autoSetTiSampler(const bool bSet);
+    samplingFunction getTiSampler() const {return updateti;}
     
     void updateDelta(Event* event);
     void updateSigma(Event* event);
@@ -111,14 +136,27 @@ public:
     bool mIsCurrent;
     bool mIsSelected;
     
+    // mCalibration and mRepartition only cover the support of the calibrated density :
+    // mCalibration[i] is the density at mSettings.mTmin + (mCalibOffset + i) * mSettings.mStep.
+    // Outside, the density is null and the repartition is 0 before and 1 after.
     QVector<double> mCalibration;
+    int mCalibOffset;
     double mCalibSum;
     QVector<double> mRepartition;
+    // Inversion sampling tables built from mRepartition (see buildInversionTables)
+    QVector<int> mGuideTable;
+    QVector<double> mProposalQ1;
     QMap<double, double> mCalibHPD;
     ProjectSettings mSettings;
     
     QList<Date> mSubDates;
     
+    // Likelihood used by fGibbsGaussian (see autoSetTiSampler)
+    GaussianLikelyhood mGaussianLikelyhood;
+    
+    // Parallel tempering : the likelihood is raised to this power (1 for the cold chain)
+    double mInverseTemperature;
+    
     const QJsonObject * mJsonEvent;
     double mMixingLevel;
 protected:
@@ -133,4 +171,44 @@ protected:
 
 };
 
+
+/**
+ * @brief Samples the theta of several dates at once, when their plugin offers a closed-form gaussian likelihood
+ * and they are sampled by fMHSymGaussAdaptWithArg or fMHSymetricWithArg.
+ * The acceptance rates are computed on contiguous arrays, so that the compiler can vectorize them.
+ * Each date draws from its own stream : the results do not depend on how dates are grouped.
+ */
+class DatesGaussBatch
+{
+public:
+    static bool accepts(const Date& date);
+    
+    void clear();
+    void append(Date* date, Event* event, const int streamIndex);
+    int size() const {return mDates.size();}
+    
+    void updateTheta(QVector<RandomStream>& streams);
+    
+private:
+    QVector<Date*> mDates;
+    QVector<Event*> mEvents;
+    QVector<int> mStreamIndexes;
+    QVector<bool> mAdaptative; // fMHSymGaussAdaptWithArg, else fMHSymetricWithArg
+    
+    // Likelihood parameters
+    QVector<double> mMeasure;
+    QVector<double> mInvError;
+    QVector<double> mA;
+    QVector<double> mB;
+    QVector<double> mC;
+    
+    // Work arrays
+    QVector<double> mTOld;
+    QVector<double> mTNew;
+    QVector<double> mCenter;
+    QVector<double> mHalfInvVariance;
+    QVector<double> mInverseTemperature;
+    QVector<double> mLogRapport;
+};
+
 #endif
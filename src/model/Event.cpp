@@ -3,6 +3,7 @@
 #include "EventConstraint.h"
 #include "PhaseConstraint.h"
 #include "Generator.h"
+#include "TruncatedNormal.h"
 #include "StdUtilities.h"
 #include "EventKnown.h"
 #include "ModelUtilities.h"
@@ -12,6 +13,8 @@
 #include <QObject>
 #include <QDebug>
 #include <QJsonObject>
+#include <QSet>
+#include <QVector>
 
 Event::Event():
 mType(eDefault),
@@ -98,8 +101,6 @@ void Event::setModelJson(const QJsonObject & iModelJson, const int idxEvent)
 {
     mModelJson = &iModelJson;
     mJsonEventIdx=idxEvent;
-    QJsonObject jEvent =(*mModelJson)[STATE_EVENTS].toArray().at(mJsonEventIdx).toObject();
-    //qDebug()<<"Event::setModelJson"<<jEvent[STATE_NAME].toString();
 }
 
 const QJsonObject * Event::getModelJson()
@@ -244,31 +245,32 @@ void Event::reset()
     mInitialized = false;
 }
 
-double Event::getThetaMinRecursive(double defaultValue,
-                                   const QVector<QVector<Event*> >& eventBranches,
-                                   const QVector<QVector<Phase*> >& phaseBranches)
+double Event::getThetaMinRecursive(double defaultValue)
 {
     // ------------------------------------------------------------------
     //  Déterminer la borne min courante pour le tirage de theta
     // ------------------------------------------------------------------
     double min1 = defaultValue;
     
-    // Max des thetas des faits en contrainte directe antérieure
+    // Max des thetas des faits initialisés en contrainte antérieure (directe ou non)
     double min2 = defaultValue;
-    for(int i=0; i<eventBranches.size(); ++i)
+    QSet<const Event*> visitedEvents;
+    QVector<const Event*> eventsToVisit;
+    eventsToVisit.append(this);
+    while(!eventsToVisit.isEmpty())
     {
-        const QVector<Event*>& branch = eventBranches[i];
-        double branchMin = defaultValue;
-        for(int j=0; j<branch.size(); ++j)
+        const Event* event = eventsToVisit.last();
+        eventsToVisit.removeLast();
+        for(int i=0; i<event->mConstraintsBwd.size(); ++i)
         {
-            const Event* event = branch[j];
-            if(event == this)
+            const Event* prev = event->mConstraintsBwd[i]->mEventFrom;
+            if(!visitedEvents.contains(prev))
             {
-                min2 = qMax(min2, branchMin);
-                break;
+                visitedEvents.insert(prev);
+                eventsToVisit.append(prev);
+                if(prev->mInitialized)
+                    min2 = qMax(min2, prev->mTheta.mX);
             }
-            if(event->mInitialized)
-                branchMin = qMax(branchMin, event->mTheta.mX);
         }
     }
     
@@ -294,41 +296,43 @@ double Event::getThetaMinRecursive(double defaultValue,
         }
     }
     
-    // Contraintes des phases précédentes
+    // Contraintes des phases précédentes (directes ou non) :
+    // chaque contrainte de phase menant à une de nos phases impose d'être au-dessus
+    // du plus grand theta de sa phase de départ plus son gamma
     double min4 = defaultValue;
-    for(int i=0; i<phaseBranches.size(); ++i)
+    QSet<const Phase*> visitedPhases;
+    QVector<const Phase*> phasesToVisit;
+    for(int i=0; i<mPhases.size(); ++i)
+    {
+        visitedPhases.insert(mPhases[i]);
+        phasesToVisit.append(mPhases[i]);
+    }
+    while(!phasesToVisit.isEmpty())
     {
-        const QVector<Phase*>& branch = phaseBranches[i];
-        double branchMin = defaultValue;
-        for(int j=0; j<branch.size(); ++j)
+        const Phase* phase = phasesToVisit.last();
+        phasesToVisit.removeLast();
+        for(int i=0; i<phase->mConstraintsBwd.size(); ++i)
         {
-            const Phase* phase = branch[j];
-            if(phase->mEvents.contains(this))
-            {
-                min4 = qMax(min4, branchMin);
-                break;
-            }
+            const PhaseConstraint* c = phase->mConstraintsBwd[i];
+            const Phase* prev = c->mPhaseFrom;
             double theta = defaultValue;
-            for(int k=0; k<phase->mEvents.size(); ++k)
+            for(int k=0; k<prev->mEvents.size(); ++k)
             {
-                if(phase->mEvents[k]->mInitialized)
+                if(prev->mEvents[k]->mInitialized)
                 {
-                    theta = std::max(theta, phase->mEvents[k]->mTheta.mX);
+                    theta = std::max(theta, prev->mEvents[k]->mTheta.mX);
                 }
             }
-            const PhaseConstraint* c = 0;
-            for(int k=0; k<phase->mConstraintsFwd.size(); ++k)
+            if(c->mGammaType != PhaseConstraint::eGammaUnknown)
+                min4 = std::max(min4, theta + c->mGamma);
+            else
+                min4 = std::max(min4, theta);
+            
+            if(!visitedPhases.contains(prev))
             {
-                if(branch.contains(phase->mConstraintsFwd[k]->mPhaseTo))
-                {
-                    c = phase->mConstraintsFwd[k];
-                    break;
-                }
+                visitedPhases.insert(prev);
+                phasesToVisit.append(prev);
             }
-            if(c && c->mGammaType != PhaseConstraint::eGammaUnknown)
-                branchMin = std::max(branchMin, theta + c->mGamma);
-            else
-                branchMin = std::max(branchMin, theta);
         }
     }
         
@@ -340,9 +344,7 @@ double Event::getThetaMinRecursive(double defaultValue,
     return min;
 }
 
-double Event::getThetaMaxRecursive(double defaultValue,
-                                   const QVector<QVector<Event*> >& eventBranches,
-                                   const QVector<QVector<Phase*> >& phaseBranches)
+double Event::getThetaMaxRecursive(double defaultValue)
 {
     // ------------------------------------------------------------------
     //  Déterminer la borne max courante pour le tirage de theta
@@ -350,22 +352,25 @@ double Event::getThetaMaxRecursive(double defaultValue,
     
     double max1 = defaultValue;
     
-    // Max des thetas des faits en contrainte directe antérieure
+    // Min des thetas des faits initialisés en contrainte postérieure (directe ou non)
     double max2 = defaultValue;
-    for(int i=0; i<eventBranches.size(); ++i)
+    QSet<const Event*> visitedEvents;
+    QVector<const Event*> eventsToVisit;
+    eventsToVisit.append(this);
+    while(!eventsToVisit.isEmpty())
     {
-        const QVector<Event*>& branch = eventBranches[i];
-        double branchMax = defaultValue;
-        for(int j=branch.size()-1; j>=0; --j)
+        const Event* event = eventsToVisit.last();
+        eventsToVisit.removeLast();
+        for(int i=0; i<event->mConstraintsFwd.size(); ++i)
         {
-            const Event* event = branch[j];
-            if(event == this)
+            const Event* next = event->mConstraintsFwd[i]->mEventTo;
+            if(!visitedEvents.contains(next))
             {
-                max2 = qMin(max2, branchMax);
-                break;
+                visitedEvents.insert(next);
+                eventsToVisit.append(next);
+                if(next->mInitialized)
+                    max2 = qMin(max2, next->mTheta.mX);
             }
-            if(event->mInitialized)
-                branchMax = qMin(branchMax, event->mTheta.mX);
         }
     }
     
@@ -391,41 +396,41 @@ double Event::getThetaMaxRecursive(double defaultValue,
         }
     }
     
-    // Contraintes des phases précédentes
+    // Contraintes des phases suivantes (directes ou non)
     double max4 = defaultValue;
-    for(int i=0; i<phaseBranches.size(); ++i)
+    QSet<const Phase*> visitedPhases;
+    QVector<const Phase*> phasesToVisit;
+    for(int i=0; i<mPhases.size(); ++i)
+    {
+        visitedPhases.insert(mPhases[i]);
+        phasesToVisit.append(mPhases[i]);
+    }
+    while(!phasesToVisit.isEmpty())
     {
-        const QVector<Phase*>& branch = phaseBranches[i];
-        double branchMax = defaultValue;
-        for(int j=branch.size()-1; j>=0; --j)
+        const Phase* phase = phasesToVisit.last();
+        phasesToVisit.removeLast();
+        for(int i=0; i<phase->mConstraintsFwd.size(); ++i)
         {
-            const Phase* phase = branch[j];
-            if(phase->mEvents.contains(this))
-            {
-                max4 = qMin(max4, branchMax);
-                break;
-            }
+            const PhaseConstraint* c = phase->mConstraintsFwd[i];
+            const Phase* next = c->mPhaseTo;
             double theta = defaultValue;
-            for(int k=0; k<phase->mEvents.size(); ++k)
+            for(int k=0; k<next->mEvents.size(); ++k)
             {
-                if(phase->mEvents[k]->mInitialized)
+                if(next->mEvents[k]->mInitialized)
                 {
-                    theta = std::min(theta, phase->mEvents[k]->mTheta.mX);
+                    theta = std::min(theta, next->mEvents[k]->mTheta.mX);
                 }
             }
-            const PhaseConstraint* c = 0;
-            for(int k=0; k<phase->mConstraintsBwd.size(); ++k)
+            if(c->mGammaType != PhaseConstraint::eGammaUnknown)
+                max4 = std::min(max4, theta - c->mGamma);
+            else
+                max4 = std::min(max4, theta);
+            
+            if(!visitedPhases.contains(next))
             {
-                if(branch.contains(phase->mConstraintsBwd[k]->mPhaseFrom))
-                {
-                    c = phase->mConstraintsBwd[k];
-                    break;
-                }
+                visitedPhases.insert(next);
+                phasesToVisit.append(next);
             }
-            if(c && c->mGammaType != PhaseConstraint::eGammaUnknown)
-                branchMax = std::min(branchMax, theta - c->mGamma);
-            else
-                branchMax = std::min(branchMax, theta);
         }
     }
     
@@ -583,9 +588,11 @@ void Event::updateTheta(double tmin, double tmax)
     switch(mMethod)
     {
         case eDoubleExp:
+        case eBoxMuller:
         {
+            // Both methods sample the same truncated gaussian : the sampler picks its regime from the interval
             try{
-                double theta = Generator::gaussByDoubleExp(theta_avg, sigma, min, max);
+                double theta = TruncatedNormal::sample(theta_avg, sigma, min, max);
                 mTheta.tryUpdate(theta, 1);
             }
             catch(QString error){
@@ -593,27 +600,10 @@ void Event::updateTheta(double tmin, double tmax)
             }
             break;
         }
-        case eBoxMuller:
-        {
-            double theta;
-            long long counter = 0;
-            do{
-                theta = Generator::gaussByBoxMuller(theta_avg, sigma);
-                ++counter;
-                if(counter == 100000000)
-                {
-                    throw QObject::tr("No MCMC solution could be found using event method ") + ModelUtilities::getEventMethodText(mMethod) + " for event named " + getName() + ". (" + QString::number(counter) + " trials done)";
-                }
-            }while(theta < min || theta > max);
-            
-            //qDebug() << "Event update num trials : " << counter;
-            mTheta.tryUpdate(theta, 1);
-            break;
-        }
         case eMHAdaptGauss:
         {
             // MH : Seul cas où le taux d'acceptation a du sens car on utilise sigma MH :
-            double theta = Generator::gaussByBoxMuller(mTheta.mX, mTheta.mSigmaMH);
+            double theta = Generator::gauss(mTheta.mX, mTheta.mSigmaMH);
             
             double rapport = 0;
             if(theta >= min && theta <= max)
@@ -50,13 +50,9 @@ public:
     
     
     // 2 fonctions utilisées pour l'init du MCMC :
-    double getThetaMinRecursive(double defaultValue,
-                                const QVector<QVector<Event*> >& eventBranches,
-                                const QVector<QVector<Phase*> >& phaseBranches);
-
-    double getThetaMaxRecursive(double defaultValue,
-                                const QVector<QVector<Event*> >& eventBranches,
-                                const QVector<QVector<Phase*> >& phaseBranches);
+    // (parcourent tous les faits et phases en contrainte, directe ou non)
+    double getThetaMinRecursive(double defaultValue);
+    double getThetaMaxRecursive(double defaultValue);
     
     virtual void updateTheta(double min, double max);
     
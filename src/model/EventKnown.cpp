@@ -1,6 +1,5 @@
 #include "EventKnown.h"
 #include "StdUtilities.h"
-#include "GraphView.h"
 #include "Generator.h"
 #include <QObject>
 
@@ -153,6 +152,7 @@ void EventKnown::generateHistos(const QList<Chain>& chains, int fftLen, double h
     */
     mTheta.mHisto.clear();
     mTheta.mChainsHistos.clear();
+    mTheta.mHistosKey = 0;
     switch(mKnownType)
     {
         case eFixed:
@@ -1,17 +1,19 @@
 #include "Model.h"
 #include "Date.h"
-#include "Project.h"
 #include "EventKnown.h"
 #include "MCMCLoopMain.h"
-#include "MCMCProgressDialog.h"
 #include "ModelUtilities.h"
 #include "QtUtilities.h"
 #include "StdUtilities.h"
 #include "DateUtils.h"
-#include "MainWindow.h"
+#include "Trace.h"
 #include "../PluginAbstract.h"
 #include <QJsonArray>
-#include <QtWidgets>
+#include <QHash>
+#include <QBitArray>
+#include <algorithm>
+#include <QtCore>
+#include <QtConcurrent>
 
 
 #pragma mark Constructor...
@@ -68,6 +70,7 @@ void Model::clear()
     mLogModel.clear();
     mLogMCMC.clear();
     mLogResults.clear();
+    mInstrumentation.clear();
 }
 
 /*Model* Model::fromJson(const QJsonObject& json)
@@ -276,13 +279,8 @@ void Model::fromJson(const QJsonObject& json)
                     mEvents.append(e);
                 }
                 catch(QString error){
-                    QMessageBox message(QMessageBox::Critical,
-                                        qApp->applicationName() + " " + qApp->applicationVersion(),
-                                        tr("Error : ") + error,
-                                        QMessageBox::Ok,
-                                        qApp->activeWindow(),
-                                        Qt::Sheet);
-                    message.exec();
+                    // Shown by the caller (no message box here : the model is also loaded by the command line)
+                    throw tr("Error : ") + error;
                 }
                 
                 
@@ -362,54 +360,79 @@ void Model::fromJson(const QJsonObject& json)
     //  Link objects to each other
     //  Must be done here !
     //  nb : Les data sont déjà linkées aux events à leur création
+    //  Events and phases are indexed by id : linking is linear in the model size
     // ------------------------------------------------------------
+    QHash<int, int> phasesIdxById;
+    phasesIdxById.reserve(mPhases.size());
+    for(int j=0; j<mPhases.size(); ++j)
+        phasesIdxById.insert(mPhases[j]->mId, j);
+    
+    QHash<int, Event*> eventsById;
+    eventsById.reserve(mEvents.size());
+    
     for(int i=0; i<mEvents.size(); ++i)
     {
-        int eventId = mEvents[i]->mId;
-        QList<int> phasesIds = mEvents[i]->mPhasesIds;
-
+        eventsById.insert(mEvents[i]->mId, mEvents[i]);
+        
         // Link des events / phases
-        for(int j=0; j<mPhases.size(); ++j)
+        // Phases are linked in mPhases order, as when they were searched phase by phase
+        const QList<int>& phasesIds = mEvents[i]->mPhasesIds;
+        QVector<int> phasesIdx;
+        phasesIdx.reserve(phasesIds.size());
+        for(int j=0; j<phasesIds.size(); ++j)
         {
-            int phaseId = mPhases[j]->mId;
-            if(phasesIds.contains(phaseId))
-            {
-                mEvents[i]->mPhases.append(mPhases[j]);
-                mPhases[j]->mEvents.append(mEvents[i]);
-            }
+            QHash<int, int>::const_iterator iter = phasesIdxById.constFind(phasesIds[j]);
+            if(iter != phasesIdxById.constEnd())
+                phasesIdx.append(iter.value());
         }
-
-        // Link des events / contraintes d'event
-        for(int j=0; j<mEventConstraints.size(); ++j)
+        std::sort(phasesIdx.begin(), phasesIdx.end());
+        phasesIdx.erase(std::unique(phasesIdx.begin(), phasesIdx.end()), phasesIdx.end());
+        
+        for(int j=0; j<phasesIdx.size(); ++j)
         {
-            if(mEventConstraints[j]->mFromId == eventId)
-            {
-                mEventConstraints[j]->mEventFrom = mEvents[i];
-                mEvents[i]->mConstraintsFwd.append(mEventConstraints[j]);
-            }
-            else if(mEventConstraints[j]->mToId == eventId)
-            {
-                mEventConstraints[j]->mEventTo = mEvents[i];
-                mEvents[i]->mConstraintsBwd.append(mEventConstraints[j]);
-            }
+            Phase* phase = mPhases[phasesIdx[j]];
+            mEvents[i]->mPhases.append(phase);
+            phase->mEvents.append(mEvents[i]);
+        }
+    }
+    
+    // Link des events / contraintes d'event
+    for(int j=0; j<mEventConstraints.size(); ++j)
+    {
+        EventConstraint* constraint = mEventConstraints[j];
+        
+        Event* eventFrom = eventsById.value(constraint->mFromId, 0);
+        if(eventFrom)
+        {
+            constraint->mEventFrom = eventFrom;
+            eventFrom->mConstraintsFwd.append(constraint);
+        }
+        Event* eventTo = eventsById.value(constraint->mToId, 0);
+        if(eventTo)
+        {
+            constraint->mEventTo = eventTo;
+            eventTo->mConstraintsBwd.append(constraint);
         }
     }
+    
     // Link des phases / contraintes de phase
-    for(int i=0; i<mPhases.size(); ++i)
+    for(int j=0; j<mPhaseConstraints.size(); ++j)
     {
-        int phaseId = mPhases[i]->mId;
-        for(int j=0; j<mPhaseConstraints.size(); ++j)
+        PhaseConstraint* constraint = mPhaseConstraints[j];
+        
+        QHash<int, int>::const_iterator iterFrom = phasesIdxById.constFind(constraint->mFromId);
+        if(iterFrom != phasesIdxById.constEnd())
         {
-            if(mPhaseConstraints[j]->mFromId == phaseId)
-            {
-                mPhaseConstraints[j]->mPhaseFrom = mPhases[i];
-                mPhases[i]->mConstraintsFwd.append(mPhaseConstraints[j]);
-            }
-            else if(mPhaseConstraints[j]->mToId == phaseId)
-            {
-                mPhaseConstraints[j]->mPhaseTo = mPhases[i];
-                mPhases[i]->mConstraintsBwd.append(mPhaseConstraints[j]);
-            }
+            Phase* phaseFrom = mPhases[iterFrom.value()];
+            constraint->mPhaseFrom = phaseFrom;
+            phaseFrom->mConstraintsFwd.append(constraint);
+        }
+        QHash<int, int>::const_iterator iterTo = phasesIdxById.constFind(constraint->mToId);
+        if(iterTo != phasesIdxById.constEnd())
+        {
+            Phase* phaseTo = mPhases[iterTo.value()];
+            constraint->mPhaseTo = phaseTo;
+            phaseTo->mConstraintsBwd.append(constraint);
         }
     }
     //return model;
@@ -446,7 +469,9 @@ QJsonObject Model::toJson() const
 
 #pragma mark Logs
 QString Model::getMCMCLog() const{
-    return mLogMCMC;
+    if(mInstrumentation.isEmpty())
+        return mLogMCMC;
+    return mLogMCMC + mInstrumentation.toHtml();
 }
 
 QString Model::getModelLog() const{
@@ -773,110 +798,117 @@ bool Model::isValid()
     }
     
     // 4 - Pas de circularité sur les contraintes de faits
-    QVector<QVector<Event*> > eventBranches;
-    try{
-        eventBranches = ModelUtilities::getAllEventsBranches(mEvents);
-    }catch(QString error){
-        throw error;
-    }
+    const QVector<Event*> sortedEvents = ModelUtilities::getEventsTopologicalOrder(mEvents);
     
     // 5 - Pas de circularité sur les contraintes de phases
     // 6 - Gammas : sur toutes les branches, la somme des gamma min < plage d'étude :
-    QVector<QVector<Phase*> > phaseBranches;
-    try{
-        phaseBranches = ModelUtilities::getAllPhasesBranches(mPhases, mSettings.mTmax - mSettings.mTmin);
-    }catch(QString error){
-        throw error;
-    }
+    const QVector<Phase*> sortedPhases = ModelUtilities::getPhasesTopologicalOrder(mPhases, mSettings.mTmax - mSettings.mTmin);
+    
+    // Phases en contrainte après chaque phase (directement ou non), indexées par leur position dans mPhases
+    const QVector<QBitArray> phasesDescendants = ModelUtilities::getPhasesDescendants(mPhases, sortedPhases);
+    QHash<const Phase*, int> phasesIndexes;
+    phasesIndexes.reserve(mPhases.size());
+    for(int i=0; i<mPhases.size(); ++i)
+        phasesIndexes.insert(mPhases[i], i);
     
     // 7 - Un fait ne paut pas appartenir à 2 phases en contrainte
-    for(int i=0; i<phaseBranches.size(); ++i)
+    for(int i=0; i<mEvents.size(); ++i)
     {
-        QVector<Event*> branchEvents;
-        for(int j=0; j<phaseBranches[i].size(); ++j)
+        const QList<Phase*>& phases = mEvents[i]->mPhases;
+        for(int j=0; j<phases.size(); ++j)
         {
-            Phase* phase = phaseBranches[i][j];
-            for(int k=0; k<phase->mEvents.size(); ++k)
+            const QBitArray& descendants = phasesDescendants.at(phasesIndexes.value(phases[j]));
+            for(int k=0; k<phases.size(); ++k)
             {
-                if(!branchEvents.contains(phase->mEvents[k]))
-                {
-                    branchEvents.append(phase->mEvents[k]);
-                    //qDebug() << phase->mEvents[k]->mName << " in " << phase->mName;
-                }
-                else
-                    throw QString("The event \"" + phase->mEvents[k]->getName() + "\" cannot belong to several phases in a same branch!");
+                if(descendants.testBit(phasesIndexes.value(phases[k])))
+                    throw QString("The event \"" + mEvents[i]->getName() + "\" cannot belong to several phases in a same branch!");
             }
         }
     }
     
     // 8 - Bounds : verifier cohérence des bornes en fonction des contraintes de faits (page 2)
     //  => Modifier les bornes des intervalles des bounds !! (juste dans le modèle servant pour le calcul)
-    for(int i=0; i<eventBranches.size(); ++i)
+    
+    // --------------------
+    // Check bound interval lower value
+    // --------------------
+    
+    // On parcourt les faits dans l'ordre des contraintes : pour chaque fait, on connait déjà
+    // le max des valeurs fixes ou du début de l'intervalle de toutes les bornes avant lui.
+    QHash<const Event*, double> lowers;
+    lowers.reserve(sortedEvents.size());
+    for(int i=0; i<sortedEvents.size(); ++i)
     {
-        for(int j=0; j<eventBranches[i].size(); ++j)
+        Event* event = sortedEvents[i];
+        double lower = mSettings.mTmin;
+        for(int j=0; j<event->mConstraintsBwd.size(); ++j)
         {
-            Event* event = eventBranches[i][j];
-            if(event->mType == Event::eKnown)
+            Event* evt = event->mConstraintsBwd[j]->mEventFrom;
+            lower = qMax(lower, lowers.value(evt));
+            if(evt->mType == Event::eKnown)
             {
-                EventKnown* bound = dynamic_cast<EventKnown*>(event);
-                
-                // --------------------
-                // Check bound interval lower value
-                // --------------------
-                
-                // On vérifie toutes les bornes avant et on prend le max
-                // de leurs valeurs fixes ou du début de leur intervalle :
-                double lower = mSettings.mTmin;
-                for(int k=0; k<j; ++k)
-                {
-                    Event* evt = eventBranches[i][k];
-                    if(evt->mType == Event::eKnown)
-                    {
-                        EventKnown* bd = dynamic_cast<EventKnown*>(evt);
-                        if(bd->mKnownType == EventKnown::eFixed)
-                            lower = qMax(lower, bd->mFixed);
-                        else if(bd->mKnownType == EventKnown::eUniform)
-                            lower = qMax(lower, bd->mUniformStart);
-                    }
-                }
-                // Update bound interval
-                if(bound->mKnownType == EventKnown::eFixed && bound->mFixed < lower)
-                {
-                    throw QString("The bound \"" + bound->getName() + "\" has a fixed value inconsistent with previous bounds in chain!");
-                }
-                else if(bound->mKnownType == EventKnown::eUniform)
-                {
-                    bound->mUniformStart = qMax(bound->mUniformStart, lower);
-                }
-                
-                // --------------------
-                // Check bound interval upper value
-                // --------------------
-                double upper = mSettings.mTmax;
-                for(int k=j+1; k<eventBranches[i].size(); ++k)
-                {
-                    Event* evt = eventBranches[i][k];
-                    if(evt->mType == Event::eKnown)
-                    {
-                        EventKnown* bd = dynamic_cast<EventKnown*>(evt);
-                        if(bd->mKnownType == EventKnown::eFixed)
-                            upper = qMin(upper, bd->mFixed);
-                        else if(bd->mKnownType == EventKnown::eUniform)
-                            upper = qMin(upper, bd->mUniformEnd);
-                    }
-                }
-                // Update bound interval
-                if(bound->mKnownType == EventKnown::eFixed && bound->mFixed > upper)
-                {
-                    throw QString("The bound \"" + bound->getName() + "\" has a fixed value inconsistent with next bounds in chain!");
-                }
-                else if(bound->mKnownType == EventKnown::eUniform)
+                EventKnown* bd = dynamic_cast<EventKnown*>(evt);
+                if(bd->mKnownType == EventKnown::eFixed)
+                    lower = qMax(lower, bd->mFixed);
+                else if(bd->mKnownType == EventKnown::eUniform)
+                    lower = qMax(lower, bd->mUniformStart);
+            }
+        }
+        lowers.insert(event, lower);
+        
+        if(event->mType == Event::eKnown)
+        {
+            EventKnown* bound = dynamic_cast<EventKnown*>(event);
+            // Update bound interval
+            if(bound->mKnownType == EventKnown::eFixed && bound->mFixed < lower)
+            {
+                throw QString("The bound \"" + bound->getName() + "\" has a fixed value inconsistent with previous bounds in chain!");
+            }
+            else if(bound->mKnownType == EventKnown::eUniform)
+            {
+                bound->mUniformStart = qMax(bound->mUniformStart, lower);
+            }
+        }
+    }
+    
+    // --------------------
+    // Check bound interval upper value
+    // --------------------
+    QHash<const Event*, double> uppers;
+    uppers.reserve(sortedEvents.size());
+    for(int i=sortedEvents.size()-1; i>=0; --i)
+    {
+        Event* event = sortedEvents[i];
+        double upper = mSettings.mTmax;
+        for(int j=0; j<event->mConstraintsFwd.size(); ++j)
+        {
+            Event* evt = event->mConstraintsFwd[j]->mEventTo;
+            upper = qMin(upper, uppers.value(evt));
+            if(evt->mType == Event::eKnown)
+            {
+                EventKnown* bd = dynamic_cast<EventKnown*>(evt);
+                if(bd->mKnownType == EventKnown::eFixed)
+                    upper = qMin(upper, bd->mFixed);
+                else if(bd->mKnownType == EventKnown::eUniform)
+                    upper = qMin(upper, bd->mUniformEnd);
+            }
+        }
+        uppers.insert(event, upper);
+        
+        if(event->mType == Event::eKnown)
+        {
+            EventKnown* bound = dynamic_cast<EventKnown*>(event);
+            // Update bound interval
+            if(bound->mKnownType == EventKnown::eFixed && bound->mFixed > upper)
+            {
+                throw QString("The bound \"" + bound->getName() + "\" has a fixed value inconsistent with next bounds in chain!");
+            }
+            else if(bound->mKnownType == EventKnown::eUniform)
+            {
+                bound->mUniformEnd = qMin(bound->mUniformEnd, upper);
+                if(bound->mUniformStart >= bound->mUniformEnd)
                 {
-                    bound->mUniformEnd = qMin(bound->mUniformEnd, upper);
-                    if(bound->mUniformStart >= bound->mUniformEnd)
-                    {
-                        throw QString("The bound \"" + bound->getName() + "\" has an inconsistent range with other related bounds!");
-                    }
+                    throw QString("The bound \"" + bound->getName() + "\" has an inconsistent range with other related bounds!");
                 }
             }
         }
@@ -992,54 +1024,23 @@ bool Model::isValid()
     }
     
     // 11 - Vérifier la cohérence entre les contraintes de faits et de phase
-    for(int i=0; i<phaseBranches.size(); ++i)
+    // Un fait ne peut pas être en contrainte vers un fait d'une phase qui précède la sienne
+    for(int i=0; i<mEventConstraints.size(); ++i)
     {
-        for(int j=0; j<phaseBranches[i].size(); ++j)
+        const Event* eventFrom = mEventConstraints[i]->mEventFrom;
+        const Event* eventTo = mEventConstraints[i]->mEventTo;
+        
+        for(int j=0; j<eventTo->mPhases.size(); ++j)
         {
-            Phase* phase = phaseBranches[i][j];
-            for(int k=0; k<phase->mEvents.size(); ++k)
+            const Phase* phaseTo = eventTo->mPhases[j];
+            const QBitArray& descendants = phasesDescendants.at(phasesIndexes.value(phaseTo));
+            
+            for(int k=0; k<eventFrom->mPhases.size(); ++k)
             {
-                Event* event = phase->mEvents[k];
-                
-                bool phaseFound = false;
-                
-                // On réinspecte toutes les phases de la branche et on vérifie que le fait n'a pas de contrainte en contradiction avec les contraintes de phase !
-                for(int l=0; l<phaseBranches[i].size(); ++l)
+                const Phase* phaseFrom = eventFrom->mPhases[k];
+                if(descendants.testBit(phasesIndexes.value(phaseFrom)))
                 {
-                    Phase* p = phaseBranches[i][l];
-                    if(p == phase)
-                    {
-                        phaseFound = true;
-                    }
-                    else
-                    {
-                        for(int m=0; m<p->mEvents.size(); ++m)
-                        {
-                            Event* e = p->mEvents[m];
-                            
-                            // Si on regarde l'élément d'un phase d'avant, le fait ne peut pas être en contrainte vers un fait de cette phase
-                            if(!phaseFound)
-                            {
-                                for(int n=0; n<e->mConstraintsBwd.size(); ++n)
-                                {
-                                    if(e->mConstraintsBwd[n]->mEventFrom == event)
-                                    {
-                                        throw "The event " + event->getName() + " (in phase " + phase->getName() + ") is before the event " + e->getName() + " (in phase " + p->getName() + "), BUT the phase " + phase->getName() + " is after the phase " + p->getName() + ".\n=> Contradiction !";
-                                    }
-                                }
-                            }
-                            else
-                            {
-                                for(int n=0; n<e->mConstraintsFwd.size(); ++n)
-                                {
-                                    if(e->mConstraintsFwd[n]->mEventTo == event)
-                                    {
-                                        throw "The event " + event->getName() + " (in phase " + phase->getName() + ") is after the event " + e->getName() + " (in phase " + p->getName() + "), BUT the phase " + phase->getName() + " is before the phase " + p->getName() + ".\n=> Contradiction !";
-                                    }
-                                }
-                            }
-                        }
-                    }
+                    throw "The event " + eventFrom->getName() + " (in phase " + phaseFrom->getName() + ") is before the event " + eventTo->getName() + " (in phase " + phaseTo->getName() + "), BUT the phase " + phaseFrom->getName() + " is after the phase " + phaseTo->getName() + ".\n=> Contradiction !";
                 }
             }
         }
@@ -1051,11 +1052,12 @@ bool Model::isValid()
 #pragma mark Generate model data
 void Model::generateCorrelations(const QList<Chain>& chains)
 {
-    QTime t = QTime::currentTime();
+    ScopedTimer timer(mInstrumentation.stat("results/correlations"));
     
     for(int i=0; i<mEvents.size(); ++i)
     {
         Event* event = mEvents[i];
+        TRACE_SCOPE(trace, "results", "Correlations : " + event->getName());
         event->mTheta.generateCorrelations(chains);
         
         for(int j=0; j<event->mDates.size(); ++j)
@@ -1068,19 +1070,16 @@ void Model::generateCorrelations(const QList<Chain>& chains)
     
     for(int i=0; i<mPhases.size(); ++i)
     {
+        TRACE_SCOPE(trace, "results", "Correlations : " + mPhases[i]->getName());
         //Phase* phase = mPhases[i];
         mPhases[i]->mAlpha.generateCorrelations(chains);
         mPhases[i]->mBeta.generateCorrelations(chains);
     }
-    
-    QTime t2 = QTime::currentTime();
-    qint64 timeDiff = t.msecsTo(t2);
-    qDebug() <<  "=> Model::generateCorrelations done in " + QString::number(timeDiff) + " ms";
 }
 
 void Model::generatePosteriorDensities(const QList<Chain>& chains, int fftLen, double hFactor)
 {
-    QTime t = QTime::currentTime();
+    ScopedTimer timer(mInstrumentation.stat("results/densities"));
     
     double tmin = mSettings.mTmin;
     double tmax = mSettings.mTmax;
@@ -1088,6 +1087,7 @@ void Model::generatePosteriorDensities(const QList<Chain>& chains, int fftLen, d
     for(int i=0; i<mEvents.size(); ++i)
     {
         Event* event = mEvents[i];
+        TRACE_SCOPE(trace, "results", "Densities : " + event->getName());
         
         // Generate event histos for all events and all bounds except for bounds of type "fixed"
         bool notEventKnownFixed = true;
@@ -1121,25 +1121,23 @@ void Model::generatePosteriorDensities(const QList<Chain>& chains, int fftLen, d
     
     for(int i=0; i<mPhases.size(); ++i)
     {
+        TRACE_SCOPE(trace, "results", "Densities : " + mPhases[i]->getName());
         Phase* phase = mPhases[i];
         
         phase->mAlpha.generateHistos(chains, fftLen, hFactor, tmin, tmax);
         phase->mBeta.generateHistos(chains, fftLen, hFactor, tmin, tmax);
         phase->mDuration.generateHistos(chains, fftLen, hFactor, 0, tmax - tmin);
     }
-    
-    QTime t2 = QTime::currentTime();
-    qint64 timeDiff = t.msecsTo(t2);
-    qDebug() <<  "=> Model::generatePosteriorDensities done in " + QString::number(timeDiff) + " ms";
 }
 
 void Model::generateNumericalResults(const QList<Chain>& chains)
 {
-    QTime t = QTime::currentTime();
+    ScopedTimer timer(mInstrumentation.stat("results/numerical"));
     
     for(int i=0; i<mEvents.size(); ++i)
     {
         Event* event = mEvents[i];
+        TRACE_SCOPE(trace, "results", "Numerical results : " + event->getName());
         event->mTheta.generateNumericalResults(chains);
         
         for(int j=0; j<event->mDates.size(); ++j)
@@ -1152,20 +1150,17 @@ void Model::generateNumericalResults(const QList<Chain>& chains)
     
     for(int i=0; i<mPhases.size(); ++i)
     {
+        TRACE_SCOPE(trace, "results", "Numerical results : " + mPhases[i]->getName());
         Phase* phase = mPhases[i];
         phase->mAlpha.generateNumericalResults(chains);
         phase->mBeta.generateNumericalResults(chains);
         phase->mDuration.generateNumericalResults(chains);
     }
-    
-    QTime t2 = QTime::currentTime();
-    qint64 timeDiff = t.msecsTo(t2);
-    qDebug() <<  "=> Model::generateNumericalResults done in " + QString::number(timeDiff) + " ms";
 }
 
 void Model::generateCredibilityAndHPD(const QList<Chain>& chains, double thresh)
 {
-    QTime t = QTime::currentTime();
+    ScopedTimer timer(mInstrumentation.stat("results/hpd"));
     
     /* double threshold = thresh;
     threshold = std::min(100.0, threshold);
@@ -1175,6 +1170,7 @@ void Model::generateCredibilityAndHPD(const QList<Chain>& chains, double thresh)
     for(int i=0; i<mEvents.size(); ++i)
     {
         Event* event = mEvents[i];
+        TRACE_SCOPE(trace, "results", "HPD : " + event->getName());
         
         bool isFixedBound = false;
         if(event->type() == Event::eKnown)
@@ -1203,6 +1199,7 @@ void Model::generateCredibilityAndHPD(const QList<Chain>& chains, double thresh)
     }
     for(int i=0; i<mPhases.size(); ++i)
     {
+        TRACE_SCOPE(trace, "results", "HPD : " + mPhases[i]->getName());
         Phase* phase = mPhases[i];
         phase->mAlpha.generateHPD(threshold);
         phase->mBeta.generateHPD(threshold);
@@ -1213,10 +1210,6 @@ void Model::generateCredibilityAndHPD(const QList<Chain>& chains, double thresh)
         phase->mBeta.generateCredibility(chains, threshold);
         phase->mDuration.generateCredibility(chains, threshold);
     }
-    
-    QTime t2 = QTime::currentTime();
-    qint64 timeDiff = t.msecsTo(t2);
-    qDebug() <<  "=> Model::generateCredibilityAndHPD done in " + QString::number(timeDiff) + " ms";
 }
 
 #pragma mark Clear model data
@@ -1227,18 +1220,23 @@ void Model::clearPosteriorDensities()
         for(int j=0; j<mEvents[i]->mDates.size(); ++j) {
             Date& date = event->mDates[j];
             date.mTheta.mHisto.clear();
+            date.mTheta.mHistosKey = 0;
             date.mSigma.mHisto.clear();
+            date.mSigma.mHistosKey = 0;
             date.mTheta.mChainsHistos.clear();
             date.mSigma.mChainsHistos.clear();
         }
         event->mTheta.mHisto.clear();
+        event->mTheta.mHistosKey = 0;
         event->mTheta.mChainsHistos.clear();
     }
     
     for(int i=0; i<mPhases.size(); ++i) {
         Phase* phase = mPhases[i];
         phase->mAlpha.mHisto.clear();
+        phase->mAlpha.mHistosKey = 0;
         phase->mBeta.mHisto.clear();
+        phase->mBeta.mHistosKey = 0;
         phase->mAlpha.mChainsHistos.clear();
         phase->mBeta.mChainsHistos.clear();
         
@@ -1251,15 +1249,20 @@ void Model::clearCredibilityAndHPD()
         for(int j=0; j<mEvents[i]->mDates.size(); ++j) {
             Date& date = event->mDates[j];
             date.mTheta.mHPD.clear();
+            date.mTheta.mHPDKey = 0;
             date.mSigma.mHPD.clear();
+            date.mSigma.mHPDKey = 0;
             
         }
         event->mTheta.mHPD.clear();
+        event->mTheta.mHPDKey = 0;
     }
     for(int i=0; i<mPhases.size(); ++i) {
         Phase* phase = mPhases[i];
         phase->mAlpha.mHPD.clear();
+        phase->mAlpha.mHPDKey = 0;
         phase->mBeta.mHPD.clear();
+        phase->mBeta.mHPDKey = 0;
     }
 }
 
@@ -1267,213 +1270,500 @@ void Model::clearCredibilityAndHPD()
 
 
 #pragma mark Date files read / write
-/** @Brief Save .dat file, the result of computation and compress it
- *
+// QDataStream version of the chunks of .dat files (version 2)
+#define DAT_STREAM_VERSION QDataStream::Qt_5_0
+
+/**
+ * @brief Everything a date stores besides its variables : delta, settings and calibration
+ */
+static void saveDateParams(QDataStream& out, const Date& date)
+{
+    out << date.mDeltaFixed;
+    out << date.mDeltaMin;
+    out << date.mDeltaMax;
+    out << date.mDeltaAverage;
+    out << date.mDeltaError;
+    
+    out << date.mSettings.mTmin;
+    out << date.mSettings.mTmax;
+    out << date.mSettings.mStep;
+    out << date.mSettings.mStepForced;
+    
+    // Compact calibration : a negative marker, then the offset of the stored support
+    // (older files directly start with the size of the calibration vector)
+    out << (qint32)-1;
+    out << (qint32)date.mCalibOffset;
+    out << date.mCalibration;
+    out << date.mRepartition;
+    out << date.mCalibHPD;
+}
+
+static void loadDateParams(QDataStream& in, Date& date)
+{
+    in >> date.mDeltaFixed;
+    in >> date.mDeltaMin;
+    in >> date.mDeltaMax;
+    in >> date.mDeltaAverage;
+    in >> date.mDeltaError;
+    
+    in >> date.mSettings.mTmin;
+    in >> date.mSettings.mTmax;
+    in >> date.mSettings.mStep;
+    in >> date.mSettings.mStepForced;
+    
+    qint32 calibMarker = 0;
+    in >> calibMarker;
+    if(calibMarker < 0)
+    {
+        qint32 calibOffset = 0;
+        in >> calibOffset;
+        date.mCalibOffset = calibOffset;
+        in >> date.mCalibration;
+    }
+    else
+    {
+        // Older files : the calibration covers the whole study period
+        date.mCalibOffset = 0;
+        date.mCalibration.resize(calibMarker);
+        for(int k=0; k<calibMarker; ++k)
+            in >> date.mCalibration[k];
+    }
+    in >> date.mRepartition;
+    in >> date.mCalibHPD;
+    
+    if (date.mCalibration.isEmpty()) qDebug()<<"Model::restoreFromFile vide";
+}
+
+void ResultsChunk::serialize()
+{
+    TRACE_SCOPE(trace, "io", "Serialize " + mChunk.mName);
+    
+    if(mType == eData)
+    {
+        ChunkedFile::compress(mChunk);
+        return;
+    }
+    
+    QDataStream out(&mChunk.mData, QIODevice::WriteOnly);
+    out.setVersion(DAT_STREAM_VERSION);
+    
+    switch(mType)
+    {
+        case eVariable:
+        {
+            mVariable.saveToStream(&out);
+            mVariable.saveValidityToStream(&out);
+            mVariable = MetropolisVariable();
+            break;
+        }
+        case eMHVariable:
+        {
+            mMHVariable.saveToStream(&out);
+            mMHVariable.saveValidityToStream(&out);
+            mMHVariable = MHVariable();
+            break;
+        }
+        case eDateParams:
+        {
+            saveDateParams(out, mDate);
+            mDate = Date();
+            break;
+        }
+        default:
+            break;
+    }
+    ChunkedFile::compress(mChunk);
+}
+
+// A chunk of the .dat file to be loaded into a variable or the parameters of a date
+struct ChunkLoad
+{
+    ChunkLoad(): mVariable(0), mMHVariable(0), mDate(0) {}
+    
+    QString mName;
+    MetropolisVariable* mVariable;
+    MHVariable* mMHVariable;
+    Date* mDate;
+    QString mError;
+};
+
+// Uncompresses and parses a chunk : chunks are independent, they are loaded in parallel
+struct ChunkLoadFromFile
+{
+    typedef void result_type;
+    
+    ChunkLoadFromFile(const ChunkedFile& file): mFile(file){}
+    
+    void operator()(ChunkLoad& load)
+    {
+        TRACE_SCOPE(trace, "io", "Load " + load.mName);
+        try{
+            QByteArray data = mFile.chunk(load.mName);
+            QDataStream in(&data, QIODevice::ReadOnly);
+            in.setVersion(mFile.streamVersion());
+            
+            MetropolisVariable* variable = load.mMHVariable ? load.mMHVariable : load.mVariable;
+            if(load.mMHVariable)
+                load.mMHVariable->loadFromStream(&in);
+            else if(load.mVariable)
+                load.mVariable->loadFromStream(&in);
+            if(variable)
+                variable->loadValidityFromStream(&in);
+            
+            if(load.mDate)
+                loadDateParams(in, *load.mDate);
+            
+            if(in.status() != QDataStream::Ok)
+                load.mError = QObject::tr("Corrupted data in the results file : ") + load.mName;
+        }
+        catch(QString error){
+            load.mError = error;
+        }
+    }
+    
+    const ChunkedFile& mFile;
+};
+
+/** @Brief Save .dat file, the result of computation.
+ *  Each variable is a chunk of the file, compressed independently (see ChunkedFile).
  * */
 void Model::saveToFile(const QString& fileName)
 {
-    if(!mEvents.empty())
-    //if(!mEvents[0]->mTheta.mTrace.empty())
-    {
+    ScopedTimer timer(mInstrumentation.stat("results/save"));
+    TraceScope trace("io", "Save results");
+    
+    QVector<ResultsChunk> snapshot = resultsSnapshot();
+    if(snapshot.isEmpty())
+        return;
+    
+    QtConcurrent::blockingMap(snapshot, ResultsChunkSerialize());
+    writeResults(fileName, snapshot);
+}
+
+/**
+ * @brief Copies the results to be saved, one item per chunk of the .dat file.
+ * Nothing is serialized here : see ResultsChunk::serialize(), which can be called on another thread.
+ */
+QVector<ResultsChunk> Model::resultsSnapshot() const
+{
+    QVector<ResultsChunk> snapshot;
+    if(mEvents.empty())
+        return snapshot;
+    
     // -----------------------------------------------------
-    //  Create file
+    //  Info
     // -----------------------------------------------------
-    
-    QFile file(fileName);
-    QByteArray uncompresedData;
-    if(file.open(QIODevice::WriteOnly))
     {
-        QDataStream out(&uncompresedData, QIODevice::WriteOnly);
+        ResultsChunk chunk;
+        chunk.mChunk.mName = "info";
+        QDataStream out(&chunk.mChunk.mData, QIODevice::WriteOnly);
+        out.setVersion(DAT_STREAM_VERSION);
         
-        // -----------------------------------------------------
-        //  Write info
-        // -----------------------------------------------------
         out << (qint32)mPhases.size();
         out << (qint32)mEvents.size();
-
+        
         qint32 numDates = 0;
         for(int i=0; i<mEvents.size(); ++i)
             numDates += mEvents[i]->mDates.size();
         out << numDates;
-        // -----------------------------------------------------
-        //  Write phases data
-        // -----------------------------------------------------
-        for(int i=0; i<mPhases.size(); ++i)
-        {
-           
-            mPhases[i]->mAlpha.saveToStream(&out);
-            mPhases[i]->mBeta.saveToStream(&out);
-            mPhases[i]->mDuration.saveToStream(&out);
-        }
-
-        // -----------------------------------------------------
-        //  Write events data
-        // -----------------------------------------------------
-        for(int i=0; i<mEvents.size(); ++i)
+        snapshot.append(chunk);
+    }
+    
+    // -----------------------------------------------------
+    //  Chains : the adaptation sets where the run starts in the traces
+    // -----------------------------------------------------
+    {
+        ResultsChunk chunk;
+        chunk.mChunk.mName = "chains";
+        QDataStream out(&chunk.mChunk.mData, QIODevice::WriteOnly);
+        out.setVersion(DAT_STREAM_VERSION);
+        
+        out << (qint32)mChains.size();
+        for(int i=0; i<mChains.size(); ++i)
         {
-
-           mEvents[i]->mTheta.saveToStream(&out);
+            const Chain& chain = mChains.at(i);
+            out << (qint32)chain.mSeed;
+            out << (quint64)chain.mNumBurnIter;
+            out << (quint64)chain.mBurnIterIndex;
+            out << (quint32)chain.mMaxBatchs;
+            out << (quint32)chain.mNumBatchIter;
+            out << (quint64)chain.mBatchIterIndex;
+            out << (quint32)chain.mBatchIndex;
+            out << (quint64)chain.mNumRunIter;
+            out << (quint64)chain.mRunIterIndex;
+            out << (quint64)chain.mTotalIter;
+            out << (quint64)chain.mThinningInterval;
         }
-
-        // -----------------------------------------------------
-        //  Write dates data
-        // -----------------------------------------------------
-        for(int i=0; i<mEvents.size(); ++i)
+        snapshot.append(chunk);
+    }
+    
+    // -----------------------------------------------------
+    //  Phases, events and dates data
+    // -----------------------------------------------------
+    for(int i=0; i<mPhases.size(); ++i)
+    {
+        const QString prefix = "phase/" + QString::number(i) + "/";
+        ResultsChunk chunk;
+        chunk.mType = ResultsChunk::eVariable;
+        
+        chunk.mChunk.mName = prefix + "alpha";
+        chunk.mVariable = mPhases[i]->mAlpha;
+        snapshot.append(chunk);
+        
+        chunk.mChunk.mName = prefix + "beta";
+        chunk.mVariable = mPhases[i]->mBeta;
+        snapshot.append(chunk);
+        
+        chunk.mChunk.mName = prefix + "duration";
+        chunk.mVariable = mPhases[i]->mDuration;
+        snapshot.append(chunk);
+    }
+    
+    for(int i=0; i<mEvents.size(); ++i)
+    {
+        ResultsChunk chunk;
+        chunk.mType = ResultsChunk::eMHVariable;
+        chunk.mChunk.mName = "event/" + QString::number(i) + "/theta";
+        chunk.mMHVariable = mEvents[i]->mTheta;
+        snapshot.append(chunk);
+    }
+    
+    for(int i=0; i<mEvents.size(); ++i)
+    {
+        const QList<Date>& dates = mEvents[i]->mDates;
+        for(int j=0; j<dates.size(); ++j)
         {
-            Event* event = mEvents[i];
-            QList<Date>& dates = event->mDates;
-            for(int j=0; j<dates.size(); ++j)
-            {
-
-                dates[j].mTheta.saveToStream(&out);
-                dates[j].mSigma.saveToStream(&out);
-                dates[j].mWiggle.saveToStream(&out);
-                
-               
-                out << dates[j].mDeltaFixed;
-                out << dates[j].mDeltaMin;
-                out << dates[j].mDeltaMax;
-                out << dates[j].mDeltaAverage;
-                out << dates[j].mDeltaError;
-                
-                out << dates[j].mSettings.mTmin;
-                out << dates[j].mSettings.mTmax;
-                out << dates[j].mSettings.mStep;
-                out << dates[j].mSettings.mStepForced;
-                
-              //  out << dates[j].mSubDates;
-                
-                out << dates[j].mCalibration;
-                out << dates[j].mRepartition;
-                out << dates[j].mCalibHPD;
-
-            }
+            const QString prefix = "date/" + QString::number(i) + "/" + QString::number(j) + "/";
+            ResultsChunk chunk;
+            chunk.mType = ResultsChunk::eMHVariable;
+            
+            chunk.mChunk.mName = prefix + "theta";
+            chunk.mMHVariable = dates[j].mTheta;
+            snapshot.append(chunk);
+            
+            chunk.mChunk.mName = prefix + "sigma";
+            chunk.mMHVariable = dates[j].mSigma;
+            snapshot.append(chunk);
+            
+            chunk.mChunk.mName = prefix + "wiggle";
+            chunk.mMHVariable = dates[j].mWiggle;
+            snapshot.append(chunk);
+            
+            chunk.mMHVariable = MHVariable();
+            chunk.mType = ResultsChunk::eDateParams;
+            chunk.mChunk.mName = prefix + "params";
+            chunk.mDate = dates[j];
+            snapshot.append(chunk);
         }
+    }
+    
+    // -----------------------------------------------------
+    //  Logs
+    // -----------------------------------------------------
+    {
+        ResultsChunk chunk;
+        chunk.mChunk.mName = "logs";
+        QDataStream out(&chunk.mChunk.mData, QIODevice::WriteOnly);
+        out.setVersion(DAT_STREAM_VERSION);
         out << mLogModel;
         out << mLogMCMC;
         out << mLogResults;
-        QByteArray compressedData = qCompress(uncompresedData);
-        file.write(compressedData);
-        file.close();
+        snapshot.append(chunk);
     }
-  }
+    return snapshot;
 }
-/** @Brief Read the .dat file, it's the result of the saved computation and uncompress it
- *
+
+/**
+ * @brief Writes a snapshot whose chunks have been serialized.
+ */
+void Model::writeResults(const QString& fileName, QVector<ResultsChunk>& snapshot)
+{
+    TraceScope trace("io", "Write results");
+    
+    QVector<FileChunk> chunks;
+    chunks.reserve(snapshot.size());
+    for(int i=0; i<snapshot.size(); ++i)
+    {
+        // Info and logs are serialized when the snapshot is taken
+        if(snapshot[i].mChunk.mCompressed.isEmpty())
+            ChunkedFile::compress(snapshot[i].mChunk);
+        chunks.append(snapshot[i].mChunk);
+        snapshot[i].mChunk = FileChunk();
+    }
+    ChunkedFile::writeCompressed(fileName, chunks, DAT_STREAM_VERSION);
+}
+
+/** @Brief Read the .dat file, it's the result of the saved computation.
+ *  Files written before the chunked format (version 1) hold no chain, so their traces cannot be split into the runs : they are refused.
  * */
 void Model::restoreFromFile(const QString& fileName)
 {
-    QFile file(fileName);
-
-    if(file.exists() && file.open(QIODevice::ReadOnly))
+    QElapsedTimer timer;
+    timer.start();
+    TraceScope trace("io", "Load results");
+    
+    if(!ChunkedFile::isChunkedFile(fileName))
+        throw QObject::tr("This results file has been written by a previous version, the model must be run again : ") + fileName;
+    
+    const bool restored = restoreFromChunkedFile(fileName);
+    
+    if(restored)
     {
-        QByteArray compressedData = file.readAll();
-
-        QByteArray uncompresedData = qUncompress(compressedData);
+        // Results saved with a valid key are kept as they are, only the others are computed
+        int fftLen = 1024;
+        double hFactor = 1;
+        getHistosParameters(fftLen, hFactor);
+        
+        generateCorrelations(mChains);
+        generatePosteriorDensities(mChains, fftLen, hFactor);
+        generateNumericalResults(mChains);
+    }
+    // Includes the densities generated above, which are also counted on their own
+    mInstrumentation.stat("results/load")->add(timer.nsecsElapsed());
+}
 
-/* #ifdef DEBUG
-        qDebug() << "Lecture fichier :"<< fileName;
-        qDebug() << "TAILLE compressedData :" << compressedData.size();
-        qDebug() << "TAILLE uncompresedData :" << uncompresedData.size();
-#endif */
-        if(uncompresedData.size()!=0)
+/**
+ * @brief Parameters of the posterior densities currently held by the variables,
+ * e.g. to display the densities restored from a .dat file without computing them again.
+ * @return false if no density has been computed
+ */
+bool Model::getHistosParameters(int& fftLen, double& hFactor) const
+{
+    for(int i=0; i<mEvents.size(); ++i)
+    {
+        const MetropolisVariable& theta = mEvents[i]->mTheta;
+        if(theta.mHistosKey != 0)
         {
-            QDataStream in(&uncompresedData, QIODevice::ReadOnly);
-
-            // -----------------------------------------------------
-            //  Read info
-            // -----------------------------------------------------
-
-            qint32 numPhases = 0;
-            in >> numPhases;
-
-            qint32 numEvents = 0;
-            in >> numEvents;
-
-            qint32 numdates = 0;
-            in >> numdates;
-
-            // -----------------------------------------------------
-            //  Read phases data
-            // -----------------------------------------------------
-
-            for(int i=0; i<mPhases.size(); ++i)
-            {
-                /*in >> mPhases[i]->mAlpha.mTrace;
-                in >> mPhases[i]->mBeta.mTrace;
-                in >> mPhases[i]->mDuration.mTrace;*/
-                mPhases[i]->mAlpha.loadFromStream(&in);
-                mPhases[i]->mBeta.loadFromStream(&in);
-                mPhases[i]->mDuration.loadFromStream(&in);
-            }
-
-            // -----------------------------------------------------
-            //  Read events data
-            // -----------------------------------------------------
-
-            for(int i=0; i<mEvents.size(); ++i)
-            {
-                /*in >> mEvents[i]->mTheta.mTrace;
-                in >> mEvents[i]->mTheta.mHistoryAcceptRateMH;
-                in >> mEvents[i]->mTheta.mAllAccepts;*/
-                mEvents[i]->mTheta.loadFromStream(&in);
-            }
-
-            // -----------------------------------------------------
-            //  Read dates data
-            // -----------------------------------------------------
-
-            for(int i=0; i<mEvents.size(); ++i)
-            {
-                for(int j=0; j<mEvents[i]->mDates.size(); ++j)
-                {
-                    /*in >> mEvents[i]->mDates[j].mTheta.mTrace;
-                    in >> mEvents[i]->mDates[j].mTheta.mHistoryAcceptRateMH;
-                    in >> mEvents[i]->mDates[j].mTheta.mAllAccepts;
-
-                    in >> mEvents[i]->mDates[j].mSigma.mTrace;
-                    in >> mEvents[i]->mDates[j].mSigma.mHistoryAcceptRateMH;
-                    in >> mEvents[i]->mDates[j].mSigma.mAllAccepts;
+            fftLen = theta.mHistosFftLen;
+            hFactor = theta.mHistosHFactor;
+            return true;
+        }
+    }
+    return false;
+}
 
-                    in >> mEvents[i]->mDates[j].mWiggle.mTrace;
-                    in >> mEvents[i]->mDates[j].mWiggle.mHistoryAcceptRateMH;
-                    in >> mEvents[i]->mDates[j].mWiggle.mAllAccepts;*/
+/**
+ *  @brief Version 2 : the file is memory mapped, and its chunks are uncompressed and parsed in parallel.
+ *  Only the chunk being parsed is held uncompressed by each thread.
+ */
+bool Model::restoreFromChunkedFile(const QString& fileName)
+{
+    ChunkedFile file;
+    file.open(fileName);
+    
+    // Version 2 files were only written by development versions, without the chains
+    if(file.version() < CHUNKED_FILE_VERSION)
+        throw QObject::tr("This results file has been written by a development version, the model must be run again : ") + fileName;
+    
+    restoreChains(file);
+    
+    QVector<ChunkLoad> loads;
+    
+    for(int i=0; i<mPhases.size(); ++i)
+    {
+        const QString prefix = "phase/" + QString::number(i) + "/";
+        ChunkLoad load;
+        load.mName = prefix + "alpha";
+        load.mVariable = &mPhases[i]->mAlpha;
+        loads.append(load);
+        load.mName = prefix + "beta";
+        load.mVariable = &mPhases[i]->mBeta;
+        loads.append(load);
+        load.mName = prefix + "duration";
+        load.mVariable = &mPhases[i]->mDuration;
+        loads.append(load);
+    }
+    
+    for(int i=0; i<mEvents.size(); ++i)
+    {
+        ChunkLoad load;
+        load.mName = "event/" + QString::number(i) + "/theta";
+        load.mMHVariable = &mEvents[i]->mTheta;
+        loads.append(load);
+    }
+    
+    for(int i=0; i<mEvents.size(); ++i)
+    {
+        for(int j=0; j<mEvents[i]->mDates.size(); ++j)
+        {
+            Date& date = mEvents[i]->mDates[j];
+            const QString prefix = "date/" + QString::number(i) + "/" + QString::number(j) + "/";
+            
+            ChunkLoad load;
+            load.mName = prefix + "theta";
+            load.mMHVariable = &date.mTheta;
+            loads.append(load);
+            load.mName = prefix + "sigma";
+            load.mMHVariable = &date.mSigma;
+            loads.append(load);
+            load.mName = prefix + "wiggle";
+            load.mMHVariable = &date.mWiggle;
+            loads.append(load);
+            
+            ChunkLoad params;
+            params.mName = prefix + "params";
+            params.mDate = &date;
+            loads.append(params);
+        }
+    }
+    
+    QtConcurrent::blockingMap(loads, ChunkLoadFromFile(file));
+    
+    for(int i=0; i<loads.size(); ++i)
+    {
+        if(!loads[i].mError.isEmpty())
+            throw loads[i].mError;
+    }
+    
+    if(file.contains("logs"))
+    {
+        QByteArray data = file.chunk("logs");
+        QDataStream in(&data, QIODevice::ReadOnly);
+        in.setVersion(file.streamVersion());
+        in >> mLogModel;
+        in >> mLogMCMC;
+        in >> mLogResults;
+    }
+    return true;
+}
 
-                    mEvents[i]->mDates[j].mTheta.loadFromStream(&in);
-                    mEvents[i]->mDates[j].mSigma.loadFromStream(&in);
-                    mEvents[i]->mDates[j].mWiggle.loadFromStream(&in);
-                                                            
-                    
-                    in >> mEvents[i]->mDates[j].mDeltaFixed;
-                    in >> mEvents[i]->mDates[j].mDeltaMin;
-                    in >> mEvents[i]->mDates[j].mDeltaMax;
-                    in >> mEvents[i]->mDates[j].mDeltaAverage;
-                    in >> mEvents[i]->mDates[j].mDeltaError;
-                    
-                    in >> mEvents[i]->mDates[j].mSettings.mTmin;
-                    in >> mEvents[i]->mDates[j].mSettings.mTmax;
-                    in >> mEvents[i]->mDates[j].mSettings.mStep;
-                    in >> mEvents[i]->mDates[j].mSettings.mStepForced;
-                    
-                   // in >> mEvents[i]->mDates[j].mSubDates;
-                    
-                    in >> mEvents[i]->mDates[j].mCalibration;
-                    in >> mEvents[i]->mDates[j].mRepartition;
-                    in >> mEvents[i]->mDates[j].mCalibHPD;
-                    
-                     if (mEvents[i]->mDates[j].mCalibration.isEmpty()) qDebug()<<"Model::restoreFromFile vide";
-                    
-                }
-            }
-            in >> mLogModel;
-            in >> mLogMCMC;
-            in >> mLogResults;
+/**
+ *  @brief The chains as they were run : the settings of the project may give other seeds, and the number of batches depends on the adaptation
+ */
+void Model::restoreChains(const ChunkedFile& file)
+{
+    QByteArray data = file.chunk("chains");
+    QDataStream in(&data, QIODevice::ReadOnly);
+    in.setVersion(file.streamVersion());
+    
+    qint32 numChains = 0;
+    in >> numChains;
+    
+    QList<Chain> chains;
+    for(int i=0; i<numChains && in.status() == QDataStream::Ok; ++i)
+    {
+        qint32 seed;
+        quint32 maxBatchs, numBatchIter, batchIndex;
+        quint64 numBurnIter, burnIterIndex, batchIterIndex, numRunIter, runIterIndex, totalIter, thinningInterval;
+        in >> seed >> numBurnIter >> burnIterIndex >> maxBatchs >> numBatchIter >> batchIterIndex >> batchIndex;
+        in >> numRunIter >> runIterIndex >> totalIter >> thinningInterval;
         
-            generateCorrelations(mChains);
-            generatePosteriorDensities(mChains, 1024, 1);
-            generateNumericalResults(mChains);
-        }
-        file.close();
+        Chain chain;
+        chain.mSeed = seed;
+        chain.mNumBurnIter = numBurnIter;
+        chain.mBurnIterIndex = burnIterIndex;
+        chain.mMaxBatchs = maxBatchs;
+        chain.mNumBatchIter = numBatchIter;
+        chain.mBatchIterIndex = batchIterIndex;
+        chain.mBatchIndex = batchIndex;
+        chain.mNumRunIter = numRunIter;
+        chain.mRunIterIndex = runIterIndex;
+        chain.mTotalIter = totalIter;
+        chain.mThinningInterval = thinningInterval;
+        chains.append(chain);
     }
+    if(in.status() != QDataStream::Ok)
+        throw QObject::tr("Corrupted data in the results file : ") + "chains";
     
+    mChains = chains;
 }
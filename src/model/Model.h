@@ -7,11 +7,51 @@
 #include "Phase.h"
 #include "EventConstraint.h"
 #include "PhaseConstraint.h"
+#include "ChunkedFile.h"
+#include "Instrumentation.h"
 
 #include <QObject>
 #include <QJsonObject>
 
 
+/**
+ * @brief Copy of a part of the results, to be written as one chunk of the .dat file.
+ * Variables and dates are implicitly shared : taking a snapshot of the results is cheap,
+ * and the Model can be modified, cleared or run again while the snapshot is written on another thread.
+ */
+struct ResultsChunk
+{
+    enum Type
+    {
+        eData = 0,
+        eVariable = 1,
+        eMHVariable = 2,
+        eDateParams = 3
+    };
+    
+    ResultsChunk(): mType(eData) {}
+    
+    // Serializes and compresses the chunk, then releases the copies (called in parallel on the chunks)
+    void serialize();
+    
+    Type mType;
+    MetropolisVariable mVariable;
+    MHVariable mMHVariable;
+    Date mDate;
+    FileChunk mChunk;
+};
+
+// Serializes the chunks of a results snapshot in parallel (QtConcurrent::map)
+struct ResultsChunkSerialize
+{
+    typedef void result_type;
+    
+    void operator()(ResultsChunk& chunk)
+    {
+        chunk.serialize();
+    }
+};
+
 class Model: public QObject
 {
     Q_OBJECT
@@ -48,12 +88,21 @@ public:
     void clear();
 
     void saveToFile(const QString& fileName);
+    QVector<ResultsChunk> resultsSnapshot() const;
+    static void writeResults(const QString& fileName, QVector<ResultsChunk>& snapshot);
     void restoreFromFile(const QString& fileName);
     
+private:
+    bool restoreFromChunkedFile(const QString& fileName);
+    void restoreChains(const ChunkedFile& file);
+    
+public:
+    
     // Only trace needed for this :
     void generateCorrelations(const QList<Chain>& chains);
     // Computed from trace using FFT :
     void generatePosteriorDensities(const QList<Chain>& chains, int fftLen, double hFactor);
+    bool getHistosParameters(int& fftLen, double& hFactor) const;
     // Trace and Posterior density needed for this :
     void generateCredibilityAndHPD(const QList<Chain>& chains, double threshold);
     // Trace and Posterior density needed for this :
@@ -76,6 +125,9 @@ public:
     QString mLogModel;
     QString mLogMCMC;
     QString mLogResults;
+    
+    // Timings of the MCMC and of the results, reported at the end of the MCMC log
+    Instrumentation mInstrumentation;
 private:
     const QJsonObject * mJson;
 };
@@ -2,9 +2,14 @@
 #include "Date.h"
 #include "EventConstraint.h"
 #include "../PluginAbstract.h"
+#include "PluginManager.h"
+#include <QJsonArray>
 #include "QtUtilities.h"
 #include <QObject>
 #include <QString>
+#include <QHash>
+#include <QSet>
+#include <algorithm>
 
 #define MHAdaptGaussStr QObject::tr("MH : proposal = adapt. Gaussian random walk")
 #define BoxMullerStr QObject::tr("AR : proposal = Gaussian")
@@ -131,246 +136,350 @@ QString ModelUtilities::getDeltaText(const Date& date)
     return result;
 }
 
-#pragma mark Events Branches
-QVector<QVector<Event*> > ModelUtilities::getNextBranches(const QVector<Event*>& curBranch, Event* lastNode)
+#pragma mark Events graph
+/**
+ * @brief ModelUtilities::getEventsTopologicalOrder
+ * Sort events so that each event comes after all the events constrained before it (Kahn's algorithm),
+ * in linear time with respect to the number of events and constraints.
+ * The level of each event is set to the length of the longest path coming from a start event
+ * (= not having constraint backward).
+ * Throws the circular branch if the events constraints are not a DAG.
+ */
+QVector<Event*> ModelUtilities::getEventsTopologicalOrder(const QList<Event*>& events)
 {
-    QVector<QVector<Event*> > branches;
-    QList<EventConstraint*> cts = lastNode->mConstraintsFwd;
-    if(cts.size() > 0)
-    {
-        for(int i=0; i<cts.size(); ++i)
-        {
-            QVector<Event*> branch = curBranch;
-            Event* newNode = cts[i]->mEventTo;
-            
-            if(newNode->mLevel <= lastNode->mLevel)
-                newNode->mLevel = lastNode->mLevel + 1;
-            
-            if(!branch.contains(newNode))
-            {
-                branch.append(newNode);
-                QVector<QVector<Event*> > nextBranches = getNextBranches(branch, cts[i]->mEventTo);
-                for(int j=0; j<nextBranches.size(); ++j)
-                    branches.append(nextBranches[j]);
-            }
-            else
-            {
-                QStringList evtNames;
-                for(int j=0; j<branch.size(); ++j)
-                    evtNames << branch[j]->getName();
-                evtNames << newNode->getName();
-                
-                throw QObject::tr("Circularity found in events model !\nPlease correct this branch :\n") + evtNames.join(" -> ");
-            }
-        }
-    }
-    else
-    {
-        branches.append(curBranch);
-    }
-    return branches;
-}
-
-QVector<QVector<Event*> > ModelUtilities::getBranchesFromEvent(Event* start)
-{
-    QVector<Event*> startBranch;
-    start->mLevel = 0;
-    startBranch.append(start);
+    QHash<Event*, int> inDegrees;
+    inDegrees.reserve(events.size());
     
-    QVector<QVector<Event*> > nextBranches;
-    try{
-        nextBranches = getNextBranches(startBranch, start);
-    }catch(QString error){
-        throw error;
-    }
+    QVector<Event*> sorted;
+    sorted.reserve(events.size());
     
-    return nextBranches;
-}
-
-
-QVector<QVector<Event*> > ModelUtilities::getAllEventsBranches(const QList<Event*>& events)
-{
-    QVector<QVector<Event*> > branches;
-    
-    // ----------------------------------------
-    //  Put all events level to 0 and
-    //  store events at start of branches (= not having constraint backward)
-    // ----------------------------------------
-    QVector<Event*> starts;
     for(int i=0; i<events.size(); ++i)
     {
         events[i]->mLevel = 0;
-        if(events[i]->mConstraintsBwd.size() == 0)
-            starts.append(events[i]);
+        inDegrees.insert(events[i], events[i]->mConstraintsBwd.size());
+        if(events[i]->mConstraintsBwd.isEmpty())
+            sorted.append(events[i]);
     }
-    if(starts.size() == 0 && events.size() != 0)
+    
+    // sorted grows while we iterate on it : it is also the queue of events ready to be emitted
+    for(int i=0; i<sorted.size(); ++i)
     {
-        throw QObject::tr("Circularity found in events model !");
+        Event* event = sorted[i];
+        const QList<EventConstraint*>& cts = event->mConstraintsFwd;
+        for(int j=0; j<cts.size(); ++j)
+        {
+            Event* next = cts[j]->mEventTo;
+            if(next->mLevel <= event->mLevel)
+                next->mLevel = event->mLevel + 1;
+            
+            if(--inDegrees[next] == 0)
+                sorted.append(next);
+        }
     }
-    else
+    
+    if(sorted.size() < events.size())
     {
-        for(int i=0; i<starts.size(); ++i)
+        // ----------------------------------------
+        //  Each event not emitted still has a backward constraint from an event not emitted :
+        //  going back from one of them necessarily loops on a circular branch.
+        // ----------------------------------------
+        Event* event = 0;
+        for(int i=0; i<events.size() && !event; ++i)
+        {
+            if(inDegrees.value(events[i]) > 0)
+                event = events[i];
+        }
+        QVector<Event*> path;
+        QSet<Event*> visited;
+        while(!visited.contains(event))
         {
-            QVector<QVector<Event*> > eventBranches;
-            try{
-                eventBranches = getBranchesFromEvent(starts[i]);
-            }catch(QString error){
-                throw error;
+            visited.insert(event);
+            path.append(event);
+            const QList<EventConstraint*>& cts = event->mConstraintsBwd;
+            for(int j=0; j<cts.size(); ++j)
+            {
+                if(inDegrees.value(cts[j]->mEventFrom) > 0)
+                {
+                    event = cts[j]->mEventFrom;
+                    break;
+                }
             }
-            for(int j=0; j<eventBranches.size(); ++j)
-                branches.append(eventBranches[j]);
         }
+        // path is walked backward : put the branch back in the constraints direction
+        const int start = path.indexOf(event);
+        QStringList evtNames;
+        evtNames << event->getName();
+        for(int j=path.size()-1; j>=start; --j)
+            evtNames << path[j]->getName();
+        
+        throw QObject::tr("Circularity found in events model !\nPlease correct this branch :\n") + evtNames.join(" -> ");
     }
-    return branches;
+    return sorted;
 }
 
-
-
-
-#pragma mark Phases Branches
-QVector<QVector<Phase*> > ModelUtilities::getNextBranches(const QVector<Phase*>& curBranch, Phase* lastNode, const double gammaSum, const double maxLength)
+#pragma mark Phases graph
+/**
+ * @brief ModelUtilities::getPhasesTopologicalOrder
+ * Same as getEventsTopologicalOrder for phases.
+ * While sorting, the longest sum of gamma min (or fixed) leading to each phase is computed :
+ * it must stay lower than maxLength (the study period length).
+ */
+QVector<Phase*> ModelUtilities::getPhasesTopologicalOrder(const QList<Phase*>& phases, const double maxLength)
 {
-    QVector<QVector<Phase*> > branches;
-    QList<PhaseConstraint*> cts = lastNode->mConstraintsFwd;
-    if(cts.size() > 0)
+    QHash<Phase*, int> inDegrees;
+    inDegrees.reserve(phases.size());
+    
+    // Longest gamma sum leading to each phase, and the previous phase on this path
+    QHash<Phase*, double> gammaSums;
+    QHash<Phase*, Phase*> gammaPrevs;
+    
+    QVector<Phase*> sorted;
+    sorted.reserve(phases.size());
+    
+    for(int i=0; i<phases.size(); ++i)
     {
-        for(int i=0; i<cts.size(); ++i)
+        phases[i]->mLevel = 0;
+        inDegrees.insert(phases[i], phases[i]->mConstraintsBwd.size());
+        gammaSums.insert(phases[i], 0.);
+        if(phases[i]->mConstraintsBwd.isEmpty())
+            sorted.append(phases[i]);
+    }
+    
+    for(int i=0; i<sorted.size(); ++i)
+    {
+        Phase* phase = sorted[i];
+        const QList<PhaseConstraint*>& cts = phase->mConstraintsFwd;
+        for(int j=0; j<cts.size(); ++j)
         {
-            QVector<Phase*> branch = curBranch;
-            Phase* newNode = cts[i]->mPhaseTo;
+            Phase* next = cts[j]->mPhaseTo;
             
-            double gamma = gammaSum;
-            if(cts[i]->mGammaType == PhaseConstraint::eGammaFixed)
-                gamma += cts[i]->mGammaFixed;
-            else if(cts[i]->mGammaType == PhaseConstraint::eGammaRange)
-                gamma += cts[i]->mGammaMin;
+            double gamma = gammaSums.value(phase);
+            if(cts[j]->mGammaType == PhaseConstraint::eGammaFixed)
+                gamma += cts[j]->mGammaFixed;
+            else if(cts[j]->mGammaType == PhaseConstraint::eGammaRange)
+                gamma += cts[j]->mGammaMin;
             
-            if(gamma < maxLength)
-            {
-                if(newNode->mLevel <= lastNode->mLevel)
-                    newNode->mLevel = lastNode->mLevel + 1;
-                
-                if(!branch.contains(newNode))
-                {
-                    branch.append(newNode);
-                    QVector<QVector<Phase*> > nextBranches = getNextBranches(branch, cts[i]->mPhaseTo, gamma, maxLength);
-                    for(int j=0; j<nextBranches.size(); ++j)
-                        branches.append(nextBranches[j]);
-                }
-                else
-                {
-                    QStringList names;
-                    for(int j=0; j<branch.size(); ++j)
-                        names << branch[j]->getName();
-                    names << newNode->getName();
-                    
-                    throw QObject::tr("Circularity found in phases model !\nPlease correct this branch :\n") + names.join(" -> ");
-                }
-            }
-            else
+            if(gamma >= maxLength)
             {
                 QStringList names;
-                for(int j=0; j<curBranch.size(); ++j)
-                    names << curBranch[j]->getName();
-                names << newNode->getName();
+                for(Phase* p = phase; p; p = gammaPrevs.value(p, 0))
+                    names.prepend(p->getName());
+                names << next->getName();
                 throw QObject::tr("Phases branch too long :\n") + names.join(" -> ");
             }
+            
+            if(!gammaPrevs.contains(next) || gamma > gammaSums.value(next))
+            {
+                gammaSums[next] = gamma;
+                gammaPrevs[next] = phase;
+            }
+            
+            if(next->mLevel <= phase->mLevel)
+                next->mLevel = phase->mLevel + 1;
+            
+            if(--inDegrees[next] == 0)
+                sorted.append(next);
         }
     }
-    else
+    
+    if(sorted.size() < phases.size())
     {
-        branches.append(curBranch);
+        Phase* phase = 0;
+        for(int i=0; i<phases.size() && !phase; ++i)
+        {
+            if(inDegrees.value(phases[i]) > 0)
+                phase = phases[i];
+        }
+        QVector<Phase*> path;
+        QSet<Phase*> visited;
+        while(!visited.contains(phase))
+        {
+            visited.insert(phase);
+            path.append(phase);
+            const QList<PhaseConstraint*>& cts = phase->mConstraintsBwd;
+            for(int j=0; j<cts.size(); ++j)
+            {
+                if(inDegrees.value(cts[j]->mPhaseFrom) > 0)
+                {
+                    phase = cts[j]->mPhaseFrom;
+                    break;
+                }
+            }
+        }
+        const int start = path.indexOf(phase);
+        QStringList names;
+        names << phase->getName();
+        for(int j=path.size()-1; j>=start; --j)
+            names << path[j]->getName();
+        
+        throw QObject::tr("Circularity found in phases model !\nPlease correct this branch :\n") + names.join(" -> ");
     }
-    return branches;
+    return sorted;
 }
 
-QVector<QVector<Phase*> > ModelUtilities::getBranchesFromPhase(Phase* start, const double maxLength)
+/**
+ * @brief ModelUtilities::getPhasesDescendants
+ * @param phases the model phases, giving the bits indexes
+ * @param sortedPhases the same phases in topological order (see getPhasesTopologicalOrder)
+ * @return for each phase, the set of phases constrained after it (directly or not) : descendants[i].testBit(j)
+ * is true if phases[j] is after phases[i] in a branch.
+ */
+QVector<QBitArray> ModelUtilities::getPhasesDescendants(const QList<Phase*>& phases, const QVector<Phase*>& sortedPhases)
 {
-    QVector<Phase*> startBranch;
-    start->mLevel = 0;
-    startBranch.append(start);
+    QHash<const Phase*, int> indexes;
+    indexes.reserve(phases.size());
+    for(int i=0; i<phases.size(); ++i)
+        indexes.insert(phases[i], i);
     
-    QVector<QVector<Phase*> > nextBranches;
-    try{
-        nextBranches = getNextBranches(startBranch, start, 0, maxLength);
-    }catch(QString error){
-        throw error;
-    }
+    QVector<QBitArray> descendants(phases.size(), QBitArray(phases.size()));
     
-    return nextBranches;
+    // Reverse topological order : the descendants of the next phases are already known
+    for(int i=sortedPhases.size()-1; i>=0; --i)
+    {
+        const Phase* phase = sortedPhases[i];
+        QBitArray& bits = descendants[indexes.value(phase)];
+        const QList<PhaseConstraint*>& cts = phase->mConstraintsFwd;
+        for(int j=0; j<cts.size(); ++j)
+        {
+            const int next = indexes.value(cts[j]->mPhaseTo);
+            bits.setBit(next);
+            bits |= descendants.at(next);
+        }
+    }
+    return descendants;
 }
 
 
-QVector<QVector<Phase*> > ModelUtilities::getAllPhasesBranches(const QList<Phase*>& phases, const double maxLength)
+#pragma mark Events independence
+static bool degreeGreaterThan(const QPair<int, int>& v1, const QPair<int, int>& v2){return (v1.second > v2.second);}
+
+/**
+ * @brief ModelUtilities::getEventsIndependentClasses
+ * Partition the events into classes of conditionally independent events (greedy graph coloring).
+ * The full conditional of an event theta depends on the events linked to it by an event constraint,
+ * on the other events of its phases having a duration constraint (tau), and on the events of the phases
+ * constrained before or after its phases. Two events coupled this way never share a class :
+ * the events of a class can thus be updated in parallel.
+ * @return the classes, each one keeping the events list order
+ */
+QVector<QVector<Event*> > ModelUtilities::getEventsIndependentClasses(const QList<Event*>& events, const QList<Phase*>& phases)
 {
-    QVector<QVector<Phase*> > branches;
+    QHash<const Event*, int> indexes;
+    indexes.reserve(events.size());
+    for(int i=0; i<events.size(); ++i)
+        indexes.insert(events[i], i);
+    
+    // ----------------------------------------
+    //  Coupling graph
+    // ----------------------------------------
+    QVector<QVector<int> > neighbours(events.size());
+    
+    for(int i=0; i<events.size(); ++i)
+    {
+        const QList<EventConstraint*>& cts = events[i]->mConstraintsFwd;
+        for(int j=0; j<cts.size(); ++j)
+        {
+            const int next = indexes.value(cts[j]->mEventTo);
+            neighbours[i].append(next);
+            neighbours[next].append(i);
+        }
+    }
     
-    QVector<Phase*> starts;
     for(int i=0; i<phases.size(); ++i)
     {
-        phases[i]->mLevel = 0;
-        if(phases[i]->mConstraintsBwd.size() == 0)
-            starts.append(phases[i]);
+        const QList<Event*>& phaseEvents = phases[i]->mEvents;
+        if(phases[i]->mTauType != Phase::eTauUnknown)
+        {
+            for(int j=0; j<phaseEvents.size(); ++j)
+            {
+                const int e1 = indexes.value(phaseEvents[j]);
+                for(int k=j+1; k<phaseEvents.size(); ++k)
+                {
+                    const int e2 = indexes.value(phaseEvents[k]);
+                    neighbours[e1].append(e2);
+                    neighbours[e2].append(e1);
+                }
+            }
+        }
+        const QList<PhaseConstraint*>& cts = phases[i]->mConstraintsFwd;
+        for(int j=0; j<cts.size(); ++j)
+        {
+            const QList<Event*>& nextEvents = cts[j]->mPhaseTo->mEvents;
+            for(int k=0; k<phaseEvents.size(); ++k)
+            {
+                const int e1 = indexes.value(phaseEvents[k]);
+                for(int l=0; l<nextEvents.size(); ++l)
+                {
+                    const int e2 = indexes.value(nextEvents[l]);
+                    neighbours[e1].append(e2);
+                    neighbours[e2].append(e1);
+                }
+            }
+        }
     }
-    if(starts.size() == 0 && phases.size() != 0)
+    
+    // ----------------------------------------
+    //  Greedy coloring, most coupled events first (Welsh-Powell)
+    // ----------------------------------------
+    QVector<QPair<int, int> > order(events.size());
+    for(int i=0; i<events.size(); ++i)
     {
-        throw QObject::tr("Circularity found in phases model !");
+        QVector<int>& n = neighbours[i];
+        std::sort(n.begin(), n.end());
+        n.erase(std::unique(n.begin(), n.end()), n.end());
+        order[i] = qMakePair(i, n.size());
     }
-    for(int i=0; i<starts.size(); ++i)
+    std::stable_sort(order.begin(), order.end(), degreeGreaterThan);
+    
+    QVector<int> colors(events.size(), -1);
+    // forbidden[c] == i means that color c is used by a neighbour of the event i
+    QVector<int> forbidden;
+    int numColors = 0;
+    
+    for(int i=0; i<order.size(); ++i)
     {
-        QVector<QVector<Phase*> > phaseBranches;
-        try{
-            phaseBranches = getBranchesFromPhase(starts[i], maxLength);
-        }catch(QString error){
-            throw error;
+        const int e = order[i].first;
+        const QVector<int>& n = neighbours.at(e);
+        for(int j=0; j<n.size(); ++j)
+        {
+            if(colors[n[j]] >= 0)
+                forbidden[colors[n[j]]] = e;
+        }
+        int color = 0;
+        while(color < numColors && forbidden[color] == e)
+            ++color;
+        if(color == numColors)
+        {
+            ++numColors;
+            forbidden.append(-1);
         }
-        for(int j=0; j<phaseBranches.size(); ++j)
-            branches.append(phaseBranches[j]);
+        colors[e] = color;
     }
-    return branches;
+    
+    QVector<QVector<Event*> > classes(numColors);
+    for(int i=0; i<events.size(); ++i)
+        classes[colors[i]].append(events[i]);
+    
+    return classes;
 }
 
 
 #pragma mark sort events by level
+static bool eventLevelLessThan(const Event* e1, const Event* e2){return (e1->mLevel < e2->mLevel);}
+static bool phaseLevelLessThan(const Phase* p1, const Phase* p2){return (p1->mLevel < p2->mLevel);}
+
 QVector<Event*> ModelUtilities::sortEventsByLevel(const QList<Event*>& events)
 {
-    int numSorted = 0;
-    int curLevel = 0;
-    QVector<Event*> results;
-    
-    while(numSorted < events.size())
-    {
-        for(int i=0; i<events.size(); ++i)
-        {
-            if(events[i]->mLevel == curLevel)
-            {
-                results.append(events[i]);
-                ++numSorted;
-            }
-        }
-        ++curLevel;
-    }
+    // Stable sort keeps the events list order inside a level
+    QVector<Event*> results = events.toVector();
+    std::stable_sort(results.begin(), results.end(), eventLevelLessThan);
     return results;
 }
 
 QVector<Phase*> ModelUtilities::sortPhasesByLevel(const QList<Phase*>& phases)
 {
-    int numSorted = 0;
-    int curLevel = 0;
-    QVector<Phase*> results;
-    
-    while(numSorted < phases.size())
-    {
-        for(int i=0; i<phases.size(); ++i)
-        {
-            if(phases[i]->mLevel == curLevel)
-            {
-                results.append(phases[i]);
-                ++numSorted;
-            }
-        }
-        ++curLevel;
-    }
+    QVector<Phase*> results = phases.toVector();
+    std::stable_sort(results.begin(), results.end(), phaseLevelLessThan);
     return results;
 }
 
@@ -528,3 +637,91 @@ QString ModelUtilities::phaseResultsHTML(Phase* p)
     }
     return text;
 }
+
+#pragma mark Project state
+/**
+ * @brief Gives a chance to the plugins to update dates saved with older versions (e.g. a new parameter in the 14C plugin).
+ */
+QJsonObject ModelUtilities::checkDatesCompatibility(const QJsonObject& stateToCheck)
+{
+    QJsonObject state = stateToCheck;
+    QJsonArray events = state[STATE_EVENTS].toArray();
+    
+    for(int i=0; i<events.size(); ++i)
+    {
+        QJsonObject event = events[i].toObject();
+        QJsonArray dates = event[STATE_EVENT_DATES].toArray();
+        for(int j=0; j<dates.size(); ++j)
+        {
+            QJsonObject date = dates[j].toObject();
+            
+            // -----------------------------------------------------------
+            //  Check the date compatibility with the plugin version
+            // -----------------------------------------------------------
+            if(date.find(STATE_DATE_SUB_DATES) == date.end())
+                date[STATE_DATE_SUB_DATES] = QJsonArray();
+            
+            if(date.find(STATE_DATE_VALID) == date.end())
+                date[STATE_DATE_VALID] = true;
+            
+            // etc...
+            // Here, we could control if all date fields are present, and add them if not.
+            
+            // -----------------------------------------------------------
+            //  Check the date compatibility with the plugin version
+            //  Only the STATE_DATE_DATA is to be checked
+            // -----------------------------------------------------------
+            QString pluginId = date[STATE_DATE_PLUGIN_ID].toString();
+            PluginAbstract* plugin = PluginManager::getPluginFromId(pluginId);
+            date[STATE_DATE_DATA] = plugin->checkValuesCompatibility(date[STATE_DATE_DATA].toObject());
+            
+            // -----------------------------------------------------------
+            //  Check subdates compatibility with the plugin version
+            // -----------------------------------------------------------
+            QJsonArray subdates = date[STATE_DATE_SUB_DATES].toArray();
+            for(int k=0; k<subdates.size(); ++k){
+                QJsonObject subdate = subdates[k].toObject();
+                subdate[STATE_DATE_DATA] = plugin->checkValuesCompatibility(subdate[STATE_DATE_DATA].toObject());
+                subdates[k] = subdate;
+            }
+            date[STATE_DATE_SUB_DATES] = subdates;
+            // -----------------------------------------------------------
+            
+            dates[j] = date;
+            event[STATE_EVENT_DATES] = dates;
+            events[i] = event;
+            state[STATE_EVENTS] = events;
+        }
+    }
+    return state;
+}
+
+/**
+ * @brief Updates the "valid" flag of the dates on the study period of the state.
+ */
+QJsonObject ModelUtilities::checkValidDates(const QJsonObject& stateToCheck)
+{
+    QJsonObject state = stateToCheck;
+    
+    QJsonObject settingsJson = state[STATE_SETTINGS].toObject();
+    ProjectSettings settings = ProjectSettings::fromJson(settingsJson);
+    
+    QJsonArray events = state[STATE_EVENTS].toArray();
+    for(int i=0; i<events.size(); ++i){
+        QJsonObject event = events[i].toObject();
+        QJsonArray dates = event[STATE_EVENT_DATES].toArray();
+        for(int j=0; j<dates.size(); ++j){
+            QJsonObject date = dates[j].toObject();
+            
+            PluginAbstract* plugin = PluginManager::getPluginFromId(date[STATE_DATE_PLUGIN_ID].toString());
+            bool valid = plugin->isDateValid(date[STATE_DATE_DATA].toObject(), settings);
+            date[STATE_DATE_VALID] = valid;
+            
+            dates[j] = date;
+        }
+        event[STATE_EVENT_DATES] = dates;
+        events[i] = event;
+    }
+    state[STATE_EVENTS] = events;
+    return state;
+}
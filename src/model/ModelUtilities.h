@@ -4,6 +4,7 @@
 #include <QIcon>
 #include <QString>
 #include <QVector>
+#include <QBitArray>
 #include "Date.h"
 #include "Event.h"
 #include "Phase.h"
@@ -19,13 +20,11 @@ public:
     static Event::Method getEventMethodFromText(const QString& text);
     static Date::DataMethod getDataMethodFromText(const QString& text);
     
-    static QVector<QVector<Event*> > getNextBranches(const QVector<Event*>& curBranch, Event* lastNode);
-    static QVector<QVector<Event*> > getBranchesFromEvent(Event* start);
-    static QVector<QVector<Event*> > getAllEventsBranches(const QList<Event*>& events);
+    static QVector<Event*> getEventsTopologicalOrder(const QList<Event*>& events);
+    static QVector<Phase*> getPhasesTopologicalOrder(const QList<Phase*>& phases, const double maxLength);
+    static QVector<QBitArray> getPhasesDescendants(const QList<Phase*>& phases, const QVector<Phase*>& sortedPhases);
     
-    static QVector<QVector<Phase*> > getNextBranches(const QVector<Phase*>& curBranch, Phase* lastNode, const double gammaSum, const double maxLength);
-    static QVector<QVector<Phase*> > getBranchesFromPhase(Phase* start, const double maxLength);
-    static QVector<QVector<Phase*> > getAllPhasesBranches(const QList<Phase*>& events, const double maxLength);
+    static QVector<QVector<Event*> > getEventsIndependentClasses(const QList<Event*>& events, const QList<Phase*>& phases);
     
     static QVector<Event*> sortEventsByLevel(const QList<Event*>& events);
     static QVector<Phase*> sortPhasesByLevel(const QList<Phase*>& phases);
@@ -39,6 +38,9 @@ public:
     static QString dateResultsHTML(Date* d);
     static QString eventResultsHTML(Event* e, bool withDates);
     static QString phaseResultsHTML(Phase* p);
+    
+    static QJsonObject checkDatesCompatibility(const QJsonObject& state);
+    static QJsonObject checkValidDates(const QJsonObject& state);
 };
 
 // These 2 global functions are used to sort events and phases lists in result view
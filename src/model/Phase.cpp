@@ -3,7 +3,7 @@
 #include "PhaseConstraint.h"
 #include "Generator.h"
 #include "QtUtilities.h"
-#include <QtWidgets>
+#include <QtCore>
 
 
 Phase::Phase():
@@ -2,7 +2,6 @@
 #define PLUGINABSTRACT_H
 
 #include "Date.h"
-#include "GraphView.h"
 #include "ProjectSettings.h"
 
 //#include <QtPlugin>
@@ -11,6 +10,9 @@
 #include <QDir>
 #include <QString>
 #include <QColor>
+#include <QIcon>
+#include <QHash>
+#include <QVariant>
 #include <QList>
 #include <QTextStream>
 #include <QPair>
@@ -18,10 +20,6 @@
 #include <QLocale>
 
 class ParamMCMC;
-class GraphView;
-class PluginFormAbstract;
-class GraphViewRefAbstract;
-class PluginSettingsViewAbstract;
 
 
 struct GroupedAction{
@@ -40,12 +38,15 @@ class PluginAbstract: public QObject
 {
     Q_OBJECT
 public:
-    PluginAbstract():mRefGraph(0){}
+    PluginAbstract(){}
     virtual ~PluginAbstract(){}
     
     virtual double getLikelyhood(const double& t, const QJsonObject& data) = 0;
     virtual QPair<double, double > getLikelyhoodArg(const double& t, const QJsonObject& data){return QPair<double, double>();}
     virtual bool withLikelyhoodArg() {return false;}
+    // Closed-form gaussian likelihood, when the data allows it (see DatesGaussBatch)
+    virtual bool withGaussianLikelyhood(const QJsonObject& data) {return false;}
+    virtual GaussianLikelyhood getGaussianLikelyhood(const QJsonObject& data) {return GaussianLikelyhood();}
 
     virtual QString getName() const = 0;
     virtual QIcon getIcon() const = 0;
@@ -80,12 +81,9 @@ public:
     virtual QJsonObject checkValuesCompatibility(const QJsonObject& values){return values;}
     virtual bool isDateValid(const QJsonObject& data, const ProjectSettings& settings){return true;}
     
-    virtual PluginFormAbstract* getForm() = 0;
-    virtual GraphViewRefAbstract* getGraphViewRef() = 0;
-    virtual PluginSettingsViewAbstract* getSettingsView() = 0;
+    // The forms, reference views and settings views are created by the user interface (see PluginUiAbstract)
     virtual QList<QHash<QString, QVariant>> getGroupedActions() {return QList<QHash<QString, QVariant>>();}
     
-    GraphViewRefAbstract* mRefGraph;
     QColor mColor;
     
 
@@ -0,0 +1,29 @@
+#ifndef PLUGINUIABSTRACT_H
+#define PLUGINUIABSTRACT_H
+
+class PluginAbstract;
+class PluginFormAbstract;
+class GraphViewRefAbstract;
+class PluginSettingsViewAbstract;
+
+
+/**
+ * @brief User interface of a plugin : creates its data form, reference curve view and settings view.
+ * PluginAbstract only holds the likelihood and the reference curves, so that the core library does not depend on the widgets.
+ * The user interfaces are created by PluginUiManager, one per loaded plugin.
+ */
+class PluginUiAbstract
+{
+public:
+    PluginUiAbstract(PluginAbstract* plugin):mPlugin(plugin), mRefGraph(0){}
+    virtual ~PluginUiAbstract(){}
+    
+    virtual PluginFormAbstract* getForm() = 0;
+    virtual GraphViewRefAbstract* getGraphViewRef() = 0;
+    virtual PluginSettingsViewAbstract* getSettingsView() = 0;
+    
+    PluginAbstract* mPlugin;
+    GraphViewRefAbstract* mRefGraph;
+};
+
+#endif
@@ -3,13 +3,12 @@
 
 #include "QtUtilities.h"
 #include "StdUtilities.h"
-#include "Plugin14CForm.h"
-#include "Plugin14CRefView.h"
-#include "Plugin14CSettingsView.h"
+#include "CalibrationStore.h"
 #include <cstdlib>
 #include <iostream>
 #include <QJsonObject>
-#include <QtWidgets>
+#include <QtCore>
+#include <QIcon>
 
 
 Plugin14C::Plugin14C()
@@ -34,13 +33,16 @@ QPair<double, double > Plugin14C::getLikelyhoodArg(const double& t, const QJsonO
     
     
     // Check if calib curve exists !
-    if(mRefDatas.find(ref_curve) != mRefDatas.end())
+    // Read only : the likelihoods are computed by several threads at once
+    const QMap< QString, QMap<QString, QMap<double, double> > >& refDatas = mRefDatas;
+    QMap< QString, QMap<QString, QMap<double, double> > >::const_iterator curves = refDatas.constFind(ref_curve);
+    if(curves != refDatas.constEnd())
     {
         double variance;
 
         
-        const QMap<double, double>& curveG = mRefDatas[ref_curve]["G"];
-        const QMap<double, double>& curveG95Sup = mRefDatas[ref_curve]["G95Sup"];
+        const QMap<double, double> curveG = curves.value().value("G");
+        const QMap<double, double> curveG95Sup = curves.value().value("G95Sup");
         
         double tMinDef=curveG.firstKey();
         double tMaxDef=curveG.lastKey();
@@ -214,11 +216,6 @@ int Plugin14C::csvMinColumns() const{
     return csvColumns().count() - 2;
 }
 
-PluginFormAbstract* Plugin14C::getForm()
-{
-    Plugin14CForm* form = new Plugin14CForm(this);
-    return form;
-}
 
 QJsonObject Plugin14C::fromCSV(const QStringList& list)
 {
@@ -291,7 +288,7 @@ QStringList Plugin14C::getRefsNames() const
 
 QString Plugin14C::getRefsPath() const
 {
-    QString path = qApp->applicationDirPath();
+    QString path = QCoreApplication::applicationDirPath();
 #ifdef Q_OS_MAC
     QDir dir(path);
     dir.cdUp();
@@ -304,6 +301,8 @@ QString Plugin14C::getRefsPath() const
 void Plugin14C::loadRefDatas()//const ProjectSettings& settings)
 {
     mRefDatas.clear();
+    // The stored calibrations were computed with the previous curves, which may have been edited or replaced
+    CalibrationStore::clear();
     
     QString calibPath = getRefsPath();
     QDir calibDir(calibPath);
@@ -415,20 +414,7 @@ const QMap<QString, QMap<double, double> >& Plugin14C::getRefData(const QString&
 }
 
 // ------------------------------------------------------------------
-GraphViewRefAbstract* Plugin14C::getGraphViewRef()
-{
-    //if(!mRefGraph) mRefGraph = new Plugin14CRefView();
-    
-    if(mRefGraph) delete mRefGraph;
-    mRefGraph = new Plugin14CRefView();
-    
-    return mRefGraph;
-}
 
-PluginSettingsViewAbstract* Plugin14C::getSettingsView()
-{
-    return new Plugin14CSettingsView(this);
-}
 
 QList<QHash<QString, QVariant>> Plugin14C::getGroupedActions()
 {
@@ -36,9 +36,6 @@ public:
     QStringList toCSV(const QJsonObject& data, const QLocale& csvLocale);
     QString getDateDesc(const Date* date) const;
     
-    PluginFormAbstract* getForm();
-    GraphViewRefAbstract* getGraphViewRef();
-    PluginSettingsViewAbstract* getSettingsView();
     QList<QHash<QString, QVariant>> getGroupedActions();
     
     QJsonObject checkValuesCompatibility(const QJsonObject& values);
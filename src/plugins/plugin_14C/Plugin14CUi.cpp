@@ -0,0 +1,39 @@
+#include "Plugin14CUi.h"
+#if USE_PLUGIN_14C
+
+#include "Plugin14C.h"
+#include "Plugin14CForm.h"
+#include "Plugin14CRefView.h"
+#include "Plugin14CSettingsView.h"
+
+
+Plugin14CUi::Plugin14CUi(Plugin14C* plugin):PluginUiAbstract(plugin),
+mPlugin14C(plugin)
+{
+
+}
+
+Plugin14CUi::~Plugin14CUi()
+{
+    
+}
+
+PluginFormAbstract* Plugin14CUi::getForm()
+{
+    Plugin14CForm* form = new Plugin14CForm(mPlugin14C);
+    return form;
+}
+
+GraphViewRefAbstract* Plugin14CUi::getGraphViewRef()
+{
+    if(mRefGraph) delete mRefGraph;
+    mRefGraph = new Plugin14CRefView();
+    return mRefGraph;
+}
+
+PluginSettingsViewAbstract* Plugin14CUi::getSettingsView()
+{
+    return new Plugin14CSettingsView(mPlugin14C);
+}
+
+#endif
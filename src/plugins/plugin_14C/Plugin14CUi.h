@@ -0,0 +1,27 @@
+#ifndef Plugin14CUi_H
+#define Plugin14CUi_H
+
+#if USE_PLUGIN_14C
+
+#include "../PluginUiAbstract.h"
+
+class Plugin14C;
+
+
+class Plugin14CUi: public PluginUiAbstract
+{
+public:
+    Plugin14CUi(Plugin14C* plugin);
+    virtual ~Plugin14CUi();
+    
+    PluginFormAbstract* getForm();
+    GraphViewRefAbstract* getGraphViewRef();
+    PluginSettingsViewAbstract* getSettingsView();
+    
+private:
+    Plugin14C* mPlugin14C;
+};
+
+#endif
+
+#endif
@@ -2,14 +2,13 @@
 #if USE_PLUGIN_AM
 
 #include "StdUtilities.h"
+#include "CalibrationStore.h"
 #include "QtUtilities.h"
-#include "PluginMagForm.h"
-#include "PluginMagRefView.h"
-#include "PluginMagSettingsView.h"
 #include <cstdlib>
 #include <iostream>
 #include <QJsonObject>
-#include <QtWidgets>
+#include <QtCore>
+#include <QIcon>
 
 
 PluginMag::PluginMag()
@@ -58,10 +57,13 @@ QPair<double, double > PluginMag::getLikelyhoodArg(const double& t, const QJsonO
     
     
     
-    if(mRefDatas.find(ref_curve) != mRefDatas.end())
+    // Read only : the likelihoods are computed by several threads at once
+    const QMap< QString, QMap<QString, QMap<double, double> > >& refDatas = mRefDatas;
+    QMap< QString, QMap<QString, QMap<double, double> > >::const_iterator curves = refDatas.constFind(ref_curve);
+    if(curves != refDatas.constEnd())
     {
-        const QMap<double, double>& curveG = mRefDatas[ref_curve]["G"];
-        const QMap<double, double>& curveG95Sup = mRefDatas[ref_curve]["G95Sup"];
+        const QMap<double, double> curveG = curves.value().value("G");
+        const QMap<double, double> curveG95Sup = curves.value().value("G95Sup");
         
         
         double tMinDef=curveG.firstKey();
@@ -125,7 +127,6 @@ bool PluginMag::isDateValid(const QJsonObject& data, const ProjectSettings& sett
     double intensity = data[DATE_AM_INTENSITY_STR].toDouble();
 
 
-
     double mesure;
     double error;
 
@@ -245,12 +246,6 @@ QStringList PluginMag::csvColumns() const
 }
 
 
-PluginFormAbstract* PluginMag::getForm()
-{
-    PluginMagForm* form = new PluginMagForm(this);
-    return form;
-}
-
 QJsonObject PluginMag::fromCSV(const QStringList& list)
 {
     QJsonObject json;
@@ -334,7 +329,7 @@ QStringList PluginMag::getRefsNames() const
 
 QString PluginMag::getRefsPath() const
 {
-    QString path = qApp->applicationDirPath();
+    QString path = QCoreApplication::applicationDirPath();
 #ifdef Q_OS_MAC
     QDir dir(path);
     dir.cdUp();
@@ -459,6 +454,9 @@ QMap<QString, QMap<double, double> > PluginMag::loadRefFile(QFileInfo refFile)
 
 void PluginMag::loadRefDatas()
 {
+    // The stored calibrations were computed with the previous curves, which may have been edited or replaced
+    CalibrationStore::clear();
+    
     QString path = QDir::currentPath();
     QString calibPath = getRefsPath();
     
@@ -586,25 +584,11 @@ void PluginMag::loadRefDatas()
     }
 }
 
-GraphViewRefAbstract* PluginMag::getGraphViewRef()
-{
-    /*if(!mRefGraph)
-        mRefGraph = new PluginMagRefView(mLanguage);
-    */
-    if(mRefGraph) delete mRefGraph;
-    mRefGraph = new PluginMagRefView();
-    
-    return mRefGraph;
-}
 
 const QMap<QString, QMap<double, double> >& PluginMag::getRefData(const QString& name)
 {
     return mRefDatas[name.toLower()];
 }
 
-PluginSettingsViewAbstract* PluginMag::getSettingsView()
-{
-    return new PluginMagSettingsView(this);
-}
 
 #endif
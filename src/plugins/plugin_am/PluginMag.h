@@ -40,9 +40,6 @@ public:
     QStringList toCSV(const QJsonObject& data, const QLocale &csvLocale);
     QString getDateDesc(const Date* date) const;
     
-    PluginFormAbstract* getForm();
-    GraphViewRefAbstract* getGraphViewRef();
-    PluginSettingsViewAbstract* getSettingsView();
     
     bool isDateValid(const QJsonObject& data, const ProjectSettings& settings);
     // ---------------------
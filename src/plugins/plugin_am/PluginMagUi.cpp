@@ -0,0 +1,39 @@
+#include "PluginMagUi.h"
+#if USE_PLUGIN_AM
+
+#include "PluginMag.h"
+#include "PluginMagForm.h"
+#include "PluginMagRefView.h"
+#include "PluginMagSettingsView.h"
+
+
+PluginMagUi::PluginMagUi(PluginMag* plugin):PluginUiAbstract(plugin),
+mPluginMag(plugin)
+{
+
+}
+
+PluginMagUi::~PluginMagUi()
+{
+    
+}
+
+PluginFormAbstract* PluginMagUi::getForm()
+{
+    PluginMagForm* form = new PluginMagForm(mPluginMag);
+    return form;
+}
+
+GraphViewRefAbstract* PluginMagUi::getGraphViewRef()
+{
+    if(mRefGraph) delete mRefGraph;
+    mRefGraph = new PluginMagRefView();
+    return mRefGraph;
+}
+
+PluginSettingsViewAbstract* PluginMagUi::getSettingsView()
+{
+    return new PluginMagSettingsView(mPluginMag);
+}
+
+#endif
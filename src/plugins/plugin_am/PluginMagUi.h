@@ -0,0 +1,27 @@
+#ifndef PluginMagUi_H
+#define PluginMagUi_H
+
+#if USE_PLUGIN_AM
+
+#include "../PluginUiAbstract.h"
+
+class PluginMag;
+
+
+class PluginMagUi: public PluginUiAbstract
+{
+public:
+    PluginMagUi(PluginMag* plugin);
+    virtual ~PluginMagUi();
+    
+    PluginFormAbstract* getForm();
+    GraphViewRefAbstract* getGraphViewRef();
+    PluginSettingsViewAbstract* getSettingsView();
+    
+private:
+    PluginMag* mPluginMag;
+};
+
+#endif
+
+#endif
@@ -2,14 +2,13 @@
 #if USE_PLUGIN_GAUSS
 
 #include "StdUtilities.h"
+#include "CalibrationStore.h"
 #include "QtUtilities.h"
-#include "PluginGaussForm.h"
-#include "PluginGaussRefView.h"
-#include "PluginGaussSettingsView.h"
 #include <cstdlib>
 #include <iostream>
 #include <QJsonObject>
-#include <QtWidgets>
+#include <QtCore>
+#include <QIcon>
 
 
 PluginGauss::PluginGauss()
@@ -53,10 +52,13 @@ QPair<double, double > PluginGauss::getLikelyhoodArg(const double& t, const QJso
     }
     else if(mode == DATE_GAUSS_MODE_CURVE){
         // Check if calib curve exists !
-        if(mRefDatas.find(ref_curve) != mRefDatas.end())
+        // Read only : the likelihoods are computed by several threads at once
+        const QMap< QString, QMap<QString, QMap<double, double> > >& refDatas = mRefDatas;
+        QMap< QString, QMap<QString, QMap<double, double> > >::const_iterator curves = refDatas.constFind(ref_curve);
+        if(curves != refDatas.constEnd())
         {
-            const QMap<double, double>& curveG = mRefDatas[ref_curve]["G"];
-            const QMap<double, double>& curveG95Sup = mRefDatas[ref_curve]["G95Sup"];
+            const QMap<double, double> curveG = curves.value().value("G");
+            const QMap<double, double> curveG95Sup = curves.value().value("G95Sup");
             
             double tMinDef=curveG.firstKey();
             double tMaxDef=curveG.lastKey();
@@ -100,6 +102,30 @@ QPair<double, double > PluginGauss::getLikelyhoodArg(const double& t, const QJso
     return qMakePair(variance, exponent);
 }
 
+bool PluginGauss::withGaussianLikelyhood(const QJsonObject& data)
+{
+    QString mode = data[DATE_GAUSS_MODE_STR].toString();
+    return (mode == DATE_GAUSS_MODE_EQ || mode == DATE_GAUSS_MODE_NONE);
+}
+
+GaussianLikelyhood PluginGauss::getGaussianLikelyhood(const QJsonObject& data)
+{
+    GaussianLikelyhood result;
+    result.mMeasure = data[DATE_GAUSS_AGE_STR].toDouble();
+    result.mError = data[DATE_GAUSS_ERROR_STR].toDouble();
+    
+    if(data[DATE_GAUSS_MODE_STR].toString() == DATE_GAUSS_MODE_NONE){
+        result.mA = 0;
+        result.mB = 1;
+        result.mC = 0;
+    }
+    else{
+        result.mA = data[DATE_GAUSS_A_STR].toDouble();
+        result.mB = data[DATE_GAUSS_B_STR].toDouble();
+        result.mC = data[DATE_GAUSS_C_STR].toDouble();
+    }
+    return result;
+}
 
 QString PluginGauss::getName() const
 {
@@ -141,12 +167,6 @@ QStringList PluginGauss::csvColumns() const
 }
 
 
-PluginFormAbstract* PluginGauss::getForm()
-{
-    PluginGaussForm* form = new PluginGaussForm(this);
-    return form;
-}
-
 /**
   * @todo for now, CSV imported data are only of equation type !
  We need to define a CSV format to allow curve mode.
@@ -257,7 +277,7 @@ QStringList PluginGauss::getRefsNames() const
 
 QString PluginGauss::getRefsPath() const
 {
-    QString path = qApp->applicationDirPath();
+    QString path = QCoreApplication::applicationDirPath();
 #ifdef Q_OS_MAC
     QDir dir(path);
     dir.cdUp();
@@ -270,6 +290,8 @@ QString PluginGauss::getRefsPath() const
 void PluginGauss::loadRefDatas()//const ProjectSettings& settings)
 {
     mRefDatas.clear();
+    // The stored calibrations were computed with the previous curves, which may have been edited or replaced
+    CalibrationStore::clear();
     
     QString calibPath = getRefsPath();
     QDir calibDir(calibPath);
@@ -381,23 +403,6 @@ const QMap<QString, QMap<double, double> >& PluginGauss::getRefData(const QStrin
 
 // ------------------------------------------------------------------
 
-GraphViewRefAbstract* PluginGauss::getGraphViewRef()
-{
-    //if(!mRefGraph) mRefGraph = new PluginGaussRefView(mLanguage);
-
-    if(mRefGraph) delete mRefGraph;
-    mRefGraph = new PluginGaussRefView();
-    
-    return mRefGraph;
-}
-
-PluginSettingsViewAbstract* PluginGauss::getSettingsView()
-{
-    return new PluginGaussSettingsView(this);
-}
-
-// ------------------------------------------------------------------
-
 QJsonObject PluginGauss::checkValuesCompatibility(const QJsonObject& values){
     QJsonObject result = values;
     if(!values.contains(DATE_GAUSS_MODE_STR)){
@@ -0,0 +1,39 @@
+#include "PluginGaussUi.h"
+#if USE_PLUGIN_GAUSS
+
+#include "PluginGauss.h"
+#include "PluginGaussForm.h"
+#include "PluginGaussRefView.h"
+#include "PluginGaussSettingsView.h"
+
+
+PluginGaussUi::PluginGaussUi(PluginGauss* plugin):PluginUiAbstract(plugin),
+mPluginGauss(plugin)
+{
+
+}
+
+PluginGaussUi::~PluginGaussUi()
+{
+    
+}
+
+PluginFormAbstract* PluginGaussUi::getForm()
+{
+    PluginGaussForm* form = new PluginGaussForm(mPluginGauss);
+    return form;
+}
+
+GraphViewRefAbstract* PluginGaussUi::getGraphViewRef()
+{
+    if(mRefGraph) delete mRefGraph;
+    mRefGraph = new PluginGaussRefView();
+    return mRefGraph;
+}
+
+PluginSettingsViewAbstract* PluginGaussUi::getSettingsView()
+{
+    return new PluginGaussSettingsView(mPluginGauss);
+}
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef PluginGaussUi_H
+#define PluginGaussUi_H
+
+#if USE_PLUGIN_GAUSS
+
+#include "../PluginUiAbstract.h"
+
+class PluginGauss;
+
+
+class PluginGaussUi: public PluginUiAbstract
+{
+public:
+    PluginGaussUi(PluginGauss* plugin);
+    virtual ~PluginGaussUi();
+    
+    PluginFormAbstract* getForm();
+    GraphViewRefAbstract* getGraphViewRef();
+    PluginSettingsViewAbstract* getSettingsView();
+    
+private:
+    PluginGauss* mPluginGauss;
+};
+
+#endif
+
+#endif
@@ -2,12 +2,11 @@
 #if USE_PLUGIN_TL
 
 #include "StdUtilities.h"
-#include "PluginTLForm.h"
-#include "PluginTLRefView.h"
 #include <cstdlib>
 #include <iostream>
 #include <QJsonObject>
-#include <QtWidgets>
+#include <QtCore>
+#include <QIcon>
 
 
 PluginTL::PluginTL()
@@ -39,6 +38,24 @@ QPair<double, double > PluginTL::getLikelyhoodArg(const double& t, const QJsonOb
     return result;
 }
 
+bool PluginTL::withGaussianLikelyhood(const QJsonObject& data)
+{
+    Q_UNUSED(data);
+    return true;
+}
+
+GaussianLikelyhood PluginTL::getGaussianLikelyhood(const QJsonObject& data)
+{
+    // g(t) = ref_year - t
+    GaussianLikelyhood result;
+    result.mMeasure = data[DATE_TL_AGE_STR].toDouble();
+    result.mError = data[DATE_TL_ERROR_STR].toDouble();
+    result.mA = 0;
+    result.mB = -1;
+    result.mC = data[DATE_TL_REF_YEAR_STR].toDouble();
+    return result;
+}
+
 QString PluginTL::getName() const
 {
     return QString("TL/OSL");
@@ -75,12 +92,6 @@ QStringList PluginTL::csvColumns() const
 }
 
 
-PluginFormAbstract* PluginTL::getForm()
-{
-    PluginTLForm* form = new PluginTLForm(this);
-    return form;
-}
-
 QJsonObject PluginTL::fromCSV(const QStringList& list)
 {
     QJsonObject json;
@@ -117,20 +128,4 @@ QString PluginTL::getDateDesc(const Date* date) const
 }
 
 
-// ------------------------------------------------------------------
-
-GraphViewRefAbstract* PluginTL::getGraphViewRef()
-{
-    //if(!mRefGraph) mRefGraph = new PluginTLRefView();
-    
-    if(mRefGraph) delete mRefGraph;
-    mRefGraph = new PluginTLRefView();
-    return mRefGraph;
-}
-
-PluginSettingsViewAbstract* PluginTL::getSettingsView()
-{
-    return 0;
-}
-
 #endif
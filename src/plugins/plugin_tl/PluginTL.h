@@ -21,6 +21,8 @@ public:
     double getLikelyhood(const double& t, const QJsonObject& data);
     bool withLikelyhoodArg() {return true; };
     QPair<double, double > getLikelyhoodArg(const double& t, const QJsonObject& data);
+    bool withGaussianLikelyhood(const QJsonObject& data);
+    GaussianLikelyhood getGaussianLikelyhood(const QJsonObject& data);
     
     QString getName() const;
     QIcon getIcon() const;
@@ -33,9 +35,6 @@ public:
     QStringList toCSV(const QJsonObject& data, const QLocale &csvLocale);
     QString getDateDesc(const Date* date) const;
     
-    PluginFormAbstract* getForm();
-    GraphViewRefAbstract* getGraphViewRef();
-    PluginSettingsViewAbstract* getSettingsView();
 };
 
 #endif
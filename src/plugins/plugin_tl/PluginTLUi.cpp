@@ -0,0 +1,38 @@
+#include "PluginTLUi.h"
+#if USE_PLUGIN_TL
+
+#include "PluginTL.h"
+#include "PluginTLForm.h"
+#include "PluginTLRefView.h"
+
+
+PluginTLUi::PluginTLUi(PluginTL* plugin):PluginUiAbstract(plugin),
+mPluginTL(plugin)
+{
+
+}
+
+PluginTLUi::~PluginTLUi()
+{
+    
+}
+
+PluginFormAbstract* PluginTLUi::getForm()
+{
+    PluginTLForm* form = new PluginTLForm(mPluginTL);
+    return form;
+}
+
+GraphViewRefAbstract* PluginTLUi::getGraphViewRef()
+{
+    if(mRefGraph) delete mRefGraph;
+    mRefGraph = new PluginTLRefView();
+    return mRefGraph;
+}
+
+PluginSettingsViewAbstract* PluginTLUi::getSettingsView()
+{
+    return 0;
+}
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef PluginTLUi_H
+#define PluginTLUi_H
+
+#if USE_PLUGIN_TL
+
+#include "../PluginUiAbstract.h"
+
+class PluginTL;
+
+
+class PluginTLUi: public PluginUiAbstract
+{
+public:
+    PluginTLUi(PluginTL* plugin);
+    virtual ~PluginTLUi();
+    
+    PluginFormAbstract* getForm();
+    GraphViewRefAbstract* getGraphViewRef();
+    PluginSettingsViewAbstract* getSettingsView();
+    
+private:
+    PluginTL* mPluginTL;
+};
+
+#endif
+
+#endif
@@ -1,11 +1,11 @@
 #include "PluginUniform.h"
 #if USE_PLUGIN_UNIFORM
 
-#include "PluginUniformForm.h"
 #include <cstdlib>
 #include <iostream>
 #include <QJsonObject>
-#include <QtWidgets>
+#include <QtCore>
+#include <QIcon>
 
 
 PluginUniform::PluginUniform()
@@ -57,12 +57,6 @@ QStringList PluginUniform::csvColumns() const
 }
 
 
-PluginFormAbstract* PluginUniform::getForm()
-{
-    PluginUniformForm* form = new PluginUniformForm(this);
-    return form;
-}
-
 QJsonObject PluginUniform::fromCSV(const QStringList& list)
 {
     QJsonObject json;
@@ -102,16 +96,4 @@ bool PluginUniform::isDateValid(const QJsonObject& data, const ProjectSettings&
 
     return (bmax > settings.mTmin && bmin < settings.mTmax) ? true : false;
  }
-// ------------------------------------------------------------------
-
-GraphViewRefAbstract* PluginUniform::getGraphViewRef()
-{
-    return 0;
-}
-
-PluginSettingsViewAbstract* PluginUniform::getSettingsView()
-{
-    return 0;
-}
-
 #endif
@@ -33,9 +33,6 @@ public:
     
     bool isDateValid(const QJsonObject& data, const ProjectSettings& settings);
 
-    PluginFormAbstract* getForm();
-    GraphViewRefAbstract* getGraphViewRef();
-    PluginSettingsViewAbstract* getSettingsView();
 };
 
 #endif
@@ -0,0 +1,35 @@
+#include "PluginUniformUi.h"
+#if USE_PLUGIN_UNIFORM
+
+#include "PluginUniform.h"
+#include "PluginUniformForm.h"
+
+
+PluginUniformUi::PluginUniformUi(PluginUniform* plugin):PluginUiAbstract(plugin),
+mPluginUniform(plugin)
+{
+
+}
+
+PluginUniformUi::~PluginUniformUi()
+{
+    
+}
+
+PluginFormAbstract* PluginUniformUi::getForm()
+{
+    PluginUniformForm* form = new PluginUniformForm(mPluginUniform);
+    return form;
+}
+
+GraphViewRefAbstract* PluginUniformUi::getGraphViewRef()
+{
+    return 0;
+}
+
+PluginSettingsViewAbstract* PluginUniformUi::getSettingsView()
+{
+    return 0;
+}
+
+#endif
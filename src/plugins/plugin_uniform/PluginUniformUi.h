@@ -0,0 +1,27 @@
+#ifndef PluginUniformUi_H
+#define PluginUniformUi_H
+
+#if USE_PLUGIN_UNIFORM
+
+#include "../PluginUiAbstract.h"
+
+class PluginUniform;
+
+
+class PluginUniformUi: public PluginUiAbstract
+{
+public:
+    PluginUniformUi(PluginUniform* plugin);
+    virtual ~PluginUniformUi();
+    
+    PluginFormAbstract* getForm();
+    GraphViewRefAbstract* getGraphViewRef();
+    PluginSettingsViewAbstract* getSettingsView();
+    
+private:
+    PluginUniform* mPluginUniform;
+};
+
+#endif
+
+#endif
@@ -0,0 +1,62 @@
+#include "PluginUiManager.h"
+#include "PluginManager.h"
+#include "../PluginAbstract.h"
+#include "../PluginUiAbstract.h"
+#include <QDebug>
+
+#include "PluginMag.h"
+#include "PluginMagUi.h"
+#include "PluginTL.h"
+#include "PluginTLUi.h"
+#include "Plugin14C.h"
+#include "Plugin14CUi.h"
+#include "PluginUniform.h"
+#include "PluginUniformUi.h"
+#include "PluginGauss.h"
+#include "PluginGaussUi.h"
+
+
+QHash<const PluginAbstract*, PluginUiAbstract*> PluginUiManager::mPluginUis = QHash<const PluginAbstract*, PluginUiAbstract*>();
+
+/**
+ * @brief Must be called after PluginManager::loadPlugins()
+ */
+void PluginUiManager::loadPluginUis()
+{
+    const QList<PluginAbstract*>& plugins = PluginManager::getPlugins();
+    for(int i=0; i<plugins.size(); ++i)
+    {
+        PluginAbstract* plugin = plugins[i];
+        PluginUiAbstract* ui = 0;
+        
+#if USE_PLUGIN_UNIFORM
+        if(PluginUniform* p = dynamic_cast<PluginUniform*>(plugin))
+            ui = new PluginUniformUi(p);
+#endif
+#if USE_PLUGIN_GAUSS
+        if(PluginGauss* p = dynamic_cast<PluginGauss*>(plugin))
+            ui = new PluginGaussUi(p);
+#endif
+#if USE_PLUGIN_TL
+        if(PluginTL* p = dynamic_cast<PluginTL*>(plugin))
+            ui = new PluginTLUi(p);
+#endif
+#if USE_PLUGIN_14C
+        if(Plugin14C* p = dynamic_cast<Plugin14C*>(plugin))
+            ui = new Plugin14CUi(p);
+#endif
+#if USE_PLUGIN_AM
+        if(PluginMag* p = dynamic_cast<PluginMag*>(plugin))
+            ui = new PluginMagUi(p);
+#endif
+        if(ui)
+            mPluginUis.insert(plugin, ui);
+        else
+            qDebug() << "No user interface for the plugin : " << plugin->getName();
+    }
+}
+
+PluginUiAbstract* PluginUiManager::getPluginUi(const PluginAbstract* plugin)
+{
+    return mPluginUis.value(plugin, 0);
+}
@@ -0,0 +1,30 @@
+#ifndef PLUGINUIMANAGER_H
+#define PLUGINUIMANAGER_H
+
+#include <QHash>
+
+class PluginAbstract;
+class PluginUiAbstract;
+
+
+/**
+ * @brief Creates and keeps the user interface of each plugin loaded by PluginManager.
+ * Only used by the application : the command line and the core library load the plugins without their UI.
+ */
+class PluginUiManager
+{
+public:
+    static void loadPluginUis();
+    static PluginUiAbstract* getPluginUi(const PluginAbstract* plugin);
+    
+private:
+    static QHash<const PluginAbstract*, PluginUiAbstract*> mPluginUis;
+    
+private:
+    PluginUiManager(){}
+    ~PluginUiManager(){}
+    
+    Q_DISABLE_COPY(PluginUiManager)
+};
+
+#endif
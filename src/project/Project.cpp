@@ -2,6 +2,7 @@
 #include "MainWindow.h"
 #include "Model.h"
 #include "PluginManager.h"
+#include "PluginUiManager.h"
 #include "ProjectSettingsDialog.h"
 #include "MCMCSettingsDialog.h"
 
@@ -18,6 +19,7 @@
 #include "DateDialog.h"
 #include "Date.h"
 #include "../PluginAbstract.h"
+#include "../PluginUiAbstract.h"
 #include "../PluginFormAbstract.h"
 #include "TrashDialog.h"
 #include "ImportDataView.h"
@@ -27,9 +29,11 @@
 
 #include "MCMCLoopMain.h"
 #include "MCMCProgressDialog.h"
+#include "ProjectSaver.h"
 
 #include "SetProjectState.h"
 #include "StateEvent.h"
+#include "Trace.h"
 
 #include <iostream>
 #include <QtWidgets>
@@ -46,14 +50,17 @@
 Project::Project():
 mName(tr("Chronomodel Project")),
 mProjectFileDir(""),
-mProjectFileName(QObject::tr("Untitled"))
-
+mProjectFileName(QObject::tr("Untitled")),
+mResultsToSave(false)
 {
     mState = emptyState();
     mLastSavedState = mState;
     
+    mSaver = new ProjectSaver(this);
+    connect(mSaver, SIGNAL(finished()), this, SLOT(savingFinished()));
+    
     mAutoSaveTimer = new QTimer(this);
-    connect(mAutoSaveTimer, SIGNAL(timeout()), this, SLOT(save()));
+    connect(mAutoSaveTimer, SIGNAL(timeout()), this, SLOT(autoSave()));
     mAutoSaveTimer->start(3000);
     mModel = new Model();
     mRefreshResults =true;
@@ -62,6 +69,9 @@ mProjectFileName(QObject::tr("Untitled"))
 Project::~Project()
 {
     mAutoSaveTimer->stop();
+    
+    // Let the last save complete : the thread can't be deleted while running
+    mSaver->wait();
 }
 
 
@@ -360,6 +370,7 @@ bool Project::isValid(){
 
 bool Project::load(const QString& path)
 {
+    TraceScope trace("io", "Load project");
     QFileInfo checkFile(path);
     if (!checkFile.exists() || !checkFile.isFile()) {
         QMessageBox message(QMessageBox::Critical,
@@ -430,25 +441,17 @@ bool Project::load(const QString& path)
             
             clearModel();
             
-            QString dataPath = path + ".dat";
-            //QFile dataFile(dataPath); // HL
-            QFile dataFile;
-            //QDir::setCurrent("/tmp");
-            dataFile.setFileName(dataPath);
-            
-            //QFileInfo fi(dataFile);
-            //dataFile.open(QIODevice::ReadOnly);
-            //if(fi.isFile())
-
-            if(false)//dataFile.exists())
+            // Results of the last run, written next to the project file
+            const QString dataPath = path + ".dat";
+            if(QFile::exists(dataPath))
             {
-
-                qDebug() << "Project::load Loading model file.dat : " << dataPath << " size=" << dataFile.size();
-      
+                qDebug() << "Project::load Loading model file.dat : " << dataPath;
+                
+                bool modelOk = false;
                 try{
                     mModel->setJson(mState);
                     mModel->fromJson(mState);
-
+                    modelOk = true;
                 }
                 catch(QString error){
                     QMessageBox message(QMessageBox::Critical,
@@ -463,23 +466,30 @@ bool Project::load(const QString& path)
                     clearModel();
                 }
                 
-                
-                try{
-                    mModel->restoreFromFile(dataPath);
-                    
-                    emit mcmcFinished(mModel);
-                }catch(QString error){
-                    QMessageBox message(QMessageBox::Critical,
-                                        tr("Error loading project MCMC results"),
-                                        tr("The project MCMC results could not be loaded.") + "\n" +
-                                        tr("Error message") + " : " + error,
-                                        QMessageBox::Ok,
-                                        qApp->activeWindow(),
-                                        Qt::Sheet);
-                    message.exec();
+                if(modelOk)
+                {
+                    try{
+                        mModel->restoreFromFile(dataPath);
+                        
+                        emit mcmcFinished(mModel);
+                    }catch(QString error){
+                        QMessageBox message(QMessageBox::Critical,
+                                            tr("Error loading project MCMC results"),
+                                            tr("The project MCMC results could not be loaded.") + "\n" +
+                                            tr("Error message") + " : " + error,
+                                            QMessageBox::Ok,
+                                            qApp->activeWindow(),
+                                            Qt::Sheet);
+                        message.exec();
+                        
+                        clearModel();
+                    }
                 }
             }
             
+            // The results on disk are the ones of the project
+            mResultsToSave = false;
+            
             // --------------------
             
             return true;
@@ -511,6 +521,7 @@ bool Project::saveAs(const QString& dialogTitle)
         // We need to reset mLastSavedState because it corresponds
         // to the last saved state in the previous file.
         mLastSavedState = QJsonObject();
+        mResultsToSave = true;
         
         return saveProjectToFile();
     }
@@ -519,8 +530,8 @@ bool Project::saveAs(const QString& dialogTitle)
 
 bool Project::askToSave(const QString& saveDialogTitle)
 {
-    // Check if modifs have been made
-    if(mState == mLastSavedState)
+    // Check if modifs have been made (or a new run)
+    if(mState == mLastSavedState && !mResultsToSave)
         return true;
     
     // We have some modifications : ask to save :
@@ -547,54 +558,117 @@ bool Project::askToSave(const QString& saveDialogTitle)
     return false;
 }
 
+/**
+ * @brief Saves the project and waits for the end of the save, showing its progress.
+ * The save itself runs on a background thread : the UI is still refreshed, and the save can be canceled.
+ * @return false if the save failed or has been canceled
+ */
 bool Project::saveProjectToFile()
 {
-    if(mLastSavedState != mState)
+    // A save still running (e.g. an autosave) is for an older state : it is replaced
+    if(mSaver->isRunning())
     {
-        QString path = mProjectFileDir + "/" + mProjectFileName;
-        QFile file(path);
-        if(file.open(QIODevice::ReadWrite | QIODevice::Text))
-        {
-#ifdef DEBUG
-            qDebug() << "Project saved to : " << path;
-#endif
-            mLastSavedState = mState;
-            
-            QJsonDocument jsonDoc(mState);
-            file.write(jsonDoc.toJson(QJsonDocument::Indented));
-            file.resize(file.pos());
-            file.close();
-        }
-        else
-        {
-            return false;
-        }
+        mSaver->cancel();
+        mSaver->wait();
+        // Its results, if any, are given again to this save when it has been interrupted
+        savingFinished();
     }
-    else
+    
+    if(!prepareSaving())
     {
 #ifdef DEBUG
         qDebug() << "Nothing new to save in project model";
 #endif
+        return true;
     }
-/*    if(!mModel->mChains.isEmpty()) // keep to the future version
+    
+    QProgressDialog dialog(tr("Saving project..."), tr("Cancel"), 0, 0, qApp->activeWindow(), Qt::Sheet);
+    dialog.setWindowModality(Qt::WindowModal);
+    dialog.setAutoClose(false);
+    dialog.setAutoReset(false);
+    connect(mSaver, SIGNAL(progressLabelChanged(const QString&)), &dialog, SLOT(setLabelText(const QString&)));
+    connect(mSaver, SIGNAL(progressRangeChanged(int, int)), &dialog, SLOT(setRange(int, int)));
+    connect(mSaver, SIGNAL(progressValueChanged(int)), &dialog, SLOT(setValue(int)));
+    connect(&dialog, SIGNAL(canceled()), mSaver, SLOT(cancel()));
+    connect(mSaver, SIGNAL(finished()), &dialog, SLOT(accept()));
+    
+    // Started once connected : finished() is queued to this thread, and processed by exec() even if the save is already over
+    mSaver->start();
+    dialog.exec();
+    mSaver->wait();
+    savingFinished();
+    
+    if(!mSaver->mError.isEmpty())
     {
-      //  qDebug() << "Saving project results";
-        mModel->saveToFile(mProjectFileDir + "/" + mProjectFileName + ".dat");
-    }
-    else {
-        QFileInfo checkFile(mProjectFileDir + "/" + mProjectFileName + ".dat");
-        if (checkFile.exists() && checkFile.isFile()) {
-            QFile(mProjectFileDir + "/" + mProjectFileName + ".dat").remove();
-        }
-         else {
-            return true;
+        if(mSaver->mError != SAVE_CANCELED_BY_USER)
+        {
+            QMessageBox message(QMessageBox::Critical,
+                                tr("Error saving project"),
+                                tr("The project could not be saved.") + "\n" +
+                                tr("Error message") + " : " + mSaver->mError,
+                                QMessageBox::Ok,
+                                qApp->activeWindow(),
+                                Qt::Sheet);
+            message.exec();
         }
+        return false;
+    }
+    return true;
+}
 
-    } */
-
+/**
+ * @brief Gives a snapshot of the project, and of its results if they changed, to the saver : the caller starts it.
+ * @return false if there is nothing new to save
+ */
+bool Project::prepareSaving()
+{
+    if(mLastSavedState == mState && !mResultsToSave)
+        return false;
+    
+    const QString path = mProjectFileDir + "/" + mProjectFileName;
+    mSaver->setProject(path, mState);
+    
+    if(mResultsToSave)
+    {
+        // Results of the last run, or none since the model has been cleared
+        if(!mModel->mEvents.isEmpty() && !mModel->mChains.isEmpty())
+            mSaver->setResults(path + ".dat", mModel->resultsSnapshot());
+        else
+            mSaver->setResultsToRemove(path + ".dat");
+        mResultsToSave = false;
+    }
     return true;
 }
 
+/**
+ * @brief Autosave only saves projects which already have a file, without waiting for the end of the save.
+ */
+void Project::autoSave()
+{
+    if(mSaver->isRunning())
+        return;
+    
+    QFileInfo info(mProjectFileDir + "/" + mProjectFileName);
+    if(info.exists() && prepareSaving())
+        mSaver->start();
+}
+
+void Project::savingFinished()
+{
+    if(mSaver->isRunning())
+        return;
+    
+    if(mSaver->mError.isEmpty())
+        mLastSavedState = mSaver->state();
+    else
+    {
+        // The results may not have been written : they are saved again next time
+        mResultsToSave = true;
+        if(mSaver->mError != SAVE_CANCELED_BY_USER)
+            qDebug() << "Project::savingFinished error : " << mSaver->mError;
+    }
+}
+
 // --------------------------------------------------------------------
 //     Project Settings
 // --------------------------------------------------------------------
@@ -1067,7 +1141,7 @@ Date Project::createDateFromPlugin(PluginAbstract* plugin)
     if(plugin)
     {
         DateDialog dialog(qApp->activeWindow());
-        PluginFormAbstract* form = plugin->getForm();
+        PluginFormAbstract* form = PluginUiManager::getPluginUi(plugin)->getForm();
         dialog.setForm(form);
         dialog.setDataMethod(plugin->getDataMethod());
         
@@ -1135,56 +1209,7 @@ void Project::addDate(int eventId, QJsonObject date)
 
 void Project::checkDatesCompatibility()
 {
-    QJsonObject state = mState;
-    QJsonArray events = mState[STATE_EVENTS].toArray();
-    
-    for(int i=0; i<events.size(); ++i)
-    {
-        QJsonObject event = events[i].toObject();
-        QJsonArray dates = event[STATE_EVENT_DATES].toArray();
-        for(int j=0; j<dates.size(); ++j)
-        {
-            QJsonObject date = dates[j].toObject();
-            
-            // -----------------------------------------------------------
-            //  Check the date compatibility with the plugin version
-            // -----------------------------------------------------------
-            if(date.find(STATE_DATE_SUB_DATES) == date.end())
-                date[STATE_DATE_SUB_DATES] = QJsonArray();
-            
-            if(date.find(STATE_DATE_VALID) == date.end())
-                date[STATE_DATE_VALID] = true;
-            
-            // etc...
-            // Here, we could control if all date fields are present, and add them if not.
-            
-            // -----------------------------------------------------------
-            //  Check the date compatibility with the plugin version
-            //  Only the STATE_DATE_DATA is to be checked
-            // -----------------------------------------------------------
-            QString pluginId = date[STATE_DATE_PLUGIN_ID].toString();
-            PluginAbstract* plugin = PluginManager::getPluginFromId(pluginId);
-            date[STATE_DATE_DATA] = plugin->checkValuesCompatibility(date[STATE_DATE_DATA].toObject());
-            
-            // -----------------------------------------------------------
-            //  Check subdates compatibility with the plugin version
-            // -----------------------------------------------------------
-            QJsonArray subdates = date[STATE_DATE_SUB_DATES].toArray();
-            for(int k=0; k<subdates.size(); ++k){
-                QJsonObject subdate = subdates[k].toObject();
-                subdate[STATE_DATE_DATA] = plugin->checkValuesCompatibility(subdate[STATE_DATE_DATA].toObject());
-                subdates[k] = subdate;
-            }
-            date[STATE_DATE_SUB_DATES] = subdates;
-            // -----------------------------------------------------------
-            
-            dates[j] = date;
-            event[STATE_EVENT_DATES] = dates;
-            events[i] = event;
-            state[STATE_EVENTS] = events;
-        }
-    }
-    mState = state;
+    mState = ModelUtilities::checkDatesCompatibility(mState);
 }
 
 void Project::updateDate(int eventId, int dateIndex)
@@ -1210,7 +1235,7 @@ void Project::updateDate(int eventId, int dateIndex)
                 PluginAbstract* plugin = PluginManager::getPluginFromId(pluginId);
                 
                 DateDialog dialog(qApp->activeWindow(), Qt::Sheet);
-                PluginFormAbstract* form = plugin->getForm();
+                PluginFormAbstract* form = PluginUiManager::getPluginUi(plugin)->getForm();
                 dialog.setForm(form);
                 dialog.setDate(date);
                 
@@ -1355,29 +1380,7 @@ void Project::recycleDates(int eventId)
 
 QJsonObject Project::checkValidDates(const QJsonObject& stateToCheck)
 {
-    QJsonObject state = stateToCheck;
-    
-    QJsonObject settingsJson = state[STATE_SETTINGS].toObject();
-    ProjectSettings settings = ProjectSettings::fromJson(settingsJson);
-    
-    QJsonArray events = state[STATE_EVENTS].toArray();
-    for(int i=0; i<events.size(); ++i){
-        QJsonObject event = events[i].toObject();
-        QJsonArray dates = event[STATE_EVENT_DATES].toArray();
-        for(int j=0; j<dates.size(); ++j){
-            QJsonObject date = dates[j].toObject();
-            
-            PluginAbstract* plugin = PluginManager::getPluginFromId(date[STATE_DATE_PLUGIN_ID].toString());
-            bool valid = plugin->isDateValid(date[STATE_DATE_DATA].toObject(), settings);
-            date[STATE_DATE_VALID] = valid;
-            
-            dates[j] = date;
-        }
-        event[STATE_EVENT_DATES] = dates;
-        events[i] = event;
-    }
-    state[STATE_EVENTS] = events;
-    return state;
+    return ModelUtilities::checkValidDates(stateToCheck);
 }
 
 void Project::mergeDates(const int eventId, const QList<int>& dateIds)
@@ -2380,10 +2383,10 @@ void Project::run()
     
     //mModel = Model::fromJson(mState);
     mModel->setJson(mState);
-    mModel->fromJson(mState);
     bool modelOk = false;
     try
     {
+        mModel->fromJson(mState);
         modelOk = mModel->isValid();
     }
     catch(QString error)
@@ -2406,6 +2409,7 @@ void Project::run()
             {
                 //Memo of the init varaible state to show in Log view
                 mModel->mLogMCMC = loop.getChainsLog() + loop.getInitLog();
+                mResultsToSave = true;
                 emit mcmcFinished(mModel);
             }
             else
@@ -2434,5 +2438,6 @@ void Project::run()
 void Project::clearModel()
 {
      mModel->clear();
+     mResultsToSave = true;
      emit noResult();
 }
@@ -25,6 +25,7 @@ class Phase;
 class EventConstraint;
 class PhaseConstraint;
 class PluginAbstract;
+class ProjectSaver;
 
 
 class Project: public QObject
@@ -65,6 +66,7 @@ public:
     bool saveAs(const QString& dialogTitle);
     bool askToSave(const QString& saveDialogTitle);
     bool saveProjectToFile();
+    bool prepareSaving();
     
     bool setSettings(const ProjectSettings& settings);    
     //void setAppSettings(const AppSettings& settings);
@@ -123,6 +125,8 @@ public:
     
 public slots:
     bool save(const QString& dialogTitle = tr("Save project as..."));
+    void autoSave();
+    void savingFinished();
     
     void mcmcSettings();
     void resetMCMC();
@@ -167,6 +171,9 @@ public:
     Model* mModel;
     
     QTimer* mAutoSaveTimer;
+    ProjectSaver* mSaver;
+    // New results, or results cleared, since the last save
+    bool mResultsToSave;
 };
 
 #endif
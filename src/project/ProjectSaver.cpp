@@ -0,0 +1,135 @@
+#include "ProjectSaver.h"
+#include "Trace.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QtConcurrent>
+#include <QDebug>
+
+
+ProjectSaver::ProjectSaver(QObject* parent):QThread(parent),
+mRemoveResults(false)
+{
+
+}
+
+ProjectSaver::~ProjectSaver()
+{
+
+}
+
+void ProjectSaver::setProject(const QString& path, const QJsonObject& state)
+{
+    mProjectPath = path;
+    mState = state;
+}
+
+void ProjectSaver::setResults(const QString& path, const QVector<ResultsChunk>& results)
+{
+    mResultsPath = path;
+    mResults = results;
+    mRemoveResults = false;
+}
+
+void ProjectSaver::setResultsToRemove(const QString& path)
+{
+    mResultsPath = path;
+    mResults.clear();
+    mRemoveResults = true;
+}
+
+const QJsonObject& ProjectSaver::state() const
+{
+    return mState;
+}
+
+void ProjectSaver::cancel()
+{
+    requestInterruption();
+}
+
+/**
+ * @brief The results are written first : the project file is only replaced once its results are saved.
+ */
+void ProjectSaver::run()
+{
+    mError = QString();
+    try{
+        if(!mResultsPath.isEmpty())
+            saveResults();
+        if(!mProjectPath.isEmpty())
+            saveProject();
+    }
+    catch(QString error){
+        mError = error;
+    }
+
+    // Release the shared copies of the results
+    mResults.clear();
+    mResultsPath = QString();
+    mProjectPath = QString();
+    mRemoveResults = false;
+}
+
+void ProjectSaver::saveResults()
+{
+    if(mRemoveResults)
+    {
+        if(QFile::exists(mResultsPath))
+            QFile::remove(mResultsPath);
+        return;
+    }
+    if(mResults.isEmpty())
+        return;
+
+    TraceScope trace("io", "Save results");
+    emit progressLabelChanged(tr("Saving results..."));
+    emit progressRangeChanged(0, mResults.size());
+
+    // The compression is the long part : it is followed and can be canceled chunk by chunk
+    QFuture<void> future = QtConcurrent::map(mResults, ResultsChunkSerialize());
+    while(!future.isFinished())
+    {
+        if(isInterruptionRequested())
+            future.cancel();
+        emit progressValueChanged(future.progressValue());
+        msleep(SAVE_PROGRESS_INTERVAL);
+    }
+    future.waitForFinished();
+
+    if(isInterruptionRequested())
+        throw QString(SAVE_CANCELED_BY_USER);
+
+    emit progressValueChanged(mResults.size());
+    Model::writeResults(mResultsPath, mResults);
+}
+
+void ProjectSaver::saveProject()
+{
+    TraceScope trace("io", "Save project");
+    emit progressLabelChanged(tr("Saving project..."));
+    emit progressRangeChanged(0, 0);
+
+    const QByteArray data = QJsonDocument(mState).toJson(QJsonDocument::Indented);
+
+    QSaveFile file(mProjectPath);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        throw tr("Cannot write the file : ") + mProjectPath;
+
+    if(file.write(data) != data.size())
+        throw tr("Cannot write the file : ") + mProjectPath;
+
+    // Last chance to cancel : the previous file is replaced by commit()
+    if(isInterruptionRequested())
+    {
+        file.cancelWriting();
+        throw QString(SAVE_CANCELED_BY_USER);
+    }
+    if(!file.commit())
+        throw tr("Cannot write the file : ") + mProjectPath;
+
+#ifdef DEBUG
+    qDebug() << "Project saved to : " << mProjectPath;
+#endif
+}
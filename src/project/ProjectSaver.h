@@ -0,0 +1,62 @@
+#ifndef PROJECTSAVER_H
+#define PROJECTSAVER_H
+
+#include "Model.h"
+
+#include <QThread>
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+
+#define SAVE_CANCELED_BY_USER "Save canceled by user"
+
+// Interval (ms) between 2 progress notifications while the results are compressed
+#define SAVE_PROGRESS_INTERVAL 100
+
+
+/**
+ * @brief Saves a snapshot of the project (and of its results) on a background thread.
+ * The snapshot is immutable : the project state is a QJsonObject and the results are implicitly shared copies,
+ * so the user can go on editing the project (or the autosave happen) while saving.
+ * Each file is written to a temporary file and renamed once complete : a canceled or failed save keeps the previous file.
+ */
+class ProjectSaver : public QThread
+{
+    Q_OBJECT
+public:
+    ProjectSaver(QObject* parent = 0);
+    virtual ~ProjectSaver();
+
+    void setProject(const QString& path, const QJsonObject& state);
+    void setResults(const QString& path, const QVector<ResultsChunk>& results);
+    void setResultsToRemove(const QString& path);
+
+    const QJsonObject& state() const;
+
+    void run();
+
+public slots:
+    void cancel();
+
+signals:
+    // Same signatures as the QProgressDialog slots
+    void progressLabelChanged(const QString& label);
+    void progressRangeChanged(int min, int max);
+    void progressValueChanged(int value);
+
+private:
+    void saveResults();
+    void saveProject();
+
+    QString mProjectPath;
+    QJsonObject mState;
+
+    QString mResultsPath;
+    QVector<ResultsChunk> mResults;
+    bool mRemoveResults;
+
+public:
+    QString mError;
+};
+
+#endif
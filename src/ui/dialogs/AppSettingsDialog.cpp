@@ -1,6 +1,8 @@
 #include "AppSettingsDialog.h"
 #include "AppSettingsDialogItemDelegate.h"
 #include "PluginSettingsViewAbstract.h"
+#include "PluginUiAbstract.h"
+#include "PluginUiManager.h"
 #include "Painting.h"
 #include <QtWidgets>
 
@@ -205,7 +207,7 @@ QDialog(parent, flags)
     const QList<PluginAbstract*>& plugins = PluginManager::getPlugins();
     for(int i=0; i<plugins.size(); ++i)
     {
-        PluginSettingsViewAbstract* view = plugins[i]->getSettingsView();
+        PluginSettingsViewAbstract* view = PluginUiManager::getPluginUi(plugins[i])->getSettingsView();
         if(view){
             QListWidgetItem* item = new QListWidgetItem();
             item->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled | Qt::ItemNeverHasChildren);
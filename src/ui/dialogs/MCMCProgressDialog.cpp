@@ -1,10 +1,14 @@
 #include "MCMCProgressDialog.h"
 #include "MCMCLoopMain.h"
+#include "GraphView.h"
+#include "Painting.h"
 #include <QtWidgets>
 
 
 MCMCProgressDialog::MCMCProgressDialog(MCMCLoopMain* loop, QWidget* parent, Qt::WindowFlags flags):QDialog(parent, flags),
-mLoop(loop)
+mLoop(loop),
+mStepIndex(0),
+mPreviewVersion(0)
 {
     setWindowTitle(tr("MCMC in progress..."));
     
@@ -21,6 +25,67 @@ mLoop(loop)
     mProgressBar2->setMinimum(0);
     mProgressBar2->setMaximum(0);
     
+    mChainsLayout = new QGridLayout();
+    
+    // ----------
+    
+    mPreviewCheck = new QCheckBox(tr("Live preview"));
+    connect(mPreviewCheck, SIGNAL(toggled(bool)), this, SLOT(showPreview(bool)));
+    
+    // The events selected in the model are checked first
+    mPreviewEventsList = new QListWidget();
+    mPreviewEventsList->setToolTip(tr("Events to preview (%1 at most)").arg(MCMC_PREVIEW_MAX_EVENTS));
+    int numChecked = 0;
+    const QList<Event*>& events = mLoop->mModel->mEvents;
+    for(int i=0; i<events.size(); ++i)
+    {
+        QListWidgetItem* item = new QListWidgetItem(events.at(i)->getName(), mPreviewEventsList);
+        const bool checked = events.at(i)->mIsSelected && numChecked < MCMC_PREVIEW_MAX_EVENTS;
+        item->setCheckState(checked ? Qt::Checked : Qt::Unchecked);
+        if(checked)
+            ++numChecked;
+    }
+    if(numChecked == 0 && mPreviewEventsList->count() > 0)
+        mPreviewEventsList->item(0)->setCheckState(Qt::Checked);
+    connect(mPreviewEventsList, SIGNAL(itemChanged(QListWidgetItem*)), this, SLOT(previewEventChanged(QListWidgetItem*)));
+    
+    QGridLayout* previewLayout = new QGridLayout();
+    previewLayout->addWidget(mPreviewEventsList, 0, 0, MCMC_PREVIEW_MAX_EVENTS * 2, 1);
+    previewLayout->setColumnStretch(1, 1);
+    previewLayout->setColumnStretch(2, 1);
+    for(int i=0; i<MCMC_PREVIEW_MAX_EVENTS; ++i)
+    {
+        QLabel* label = new QLabel();
+        
+        GraphView* density = new GraphView();
+        density->setMinimumHeight(80);
+        density->showYAxisValues(false);
+        density->setRangeY(0, 1);
+        
+        GraphView* trace = new GraphView();
+        trace->setMinimumHeight(80);
+        trace->setRangeY(0, 1);
+        
+        previewLayout->addWidget(label, i * 2, 1, 1, 2);
+        previewLayout->addWidget(density, i * 2 + 1, 1);
+        previewLayout->addWidget(trace, i * 2 + 1, 2);
+        
+        label->setVisible(false);
+        density->setVisible(false);
+        trace->setVisible(false);
+        
+        mPreviewLabels.append(label);
+        mPreviewDensities.append(density);
+        mPreviewTraces.append(trace);
+    }
+    mPreviewWidget = new QWidget();
+    mPreviewWidget->setLayout(previewLayout);
+    mPreviewWidget->setVisible(false);
+    
+    mPreviewTimer = new QTimer(this);
+    mPreviewTimer->setInterval(MCMC_PREVIEW_INTERVAL);
+    connect(mPreviewTimer, SIGNAL(timeout()), this, SLOT(updatePreview()));
+    
     // ----------
     
     QDialogButtonBox* buttonBox = new QDialogButtonBox();
@@ -36,6 +101,9 @@ mLoop(loop)
     QVBoxLayout* layout = new QVBoxLayout();
     layout->addWidget(mLabel1);
     layout->addWidget(mProgressBar1);
+    layout->addLayout(mChainsLayout);
+    layout->addWidget(mPreviewCheck);
+    layout->addWidget(mPreviewWidget);
     //layout->addWidget(mLabel2);
     //layout->addWidget(mProgressBar2);
     layout->addWidget(buttonBox);
@@ -46,14 +114,15 @@ mLoop(loop)
     // -----------
     
     //connect(mLoop, SIGNAL(messageSent(QString)), this, SLOT(addMessage(QString)));
-    //connect(mLoop, SIGNAL(stepChanged(QString, int, int)), this, SLOT(setTitle(QString, int, int)));
     //connect(mLoop, SIGNAL(progressChanged(int)), this, SLOT(setProgress(int)));
     
     connect(mLoop, SIGNAL(finished()), this, SLOT(setFinishedState()));
     connect(mLoop, SIGNAL(finished()), this, SLOT(accept()));
     
-    connect(mLoop, SIGNAL(stepChanged(const QString&, int, int)), this, SLOT(setTitle1(const QString&, int, int)));
-    connect(mLoop, SIGNAL(stepProgressed(int)), this, SLOT(setProgress1(int)));
+    // The loop does not send its progress : it is polled at a fixed rate, whatever the speed of the iterations
+    mTimer = new QTimer(this);
+    mTimer->setInterval(MCMC_PROGRESS_INTERVAL);
+    connect(mTimer, SIGNAL(timeout()), this, SLOT(updateProgress()));
 }
 
 MCMCProgressDialog::~MCMCProgressDialog()
@@ -65,6 +134,7 @@ MCMCProgressDialog::~MCMCProgressDialog()
 int MCMCProgressDialog::startMCMC()
 {
     mLoop->start();
+    mTimer->start();
     return exec();
 }
 
@@ -102,5 +172,159 @@ void MCMCProgressDialog::setFinishedState()
 {
    // mOKBut->setEnabled(true);
     mCancelBut->setEnabled(false);
+    mTimer->stop();
+    mPreviewTimer->stop();
 }
 
+void MCMCProgressDialog::updateProgress()
+{
+    const MCMCProgress progress = mLoop->progress();
+    
+    if(progress.mStepIndex != mStepIndex)
+    {
+        mStepIndex = progress.mStepIndex;
+        setTitle1(progress.mStepTitle, 0, progress.mStepMax);
+    }
+    setProgress1(progress.mStepValue);
+    
+    // Chains run on workers progress at the same time : one bar each
+    if(progress.mDispatched && progress.mChainsValue.size() > 1)
+    {
+        if(mChainsBars.isEmpty())
+        {
+            for(int i=0; i<progress.mChainsValue.size(); ++i)
+            {
+                QProgressBar* bar = new QProgressBar();
+                bar->setMinimum(0);
+                bar->setMaximum(progress.mChainsMax.at(i));
+                mChainsLayout->addWidget(new QLabel(tr("Chain %1").arg(i + 1)), i, 0);
+                mChainsLayout->addWidget(bar, i, 1);
+                mChainsBars.append(bar);
+            }
+        }
+        for(int i=0; i<mChainsBars.size(); ++i)
+            mChainsBars[i]->setValue(progress.mChainsValue.at(i));
+    }
+}
+
+
+#pragma mark Live preview
+void MCMCProgressDialog::showPreview(bool show)
+{
+    mPreviewWidget->setVisible(show);
+    if(show)
+    {
+        setPreviewEvents();
+        mPreviewTimer->start();
+    }
+    else
+    {
+        // The sampler stops updating the preview
+        mLoop->mPreview.setEvents(QList<int>());
+        mPreviewTimer->stop();
+    }
+    adjustSize();
+}
+
+void MCMCProgressDialog::previewEventChanged(QListWidgetItem* item)
+{
+    int numChecked = 0;
+    for(int i=0; i<mPreviewEventsList->count(); ++i)
+    {
+        if(mPreviewEventsList->item(i)->checkState() == Qt::Checked)
+            ++numChecked;
+    }
+    if(numChecked > MCMC_PREVIEW_MAX_EVENTS)
+    {
+        // Calls this slot again
+        item->setCheckState(Qt::Unchecked);
+        return;
+    }
+    if(mPreviewCheck->isChecked())
+        setPreviewEvents();
+}
+
+void MCMCProgressDialog::setPreviewEvents()
+{
+    QList<int> eventsIndexes;
+    for(int i=0; i<mPreviewEventsList->count(); ++i)
+    {
+        if(mPreviewEventsList->item(i)->checkState() == Qt::Checked)
+            eventsIndexes.append(i);
+    }
+    mLoop->mPreview.setEvents(eventsIndexes);
+}
+
+/**
+ * @brief Only the small copy made by the sampler is read (histograms and last iterations) : the traces of the chains are never copied.
+ */
+void MCMCProgressDialog::updatePreview()
+{
+    const MCMCPreviewSnapshot snapshot = mLoop->mPreview.snapshot();
+    // Nothing sampled yet : the chains are not running
+    if(snapshot.mVersion == mPreviewVersion || snapshot.mChainIndex < 0)
+        return;
+    mPreviewVersion = snapshot.mVersion;
+    
+    QString stage;
+    if(snapshot.mState == MCMCLoop::eBurning)
+        stage = tr("burn");
+    else if(snapshot.mState == MCMCLoop::eAdapting)
+        stage = tr("adapt");
+    else if(snapshot.mState == MCMCLoop::eRunning)
+        stage = tr("run");
+    
+    const double binWidth = (snapshot.mTmax - snapshot.mTmin) / MCMC_PREVIEW_BINS;
+    const QList<Event*>& events = mLoop->mModel->mEvents;
+    
+    for(int i=0; i<MCMC_PREVIEW_MAX_EVENTS; ++i)
+    {
+        const bool visible = (i < snapshot.mSeries.size());
+        mPreviewLabels[i]->setVisible(visible);
+        mPreviewDensities[i]->setVisible(visible);
+        mPreviewTraces[i]->setVisible(visible);
+        if(!visible)
+            continue;
+        
+        const MCMCPreviewSeries& series = snapshot.mSeries.at(i);
+        
+        QString text = events.at(series.mEventIndex)->getName() + " : " + tr("chain %1, %2, %3 iterations").arg(snapshot.mChainIndex + 1).arg(stage).arg(series.mIterations);
+        if(series.mIsMH && series.mIterations > 1)
+            text += ", " + tr("acceptance %1 %").arg(QString::number(100. * series.mAccepted / (series.mIterations - 1), 'f', 1));
+        mPreviewLabels[i]->setText(text);
+        
+        // ----- Density of the current stage -----
+        GraphCurve density;
+        density.mName = "Density";
+        density.mPen = QPen(Painting::mainColorLight, 1);
+        density.mBrush = QColor(Painting::mainColorLight.red(), Painting::mainColorLight.green(), Painting::mainColorLight.blue(), 100);
+        density.mIsHisto = false;
+        density.mIsRectFromZero = true;
+        if(series.mIterations > 0)
+        {
+            for(int b=0; b<series.mHisto.size(); ++b)
+                density.mData[snapshot.mTmin + (b + 0.5) * binWidth] = series.mHisto.at(b) / (series.mIterations * binWidth);
+        }
+        GraphView* densityGraph = mPreviewDensities[i];
+        densityGraph->removeAllCurves();
+        densityGraph->setRangeX(snapshot.mTmin, snapshot.mTmax);
+        densityGraph->setCurrentX(snapshot.mTmin, snapshot.mTmax);
+        densityGraph->addCurve(density);
+        densityGraph->adjustYToMaxValue();
+        
+        // ----- Last iterations -----
+        GraphCurve trace;
+        trace.mName = "Trace";
+        trace.mUseVectorData = true;
+        trace.mDataVector = series.mTrace;
+        trace.mPen.setColor(Painting::chainColors.at(snapshot.mChainIndex % Painting::chainColors.size()));
+        trace.mIsHisto = false;
+        GraphView* traceGraph = mPreviewTraces[i];
+        traceGraph->removeAllCurves();
+        traceGraph->setRangeX(0, qMax(1, series.mTrace.size() - 1));
+        traceGraph->setCurrentX(0, qMax(1, series.mTrace.size() - 1));
+        traceGraph->addCurve(trace);
+        if(!series.mTrace.isEmpty())
+            traceGraph->adjustYToMinMaxValue();
+    }
+}
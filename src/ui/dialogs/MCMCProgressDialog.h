@@ -2,12 +2,19 @@
 #define MCMCProgressDialog_H
 
 #include <QDialog>
+#include <QList>
 
 class MCMCLoopMain;
 class QLabel;
 class QProgressBar;
 class QTextEdit;
 class QPushButton;
+class QTimer;
+class QGridLayout;
+class QCheckBox;
+class QListWidget;
+class QListWidgetItem;
+class GraphView;
 
 
 class MCMCProgressDialog: public QDialog
@@ -31,6 +38,17 @@ public slots:
     
     void setFinishedState();
     
+    // Reads the progress of the loop (see MCMCLoop::progress), every MCMC_PROGRESS_INTERVAL ms
+    void updateProgress();
+    
+    // Live preview of the chosen events (see MCMCPreview), every MCMC_PREVIEW_INTERVAL ms
+    void showPreview(bool show);
+    void previewEventChanged(QListWidgetItem* item);
+    void updatePreview();
+    
+private:
+    void setPreviewEvents();
+    
 public:
     MCMCLoopMain* mLoop;
     QLabel* mLabel1;
@@ -39,6 +57,23 @@ public:
     QProgressBar* mProgressBar2;
    // QPushButton* mOKBut;
     QPushButton* mCancelBut;
+    
+    QTimer* mTimer;
+    int mStepIndex;
+    
+    // One bar per chain, when there are several chains
+    QGridLayout* mChainsLayout;
+    QList<QProgressBar*> mChainsBars;
+    
+    QCheckBox* mPreviewCheck;
+    QWidget* mPreviewWidget;
+    QListWidget* mPreviewEventsList;
+    QTimer* mPreviewTimer;
+    int mPreviewVersion;
+    // One row per previewed event : density of the current stage, last iterations, acceptance
+    QList<QLabel*> mPreviewLabels;
+    QList<GraphView*> mPreviewDensities;
+    QList<GraphView*> mPreviewTraces;
 };
 
 #endif
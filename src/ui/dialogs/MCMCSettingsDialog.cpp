@@ -50,6 +50,18 @@ QDialog(parent, flags)
     
     mLabelLevel = new Label(tr("Mixing level"),this);
     mLevelEdit = new LineEdit(this);
+    
+    mGeneratorLab = new Label(tr("Generator") + " :", this);
+    mGeneratorCombo = new QComboBox(this);
+    // Items are in the order of Generator::Engine
+    mGeneratorCombo->addItem(tr("Mersenne / Box-Muller"));
+    mGeneratorCombo->addItem(tr("Xoshiro / Ziggurat (faster)"));
+    mGeneratorCombo->setToolTip(tr("Mersenne / Box-Muller is the generator of previous versions, Xoshiro / Ziggurat draws the same distributions faster. Neither reproduces the results of previous versions with the same seeds : the order of the updates and the samplers have changed."));
+    
+    mReplicasLab = new Label(tr("Replicas"), this);
+    mReplicasSpin = new QSpinBox(this);
+    mReplicasSpin->setRange(1, 16);
+    mReplicasSpin->setToolTip(tr("Parallel tempering : over 1, hot replicas of the model run on other cores and swap their states with the recorded chain. It helps multimodal calibrations to mix."));
 
     mOkBut = new Button(tr("OK"), this);
     mCancelBut = new Button(tr("Cancel"), this);
@@ -77,6 +89,8 @@ void MCMCSettingsDialog::setSettings(const MCMCSettings& settings)
     mSeedsEdit->setText(intListToString(settings.mSeeds, ";"));
     
     mLevelEdit->setText(mLoc.toString(settings.mMixingLevel));
+    mGeneratorCombo->setCurrentIndex((int)settings.mGeneratorEngine);
+    mReplicasSpin->setValue(settings.mNumReplicas);
 }
 
 MCMCSettings MCMCSettingsDialog::getSettings()
@@ -93,6 +107,8 @@ MCMCSettings MCMCSettingsDialog::getSettings()
     settings.mMixingLevel = mLoc.toDouble(mLevelEdit->text());
     
     settings.mSeeds = stringListToIntList(mSeedsEdit->text(), ";");
+    settings.mGeneratorEngine = (Generator::Engine)mGeneratorCombo->currentIndex();
+    settings.mNumReplicas = mReplicasSpin->value();
     
     return settings;
 }
@@ -178,6 +194,8 @@ void MCMCSettingsDialog::updateLayout()
     mBatchNRect = mBatch1Rect.adjusted(2*mBatch1Rect.width() + 2*m, 0, 2*mBatch1Rect.width() + 2*m, 0);
     
     mNumProcEdit->setGeometry(width()/2 + m, 40, editW, lineH);
+    mGeneratorLab->setGeometry(width()/2 + 3*m + editW, 40, 70, lineH);
+    mGeneratorCombo->setGeometry(width()/2 + 4*m + editW + 70, 40, width()/2 - 6*m - editW - 70, lineH);
     mNumBurnEdit->setGeometry(mBurnRect.x() + (mBurnRect.width() - editW)/2, mBurnRect.y() + 2*lineH, editW, lineH);
     mNumIterEdit->setGeometry(mAquireRect.x() + (mAquireRect.width() - editW)/2, mAquireRect.y() + 2*lineH, editW, lineH);
     mDownSamplingEdit->setGeometry(mAquireRect.x() + (mAquireRect.width() - editW)/2, mAquireRect.y() + 4*lineH, editW, lineH);
@@ -194,6 +212,8 @@ void MCMCSettingsDialog::updateLayout()
 
     mLabelLevel->setGeometry(width()/2 + m/2+10, height() - 2*m - butH - lineH, editW, lineH);
     mLevelEdit->setGeometry(width()/2 + m/2+120, height() - 2*m - butH - lineH, 50, lineH);
+    mReplicasLab->setGeometry(width()/2 + m/2+180, height() - 2*m - butH - lineH, 55, lineH);
+    mReplicasSpin->setGeometry(width()/2 + m/2+240, height() - 2*m - butH - lineH, width()/2 - m/2 - 240 - m, lineH);
     
     mOkBut->setGeometry(width() - 2*m - 2*butW, height() - m - butH, butW, butH);
     mCancelBut->setGeometry(width() - m - butW, height() - m - butH, butW, butH);
@@ -8,6 +8,7 @@ class Label;
 class LineEdit;
 class Button;
 class QSpinBox;
+class QComboBox;
 class HelpWidget;
 
 
@@ -41,6 +42,12 @@ private:
     Label* mLabelLevel;
     LineEdit* mLevelEdit;
     
+    Label* mGeneratorLab;
+    QComboBox* mGeneratorCombo;
+    
+    Label* mReplicasLab;
+    QSpinBox* mReplicasSpin;
+    
     Button* mOkBut;
     Button* mCancelBut;
     
@@ -3,9 +3,11 @@
 #include "Button.h"
 #include "ColorPicker.h"
 #include "PluginManager.h"
+#include "PluginUiManager.h"
 #include "ModelUtilities.h"
 #include "Date.h"
 #include "../PluginAbstract.h"
+#include "../PluginUiAbstract.h"
 #include "../PluginSettingsViewAbstract.h"
 #include <QtWidgets>
 
@@ -40,7 +42,7 @@ mPlugin(plugin)
     // ----------------------------------------
     //  This form is plugin specific
     // ----------------------------------------
-    mView = plugin->getSettingsView();
+    mView = PluginUiManager::getPluginUi(plugin)->getSettingsView();
     if(mView){
         // useless using a layout below...
         mView->setParent(this);
@@ -3,6 +3,7 @@
 #include "StdUtilities.h"
 #include "DateUtils.h"
 #include "Painting.h"
+#include "Trace.h"
 #include <QtWidgets>
 #include <algorithm>
 #include <QtSvg>
@@ -481,6 +482,7 @@ void GraphView::repaintGraph(const bool aAlsoPaintBackground)
     
 void GraphView::paintEvent(QPaintEvent* )
 {
+    TraceScope trace("ui", "GraphView::paintEvent");
  //   Q_UNUSED(event);
     
     
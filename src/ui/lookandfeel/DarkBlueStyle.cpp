@@ -1,5 +1,6 @@
 #include "DarkBlueStyle.h"
 #include "QtUtilities.h"
+#include "WidgetUtilities.h"
 #include "Painting.h"
 #include <QtWidgets>
 
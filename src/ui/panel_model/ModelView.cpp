@@ -16,6 +16,7 @@
 #include "MainWindow.h"
 #include "Project.h"
 #include "QtUtilities.h"
+#include "WidgetUtilities.h"
 #include "StdUtilities.h"
 #include "StepDialog.h"
 #include "DateUtils.h"
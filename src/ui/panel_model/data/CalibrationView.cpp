@@ -4,7 +4,9 @@
 #include "Event.h"
 #include "Marker.h"
 #include "../PluginAbstract.h"
+#include "../PluginUiAbstract.h"
 #include "../GraphViewRefAbstract.h"
+#include "PluginUiManager.h"
 #include "MainWindow.h"
 #include "Project.h"
 #include "GraphView.h"
@@ -16,6 +18,7 @@
 #include "Label.h"
 #include "ModelUtilities.h"
 #include "QtUtilities.h"
+#include "WidgetUtilities.h"
 #include "DoubleValidator.h"
 #include <QtWidgets>
 #include <QClipboard>
@@ -144,7 +147,7 @@ void CalibrationView::updateGraphs()
     {
         DensityAnalysis results;
         results.analysis = analyseFunction(mDate.getCalibMap());
-        results.quartiles = quartilesForRepartition(mDate.mRepartition, mSettings.mTmin, mSettings.mStep);
+        results.quartiles = quartilesForRepartition(mDate.mRepartition, mDate.getCalibTmin(), mSettings.mStep);
         //mResultsLab->setText(densityAnalysisToString(results));
         QString resultsStr = densityAnalysisToString(results);
         // ------------------------------------------------------------
@@ -223,7 +226,7 @@ void CalibrationView::updateGraphs()
         // ------------------------------------------------------------
         
         // Get the ref graph for this plugin and this date
-        mRefGraphView = mDate.mPlugin->getGraphViewRef();
+        mRefGraphView = PluginUiManager::getPluginUi(mDate.mPlugin)->getGraphViewRef();
         if(mRefGraphView)
         {
             mRefGraphView->setFormatFunctX(DateUtils::convertToAppSettingsFormatStr); // must be before setDate, because setDate use it
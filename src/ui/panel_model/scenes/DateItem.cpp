@@ -3,6 +3,9 @@
 #include "Painting.h"
 #include "EventItem.h"
 #include "Project.h"
+#include "GraphView.h"
+#include "StdUtilities.h"
+#include "../PluginAbstract.h"
 #include <QtWidgets>
 
 
@@ -25,7 +28,74 @@ mGreyedOut(false)
     d.mSettings.mStep = s.mStep;
     d.calibrate(s);
     //    qDebug()<<" DateItem::DateItem"<<d.mSettings.mTmin<<d.mSettings.mTmax<<d.mSettings.mStep;
-    mCalibThumb = d.generateCalibThumb();
+    mCalibThumb = generateCalibThumb(d);
+}
+
+/**
+ * @brief Thumbnail of the calibration drawn in the item (was Date::generateCalibThumb : the model does not depend on the widgets anymore)
+ */
+QPixmap DateItem::generateCalibThumb(const Date& date)
+{
+    if(date.mIsValid){
+        //  No need to draw the graph on a large size
+        //  These values are arbitary
+        QSize size(200, 30);
+        QPixmap thumb(size);
+        
+        QPainter p;
+        p.begin(&thumb);
+        p.setRenderHint(QPainter::Antialiasing);
+        
+        double tmin = date.mSettings.mTmin;
+        double tmax = date.mSettings.mTmax;
+        // qDebug()<<" DateItem::generateCalibThumb"<<tmin<<tmax<<date.mSettings.mStep;
+        GraphView graph;
+        graph.setFixedSize(size);
+        graph.setMargins(0, 0, 0, 0);
+        
+        graph.setRangeX(tmin, tmax);
+        graph.setCurrentX(tmin, tmax);
+        graph.setRangeY(0, 1.1f);
+        
+        graph.showXAxisArrow(false);
+        graph.showXAxisTicks(false);
+        graph.showXAxisSubTicks(false);
+        graph.showXAxisValues(false);
+        
+        graph.showYAxisArrow(false);
+        graph.showYAxisTicks(false);
+        graph.showYAxisSubTicks(false);
+        graph.showYAxisValues(false);
+        
+        graph.setXAxisMode(GraphView::eHidden);
+        graph.setYAxisMode(GraphView::eHidden);
+        
+        QColor color = date.mPlugin->getColor();//  Painting::mainColorLight;
+        
+        GraphCurve curve;
+        curve.mData = normalize_map(date.getCalibMap());
+        curve.mName = "Calibration";
+        curve.mPen = QPen(color, 2.f);
+        curve.mBrush = color;
+        curve.mIsHisto = false;
+        curve.mIsRectFromZero = true; // For Typo !!
+        
+        graph.addCurve(curve);
+        graph.repaint();
+        
+        graph.render(&p);
+        p.end();
+        
+        return thumb;
+    }
+    else{
+        // If date is invalid, return a null pixmap!
+        return QPixmap();
+    }
+    
+    //thumb.save("test.png");
+    //thumb = graph.grab();
+    
 }
 
 const QJsonObject& DateItem::date() const
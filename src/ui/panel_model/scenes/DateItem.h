@@ -3,11 +3,14 @@
 
 #include <QObject>
 #include <QGraphicsObject>
+#include <QPixmap>
 #include <QJsonObject>
 #include <QColor>
 #include "EventsScene.h"
 #include "ProjectSettings.h"
 
+class Date;
+
 class DateItem : public QGraphicsObject
 {
     Q_OBJECT
@@ -22,6 +25,8 @@ public:
     QRectF boundingRect() const;
     
 protected:
+    static QPixmap generateCalibThumb(const Date& date);
+    
     void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget);
     void mousePressEvent(QGraphicsSceneMouseEvent* e);
     void mouseReleaseEvent(QGraphicsSceneMouseEvent* e);
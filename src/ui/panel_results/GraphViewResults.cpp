@@ -2,6 +2,7 @@
 #include "Button.h"
 #include "Painting.h"
 #include "QtUtilities.h"
+#include "WidgetUtilities.h"
 #include "MainWindow.h"
 #include "MHVariable.h"
 #include <QtWidgets>
@@ -25,9 +25,11 @@
 #include "Project.h"
 
 #include "QtUtilities.h"
+#include "WidgetUtilities.h"
 #include "StdUtilities.h"
 #include "ModelUtilities.h"
 #include "DoubleValidator.h"
+#include "Trace.h"
 
 #include "../PluginAbstract.h"
 
@@ -512,6 +514,7 @@ void ResultsView::updateControls()
 
 void ResultsView::updateLayout()
 {
+    TraceScope trace("ui", "ResultsView::updateLayout");
     qDebug() << "ResultsView::updateLayout";
     
     int sbe = qApp->style()->pixelMetric(QStyle::PM_ScrollBarExtent);
@@ -707,6 +710,7 @@ void ResultsView::clearResults()
  */
 void ResultsView::updateResults(Model* model)
 {
+    TraceScope trace("ui", "ResultsView::updateResults");
     clearResults();
 
     qDebug() << "ResultsView::updateResults";
@@ -715,7 +719,20 @@ void ResultsView::updateResults(Model* model)
         return;
     
     if(model)
+    {
         mModel = model;
+        
+        // Show the parameters of the densities already computed, so that they are reused
+        int fftLen = 0;
+        double hFactor = 0;
+        if(mModel->getHistosParameters(fftLen, hFactor))
+        {
+            mFFTLenCombo->blockSignals(true);
+            mFFTLenCombo->setCurrentText(QString::number(fftLen));
+            mFFTLenCombo->blockSignals(false);
+            mHFactorEdit->setText(QString::number(hFactor));
+        }
+    }
     
     mChains = mModel->mChains;
     mSettings = mModel->mSettings;
@@ -989,8 +1006,7 @@ void ResultsView::generatePosteriorDistribs()
             hFactor = 1;
             mHFactorEdit->setText("1");
         }
-        mModel->clearPosteriorDensities();
-        
+        // Densities still valid for these parameters (e.g. restored from the .dat file) are not computed again
         mModel->generatePosteriorDensities(mChains, len, hFactor);
         mModel->generateNumericalResults(mChains);
         
@@ -1009,7 +1025,6 @@ void ResultsView::generateCredibilityAndHPD()
         
         // ??? mModel->generateNumericalResults(mChains);
         
-        mModel->clearCredibilityAndHPD();
         mModel->generateCredibilityAndHPD(mChains, mHPDEdit->text().toDouble());
         
         emit credibilityAndHPDGenerated();
@@ -1022,6 +1037,7 @@ void ResultsView::generateCredibilityAndHPD()
  */
 void ResultsView::generateCurves()
 {
+    TraceScope trace("ui", "ResultsView::generateCurves");
     qDebug() << "ResultsView::generateCurves";
     
     GraphViewResults::Variable variable;
@@ -1084,6 +1100,7 @@ void ResultsView::updateCurvesToShow()
  */
 void ResultsView::updateScales()
 {
+    TraceScope trace("ui", "ResultsView::updateScales");
     qDebug() << "ResultsView::updateScales";
     
     int tabIdx = mTabs->currentIndex();
@@ -489,6 +489,7 @@ void MainWindow::appSettings()
 void MainWindow::setAppSettings(const AppSettings& s)
 {
     mAppSettings = s;
+    AppSettings::setCurrent(mAppSettings);
     QLocale::Language newLanguage = s.mLanguage;
     QLocale::Country newCountry= s.mCountry;
     
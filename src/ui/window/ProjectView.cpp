@@ -2,6 +2,7 @@
 #include "ModelView.h"
 #include "ResultsView.h"
 #include "Painting.h"
+#include "MainWindow.h"
 #include <QtWidgets>
 
 #pragma mark Constructor / Destructor / Init
@@ -46,9 +47,19 @@ ProjectView::ProjectView(QWidget* parent, Qt::WindowFlags flags):QWidget(parent,
     mLogTabs->addTab(mLogResultsEdit, tr("Posterior distrib. results"));
     mLogTabs->setContentsMargins(15, 15, 15, 15);
     
+    mExportInstrumentationBut = new QPushButton(tr("Export timings..."));
+    mExportInstrumentationBut->setEnabled(false);
+    connect(mExportInstrumentationBut, SIGNAL(clicked()), this, SLOT(exportInstrumentation()));
+    
+    QHBoxLayout* logButtonsLayout = new QHBoxLayout();
+    logButtonsLayout->setContentsMargins(15, 0, 15, 0);
+    logButtonsLayout->addStretch();
+    logButtonsLayout->addWidget(mExportInstrumentationBut);
+    
     mLogView = new QWidget();
     QVBoxLayout* logLayout = new QVBoxLayout();
     logLayout->addWidget(mLogTabs);
+    logLayout->addLayout(logButtonsLayout);
     mLogView->setLayout(logLayout);
     
     mStack = new QStackedWidget();
@@ -83,6 +94,8 @@ void ProjectView::resetInterface()
     showModel();
     mModelView   -> resetInterface();
     mResultsView -> clearResults();
+    mInstrumentation = QJsonObject();
+    mExportInstrumentationBut->setEnabled(false);
 }
 void ProjectView::showHelp(bool show)
 {
@@ -141,6 +154,8 @@ void ProjectView:: ApplySettings(Model* model)
         mLogModelEdit->setText(model->getModelLog());
 
         mLogMCMCEdit->setText(model->getMCMCLog());
+        mInstrumentation = model->mInstrumentation.toJson();
+        mExportInstrumentationBut->setEnabled(!model->mInstrumentation.isEmpty());
 
         model->generateResultsLog();
         updateResultsLog(model->getResultsLog());
@@ -159,6 +174,8 @@ void ProjectView::updateResults(Model* model)
         mLogModelEdit->setText(model->getModelLog());
         
         mLogMCMCEdit->setText(model->getMCMCLog());
+        mInstrumentation = model->mInstrumentation.toJson();
+        mExportInstrumentationBut->setEnabled(!model->mInstrumentation.isEmpty());
         
         model->generateResultsLog();
         mLogResultsEdit->setText(model->getResultsLog());
@@ -172,6 +189,22 @@ void ProjectView::updateResultsLog(const QString& log)
     mLogResultsEdit->setText(log);
 }
 
+void ProjectView::exportInstrumentation()
+{
+    QString path = QFileDialog::getSaveFileName(qApp->activeWindow(), tr("Export timings"),
+                                                MainWindow::getInstance()->getCurrentPath(), tr("JSON File (*.json)"));
+    if(path.isEmpty())
+        return;
+    
+    MainWindow::getInstance()->setCurrentPath(QFileInfo(path).absolutePath());
+    
+    QFile file(path);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Text) || file.write(QJsonDocument(mInstrumentation).toJson(QJsonDocument::Indented)) < 0)
+    {
+        QMessageBox::warning(qApp->activeWindow(), tr("Export timings"), tr("Cannot write the file : ") + path);
+    }
+}
+
 
 #pragma mark Read/Write settings
 void ProjectView::writeSettings()
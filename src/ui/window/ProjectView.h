@@ -2,11 +2,13 @@
 #define ProjectView_H
 
 #include <QWidget>
+#include <QJsonObject>
 #include "MCMCLoopMain.h"
 
 class QStackedWidget;
 class QTextEdit;
 class QTabWidget;
+class QPushButton;
 
 class ModelView;
 class ResultsView;
@@ -42,6 +44,7 @@ public slots:
 
     void updateResults(Model*);
     void updateResultsLog(const QString& log);
+    void exportInstrumentation();
     
 private:
     QStackedWidget* mStack;
@@ -52,6 +55,10 @@ private:
     QTextEdit* mLogModelEdit;
     QTextEdit* mLogMCMCEdit;
     QTextEdit* mLogResultsEdit;
+    
+    // Timings of the last run, as shown at the end of the MCMC log
+    QPushButton* mExportInstrumentationBut;
+    QJsonObject mInstrumentation;
 };
 
 #endif
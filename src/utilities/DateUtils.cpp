@@ -1,5 +1,5 @@
 #include "DateUtils.h"
-#include "MainWindow.h"
+#include "AppSettings.h"
 #include <cmath>
 #include <QLocale>
 
@@ -54,7 +54,7 @@ QString DateUtils::dateToString(const double date, int precision){
     QLocale locale;
     locale.setNumberOptions(QLocale::OmitGroupSeparator);
     if(precision == -1)
-        precision = MainWindow::getInstance()->getAppSettings().mPrecision;
+        precision = AppSettings::current().mPrecision;
     char fmt = 'f';
     if (date>250000){
         fmt = 'G';
@@ -66,7 +66,7 @@ QString DateUtils::dateToString(const double date, int precision){
         return locale.toString(date, fmt, precision);
 }
 QString DateUtils::getAppSettingsFormat(){
-    return formatString(MainWindow::getInstance()->getAppSettings().mFormatDate);
+    return formatString(AppSettings::current().mFormatDate);
 }
 
 
@@ -74,7 +74,7 @@ QString DateUtils::convertToAppSettingsFormatStr(const double valueToFormat){
     return dateToString(convertToAppSettingsFormat(valueToFormat));
 }
 double DateUtils::convertToAppSettingsFormat(const double valueToFormat){
-    const AppSettings& s = MainWindow::getInstance()->getAppSettings();
+    const AppSettings& s = AppSettings::current();
     return DateUtils::convertToFormat(valueToFormat, s.mFormatDate);
 }
 
@@ -82,7 +82,7 @@ QString DateUtils::convertFromAppSettingsFormatStr(const double formattedValue){
     return dateToString(convertFromAppSettingsFormat(formattedValue));
 }
 double DateUtils::convertFromAppSettingsFormat(const double formattedValue){
-    const AppSettings& s = MainWindow::getInstance()->getAppSettings();
+    const AppSettings& s = AppSettings::current();
     return DateUtils::convertFromFormat(formattedValue, s.mFormatDate);
 }
 
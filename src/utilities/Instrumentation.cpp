@@ -0,0 +1,189 @@
+#include "Instrumentation.h"
+#include "QtUtilities.h"
+
+#include <QJsonArray>
+#include <QLocale>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#endif
+
+
+void InstrumentStat::add(qint64 ns, quint64 items)
+{
+    ++mCalls;
+    mItems += items;
+    mTotalNs += ns;
+    if(ns > mMaxNs)
+        mMaxNs = ns;
+}
+
+#pragma mark Instrumentation
+Instrumentation::Instrumentation()
+{
+    
+}
+
+Instrumentation::~Instrumentation()
+{
+    qDeleteAll(mStats);
+}
+
+InstrumentStat* Instrumentation::stat(const QString& name)
+{
+    QMutexLocker locker(&mMutex);
+    InstrumentStat* stat = mStats.value(name, 0);
+    if(!stat)
+    {
+        stat = new InstrumentStat();
+        mStats.insert(name, stat);
+        mNames.append(name);
+    }
+    return stat;
+}
+
+void Instrumentation::setValue(const QString& name, double value)
+{
+    QMutexLocker locker(&mMutex);
+    if(!mValues.contains(name))
+        mValueNames.append(name);
+    mValues[name] = value;
+}
+
+/**
+ * @brief The stats are reset, not deleted : the pointers kept by the loops stay valid.
+ */
+void Instrumentation::clear()
+{
+    QMutexLocker locker(&mMutex);
+    for(QMap<QString, InstrumentStat*>::iterator it = mStats.begin(); it != mStats.end(); ++it)
+        *it.value() = InstrumentStat();
+    mValues.clear();
+    mValueNames.clear();
+}
+
+bool Instrumentation::isEmpty() const
+{
+    QMutexLocker locker(&mMutex);
+    for(QMap<QString, InstrumentStat*>::const_iterator it = mStats.constBegin(); it != mStats.constEnd(); ++it)
+    {
+        if(it.value()->mCalls > 0)
+            return false;
+    }
+    return mValues.isEmpty();
+}
+
+QJsonObject Instrumentation::toJson() const
+{
+    QMutexLocker locker(&mMutex);
+    
+    QJsonArray stats;
+    for(int i=0; i<mNames.size(); ++i)
+    {
+        const InstrumentStat* stat = mStats.value(mNames.at(i));
+        if(stat->mCalls == 0)
+            continue;
+        
+        const double seconds = stat->mTotalNs * 1e-9;
+        QJsonObject json;
+        json["name"] = mNames.at(i);
+        json["calls"] = (double)stat->mCalls;
+        json["items"] = (double)stat->mItems;
+        json["total_s"] = seconds;
+        json["mean_ms"] = stat->mTotalNs * 1e-6 / stat->mCalls;
+        json["max_ms"] = stat->mMaxNs * 1e-6;
+        if(seconds > 0)
+            json["items_per_s"] = stat->mItems / seconds;
+        stats.append(json);
+    }
+    
+    QJsonObject values;
+    for(int i=0; i<mValueNames.size(); ++i)
+        values[mValueNames.at(i)] = mValues.value(mValueNames.at(i));
+    
+    QJsonObject json;
+    json["stats"] = stats;
+    json["values"] = values;
+    json["peak_memory_bytes"] = (double)peakMemory();
+    return json;
+}
+
+/**
+ * @brief Table appended to the MCMC log
+ */
+QString Instrumentation::toHtml() const
+{
+    QMutexLocker locker(&mMutex);
+    QLocale locale;
+    
+    QString html = "<hr>" + textBold("Timings") + "<br>";
+    html += "<table cellspacing=\"0\" cellpadding=\"3\">";
+    html += "<tr><td><b>Stage</b></td><td align=\"right\"><b>Calls</b></td><td align=\"right\"><b>Total (s)</b></td><td align=\"right\"><b>Mean (ms)</b></td><td align=\"right\"><b>Max (ms)</b></td><td align=\"right\"><b>Items / s</b></td></tr>";
+    for(int i=0; i<mNames.size(); ++i)
+    {
+        const InstrumentStat* stat = mStats.value(mNames.at(i));
+        if(stat->mCalls == 0)
+            continue;
+        
+        const double seconds = stat->mTotalNs * 1e-9;
+        html += "<tr><td>" + mNames.at(i) + "</td>";
+        html += "<td align=\"right\">" + locale.toString((qulonglong)stat->mCalls) + "</td>";
+        html += "<td align=\"right\">" + locale.toString(seconds, 'f', 3) + "</td>";
+        html += "<td align=\"right\">" + locale.toString(stat->mTotalNs * 1e-6 / stat->mCalls, 'f', 3) + "</td>";
+        html += "<td align=\"right\">" + locale.toString(stat->mMaxNs * 1e-6, 'f', 3) + "</td>";
+        html += "<td align=\"right\">" + ((seconds > 0) ? locale.toString(stat->mItems / seconds, 'f', 0) : QString()) + "</td></tr>";
+    }
+    html += "</table>";
+    
+    for(int i=0; i<mValueNames.size(); ++i)
+        html += line(mValueNames.at(i) + " : " + locale.toString(mValues.value(mValueNames.at(i)), 'f', 1));
+    
+    const qint64 memory = peakMemory();
+    if(memory >= 0)
+        html += line("Peak memory : " + locale.toString(memory / (1024. * 1024.), 'f', 1) + " MB");
+    return html;
+}
+
+qint64 Instrumentation::peakMemory()
+{
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return (qint64)counters.PeakWorkingSetSize;
+    return -1;
+#elif defined(Q_OS_UNIX)
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) != 0)
+        return -1;
+#if defined(Q_OS_MAC)
+    return (qint64)usage.ru_maxrss; // bytes
+#else
+    return (qint64)usage.ru_maxrss * 1024; // kilobytes
+#endif
+#else
+    return -1;
+#endif
+}
+
+#pragma mark Scoped timer
+ScopedTimer::ScopedTimer(InstrumentStat* stat, quint64 items):
+mStat(stat),
+mItems(items)
+{
+    if(mStat)
+        mTimer.start();
+}
+
+ScopedTimer::~ScopedTimer()
+{
+    if(mStat)
+        mStat->add(mTimer.nsecsElapsed(), mItems);
+}
+
+void ScopedTimer::setItems(quint64 items)
+{
+    mItems = items;
+}
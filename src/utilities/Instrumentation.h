@@ -0,0 +1,79 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <QString>
+#include <QStringList>
+#include <QMap>
+#include <QMutex>
+#include <QJsonObject>
+#include <QElapsedTimer>
+
+
+/**
+ * @brief Calls, processed items and time of an instrumented stage.
+ * A stat is only updated by one thread at a time (e.g. the MCMC thread) : it is not locked.
+ */
+struct InstrumentStat
+{
+    InstrumentStat(): mCalls(0), mItems(0), mTotalNs(0), mMaxNs(0) {}
+    
+    void add(qint64 ns, quint64 items = 1);
+    
+    quint64 mCalls;
+    quint64 mItems;
+    qint64 mTotalNs;
+    qint64 mMaxNs;
+};
+
+/**
+ * @brief Named timers, counters and values of a run (MCMC stages, update of each kind of variable,
+ * post-processing...), shown in the MCMC log and exported as JSON.
+ * The stats are created on demand and keep their address : the hot loops keep pointers to them.
+ * Names are "<group>/<stage>", e.g. "mcmc/update", "update/dates", "results/densities".
+ */
+class Instrumentation
+{
+public:
+    Instrumentation();
+    ~Instrumentation();
+    
+    InstrumentStat* stat(const QString& name);
+    void setValue(const QString& name, double value);
+    void clear();
+    bool isEmpty() const;
+    
+    QJsonObject toJson() const;
+    QString toHtml() const;
+    
+    // Peak resident memory of the process (bytes), or -1 if unknown on this system
+    static qint64 peakMemory();
+    
+private:
+    Instrumentation(const Instrumentation&);
+    Instrumentation& operator=(const Instrumentation&);
+    
+    mutable QMutex mMutex;
+    QStringList mNames; // in order of creation
+    QMap<QString, InstrumentStat*> mStats;
+    QStringList mValueNames;
+    QMap<QString, double> mValues;
+};
+
+/**
+ * @brief Adds its lifetime to a stat (nothing if the stat is null)
+ */
+class ScopedTimer
+{
+public:
+    ScopedTimer(InstrumentStat* stat, quint64 items = 1);
+    ~ScopedTimer();
+    
+    void setItems(quint64 items);
+    
+private:
+    InstrumentStat* mStat;
+    quint64 mItems;
+    QElapsedTimer mTimer;
+};
+
+#endif
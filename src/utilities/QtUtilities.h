@@ -4,23 +4,18 @@
 #include <QStringList>
 #include <QColor>
 #include <QFileInfo>
+#include <QJsonArray>
 #include "AppSettings.h"
-#include "AxisTool.h"
 
 bool colorIsDark(const QColor& color);
 void sortIntList(QList<int>& list);
 
 QList<QStringList> readCSV(const QString& filePath, const QString& separator = ",");
-int defaultDpiX();
-qreal dpiScaled(qreal value);
 QColor getContrastedColor(const QColor& color);
 QList<int> stringListToIntList(const QString& listStr, const QString& separator = ",");
 QStringList intListToStringList(const QList<int>& intList);
 QString intListToString(const QList<int>& intList, const QString& separator = ",");
 
-QFileInfo saveWidgetAsImage(QObject* widget, const QRect& r, const QString& dialogTitle, const QString& defaultPath,  const AppSettings & setting);
-bool saveWidgetAsSVG(QWidget* widget, const QRect& r, const QString& fileName);
-
 bool isComment(const QString& str);
 QString prepareTooltipText(const QString& title, const QString& text);
 
@@ -38,7 +33,6 @@ bool constraintIsCircular( QJsonArray constraints, const int FromId, const int T
 QString formatValueToAppSettingsPrecision(const double valueToFormat);
 
 bool saveCsvTo(const QList<QStringList>& data, const QString& filePath, const QString& csvSep);
-bool saveAsCsv(const QList<QStringList>& data, const QString& title = QObject::tr("Save as..."));
 
 
 #endif
@@ -310,6 +310,38 @@ double vector_interpolate_idx_for_value(const double value, const QVector<double
     }
     return 0;
 }
+
+/**
+    @brief Accumulates the logarithms of "values" into "logSum" : a null value gives -inf, so the product stays null.
+    Flat loops over contiguous buffers, left for the compiler to vectorize.
+ */
+void log_accumulate(double* logSum, const double* values, const int n)
+{
+    for(int i=0; i<n; ++i)
+        logSum[i] += log(values[i]);
+}
+
+/**
+    @brief Replaces the logarithms in "data" by exp(data[i] - max) and returns the max.
+    The largest value becomes 1 : the scale of the product is lost but it never underflows.
+ */
+double exp_from_log(double* data, const int n)
+{
+    double maxLog = -INFINITY;
+    for(int i=0; i<n; ++i)
+        maxLog = std::max(maxLog, data[i]);
+    
+    if(!std::isfinite(maxLog))
+    {
+        std::fill(data, data + n, 0.);
+        return maxLog;
+    }
+    
+    for(int i=0; i<n; ++i)
+        data[i] = exp(data[i] - maxLog);
+    return maxLog;
+}
+
 /**
     @brief  This function make a QMap which are a copy of the QMap aMap to obtain an percent of area
     @param threshold is in percent
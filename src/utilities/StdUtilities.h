@@ -182,6 +182,10 @@ QVector<double> equal_areas(const QVector<double>& data, const double step, cons
 QMap<double, double> vector_to_map(const QVector<double>& data, const double min, const double max, const double step);
 double vector_interpolate_idx_for_value(const double value, const QVector<double>& vector);
 
+// Products of densities in log space : logSum[i] += log(values[i]), then data[i] = exp(data[i] - max)
+void log_accumulate(double* logSum, const double* values, const int n);
+double exp_from_log(double* data, const int n);
+
 double map_area(const QMap<double, double>& map);
 const QMap<double, double> create_HPD(const QMap<double, double>& aMap, double threshold);
 
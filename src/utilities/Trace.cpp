@@ -0,0 +1,224 @@
+#include "Trace.h"
+
+#include <QCoreApplication>
+#include <QThread>
+#include <QMutex>
+#include <QList>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QSaveFile>
+
+
+namespace
+{
+    QAtomicInt sEnabled(0);
+    QAtomicInt sGeneration(0);
+    QElapsedTimer sClock;
+
+    // Buffers of all the threads which have traced something : they live until the end of the process,
+    // because the threads of the pools are reused and keep a pointer to their buffer.
+    QMutex sBuffersMutex;
+    QList<TraceBuffer*> sBuffers;
+
+    thread_local TraceBuffer* tBuffer = 0;
+}
+
+#pragma mark Buffer
+TraceBuffer::TraceBuffer(int threadId, const QString& threadName):
+mEvents(new TraceEvent[TRACE_BUFFER_SIZE]),
+mCount(0),
+mDropped(0),
+mGeneration(sGeneration.load()),
+mThreadId(threadId),
+mThreadName(threadName)
+{
+
+}
+
+TraceBuffer::~TraceBuffer()
+{
+    delete[] mEvents;
+}
+
+void TraceBuffer::append(const char* category, const QString& name, qint64 startNs, qint64 durationNs)
+{
+    const int generation = sGeneration.load();
+    if(mGeneration.load() != generation)
+    {
+        mCount.storeRelease(0);
+        mDropped.store(0);
+        mGeneration.store(generation);
+    }
+
+    const int index = mCount.load();
+    if(index >= TRACE_BUFFER_SIZE)
+    {
+        mDropped.ref();
+        return;
+    }
+    TraceEvent& event = mEvents[index];
+    event.mCategory = category;
+    event.mName = name;
+    event.mStartNs = startNs;
+    event.mDurationNs = durationNs;
+
+    // The event is complete before it can be read
+    mCount.storeRelease(index + 1);
+}
+
+#pragma mark Trace
+void Trace::start()
+{
+    // The buffers are cleared lazily, by the next append of their own thread
+    sGeneration.ref();
+    sClock.start();
+    sEnabled.storeRelease(1);
+}
+
+void Trace::stop()
+{
+    sEnabled.storeRelease(0);
+}
+
+bool Trace::isEnabled()
+{
+    return sEnabled.loadAcquire() != 0;
+}
+
+qint64 Trace::now()
+{
+    return sClock.nsecsElapsed();
+}
+
+void Trace::add(const char* category, const QString& name, qint64 startNs, qint64 durationNs)
+{
+    if(!isEnabled())
+        return;
+    threadBuffer()->append(category, name, startNs, durationNs);
+}
+
+TraceBuffer* Trace::threadBuffer()
+{
+    if(!tBuffer)
+    {
+        QMutexLocker locker(&sBuffersMutex);
+        const int threadId = sBuffers.size() + 1;
+
+        QThread* thread = QThread::currentThread();
+        QString threadName = thread->objectName();
+        if(QCoreApplication::instance() && thread == QCoreApplication::instance()->thread())
+            threadName = "Main";
+        else if(threadName.isEmpty())
+            threadName = "Thread " + QString::number(threadId);
+
+        tBuffer = new TraceBuffer(threadId, threadName);
+        sBuffers.append(tBuffer);
+    }
+    return tBuffer;
+}
+
+/**
+ * @brief Chrome trace-event format : "X" events with their timestamp and duration in microseconds,
+ * and "M" events naming the threads.
+ */
+void Trace::write(const QString& path)
+{
+    const int generation = sGeneration.load();
+    QJsonArray events;
+    int dropped = 0;
+
+    {
+        QMutexLocker locker(&sBuffersMutex);
+        for(int i=0; i<sBuffers.size(); ++i)
+        {
+            const TraceBuffer* buffer = sBuffers.at(i);
+            if(buffer->mGeneration.load() != generation)
+                continue;
+
+            const int count = buffer->mCount.loadAcquire();
+            if(count == 0)
+                continue;
+
+            QJsonObject args;
+            args["name"] = buffer->mThreadName;
+            QJsonObject threadName;
+            threadName["name"] = QString("thread_name");
+            threadName["ph"] = QString("M");
+            threadName["pid"] = 1;
+            threadName["tid"] = buffer->mThreadId;
+            threadName["args"] = args;
+            events.append(threadName);
+
+            for(int j=0; j<count; ++j)
+            {
+                const TraceEvent& event = buffer->mEvents[j];
+                QJsonObject json;
+                json["name"] = event.mName;
+                json["cat"] = QString(event.mCategory);
+                json["ph"] = QString("X");
+                json["ts"] = event.mStartNs * 1e-3;
+                json["dur"] = event.mDurationNs * 1e-3;
+                json["pid"] = 1;
+                json["tid"] = buffer->mThreadId;
+                events.append(json);
+            }
+            dropped += buffer->mDropped.load();
+        }
+    }
+
+    QJsonObject otherData;
+    otherData["application"] = qApp ? qApp->applicationName() + " " + qApp->applicationVersion() : QString();
+    otherData["dropped_events"] = dropped;
+
+    QJsonObject trace;
+    trace["traceEvents"] = events;
+    trace["displayTimeUnit"] = QString("ms");
+    trace["otherData"] = otherData;
+
+    const QByteArray data = QJsonDocument(trace).toJson(QJsonDocument::Compact);
+    QSaveFile file(path);
+    if(!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit())
+        throw QObject::tr("Cannot write the file : ") + path;
+}
+
+#pragma mark Scope
+TraceScope::TraceScope(const char* category, const char* name):
+mCategory(category),
+mStartNs(-1)
+{
+    if(Trace::isEnabled())
+    {
+        mName = QString(name);
+        mStartNs = Trace::now();
+    }
+}
+
+TraceScope::TraceScope(const char* category):
+mCategory(category),
+mStartNs(-1)
+{
+    if(Trace::isEnabled())
+        mStartNs = Trace::now();
+}
+
+TraceScope::~TraceScope()
+{
+    end();
+}
+
+void TraceScope::restart()
+{
+    end();
+    mName.clear();
+    if(Trace::isEnabled())
+        mStartNs = Trace::now();
+}
+
+void TraceScope::end()
+{
+    if(mStartNs >= 0)
+        Trace::add(mCategory, mName, mStartNs, Trace::now() - mStartNs);
+    mStartNs = -1;
+}
@@ -0,0 +1,106 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QString>
+#include <QAtomicInt>
+
+// Events kept per thread : the next ones are dropped (and counted) when a buffer is full
+#define TRACE_BUFFER_SIZE 32768
+
+// Environment variable enabling the trace of the application : path of the trace file written at exit
+#define TRACE_ENV_VARIABLE "CHRONOMODEL_TRACE"
+
+
+/**
+ * @brief Timed event of the trace : a "complete" event ("ph":"X") of the Chrome trace format
+ */
+struct TraceEvent
+{
+    TraceEvent(): mCategory(0), mStartNs(0), mDurationNs(0) {}
+
+    const char* mCategory;
+    QString mName;
+    qint64 mStartNs;
+    qint64 mDurationNs;
+};
+
+/**
+ * @brief Events of one thread. Only this thread appends events :
+ * the count is published after the event is written, so the trace can be read at any time without lock.
+ */
+class TraceBuffer
+{
+public:
+    TraceBuffer(int threadId, const QString& threadName);
+    ~TraceBuffer();
+
+    void append(const char* category, const QString& name, qint64 startNs, qint64 durationNs);
+
+    TraceEvent* mEvents;
+    QAtomicInt mCount;
+    QAtomicInt mDropped;
+    QAtomicInt mGeneration; // the events of older generations are cleared by the next append
+    int mThreadId;
+    QString mThreadName;
+
+private:
+    TraceBuffer(const TraceBuffer&);
+    TraceBuffer& operator=(const TraceBuffer&);
+};
+
+/**
+ * @brief Opt-in timeline of a run (calibration of each date, chain stages, adapt batches, post-processing,
+ * save / load, rendering...) written as a Chrome trace-event file, to be opened in chrome://tracing or Perfetto.
+ * Nothing is recorded until start() is called : the cost of a disabled TraceScope is one atomic load.
+ * The trace is enabled by the --trace option of the command line, or by the CHRONOMODEL_TRACE environment variable.
+ */
+class Trace
+{
+public:
+    // Clears the previous events and starts the clock of the trace
+    static void start();
+    static void stop();
+    static bool isEnabled();
+
+    // Nanoseconds since start()
+    static qint64 now();
+    static void add(const char* category, const QString& name, qint64 startNs, qint64 durationNs);
+
+    // Writes the events recorded so far (throws a QString on error)
+    static void write(const QString& path);
+
+private:
+    static TraceBuffer* threadBuffer();
+};
+
+/**
+ * @brief Records its lifetime as an event of the trace (nothing if the trace is disabled).
+ * Names built at run time are given with TRACE_SCOPE and TRACE_RESTART, so that they are not built when the trace is disabled.
+ */
+class TraceScope
+{
+public:
+    TraceScope(const char* category, const char* name);
+    // Event without name : it is given by setName() when isActive()
+    explicit TraceScope(const char* category);
+    ~TraceScope();
+
+    bool isActive() const {return mStartNs >= 0;}
+    void setName(const QString& name) {mName = name;}
+
+    // Ends the current event and starts the next one, e.g. for the stages of a chain
+    void restart();
+
+private:
+    void end();
+
+    const char* mCategory;
+    QString mName;
+    qint64 mStartNs;
+};
+
+// Declares the TraceScope "variable" : the name expression is only evaluated when the trace is enabled
+#define TRACE_SCOPE(variable, category, name) TraceScope variable(category); if(variable.isActive()) variable.setName(name)
+#define TRACE_RESTART(variable, name) do{ variable.restart(); if(variable.isActive()) variable.setName(name); }while(0)
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef WIDGETUTILITIES_H
+#define WIDGETUTILITIES_H
+
+#include <QStringList>
+#include <QFileInfo>
+#include <QObject>
+#include <QRect>
+#include "AppSettings.h"
+
+class QWidget;
+
+// Helpers of the user interface : they need a QApplication (QtUtilities is used by the core library and the command line)
+
+int defaultDpiX();
+qreal dpiScaled(qreal value);
+
+QFileInfo saveWidgetAsImage(QObject* widget, const QRect& r, const QString& dialogTitle, const QString& defaultPath,  const AppSettings & setting);
+bool saveWidgetAsSVG(QWidget* widget, const QRect& r, const QString& fileName);
+
+bool saveAsCsv(const QList<QStringList>& data, const QString& title = QObject::tr("Save as..."));
+
+
+#endif